@@ -0,0 +1,106 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "PraxisInventoryObservers.h"
+#include "PraxisInventoryService.h"
+#include "MassExecutionContext.h"
+#include "Fragments/MaterialFragments.h"
+#include "Fragments/MaterialIndexDirtyTag.h"
+#include "Fragments/MaterialPooledTag.h"
+#include "Fragments/MaterialSKUFragment.h"
+
+// ════════════════════════════════════════════════════════════════════════════════
+// Base
+// ════════════════════════════════════════════════════════════════════════════════
+
+UPraxisMaterialObserver::UPraxisMaterialObserver()
+	: EntityQuery(*this)
+{
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::All);
+
+	// The service's indexes are game-thread only
+	bRequiresGameThreadExecution = true;
+}
+
+void UPraxisMaterialObserver::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager)
+{
+	// Every material entity has a quantity; no other archetype does
+	EntityQuery.AddRequirement<FMaterialQuantityFragment>(EMassFragmentAccess::ReadOnly);
+}
+
+void UPraxisMaterialObserver::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	UPraxisInventoryService* InventoryService = UWorld::GetSubsystem<UPraxisInventoryService>(EntityManager.GetWorld());
+	if (!InventoryService || InventoryService->IsIgnoringMaterialObservers())
+	{
+		return;
+	}
+
+	EntityQuery.ForEachEntityChunk(Context, [this, InventoryService](FMassExecutionContext& ChunkContext)
+	{
+		HandleChunk(*InventoryService, ChunkContext);
+	});
+}
+
+// ════════════════════════════════════════════════════════════════════════════════
+// Added / Removed / Changed
+// ════════════════════════════════════════════════════════════════════════════════
+
+UPraxisMaterialAddedObserver::UPraxisMaterialAddedObserver()
+{
+	ObservedType = FMaterialQuantityFragment::StaticStruct();
+	Operation = EMassObservedOperation::Add;
+}
+
+void UPraxisMaterialAddedObserver::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager)
+{
+	Super::ConfigureQueries(EntityManager);
+
+	// Pool entities are created without a SKU and parked; they only become material when spawned into
+	EntityQuery.AddConstSharedRequirement<FMaterialSKUFragment>();
+	EntityQuery.AddTagRequirement<FMaterialPooledTag>(EMassFragmentPresence::None);
+}
+
+void UPraxisMaterialAddedObserver::HandleChunk(UPraxisInventoryService& InventoryService, FMassExecutionContext& Context) const
+{
+	InventoryService.HandleMaterialEntitiesAdded(Context.GetEntities());
+}
+
+UPraxisMaterialRemovedObserver::UPraxisMaterialRemovedObserver()
+{
+	ObservedType = FMaterialQuantityFragment::StaticStruct();
+	Operation = EMassObservedOperation::Remove;
+}
+
+void UPraxisMaterialRemovedObserver::HandleChunk(UPraxisInventoryService& InventoryService, FMassExecutionContext& Context) const
+{
+	InventoryService.HandleMaterialEntitiesRemoved(Context.GetEntities());
+}
+
+UPraxisMaterialChangedObserver::UPraxisMaterialChangedObserver()
+{
+	ObservedType = FMaterialIndexDirtyTag::StaticStruct();
+	Operation = EMassObservedOperation::Add;
+}
+
+void UPraxisMaterialChangedObserver::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager)
+{
+	Super::ConfigureQueries(EntityManager);
+	EntityQuery.AddTagRequirement<FMaterialIndexDirtyTag>(EMassFragmentPresence::All);
+}
+
+void UPraxisMaterialChangedObserver::HandleChunk(UPraxisInventoryService& InventoryService, FMassExecutionContext& Context) const
+{
+	InventoryService.HandleMaterialEntitiesChanged(Context.GetEntities());
+
+	// Clear the flag once filed, so the next change is observed again. Parked entities
+	// filled in by another system have left the pool: unpark them too
+	const bool bParked = Context.DoesArchetypeHaveTag<FMaterialPooledTag>();
+	for (const FMassEntityHandle& Entity : Context.GetEntities())
+	{
+		Context.Defer().RemoveTag<FMaterialIndexDirtyTag>(Entity);
+		if (bParked)
+		{
+			Context.Defer().RemoveTag<FMaterialPooledTag>(Entity);
+		}
+	}
+}
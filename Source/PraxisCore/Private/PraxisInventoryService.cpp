@@ -5,6 +5,11 @@
 #include "PraxisMassSubsystem.h"
 #include "PraxisLocationRegistry.h"
 #include "Fragments/MaterialFragments.h"
+#include "Fragments/MaterialSKUFragment.h"
+#include "Fragments/MaterialPooledTag.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/Paths.h"
 
 // ════════════════════════════════════════════════════════════════════════════════
 // Lifecycle
@@ -17,6 +22,8 @@ void UPraxisInventoryService::Initialize(FSubsystemCollectionBase& Collection)
 	// Get our custom Mass subsystem
 	if (UWorld* World = GetWorld())
 	{
+		TransactionJournal.SetCapacity(TransactionHistoryCapacity);
+		
 		MassSubsystem = World->GetSubsystem<UPraxisMassSubsystem>();
 		LocationRegistry = World->GetSubsystem<UPraxisLocationRegistry>();
 		
@@ -48,10 +55,22 @@ void UPraxisInventoryService::Deinitialize()
 	// Capture count before cleanup
 	const int32 EntityCount = MaterialEntities.Num();
 	
+	// The auditor only reads its own slice copy, but don't leave it running past teardown
+	if (AuditTask.IsValid())
+	{
+		AuditTask.Wait();
+		AuditTask = UE::Tasks::TTask<TArray<FPraxisAuditFinding>>();
+	}
+	AuditInFlight.Reset();
+	AuditCursor = 0;
+	AuditRoundStartSequence = 0;
+	AuditPreviousRoundSequence = 0;
+	
 	// Cleanup all material entities
 	if (MassSubsystem && MassSubsystem->IsInitialized())
 	{
 		FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+		TGuardValue<bool> ObserverGuard(bIgnoreMaterialObservers, true);
 		
 		for (const FMassEntityHandle& Entity : MaterialEntities)
 		{
@@ -60,13 +79,60 @@ void UPraxisInventoryService::Deinitialize()
 				EntityManager.DestroyEntity(Entity);
 			}
 		}
+		
+		// Pooled and pending entities
+		for (const TPair<TPair<FName, FName>, FPraxisMaterialEntityPool>& Pool : EntityPools)
+		{
+			for (const FMassEntityHandle& Entity : Pool.Value.GetEntities())
+			{
+				if (EntityManager.IsEntityValid(Entity))
+				{
+					EntityManager.DestroyEntity(Entity);
+				}
+			}
+		}
+		for (const FMassEntityHandle& Entity : PendingEntityDestroys)
+		{
+			if (EntityManager.IsEntityValid(Entity))
+			{
+				EntityManager.DestroyEntity(Entity);
+			}
+		}
 	}
 	
 	MaterialEntities.Empty();
+	EntityPools.Empty();
+	PooledEntityCount = 0;
+	PendingEntityDestroys.Empty();
+	MaterialIndex.Reset();
+	SKUSharedFragments.Empty();
+	SKUUnitsOfMeasure.Empty();
 	BOMs.Empty();
-	Locations.Empty();
+	LocationTable.Reset();
+	LocationCapacities.Empty();
+	SubLocationCapacities.Empty();
+	SubLocationNodes.Empty();
+	SubLocationLookup.Empty();
+	PutawayBins.Empty();
+	PutawayIndexes.Empty();
+	LocationPutawayBins.Empty();
+	SubLocationPutawayBins.Empty();
+	MachineLocations.Empty();
 	InventoryCache.Empty();
-	TransactionHistory.Empty();
+	TransactionJournal.Reset();
+	Genealogy.Reset();
+	GenealogyCompactAt = 0;
+	ReservationLedger.Reset();
+	ReservationExpiryWheel.Reset();
+	ReservationExpiryTimers.Empty();
+	ReservationExpiryOwners.Empty();
+	CompactionCandidates.Empty();
+	OpenLots.Empty();
+	FluidStore.Reset();
+	SnapshotSlots[0].Reset();
+	SnapshotSlots[1].Reset();
+	DirtySnapshotSKUs.Empty();
+	DirtySnapshotLocations.Empty();
 	bArchetypeInitialized = false;
 	
 	UE_LOG(LogPraxisSim, Log, TEXT("Inventory service deinitialized - cleaned up %d entities"), EntityCount);
@@ -84,18 +150,33 @@ void UPraxisInventoryService::BuildMaterialEntityTemplate()
 	// Build fragment requirements for material entities
 	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
 	
-	// Create archetype composition descriptor with all material fragments
+	// Create archetype composition descriptor with all material fragments.
+	// SKU master data is a const shared fragment whose value is given at creation (so entities chunk by SKU)
 	FMassArchetypeCompositionDescriptor Composition;
-	Composition.Fragments.Add(*FMaterialTypeFragment::StaticStruct());
 	Composition.Fragments.Add(*FMaterialStateFragment::StaticStruct());
 	Composition.Fragments.Add(*FMaterialQuantityFragment::StaticStruct());
 	Composition.Fragments.Add(*FMaterialLocationFragment::StaticStruct());
 	Composition.Fragments.Add(*FMaterialGenealogyFragment::StaticStruct());
 	Composition.Fragments.Add(*FMaterialReservationFragment::StaticStruct());
+	Composition.ConstSharedFragments.Add(*FMaterialSKUFragment::StaticStruct());
 	
 	// Create archetype from composition
 	MaterialArchetype = EntityManager.CreateArchetype(Composition);
-	bArchetypeInitialized = MaterialArchetype.IsValid();
+	
+	// Pool refills are created parked, so bulk reads never see them
+	Composition.Tags.Add(*FMaterialPooledTag::StaticStruct());
+	PooledMaterialArchetype = EntityManager.CreateArchetype(Composition);
+	bArchetypeInitialized = MaterialArchetype.IsValid() && PooledMaterialArchetype.IsValid();
+	
+	// Chunk query for bulk reads
+	MaterialQuery = FMassEntityQuery(EntityManager.AsShared());
+	MaterialQuery.AddConstSharedRequirement<FMaterialSKUFragment>();
+	MaterialQuery.AddRequirement<FMaterialStateFragment>(EMassFragmentAccess::ReadOnly);
+	MaterialQuery.AddRequirement<FMaterialQuantityFragment>(EMassFragmentAccess::ReadOnly);
+	MaterialQuery.AddRequirement<FMaterialLocationFragment>(EMassFragmentAccess::ReadOnly);
+	MaterialQuery.AddRequirement<FMaterialGenealogyFragment>(EMassFragmentAccess::ReadOnly);
+	MaterialQuery.AddRequirement<FMaterialReservationFragment>(EMassFragmentAccess::ReadOnly);
+	MaterialQuery.AddTagRequirement<FMaterialPooledTag>(EMassFragmentPresence::None);
 	
 	if (bArchetypeInitialized)
 	{
@@ -142,9 +223,9 @@ bool UPraxisInventoryService::AddRawMaterial(
 		return false;
 	}
 	
-	// Check capacity
+	// Check capacity (usage is booked when the new batch is indexed)
 	const float RequiredVolume = Quantity * VolumePerUnit;
-	if (!UpdateLocationCapacity(LocationId, RequiredVolume, 1))
+	if (!CheckLocationCapacity(LocationId, RequiredVolume, 1, SubLocationId))
 	{
 		UE_LOG(LogPraxisSim, Warning, 
 			TEXT("Insufficient capacity at %s for %d units of %s (%.2f m³ required)"),
@@ -159,15 +240,11 @@ bool UPraxisInventoryService::AddRawMaterial(
 	if (Entity.IsSet())
 	{
 		MaterialEntities.Add(Entity);
+		IndexMaterialEntity(Entity);
 		
 		// Log transaction
-		FInventoryTransaction Transaction;
-		Transaction.TransactionType = TEXT("Purchase");
-		Transaction.SKU = SKU;
-		Transaction.QuantityDelta = Quantity;
-		Transaction.LocationId = LocationId;
+		FPraxisTransactionRecord Transaction(EPraxisInventoryTransactionType::Purchase, SKU, Quantity, LocationId);
 		Transaction.SubLocationId = SubLocationId;
-		Transaction.Timestamp = FDateTime::UtcNow();
 		
 		// Get batch ID from entity for transaction record
 		FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
@@ -178,8 +255,7 @@ bool UPraxisInventoryService::AddRawMaterial(
 		
 		LogTransaction(Transaction);
 		
-		// Update aggregates
-		UpdateAggregates();
+		OnTransactionCommitted();
 		
 		UE_LOG(LogPraxisSim, Log, 
 			TEXT("Added %d units of %s to %s.%s (Entity: %d)"),
@@ -200,12 +276,10 @@ bool UPraxisInventoryService::AddRawMaterial(
 		FlowEvent.Duration = 0.5f;
 		BroadcastFlowEvent(FlowEvent);
 		
-		OnInventoryChanged.Broadcast(SKU, LocationId, Quantity);
+		NotifyInventoryChanged(SKU, LocationId, Quantity);
 		return true;
 	}
 	
-	// Rollback capacity change if entity spawn failed
-	UpdateLocationCapacity(LocationId, -RequiredVolume, -1);
 	return false;
 }
 
@@ -214,7 +288,8 @@ bool UPraxisInventoryService::ReserveMaterial(
 	int32 Quantity,
 	FName LocationId,
 	int64 WorkOrderId,
-	FName MachineId)
+	FName MachineId,
+	float TimeToLiveSeconds)
 {
 	if (!MassSubsystem || !MassSubsystem->IsInitialized())
 	{
@@ -230,54 +305,25 @@ bool UPraxisInventoryService::ReserveMaterial(
 	
 	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
 	
-	// Find unreserved entities matching SKU and location
+	// Find unclaimed units of lots matching SKU and location, in the SKU's pick order
 	int32 RemainingToReserve = Quantity;
-	TArray<FMassEntityHandle> EntitiesToReserve;
+	TArray<TPair<FMassEntityHandle, int32>> Claims;  // Entity + quantity to claim from it
 	
-	for (const FMassEntityHandle& Entity : MaterialEntities)
+	MaterialIndex.VisitLots(SKU, LocationId, [&](FMassEntityHandle Entity, const FPraxisMaterialIndex::FEntry& Entry)
 	{
-		if (!EntityManager.IsEntityValid(Entity))
-		{
-			continue;
-		}
-		
-		// Check SKU match
-		const FMaterialTypeFragment* TypeFrag = EntityManager.GetFragmentDataPtr<FMaterialTypeFragment>(Entity);
-		if (!TypeFrag || TypeFrag->SKU != SKU)
-		{
-			continue;
-		}
-		
-		// Check location match
-		const FMaterialLocationFragment* LocationFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(Entity);
-		if (!LocationFrag || LocationFrag->LocationId != LocationId)
-		{
-			continue;
-		}
-		
-		// Check not already reserved
-		const FMaterialReservationFragment* ReservationFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(Entity);
-		if (!ReservationFrag || ReservationFrag->bReserved)
-		{
-			continue;
-		}
-		
-		// Check quantity available
-		const FMaterialQuantityFragment* QuantityFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(Entity);
-		if (!QuantityFrag || QuantityFrag->Quantity <= 0)
+		const int32 Unclaimed = GetUnclaimedQuantity(Entity, Entry);
+		if (Unclaimed <= 0 || !EntityManager.IsEntityValid(Entity))
 		{
-			continue;
+			return true;
 		}
 		
-		// This entity can contribute to the reservation
-		EntitiesToReserve.Add(Entity);
-		RemainingToReserve -= QuantityFrag->Quantity;
+		// Claim only what is needed; the rest of the batch stays available
+		const int32 ClaimQuantity = FMath::Min(Unclaimed, RemainingToReserve);
+		Claims.Add(TPair<FMassEntityHandle, int32>(Entity, ClaimQuantity));
+		RemainingToReserve -= ClaimQuantity;
 		
-		if (RemainingToReserve <= 0)
-		{
-			break;  // We have enough
-		}
-	}
+		return RemainingToReserve > 0;  // Stop once we have enough
+	});
 	
 	// Check if we found enough material
 	if (RemainingToReserve > 0)
@@ -288,40 +334,32 @@ bool UPraxisInventoryService::ReserveMaterial(
 		return false;
 	}
 	
-	// Mark entities as reserved
-	int32 TotalReserved = 0;
-	for (const FMassEntityHandle& Entity : EntitiesToReserve)
+	// Record the claims (batches are split later, when the units are consumed)
+	const FPraxisMaterialReservationKey Owner(WorkOrderId, MachineId);
+	const double ClaimTime = GetWorld()->GetTimeSeconds();
+	for (const TPair<FMassEntityHandle, int32>& Claim : Claims)
 	{
-		FMaterialReservationFragment* ReservationFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(Entity);
-		const FMaterialQuantityFragment* QuantityFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(Entity);
-		
-		if (ReservationFrag && QuantityFrag)
-		{
-			ReservationFrag->bReserved = true;
-			ReservationFrag->ReservedForWorkOrder = WorkOrderId;
-			ReservationFrag->ReservedForMachine = MachineId;
-			ReservationFrag->ReservationTime = GetWorld()->GetTimeSeconds();
-			
-			TotalReserved += QuantityFrag->Quantity;
-		}
+		const FPraxisMaterialIndex::FEntry* Entry = MaterialIndex.FindEntry(Claim.Key);
+		ReservationLedger.AddClaim(Claim.Key, Entry->StockKey, Owner, Claim.Value, ClaimTime);
+		ApplyReservedDelta(SKU, Entry->StockKey.LocationId, Claim.Value);
+	}
+	
+	if (TimeToLiveSeconds > 0.0f)
+	{
+		ScheduleReservationExpiry(Owner, TimeToLiveSeconds);
 	}
 	
 	// Log transaction
-	FInventoryTransaction Transaction;
-	Transaction.TransactionType = TEXT("Reservation");
-	Transaction.SKU = SKU;
-	Transaction.QuantityDelta = TotalReserved;
-	Transaction.LocationId = LocationId;
-	Transaction.Reference = FString::Printf(TEXT("WO:%lld Machine:%s"), WorkOrderId, *MachineId.ToString());
-	Transaction.Timestamp = FDateTime::UtcNow();
+	FPraxisTransactionRecord Transaction(EPraxisInventoryTransactionType::Reservation, SKU, Quantity, LocationId);
+	Transaction.WorkOrderId = WorkOrderId;
+	Transaction.RefName = MachineId;
 	LogTransaction(Transaction);
 	
-	// Update aggregates
-	UpdateAggregates();
+	OnTransactionCommitted();
 	
 	UE_LOG(LogPraxisSim, Log, 
 		TEXT("Reserved %d units of %s at %s for WO:%lld (Machine: %s)"),
-		TotalReserved, *SKU.ToString(), *LocationId.ToString(), WorkOrderId, *MachineId.ToString());
+		Quantity, *SKU.ToString(), *LocationId.ToString(), WorkOrderId, *MachineId.ToString());
 	
 	return true;
 }
@@ -334,6 +372,33 @@ bool UPraxisInventoryService::ConsumeReservedMaterial(
 	FName MachineId,
 	int64 WorkOrderId,
 	FName SKU)
+{
+	return ConsumeReservedUnits(MachineId, WorkOrderId, SKU, 1);
+}
+
+bool UPraxisInventoryService::ProduceFinishedGood(
+	FName MachineId,
+	int64 WorkOrderId,
+	FName OutputSKU,
+	FName OutputLocationId)
+{
+	return CompleteWIPUnits(MachineId, WorkOrderId, OutputSKU, OutputLocationId, 1, false);
+}
+
+bool UPraxisInventoryService::ProduceScrap(
+	FName MachineId,
+	int64 WorkOrderId,
+	FName SKU,
+	FName ScrapLocationId)
+{
+	return CompleteWIPUnits(MachineId, WorkOrderId, SKU, ScrapLocationId, 1, true);
+}
+
+bool UPraxisInventoryService::ConsumeReservedUnits(
+	FName MachineId,
+	int64 WorkOrderId,
+	FName SKU,
+	int32 Quantity)
 {
 	if (!MassSubsystem || !MassSubsystem->IsInitialized())
 	{
@@ -342,50 +407,99 @@ bool UPraxisInventoryService::ConsumeReservedMaterial(
 	}
 	
 	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	const FPraxisMaterialReservationKey Owner(WorkOrderId, MachineId);
+	const FName MachineWIPLocation = GetMachineLocations(MachineId).WIPName;
 	
-	// Find a reserved entity matching the work order and machine
-	FMassEntityHandle FoundEntity;
-	float VolumePerUnit = 0.01f;
+	// Units drawn per source location, for one journal record each
+	TArray<TPair<FName, int32>, TInlineAllocator<2>> ConsumedBySource;
+	int32 Remaining = Quantity;
 	
-	for (const FMassEntityHandle& Entity : MaterialEntities)
+	while (Remaining > 0)
 	{
-		if (!EntityManager.IsEntityValid(Entity))
+		// Oldest ledger claim of this work order/machine on the SKU
+		const int32 ClaimId = ReservationLedger.FindClaim(Owner, SKU);
+		if (ClaimId == INDEX_NONE)
 		{
-			continue;
+			break;
 		}
 		
-		// Check reservation matches
-		const FMaterialReservationFragment* ResFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(Entity);
-		if (!ResFrag || !ResFrag->bReserved)
+		const FMassEntityHandle Source = ReservationLedger.GetClaim(ClaimId).Batch;
+		const FMaterialQuantityFragment* QtyFrag = EntityManager.IsEntityValid(Source)
+			? EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(Source)
+			: nullptr;
+		if (!QtyFrag || QtyFrag->Quantity <= 0)
 		{
-			continue;
+			break;
 		}
 		
-		if (ResFrag->ReservedForWorkOrder != WorkOrderId || ResFrag->ReservedForMachine != MachineId)
+		const int32 Take = FMath::Min3(Remaining, ReservationLedger.GetClaim(ClaimId).Quantity, QtyFrag->Quantity);
+		const float VolumePerUnit = QtyFrag->VolumePerUnit;
+		
+		const FMaterialLocationFragment* LocFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(Source);
+		const FMaterialGenealogyFragment* GenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(Source);
+		const FName SourceLocation = LocFrag ? LocFrag->LocationId : NAME_None;
+		const FGuid ParentBatchId = GenFrag ? GenFrag->BatchId : FGuid();
+		
+		// Split the consumed units off the batch: the claim shrinks with them
+		ReduceReservationClaim(ClaimId, Take);
+		EntityManager.GetFragmentDataChecked<FMaterialQuantityFragment>(Source).Quantity -= Take;
+		
+		// Create WIP entity at machine
+		FMassEntityHandle WIPEntity = SpawnMaterialEntity(
+			SKU, Take, MachineWIPLocation, NAME_None, VolumePerUnit, 1,  // 1 = WorkInProcess
+			TConstArrayView<FGuid>(&ParentBatchId, ParentBatchId.IsValid() ? 1 : 0));
+		
+		if (WIPEntity.IsSet())
 		{
-			continue;
+			MaterialEntities.Add(WIPEntity);
+			
+			// Parent link is in the genealogy graph; record where the WIP was made
+			FMaterialGenealogyFragment* WIPGenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(WIPEntity);
+			if (WIPGenFrag && ParentBatchId.IsValid())
+			{
+				WIPGenFrag->SourceMachineId = MachineId;
+				WIPGenFrag->SourceWorkOrderId = WorkOrderId;
+				SyncGenealogyNode(WIPEntity);
+			}
+			
+			// Set reservation on WIP to track it
+			FMaterialReservationFragment* WIPResFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(WIPEntity);
+			if (WIPResFrag)
+			{
+				WIPResFrag->bReserved = true;
+				WIPResFrag->ReservedForWorkOrder = WorkOrderId;
+				WIPResFrag->ReservedForMachine = MachineId;
+				WIPResFrag->ReservationTime = GetWorld()->GetTimeSeconds();
+			}
+			
+			IndexMaterialEntity(WIPEntity);
 		}
 		
-		// Check SKU matches
-		const FMaterialTypeFragment* TypeFrag = EntityManager.GetFragmentDataPtr<FMaterialTypeFragment>(Entity);
-		if (!TypeFrag || TypeFrag->SKU != SKU)
+		// Spawning can move entities between chunks; look the source up again.
+		// If it is depleted, remove it
+		if (EntityManager.GetFragmentDataChecked<FMaterialQuantityFragment>(Source).Quantity <= 0)
 		{
-			continue;
+			DestroyMaterialEntity(Source);
 		}
-		
-		// Check has quantity
-		const FMaterialQuantityFragment* QtyFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(Entity);
-		if (!QtyFrag || QtyFrag->Quantity <= 0)
+		else
 		{
-			continue;
+			IndexMaterialEntity(Source);
 		}
 		
-		FoundEntity = Entity;
-		VolumePerUnit = QtyFrag->VolumePerUnit;
-		break;
+		TPair<FName, int32>* Consumed = ConsumedBySource.FindByPredicate(
+			[SourceLocation](const TPair<FName, int32>& Entry) { return Entry.Key == SourceLocation; });
+		if (Consumed)
+		{
+			Consumed->Value += Take;
+		}
+		else
+		{
+			ConsumedBySource.Emplace(SourceLocation, Take);
+		}
+		Remaining -= Take;
 	}
 	
-	if (!FoundEntity.IsSet())
+	if (ConsumedBySource.Num() == 0)
 	{
 		UE_LOG(LogPraxisSim, Warning, 
 			TEXT("No reserved %s found for WO:%lld on Machine:%s"),
@@ -393,327 +507,282 @@ bool UPraxisInventoryService::ConsumeReservedMaterial(
 		return false;
 	}
 	
-	// Get fragment pointers
-	FMaterialQuantityFragment* QtyFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(FoundEntity);
-	FMaterialLocationFragment* LocFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(FoundEntity);
-	FMaterialStateFragment* StateFrag = EntityManager.GetFragmentDataPtr<FMaterialStateFragment>(FoundEntity);
-	const FMaterialGenealogyFragment* GenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(FoundEntity);
-	
-	if (!QtyFrag)
-	{
-		return false;
-	}
-	
-	FName SourceLocation = LocFrag ? LocFrag->LocationId : NAME_None;
-	FGuid ParentBatchId = GenFrag ? GenFrag->BatchId : FGuid();
-	
-	// Decrement quantity
-	QtyFrag->Quantity -= 1;
-	
-	// Update source location capacity
-	UpdateLocationCapacity(SourceLocation, -VolumePerUnit, 0);
-	
-	// Create WIP entity at machine
-	FName MachineWIPLocation = FName(*FString::Printf(TEXT("%s.WIP"), *MachineId.ToString()));
-	FMassEntityHandle WIPEntity = SpawnMaterialEntity(
-		SKU, 1, MachineWIPLocation, NAME_None, VolumePerUnit, 1);  // 1 = WorkInProcess
-	
-	if (WIPEntity.IsSet())
+	for (const TPair<FName, int32>& Consumed : ConsumedBySource)
 	{
-		MaterialEntities.Add(WIPEntity);
+		// Log transaction
+		FPraxisTransactionRecord Transaction(EPraxisInventoryTransactionType::Consumption, SKU, -Consumed.Value, Consumed.Key);
+		Transaction.WorkOrderId = WorkOrderId;
+		Transaction.RefName = MachineId;
+		LogTransaction(Transaction);
 		
-		// Set genealogy to link to parent batch
-		FMaterialGenealogyFragment* WIPGenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(WIPEntity);
-		if (WIPGenFrag && ParentBatchId.IsValid())
-		{
-			WIPGenFrag->ParentBatchIds.Add(ParentBatchId);
-			WIPGenFrag->SourceMachineId = MachineId;
-			WIPGenFrag->SourceWorkOrderId = WorkOrderId;
-		}
+		// Broadcast flow event for visualization
+		FVector SourcePos = GetLocationWorldPosition(Consumed.Key);
+		FPraxisMaterialFlowEvent FlowEvent = FPraxisMaterialFlowEvent::CreateConsume(
+			SKU, Consumed.Value, Consumed.Key, SourcePos, MachineId, WorkOrderId);
+		FlowEvent.DestinationPosition = SourcePos + FVector(0, 0, 50); // Rise up animation
+		BroadcastFlowEvent(FlowEvent);
 		
-		// Set reservation on WIP to track it
-		FMaterialReservationFragment* WIPResFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(WIPEntity);
-		if (WIPResFrag)
-		{
-			WIPResFrag->bReserved = true;
-			WIPResFrag->ReservedForWorkOrder = WorkOrderId;
-			WIPResFrag->ReservedForMachine = MachineId;
-			WIPResFrag->ReservationTime = GetWorld()->GetTimeSeconds();
-		}
+		NotifyInventoryChanged(SKU, Consumed.Key, -Consumed.Value);
 	}
 	
-	// If source entity is depleted, remove it
-	if (QtyFrag->Quantity <= 0)
+	OnTransactionCommitted();
+	
+	if (Remaining > 0)
 	{
-		UpdateLocationCapacity(SourceLocation, 0, -1);  // Remove item count
-		EntityManager.DestroyEntity(FoundEntity);
-		MaterialEntities.Remove(FoundEntity);
+		UE_LOG(LogPraxisSim, Warning, 
+			TEXT("Consumed only %d of %d %s for WO:%lld (Machine: %s) - reservation exhausted"),
+			Quantity - Remaining, Quantity, *SKU.ToString(), WorkOrderId, *MachineId.ToString());
+		return false;
 	}
 	
-	// Log transaction
-	FInventoryTransaction Transaction;
-	Transaction.TransactionType = TEXT("Consumption");
-	Transaction.SKU = SKU;
-	Transaction.QuantityDelta = -1;
-	Transaction.LocationId = SourceLocation;
-	Transaction.Reference = FString::Printf(TEXT("WO:%lld Machine:%s"), WorkOrderId, *MachineId.ToString());
-	Transaction.Timestamp = FDateTime::UtcNow();
-	LogTransaction(Transaction);
-	
-	UpdateAggregates();
-	
-	// Broadcast flow event for visualization
-	FVector SourcePos = GetLocationWorldPosition(SourceLocation);
-	FPraxisMaterialFlowEvent FlowEvent = FPraxisMaterialFlowEvent::CreateConsume(
-		SKU, 1, SourceLocation, SourcePos, MachineId, WorkOrderId);
-	FlowEvent.DestinationPosition = SourcePos + FVector(0, 0, 50); // Rise up animation
-	BroadcastFlowEvent(FlowEvent);
-	
 	UE_LOG(LogPraxisSim, Verbose, 
-		TEXT("Consumed 1 %s for WO:%lld (Machine: %s) -> WIP"),
-		*SKU.ToString(), WorkOrderId, *MachineId.ToString());
+		TEXT("Consumed %d %s for WO:%lld (Machine: %s) -> WIP"),
+		Quantity, *SKU.ToString(), WorkOrderId, *MachineId.ToString());
 	
 	return true;
 }
 
-bool UPraxisInventoryService::ProduceFinishedGood(
+bool UPraxisInventoryService::CompleteWIPUnits(
 	FName MachineId,
 	int64 WorkOrderId,
 	FName OutputSKU,
-	FName OutputLocationId)
+	FName OutputLocationId,
+	int32 Quantity,
+	bool bScrap,
+	const TMap<FName, int32>* Inputs)
 {
 	if (!MassSubsystem || !MassSubsystem->IsInitialized())
 	{
-		UE_LOG(LogPraxisSim, Error, TEXT("Cannot produce FG - Mass subsystem not available"));
+		UE_LOG(LogPraxisSim, Error, TEXT("Cannot %s - Mass subsystem not available"),
+			bScrap ? TEXT("produce scrap") : TEXT("produce FG"));
 		return false;
 	}
 	
 	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	const uint8 NewState = bScrap ? 3 : 2;  // 3 = Scrap, 2 = FinishedGoods
 	
-	// Find WIP entity for this machine/work order
-	FMassEntityHandle WIPEntity;
-	FName MachineWIPLocation = FName(*FString::Printf(TEXT("%s.WIP"), *MachineId.ToString()));
-	
-	for (const FMassEntityHandle& Entity : MaterialEntities)
+	int32 Remaining = Quantity;
+	if (Inputs)
 	{
-		if (!EntityManager.IsEntityValid(Entity))
+		if (!MakeFromWIPInputs(MachineId, WorkOrderId, OutputSKU, OutputLocationId, Quantity, bScrap, *Inputs))
 		{
-			continue;
+			return false;
 		}
+		Remaining = 0;
+	}
+	else
+	{
+		// Pick WIP batches for this machine/work order first: completing them re-indexes,
+		// so the reserved list can't be walked while they change
+		TArray<TPair<FMassEntityHandle, int32>, TInlineAllocator<4>> Picks;
+		const FName MachineWIPLocation = GetMachineLocations(MachineId).WIPName;
 		
-		// Check state is WIP
-		const FMaterialStateFragment* StateFrag = EntityManager.GetFragmentDataPtr<FMaterialStateFragment>(Entity);
-		if (!StateFrag || StateFrag->State != EMaterialState::WorkInProcess)
+		for (const FMassEntityHandle& Entity : MaterialIndex.FindReserved(FPraxisMaterialReservationKey(WorkOrderId, MachineId)))
 		{
-			continue;
+			// Check state is WIP at the machine's WIP location
+			const FPraxisMaterialIndex::FEntry* IndexEntry = MaterialIndex.FindEntry(Entity);
+			if (!IndexEntry
+				|| IndexEntry->StockKey.MaterialState != static_cast<uint8>(EMaterialState::WorkInProcess)
+				|| IndexEntry->StockKey.LocationId != MachineWIPLocation
+				|| IndexEntry->Quantity <= 0)
+			{
+				continue;
+			}
+		
+			if (!EntityManager.IsEntityValid(Entity))
+			{
+				continue;
+			}
+		
+			const int32 Take = FMath::Min(IndexEntry->Quantity, Remaining);
+			Picks.Emplace(Entity, Take);
+			Remaining -= Take;
+			if (Remaining == 0)
+			{
+				break;
+			}
 		}
 		
-		// Check location is machine WIP
-		const FMaterialLocationFragment* LocFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(Entity);
-		if (!LocFrag || LocFrag->LocationId != MachineWIPLocation)
+		if (Picks.Num() == 0)
 		{
-			continue;
+			UE_LOG(LogPraxisSim, Warning, 
+				TEXT("No WIP found for WO:%lld on Machine:%s%s"),
+				WorkOrderId, *MachineId.ToString(), bScrap ? TEXT(" to scrap") : TEXT(""));
+			return false;
 		}
 		
-		// Check reservation matches
-		const FMaterialReservationFragment* ResFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(Entity);
-		if (!ResFrag || ResFrag->ReservedForWorkOrder != WorkOrderId || ResFrag->ReservedForMachine != MachineId)
+		for (const TPair<FMassEntityHandle, int32>& Pick : Picks)
 		{
-			continue;
-		}
+			const FMassEntityHandle WIPEntity = Pick.Key;
+			FMaterialQuantityFragment& WIPQty = EntityManager.GetFragmentDataChecked<FMaterialQuantityFragment>(WIPEntity);
 		
-		WIPEntity = Entity;
-		break;
-	}
-	
-	if (!WIPEntity.IsSet())
-	{
-		UE_LOG(LogPraxisSim, Warning, 
-			TEXT("No WIP found for WO:%lld on Machine:%s"),
-			WorkOrderId, *MachineId.ToString());
-		return false;
-	}
-	
-	// Get WIP data
-	const FMaterialQuantityFragment* WIPQtyFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(WIPEntity);
-	const FMaterialGenealogyFragment* WIPGenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(WIPEntity);
-	
-	float VolumePerUnit = WIPQtyFrag ? WIPQtyFrag->VolumePerUnit : 0.01f;
-	FGuid WIPBatchId = WIPGenFrag ? WIPGenFrag->BatchId : FGuid();
-	
-	// Destroy WIP entity
-	EntityManager.DestroyEntity(WIPEntity);
-	MaterialEntities.Remove(WIPEntity);
-	
-	// Create FG entity at output location
-	FMassEntityHandle FGEntity = SpawnMaterialEntity(
-		OutputSKU, 1, OutputLocationId, NAME_None, VolumePerUnit, 2);  // 2 = FinishedGoods
-	
-	if (FGEntity.IsSet())
-	{
-		MaterialEntities.Add(FGEntity);
+			if (Pick.Value >= WIPQty.Quantity)
+			{
+				// Whole batch: convert the WIP to its output, keeping the batch
+				TransitionWIPEntity(WIPEntity, OutputSKU, OutputLocationId, NewState, !bScrap, MachineId, WorkOrderId);
+				continue;
+			}
 		
-		// Set genealogy
-		FMaterialGenealogyFragment* FGGenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(FGEntity);
-		if (FGGenFrag)
-		{
-			if (WIPBatchId.IsValid())
+			// Part of the batch: split the completed units off into an output batch
+			WIPQty.Quantity -= Pick.Value;
+			const float VolumePerUnit = WIPQty.VolumePerUnit;
+			const FMaterialGenealogyFragment* WIPGenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(WIPEntity);
+			const FGuid WIPBatchId = WIPGenFrag ? WIPGenFrag->BatchId : FGuid();
+			IndexMaterialEntity(WIPEntity);
+		
+			FMassEntityHandle OutputEntity = SpawnMaterialEntity(
+				OutputSKU, Pick.Value, OutputLocationId, NAME_None, VolumePerUnit, NewState,
+				TConstArrayView<FGuid>(&WIPBatchId, WIPBatchId.IsValid() ? 1 : 0));
+		
+			if (OutputEntity.IsSet())
 			{
-				FGGenFrag->ParentBatchIds.Add(WIPBatchId);
+				MaterialEntities.Add(OutputEntity);
+			
+				if (FMaterialGenealogyFragment* GenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(OutputEntity))
+				{
+					GenFrag->SourceMachineId = MachineId;
+					GenFrag->SourceWorkOrderId = WorkOrderId;
+					GenFrag->bPassedQuality = !bScrap;
+				}
+				SyncGenealogyNode(OutputEntity);
+				IndexMaterialEntity(OutputEntity);
 			}
-			FGGenFrag->SourceMachineId = MachineId;
-			FGGenFrag->SourceWorkOrderId = WorkOrderId;
-			FGGenFrag->bPassedQuality = true;
 		}
-		
-		// Update destination capacity
-		UpdateLocationCapacity(OutputLocationId, VolumePerUnit, 1);
 	}
 	
+	const int32 Completed = Quantity - Remaining;
+	
 	// Log transaction
-	FInventoryTransaction Transaction;
-	Transaction.TransactionType = TEXT("Production");
-	Transaction.SKU = OutputSKU;
-	Transaction.QuantityDelta = 1;
-	Transaction.LocationId = OutputLocationId;
-	Transaction.Reference = FString::Printf(TEXT("WO:%lld Machine:%s"), WorkOrderId, *MachineId.ToString());
-	Transaction.Timestamp = FDateTime::UtcNow();
+	FPraxisTransactionRecord Transaction(
+		bScrap ? EPraxisInventoryTransactionType::Scrap : EPraxisInventoryTransactionType::Production,
+		OutputSKU, Completed, OutputLocationId);
+	Transaction.WorkOrderId = WorkOrderId;
+	Transaction.RefName = MachineId;
 	LogTransaction(Transaction);
 	
-	UpdateAggregates();
+	OnTransactionCommitted();
 	
 	UE_LOG(LogPraxisSim, Verbose, 
-		TEXT("Produced 1 %s for WO:%lld (Machine: %s) -> %s"),
-		*OutputSKU.ToString(), WorkOrderId, *MachineId.ToString(), *OutputLocationId.ToString());
+		TEXT("%s %d %s for WO:%lld (Machine: %s) -> %s"),
+		bScrap ? TEXT("Scrapped") : TEXT("Produced"),
+		Completed, *OutputSKU.ToString(), WorkOrderId, *MachineId.ToString(), *OutputLocationId.ToString());
 	
 	// Broadcast flow event for visualization
 	FVector DestPos = GetLocationWorldPosition(OutputLocationId);
 	FPraxisMaterialFlowEvent FlowEvent = FPraxisMaterialFlowEvent::CreateProduce(
-		OutputSKU, 1, OutputLocationId, DestPos, MachineId, WorkOrderId, 2); // 2 = FinishedGoods
+		OutputSKU, Completed, OutputLocationId, DestPos, MachineId, WorkOrderId, NewState);
 	FlowEvent.SourcePosition = DestPos - FVector(0, 0, 50); // Pop up from below
 	BroadcastFlowEvent(FlowEvent);
 	
-	OnInventoryChanged.Broadcast(OutputSKU, OutputLocationId, 1);
+	NotifyInventoryChanged(OutputSKU, OutputLocationId, Completed);
+	
+	if (Remaining > 0)
+	{
+		UE_LOG(LogPraxisSim, Warning, 
+			TEXT("Completed only %d of %d units for WO:%lld on Machine:%s - WIP exhausted"),
+			Completed, Quantity, WorkOrderId, *MachineId.ToString());
+		return false;
+	}
 	return true;
 }
 
-bool UPraxisInventoryService::ProduceScrap(
+bool UPraxisInventoryService::MakeFromWIPInputs(
 	FName MachineId,
 	int64 WorkOrderId,
-	FName SKU,
-	FName ScrapLocationId)
+	FName OutputSKU,
+	FName OutputLocationId,
+	int32 Quantity,
+	bool bScrap,
+	const TMap<FName, int32>& Inputs)
 {
-	if (!MassSubsystem || !MassSubsystem->IsInitialized())
-	{
-		UE_LOG(LogPraxisSim, Error, TEXT("Cannot produce scrap - Mass subsystem not available"));
-		return false;
-	}
-	
 	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	const FPraxisMaterialReservationKey Owner(WorkOrderId, MachineId);
+	const FName MachineWIPLocation = GetMachineLocations(MachineId).WIPName;
 	
-	// Find WIP entity for this machine/work order
-	FMassEntityHandle WIPEntity;
-	FName MachineWIPLocation = FName(*FString::Printf(TEXT("%s.WIP"), *MachineId.ToString()));
-	
-	for (const FMassEntityHandle& Entity : MaterialEntities)
+	// Pick every input before using any up, so a short one leaves the WIP as it was
+	TArray<TPair<FMassEntityHandle, int32>, TInlineAllocator<4>> Picks;
+	for (const TPair<FName, int32>& Input : Inputs)
 	{
-		if (!EntityManager.IsEntityValid(Entity))
+		int32 ToPick = Input.Value;
+		for (const FMassEntityHandle& Entity : MaterialIndex.FindReserved(Owner))
 		{
-			continue;
+			if (ToPick <= 0)
+			{
+				break;
+			}
+			
+			const FPraxisMaterialIndex::FEntry* IndexEntry = MaterialIndex.FindEntry(Entity);
+			if (!IndexEntry
+				|| IndexEntry->StockKey.SKU != Input.Key
+				|| IndexEntry->StockKey.MaterialState != static_cast<uint8>(EMaterialState::WorkInProcess)
+				|| IndexEntry->StockKey.LocationId != MachineWIPLocation
+				|| IndexEntry->Quantity <= 0
+				|| !EntityManager.IsEntityValid(Entity))
+			{
+				continue;
+			}
+			
+			const int32 Take = FMath::Min(IndexEntry->Quantity, ToPick);
+			Picks.Emplace(Entity, Take);
+			ToPick -= Take;
 		}
 		
-		// Check state is WIP
-		const FMaterialStateFragment* StateFrag = EntityManager.GetFragmentDataPtr<FMaterialStateFragment>(Entity);
-		if (!StateFrag || StateFrag->State != EMaterialState::WorkInProcess)
+		if (ToPick > 0)
 		{
-			continue;
+			UE_LOG(LogPraxisSim, Warning, 
+				TEXT("Insufficient WIP %s for WO:%lld on Machine:%s to make %d %s. Needed: %d, Available: %d"),
+				*Input.Key.ToString(), WorkOrderId, *MachineId.ToString(), Quantity, *OutputSKU.ToString(),
+				Input.Value, Input.Value - ToPick);
+			return false;
 		}
-		
-		// Check location is machine WIP
-		const FMaterialLocationFragment* LocFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(Entity);
-		if (!LocFrag || LocFrag->LocationId != MachineWIPLocation)
+	}
+	
+	// Use the inputs up; every batch drawn on is a parent of the output
+	TArray<FGuid, TInlineAllocator<4>> ParentBatchIds;
+	float InputVolume = 0.0f;
+	for (const TPair<FMassEntityHandle, int32>& Pick : Picks)
+	{
+		// Retiring an input can move entities between chunks; look each one up afresh
+		FMaterialQuantityFragment& WIPQty = EntityManager.GetFragmentDataChecked<FMaterialQuantityFragment>(Pick.Key);
+		const FMaterialGenealogyFragment* WIPGenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(Pick.Key);
+		if (WIPGenFrag && WIPGenFrag->BatchId.IsValid())
 		{
-			continue;
+			ParentBatchIds.AddUnique(WIPGenFrag->BatchId);
 		}
+		InputVolume += Pick.Value * WIPQty.VolumePerUnit;
 		
-		// Check reservation matches
-		const FMaterialReservationFragment* ResFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(Entity);
-		if (!ResFrag || ResFrag->ReservedForWorkOrder != WorkOrderId || ResFrag->ReservedForMachine != MachineId)
+		WIPQty.Quantity -= Pick.Value;
+		if (WIPQty.Quantity <= 0)
 		{
-			continue;
+			DestroyMaterialEntity(Pick.Key);
+		}
+		else
+		{
+			IndexMaterialEntity(Pick.Key);
 		}
-		
-		WIPEntity = Entity;
-		break;
-	}
-	
-	if (!WIPEntity.IsSet())
-	{
-		UE_LOG(LogPraxisSim, Warning, 
-			TEXT("No WIP found for WO:%lld on Machine:%s to scrap"),
-			WorkOrderId, *MachineId.ToString());
-		return false;
 	}
 	
-	// Get WIP data
-	const FMaterialQuantityFragment* WIPQtyFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(WIPEntity);
-	const FMaterialGenealogyFragment* WIPGenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(WIPEntity);
-	
-	float VolumePerUnit = WIPQtyFrag ? WIPQtyFrag->VolumePerUnit : 0.01f;
-	FGuid WIPBatchId = WIPGenFrag ? WIPGenFrag->BatchId : FGuid();
+	// Sized as its BOM says, else as the inputs it was made from
+	const FBOMEntry* BOM = FindBOMForOutput(OutputSKU);
+	const float VolumePerUnit = BOM ? BOM->OutputVolumePerUnit : InputVolume / FMath::Max(1, Quantity);
 	
-	// Destroy WIP entity
-	EntityManager.DestroyEntity(WIPEntity);
-	MaterialEntities.Remove(WIPEntity);
-	
-	// Create Scrap entity at scrap location
-	FMassEntityHandle ScrapEntity = SpawnMaterialEntity(
-		SKU, 1, ScrapLocationId, NAME_None, VolumePerUnit, 3);  // 3 = Scrap
+	FMassEntityHandle OutputEntity = SpawnMaterialEntity(
+		OutputSKU, Quantity, OutputLocationId, NAME_None, VolumePerUnit, bScrap ? 3 : 2,  // 3 = Scrap, 2 = FinishedGoods
+		ParentBatchIds, BOM ? BOM->BOMId : NAME_None);
 	
-	if (ScrapEntity.IsSet())
+	if (OutputEntity.IsSet())
 	{
-		MaterialEntities.Add(ScrapEntity);
+		MaterialEntities.Add(OutputEntity);
 		
-		// Set genealogy with quality flag false
-		FMaterialGenealogyFragment* ScrapGenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(ScrapEntity);
-		if (ScrapGenFrag)
+		if (FMaterialGenealogyFragment* GenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(OutputEntity))
 		{
-			if (WIPBatchId.IsValid())
-			{
-				ScrapGenFrag->ParentBatchIds.Add(WIPBatchId);
-			}
-			ScrapGenFrag->SourceMachineId = MachineId;
-			ScrapGenFrag->SourceWorkOrderId = WorkOrderId;
-			ScrapGenFrag->bPassedQuality = false;  // Failed quality
+			GenFrag->SourceMachineId = MachineId;
+			GenFrag->SourceWorkOrderId = WorkOrderId;
+			GenFrag->bPassedQuality = !bScrap;
 		}
-		
-		// Update destination capacity
-		UpdateLocationCapacity(ScrapLocationId, VolumePerUnit, 1);
+		SyncGenealogyNode(OutputEntity);
+		IndexMaterialEntity(OutputEntity);
 	}
-	
-	// Log transaction
-	FInventoryTransaction Transaction;
-	Transaction.TransactionType = TEXT("Scrap");
-	Transaction.SKU = SKU;
-	Transaction.QuantityDelta = 1;
-	Transaction.LocationId = ScrapLocationId;
-	Transaction.Reference = FString::Printf(TEXT("WO:%lld Machine:%s"), WorkOrderId, *MachineId.ToString());
-	Transaction.Timestamp = FDateTime::UtcNow();
-	LogTransaction(Transaction);
-	
-	UpdateAggregates();
-	
-	UE_LOG(LogPraxisSim, Verbose, 
-		TEXT("Scrapped 1 %s for WO:%lld (Machine: %s) -> %s"),
-		*SKU.ToString(), WorkOrderId, *MachineId.ToString(), *ScrapLocationId.ToString());
-	
-	// Broadcast flow event for visualization
-	FVector DestPos = GetLocationWorldPosition(ScrapLocationId);
-	FPraxisMaterialFlowEvent FlowEvent = FPraxisMaterialFlowEvent::CreateProduce(
-		SKU, 1, ScrapLocationId, DestPos, MachineId, WorkOrderId, 3); // 3 = Scrap
-	FlowEvent.SourcePosition = DestPos - FVector(0, 0, 50); // Pop up from below
-	BroadcastFlowEvent(FlowEvent);
-	
 	return true;
 }
 
@@ -731,8 +800,22 @@ bool UPraxisInventoryService::ReleaseReservation(
 	
 	int32 ReleasedCount = 0;
 	
-	// Find all entities reserved for this work order/machine
-	for (const FMassEntityHandle& Entity : MaterialEntities)
+	// Drop ledger claims (and their expiry); the batches themselves never changed
+	const FPraxisMaterialReservationKey Owner(WorkOrderId, MachineId);
+	ReleasedCount += ReleaseReservationClaims(Owner).Num();
+	
+	int32 ExpiryTimer = INDEX_NONE;
+	if (ReservationExpiryTimers.RemoveAndCopyValue(Owner, ExpiryTimer))
+	{
+		ReservationExpiryWheel.Cancel(ExpiryTimer);
+		ReservationExpiryOwners.Remove(ExpiryTimer);
+	}
+	
+	// Find all (WIP) entities reserved for this work order/machine. Copy the bucket first:
+	// releasing re-keys each entity, which reshuffles the bucket being read.
+	const TArray<FMassEntityHandle> ReservedEntities(MaterialIndex.FindReserved(FPraxisMaterialReservationKey(WorkOrderId, MachineId)));
+	
+	for (const FMassEntityHandle& Entity : ReservedEntities)
 	{
 		if (!EntityManager.IsEntityValid(Entity))
 		{
@@ -745,23 +828,19 @@ bool UPraxisInventoryService::ReleaseReservation(
 			continue;
 		}
 		
-		if (ResFrag->ReservedForWorkOrder != WorkOrderId || ResFrag->ReservedForMachine != MachineId)
-		{
-			continue;
-		}
-		
 		// Release the reservation
 		ResFrag->bReserved = false;
 		ResFrag->ReservedForWorkOrder = 0;
 		ResFrag->ReservedForMachine = NAME_None;
 		ResFrag->ReservationTime = 0.0;
+		IndexMaterialEntity(Entity);
 		
 		ReleasedCount++;
 	}
 	
 	if (ReleasedCount > 0)
 	{
-		UpdateAggregates();
+		OnTransactionCommitted();
 		
 		UE_LOG(LogPraxisSim, Log, 
 			TEXT("Released %d reservations for WO:%lld (Machine: %s)"),
@@ -792,7 +871,7 @@ bool UPraxisInventoryService::TransformMaterial(
 	}
 	
 	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
-	FName MachineWIPLocation = FName(*FString::Printf(TEXT("%s.WIP"), *SourceMachineId.ToString()));
+	const FName MachineWIPLocation = GetMachineLocations(SourceMachineId).WIPName;
 	
 	// ═══════════════════════════════════════════════════════════════════════════
 	// Phase 1: Validate all inputs are available
@@ -809,43 +888,24 @@ bool UPraxisInventoryService::TransformMaterial(
 		int32 RemainingToFind = RequiredQty;
 		TArray<TPair<FMassEntityHandle, int32>>& EntitiesForSKU = InputsToConsume.FindOrAdd(InputSKU);
 		
-		// Find WIP entities at machine for this SKU
-		for (const FMassEntityHandle& Entity : MaterialEntities)
+		// Find WIP entities at machine for this SKU reserved for this work order
+		for (const FMassEntityHandle& Entity : MaterialIndex.FindReserved(FPraxisMaterialReservationKey(WorkOrderId, SourceMachineId)))
 		{
 			if (RemainingToFind <= 0)
 			{
 				break;
 			}
 			
-			if (!EntityManager.IsEntityValid(Entity))
-			{
-				continue;
-			}
-			
-			// Check state is WIP
-			const FMaterialStateFragment* StateFrag = EntityManager.GetFragmentDataPtr<FMaterialStateFragment>(Entity);
-			if (!StateFrag || StateFrag->State != EMaterialState::WorkInProcess)
-			{
-				continue;
-			}
-			
-			// Check location is machine WIP
-			const FMaterialLocationFragment* LocFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(Entity);
-			if (!LocFrag || LocFrag->LocationId != MachineWIPLocation)
-			{
-				continue;
-			}
-			
-			// Check SKU matches
-			const FMaterialTypeFragment* TypeFrag = EntityManager.GetFragmentDataPtr<FMaterialTypeFragment>(Entity);
-			if (!TypeFrag || TypeFrag->SKU != InputSKU)
+			const FPraxisMaterialIndex::FEntry* IndexEntry = MaterialIndex.FindEntry(Entity);
+			if (!IndexEntry
+				|| IndexEntry->StockKey.SKU != InputSKU
+				|| IndexEntry->StockKey.MaterialState != static_cast<uint8>(EMaterialState::WorkInProcess)
+				|| IndexEntry->StockKey.LocationId != MachineWIPLocation)
 			{
 				continue;
 			}
 			
-			// Check reservation matches work order
-			const FMaterialReservationFragment* ResFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(Entity);
-			if (!ResFrag || ResFrag->ReservedForWorkOrder != WorkOrderId || ResFrag->ReservedForMachine != SourceMachineId)
+			if (!EntityManager.IsEntityValid(Entity))
 			{
 				continue;
 			}
@@ -925,18 +985,17 @@ bool UPraxisInventoryService::TransformMaterial(
 			
 			if (QtyFrag->Quantity <= 0)
 			{
-				EntityManager.DestroyEntity(Entity);
-				MaterialEntities.Remove(Entity);
+				DestroyMaterialEntity(Entity);
+			}
+			else
+			{
+				IndexMaterialEntity(Entity);
 			}
 			
 			// Log consumption transaction
-			FInventoryTransaction ConsumeTx;
-			ConsumeTx.TransactionType = TEXT("BOMConsumption");
-			ConsumeTx.SKU = InputSKU;
-			ConsumeTx.QuantityDelta = -ConsumeQty;
-			ConsumeTx.LocationId = MachineWIPLocation;
-			ConsumeTx.Reference = FString::Printf(TEXT("BOM:%s WO:%lld"), *BOMId.ToString(), WorkOrderId);
-			ConsumeTx.Timestamp = FDateTime::UtcNow();
+			FPraxisTransactionRecord ConsumeTx(EPraxisInventoryTransactionType::BOMConsumption, InputSKU, -ConsumeQty, MachineWIPLocation);
+			ConsumeTx.WorkOrderId = WorkOrderId;
+			ConsumeTx.RefName = BOMId;
 			LogTransaction(ConsumeTx);
 		}
 	}
@@ -951,42 +1010,32 @@ bool UPraxisInventoryService::TransformMaterial(
 		OutputLocationId,
 		NAME_None,
 		BOM->OutputVolumePerUnit,
-		2);  // 2 = FinishedGoods
+		2,  // 2 = FinishedGoods
+		ParentBatchIds,
+		BOMId);
 	
 	if (OutputEntity.IsSet())
 	{
 		MaterialEntities.Add(OutputEntity);
 		
-		// Set genealogy with all parent batches
+		// Parent batches were linked at spawn; record the source
 		FMaterialGenealogyFragment* OutputGenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(OutputEntity);
 		if (OutputGenFrag)
 		{
-			OutputGenFrag->ParentBatchIds = ParentBatchIds;
 			OutputGenFrag->SourceMachineId = SourceMachineId;
 			OutputGenFrag->SourceWorkOrderId = WorkOrderId;
 			OutputGenFrag->bPassedQuality = true;
+			SyncGenealogyNode(OutputEntity);
 		}
 		
-		// Set BOM ID on the output
-		FMaterialTypeFragment* OutputTypeFrag = EntityManager.GetFragmentDataPtr<FMaterialTypeFragment>(OutputEntity);
-		if (OutputTypeFrag)
-		{
-			OutputTypeFrag->BOMId = BOMId;
-		}
-		
-		// Update destination capacity
-		UpdateLocationCapacity(OutputLocationId, OutputVolume, 1);
+		IndexMaterialEntity(OutputEntity);
 	}
 	
 	// Log production transaction
-	FInventoryTransaction ProduceTx;
-	ProduceTx.TransactionType = TEXT("BOMProduction");
-	ProduceTx.SKU = BOM->OutputSKU;
-	ProduceTx.QuantityDelta = BOM->OutputQuantity;
-	ProduceTx.LocationId = OutputLocationId;
-	ProduceTx.Reference = FString::Printf(TEXT("BOM:%s WO:%lld Inputs:%d"), 
-		*BOMId.ToString(), WorkOrderId, ParentBatchIds.Num());
-	ProduceTx.Timestamp = FDateTime::UtcNow();
+	FPraxisTransactionRecord ProduceTx(EPraxisInventoryTransactionType::BOMProduction, BOM->OutputSKU, BOM->OutputQuantity, OutputLocationId);
+	ProduceTx.WorkOrderId = WorkOrderId;
+	ProduceTx.RefName = BOMId;
+	ProduceTx.RefCount = ParentBatchIds.Num();
 	if (OutputEntity.IsSet())
 	{
 		const FMaterialGenealogyFragment* OutGen = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(OutputEntity);
@@ -997,14 +1046,14 @@ bool UPraxisInventoryService::TransformMaterial(
 	}
 	LogTransaction(ProduceTx);
 	
-	UpdateAggregates();
+	OnTransactionCommitted();
 	
 	UE_LOG(LogPraxisSim, Log, 
 		TEXT("BOM Transform: %s -> %d x %s at %s (WO:%lld, Parents:%d)"),
 		*BOMId.ToString(), BOM->OutputQuantity, *BOM->OutputSKU.ToString(),
 		*OutputLocationId.ToString(), WorkOrderId, ParentBatchIds.Num());
 	
-	OnInventoryChanged.Broadcast(BOM->OutputSKU, OutputLocationId, BOM->OutputQuantity);
+	NotifyInventoryChanged(BOM->OutputSKU, OutputLocationId, BOM->OutputQuantity);
 	return true;
 }
 
@@ -1032,59 +1081,30 @@ bool UPraxisInventoryService::ShipFinishedGoods(
 	TArray<TPair<FMassEntityHandle, int32>> EntitiesToShip;  // Entity + quantity to take
 	float TotalVolumeToShip = 0.0f;
 	
-	for (const FMassEntityHandle& Entity : MaterialEntities)
+	static constexpr uint8 FinishedGoodsState = static_cast<uint8>(EMaterialState::FinishedGoods);
+	
+	MaterialIndex.VisitLots(SKU, LocationId, [&](FMassEntityHandle Entity, const FPraxisMaterialIndex::FEntry& Entry)
 	{
-		if (RemainingToShip <= 0)
-		{
-			break;
-		}
-		
-		if (!EntityManager.IsEntityValid(Entity))
-		{
-			continue;
-		}
-		
-		// Check state is Finished Goods
-		const FMaterialStateFragment* StateFrag = EntityManager.GetFragmentDataPtr<FMaterialStateFragment>(Entity);
-		if (!StateFrag || StateFrag->State != EMaterialState::FinishedGoods)
+		const int32 Unclaimed = GetUnclaimedQuantity(Entity, Entry);
+		if (Entry.StockKey.MaterialState != FinishedGoodsState || Unclaimed <= 0 || !EntityManager.IsEntityValid(Entity))
 		{
-			continue;
-		}
-		
-		// Check SKU match
-		const FMaterialTypeFragment* TypeFrag = EntityManager.GetFragmentDataPtr<FMaterialTypeFragment>(Entity);
-		if (!TypeFrag || TypeFrag->SKU != SKU)
-		{
-			continue;
-		}
-		
-		// Check location match
-		const FMaterialLocationFragment* LocationFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(Entity);
-		if (!LocationFrag || LocationFrag->LocationId != LocationId)
-		{
-			continue;
-		}
-		
-		// Check not reserved
-		const FMaterialReservationFragment* ReservationFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(Entity);
-		if (ReservationFrag && ReservationFrag->bReserved)
-		{
-			continue;
+			return true;
 		}
 		
-		// Check quantity available
 		const FMaterialQuantityFragment* QuantityFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(Entity);
-		if (!QuantityFrag || QuantityFrag->Quantity <= 0)
+		if (!QuantityFrag)
 		{
-			continue;
+			return true;
 		}
 		
-		// Calculate how much to take from this entity
-		const int32 TakeQuantity = FMath::Min(QuantityFrag->Quantity, RemainingToShip);
+		// Calculate how much to take from this entity (claimed units stay behind)
+		const int32 TakeQuantity = FMath::Min(Unclaimed, RemainingToShip);
 		EntitiesToShip.Add(TPair<FMassEntityHandle, int32>(Entity, TakeQuantity));
 		TotalVolumeToShip += TakeQuantity * QuantityFrag->VolumePerUnit;
 		RemainingToShip -= TakeQuantity;
-	}
+		
+		return RemainingToShip > 0;
+	});
 	
 	// Check if we found enough material
 	if (RemainingToShip > 0)
@@ -1116,39 +1136,35 @@ bool UPraxisInventoryService::ShipFinishedGoods(
 		if (GenFrag && GenFrag->BatchId.IsValid())
 		{
 			ShippedBatchIds.AddUnique(GenFrag->BatchId);
+			
+			const uint32 GraphId = Genealogy.FindBatch(GenFrag->BatchId);
+			if (Genealogy.IsValidId(GraphId))
+			{
+				Genealogy.MarkShipped(GraphId);
+			}
 		}
 		
-		const float ShipVolume = ShipQty * QuantityFrag->VolumePerUnit;
-		
 		if (ShipQty == QuantityFrag->Quantity)
 		{
 			// Ship entire entity - destroy it
-			UpdateLocationCapacity(LocationId, -ShipVolume, -1);
-			EntityManager.DestroyEntity(Entity);
-			MaterialEntities.Remove(Entity);
+			DestroyMaterialEntity(Entity);
 		}
 		else
 		{
 			// Partial shipment - reduce quantity
 			QuantityFrag->Quantity -= ShipQty;
-			UpdateLocationCapacity(LocationId, -ShipVolume, 0);  // Volume down, item count unchanged
+			IndexMaterialEntity(Entity);
 		}
 		
 		TotalShipped += ShipQty;
 	}
 	
 	// Log transaction
-	FInventoryTransaction Transaction;
-	Transaction.TransactionType = TEXT("Shipment");
-	Transaction.SKU = SKU;
-	Transaction.QuantityDelta = -TotalShipped;
-	Transaction.LocationId = LocationId;
-	Transaction.Reference = FString::Printf(TEXT("Batches:%d"), ShippedBatchIds.Num());
-	Transaction.Timestamp = FDateTime::UtcNow();
+	FPraxisTransactionRecord Transaction(EPraxisInventoryTransactionType::Shipment, SKU, -TotalShipped, LocationId);
+	Transaction.RefCount = ShippedBatchIds.Num();
 	LogTransaction(Transaction);
 	
-	// Update aggregates
-	UpdateAggregates();
+	OnTransactionCommitted();
 	
 	UE_LOG(LogPraxisSim, Log, 
 		TEXT("Shipped %d units of %s from %s (Batches: %d)"),
@@ -1167,7 +1183,7 @@ bool UPraxisInventoryService::ShipFinishedGoods(
 	FlowEvent.Duration = 0.5f;
 	BroadcastFlowEvent(FlowEvent);
 	
-	OnInventoryChanged.Broadcast(SKU, LocationId, -TotalShipped);
+	NotifyInventoryChanged(SKU, LocationId, -TotalShipped);
 	return true;
 }
 
@@ -1202,52 +1218,29 @@ bool UPraxisInventoryService::TransferMaterial(
 	TArray<TPair<FMassEntityHandle, int32>> EntitiesToTransfer;  // Entity + quantity to take from it
 	float TotalVolumeToTransfer = 0.0f;
 	
-	for (const FMassEntityHandle& Entity : MaterialEntities)
+	// Unreserved lots only (can't transfer reserved material), in the SKU's pick order
+	MaterialIndex.VisitLots(SKU, FromLocation, [&](FMassEntityHandle Entity, const FPraxisMaterialIndex::FEntry& Entry)
 	{
-		if (!EntityManager.IsEntityValid(Entity))
-		{
-			continue;
-		}
-		
-		// Check SKU match
-		const FMaterialTypeFragment* TypeFrag = EntityManager.GetFragmentDataPtr<FMaterialTypeFragment>(Entity);
-		if (!TypeFrag || TypeFrag->SKU != SKU)
-		{
-			continue;
-		}
-		
-		// Check location match
-		const FMaterialLocationFragment* LocationFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(Entity);
-		if (!LocationFrag || LocationFrag->LocationId != FromLocation)
+		const int32 Unclaimed = GetUnclaimedQuantity(Entity, Entry);
+		if (Unclaimed <= 0 || !EntityManager.IsEntityValid(Entity))
 		{
-			continue;
-		}
-		
-		// Check not reserved (can't transfer reserved material)
-		const FMaterialReservationFragment* ReservationFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(Entity);
-		if (ReservationFrag && ReservationFrag->bReserved)
-		{
-			continue;
+			return true;
 		}
 		
-		// Check quantity available
 		const FMaterialQuantityFragment* QuantityFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(Entity);
-		if (!QuantityFrag || QuantityFrag->Quantity <= 0)
+		if (!QuantityFrag)
 		{
-			continue;
+			return true;
 		}
 		
-		// Calculate how much to take from this entity
-		const int32 TakeQuantity = FMath::Min(QuantityFrag->Quantity, RemainingToTransfer);
+		// Calculate how much to take from this entity (claimed units stay behind)
+		const int32 TakeQuantity = FMath::Min(Unclaimed, RemainingToTransfer);
 		EntitiesToTransfer.Add(TPair<FMassEntityHandle, int32>(Entity, TakeQuantity));
 		TotalVolumeToTransfer += TakeQuantity * QuantityFrag->VolumePerUnit;
 		RemainingToTransfer -= TakeQuantity;
 		
-		if (RemainingToTransfer <= 0)
-		{
-			break;
-		}
-	}
+		return RemainingToTransfer > 0;
+	});
 	
 	// Check if we found enough material
 	if (RemainingToTransfer > 0)
@@ -1282,17 +1275,13 @@ bool UPraxisInventoryService::TransferMaterial(
 			continue;
 		}
 		
-		const float TransferVolume = TransferQty * QuantityFrag->VolumePerUnit;
-		
 		if (TransferQty == QuantityFrag->Quantity)
 		{
 			// Transfer entire entity - just update location
 			LocationFrag->LocationId = ToLocation;
+			LocationFrag->SubLocationId = NAME_None;
 			LocationFrag->LocationEnterTime = GetWorld()->GetTimeSeconds();
-			
-			// Update capacities
-			UpdateLocationCapacity(FromLocation, -TransferVolume, -1);
-			UpdateLocationCapacity(ToLocation, TransferVolume, 1);
+			IndexMaterialEntity(Entity);
 			
 			TotalTransferred += TransferQty;
 		}
@@ -1300,30 +1289,24 @@ bool UPraxisInventoryService::TransferMaterial(
 		{
 			// Partial transfer - reduce source and create new entity at destination
 			QuantityFrag->Quantity -= TransferQty;
+			IndexMaterialEntity(Entity);
 			
-			// Get state for new entity
+			// Get state and batch for new entity
 			const FMaterialStateFragment* StateFrag = EntityManager.GetFragmentDataPtr<FMaterialStateFragment>(Entity);
 			uint8 State = StateFrag ? static_cast<uint8>(StateFrag->State) : 0;
+			const FMaterialGenealogyFragment* SourceGenealogy = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(Entity);
+			const FGuid SourceBatchId = SourceGenealogy ? SourceGenealogy->BatchId : FGuid();
 			
-			// Spawn new entity at destination
+			// Spawn new entity at destination, split from the source batch
 			FMassEntityHandle NewEntity = SpawnMaterialEntity(
-				SKU, TransferQty, ToLocation, NAME_None, QuantityFrag->VolumePerUnit, State);
+				SKU, TransferQty, ToLocation, NAME_None, QuantityFrag->VolumePerUnit, State,
+				TConstArrayView<FGuid>(&SourceBatchId, SourceBatchId.IsValid() ? 1 : 0));
 			
 			if (NewEntity.IsSet())
 			{
 				MaterialEntities.Add(NewEntity);
 				
-				// Copy genealogy from source
-				const FMaterialGenealogyFragment* SourceGenealogy = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(Entity);
-				FMaterialGenealogyFragment* NewGenealogy = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(NewEntity);
-				if (SourceGenealogy && NewGenealogy)
-				{
-					NewGenealogy->ParentBatchIds.Add(SourceGenealogy->BatchId);
-				}
-				
-				// Update capacities (source volume reduction, destination addition)
-				UpdateLocationCapacity(FromLocation, -TransferVolume, 0);  // Volume down, item count unchanged
-				UpdateLocationCapacity(ToLocation, TransferVolume, 1);    // New entity at destination
+				IndexMaterialEntity(NewEntity);
 				
 				TotalTransferred += TransferQty;
 			}
@@ -1331,17 +1314,11 @@ bool UPraxisInventoryService::TransferMaterial(
 	}
 	
 	// Log transaction
-	FInventoryTransaction Transaction;
-	Transaction.TransactionType = TEXT("Transfer");
-	Transaction.SKU = SKU;
-	Transaction.QuantityDelta = TotalTransferred;
-	Transaction.LocationId = ToLocation;
-	Transaction.Reference = FString::Printf(TEXT("From: %s"), *FromLocation.ToString());
-	Transaction.Timestamp = FDateTime::UtcNow();
+	FPraxisTransactionRecord Transaction(EPraxisInventoryTransactionType::Transfer, SKU, TotalTransferred, ToLocation);
+	Transaction.RefName = FromLocation;
 	LogTransaction(Transaction);
 	
-	// Update aggregates
-	UpdateAggregates();
+	OnTransactionCommitted();
 	
 	UE_LOG(LogPraxisSim, Log, 
 		TEXT("Transferred %d units of %s from %s to %s"),
@@ -1364,417 +1341,2897 @@ bool UPraxisInventoryService::TransferMaterial(
 		SKU, TotalTransferred, FromLocation, ToLocation, SourcePos, DestPos, MatState);
 	BroadcastFlowEvent(FlowEvent);
 	
-	OnInventoryChanged.Broadcast(SKU, FromLocation, -TotalTransferred);
-	OnInventoryChanged.Broadcast(SKU, ToLocation, TotalTransferred);
+	NotifyInventoryChanged(SKU, FromLocation, -TotalTransferred);
+	NotifyInventoryChanged(SKU, ToLocation, TotalTransferred);
 	
 	return true;
 }
 
 // ════════════════════════════════════════════════════════════════════════════════
-// Queries
+// Batched Transactions
 // ════════════════════════════════════════════════════════════════════════════════
 
-FInventorySummary UPraxisInventoryService::GetInventorySummary(FName SKU) const
+bool UPraxisInventoryService::ApplyInventoryBatch(const TArray<FPraxisInventoryOp>& Ops, int32& OutAppliedCount)
 {
-	if (const FInventorySummary* Summary = InventoryCache.Find(SKU))
+	OutAppliedCount = 0;
+	
+	if (!MassSubsystem || !MassSubsystem->IsInitialized())
 	{
-		return *Summary;
+		UE_LOG(LogPraxisSim, Error, TEXT("Cannot apply inventory batch - Mass subsystem not available"));
+		return false;
 	}
 	
-	return FInventorySummary();
-}
-
-int32 UPraxisInventoryService::GetAvailableQuantity(FName SKU, FName LocationId) const
-{
-	if (const FInventorySummary* Summary = InventoryCache.Find(SKU))
+	if (Ops.Num() == 0)
 	{
-		if (const int32* Qty = Summary->QuantityByLocation.Find(LocationId))
-		{
-			// TODO: Subtract reserved quantity at this location
-			return *Qty;
-		}
+		return true;
 	}
 	
-	return 0;
-}
-
-bool UPraxisInventoryService::HasCapacity(FName LocationId, float RequiredVolume) const
-{
-	if (const FLocationCapacity* Capacity = Locations.Find(LocationId))
+	const int32 FailedIndex = ValidateInventoryBatch(Ops);
+	if (FailedIndex != INDEX_NONE)
 	{
-		return Capacity->GetRemainingVolume() >= RequiredVolume;
+		const FPraxisInventoryOp& Failed = Ops[FailedIndex];
+		UE_LOG(LogPraxisSim, Warning, 
+			TEXT("Inventory batch rejected: op %d (%s x%d %s @ %s, WO:%lld) cannot be satisfied"),
+			FailedIndex, *UEnum::GetValueAsString(Failed.Type), Failed.Quantity, *Failed.SKU.ToString(),
+			*Failed.LocationId.ToString(), Failed.WorkOrderId);
+		return false;
 	}
 	
-	return true; // No capacity limit defined - allow anything
-}
-
-FLocationCapacity UPraxisInventoryService::GetLocationCapacity(FName LocationId) const
-{
-	if (const FLocationCapacity* Capacity = Locations.Find(LocationId))
+	// Apply in one pass with commit hooks and notifications deferred
+	++BatchDepth;
+	
+	for (const FPraxisInventoryOp& Op : Ops)
 	{
-		return *Capacity;
+		bool bApplied = true;
+		switch (Op.Type)
+		{
+		case EPraxisInventoryOpType::Consume:
+			bApplied = ConsumeReservedUnits(Op.MachineId, Op.WorkOrderId, Op.SKU, Op.Quantity);
+			break;
+		
+		case EPraxisInventoryOpType::Produce:
+			bApplied = CompleteWIPUnits(Op.MachineId, Op.WorkOrderId, Op.SKU, Op.LocationId, Op.Quantity, false, Op.bExplicitInputs ? &Op.Inputs : nullptr);
+			break;
+		
+		case EPraxisInventoryOpType::Scrap:
+			bApplied = CompleteWIPUnits(Op.MachineId, Op.WorkOrderId, Op.SKU, Op.LocationId, Op.Quantity, true, Op.bExplicitInputs ? &Op.Inputs : nullptr);
+			break;
+		
+		case EPraxisInventoryOpType::Transfer:
+			bApplied = TransferMaterial(Op.SKU, Op.Quantity, Op.LocationId, Op.DestinationLocationId);
+			break;
+		
+		case EPraxisInventoryOpType::Ship:
+			bApplied = ShipFinishedGoods(Op.SKU, Op.Quantity, Op.LocationId);
+			break;
+		
+		case EPraxisInventoryOpType::Reserve:
+			bApplied = ReserveMaterial(Op.SKU, Op.Quantity, Op.LocationId, Op.WorkOrderId, Op.MachineId);
+			break;
+		}
+		
+		if (bApplied)
+		{
+			++OutAppliedCount;
+		}
+		else
+		{
+			// Validation covered stock and capacity, so this is missing fragment data
+			UE_LOG(LogPraxisSim, Warning, TEXT("Inventory batch: op %s x%d %s failed during apply"),
+				*UEnum::GetValueAsString(Op.Type), Op.Quantity, *Op.SKU.ToString());
+		}
 	}
 	
-	return FLocationCapacity();
-}
-
-TArray<FInventoryTransaction> UPraxisInventoryService::GetTransactionHistory(int32 MaxRecords) const
-{
-	TArray<FInventoryTransaction> Result;
-	const int32 StartIndex = FMath::Max(0, TransactionHistory.Num() - MaxRecords);
+	--BatchDepth;
 	
-	for (int32 i = StartIndex; i < TransactionHistory.Num(); ++i)
+	if (BatchDepth == 0)
 	{
-		Result.Add(TransactionHistory[i]);
+		OnTransactionCommitted();
+		
+		TArray<FPraxisMaterialFlowEvent> FlowEvents = MoveTemp(PendingFlowEvents);
+		PendingFlowEvents.Reset();
+		for (const FPraxisMaterialFlowEvent& Event : FlowEvents)
+		{
+			OnMaterialFlowEvent.Broadcast(Event);
+		}
+		
+		TMap<TPair<FName, FName>, int32> Changes = MoveTemp(PendingInventoryChanges);
+		PendingInventoryChanges.Reset();
+		for (const TPair<TPair<FName, FName>, int32>& Change : Changes)
+		{
+			if (Change.Value != 0)
+			{
+				OnInventoryChanged.Broadcast(Change.Key.Key, Change.Key.Value, Change.Value);
+			}
+		}
 	}
 	
-	return Result;
+	return OutAppliedCount == Ops.Num();
 }
 
-TArray<FLocationInventoryItem> UPraxisInventoryService::GetInventoryAtLocation(FName LocationId) const
+int32 UPraxisInventoryService::ValidateInventoryBatch(const TArray<FPraxisInventoryOp>& Ops) const
 {
-	TArray<FLocationInventoryItem> Result;
+	// Running balances, seeded lazily from the index and adjusted as each op is simulated
+	static constexpr uint8 AnyState = 0xFF;
+	const uint8 FGState = static_cast<uint8>(EMaterialState::FinishedGoods);
 	
-	if (!MassSubsystem || !MassSubsystem->IsInitialized())
+	TMap<FPraxisMaterialStockKey, int32> Unreserved;                              // (SKU, Loc, AnyState|FG)
+	TMap<TPair<FPraxisMaterialReservationKey, FName>, int32> ReservedInput;       // (WO, Machine) + SKU
+	TMap<TPair<FPraxisMaterialReservationKey, FName>, int32> WIP;                 // (WO, Machine) + SKU, NAME_None = any
+	TMap<FName, float> VolumeDelta;                                               // Location volume moved by earlier ops
+	
+	auto SumStock = [this](const FPraxisMaterialStockKey& Key)
 	{
-		return Result;
-	}
+		int32 Total = -ReservationLedger.GetClaimedStock(Key);
+		for (const FMassEntityHandle& Entity : MaterialIndex.FindStock(Key))
+		{
+			if (const FPraxisMaterialIndex::FEntry* Entry = MaterialIndex.FindEntry(Entity))
+			{
+				Total += Entry->Quantity;
+			}
+		}
+		return Total;
+	};
 	
-	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	auto UnreservedBalance = [&](FName SKU, FName LocationId, uint8 State) -> int32&
+	{
+		const FPraxisMaterialStockKey Key(SKU, LocationId, State, false);
+		if (int32* Balance = Unreserved.Find(Key))
+		{
+			return *Balance;
+		}
+		
+		int32 Initial = 0;
+		if (State == AnyState)
+		{
+			// RawMaterial, WorkInProcess, FinishedGoods, Scrap, InTransit
+			for (uint8 S = 0; S < 5; ++S)
+			{
+				Initial += SumStock(FPraxisMaterialStockKey(SKU, LocationId, S, false));
+			}
+		}
+		else
+		{
+			Initial = SumStock(Key);
+		}
+		return Unreserved.Add(Key, Initial);
+	};
 	
-	// Aggregate inventory by SKU and state at this location
-	TMap<TPair<FName, uint8>, FLocationInventoryItem> Aggregated;
+	auto ReservedBalance = [&](FName MachineId, int64 WorkOrderId, FName SKU) -> int32&
+	{
+		const TPair<FPraxisMaterialReservationKey, FName> Key(FPraxisMaterialReservationKey(WorkOrderId, MachineId), SKU);
+		if (int32* Balance = ReservedInput.Find(Key))
+		{
+			return *Balance;
+		}
+		return ReservedInput.Add(Key, GetReservedQuantity(MachineId, WorkOrderId, SKU));
+	};
 	
-	for (const FMassEntityHandle& Entity : MaterialEntities)
+	auto WIPBalance = [&](FName MachineId, int64 WorkOrderId, FName SKU) -> int32&
 	{
-		if (!EntityManager.IsEntityValid(Entity))
+		const TPair<FPraxisMaterialReservationKey, FName> Key(FPraxisMaterialReservationKey(WorkOrderId, MachineId), SKU);
+		if (int32* Balance = WIP.Find(Key))
 		{
-			continue;
+			return *Balance;
 		}
-		
-		// Check location match
-		const FMaterialLocationFragment* LocFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(Entity);
-		if (!LocFrag || LocFrag->LocationId != LocationId)
+		return WIP.Add(Key, GetWIPQuantity(MachineId, WorkOrderId, SKU));
+	};
+	
+	for (int32 OpIndex = 0; OpIndex < Ops.Num(); ++OpIndex)
+	{
+		const FPraxisInventoryOp& Op = Ops[OpIndex];
+		if (Op.Quantity <= 0)
 		{
-			continue;
+			return OpIndex;
 		}
 		
-		// Get other fragments
-		const FMaterialTypeFragment* TypeFrag = EntityManager.GetFragmentDataPtr<FMaterialTypeFragment>(Entity);
-		const FMaterialStateFragment* StateFrag = EntityManager.GetFragmentDataPtr<FMaterialStateFragment>(Entity);
-		const FMaterialQuantityFragment* QtyFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(Entity);
-		const FMaterialReservationFragment* ResFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(Entity);
+		switch (Op.Type)
+		{
+		case EPraxisInventoryOpType::Reserve:
+		{
+			int32& Available = UnreservedBalance(Op.SKU, Op.LocationId, AnyState);
+			if (Available < Op.Quantity)
+			{
+				return OpIndex;
+			}
+			Available -= Op.Quantity;
+			ReservedBalance(Op.MachineId, Op.WorkOrderId, Op.SKU) += Op.Quantity;
+			break;
+		}
 		
-		if (!TypeFrag || !QtyFrag)
+		case EPraxisInventoryOpType::Consume:
 		{
-			continue;
+			int32& Reserved = ReservedBalance(Op.MachineId, Op.WorkOrderId, Op.SKU);
+			if (Reserved < Op.Quantity)
+			{
+				return OpIndex;
+			}
+			Reserved -= Op.Quantity;
+			WIPBalance(Op.MachineId, Op.WorkOrderId, Op.SKU) += Op.Quantity;
+			WIPBalance(Op.MachineId, Op.WorkOrderId, NAME_None) += Op.Quantity;
+			break;
 		}
 		
-		const uint8 State = StateFrag ? static_cast<uint8>(StateFrag->State) : 0;
-		const TPair<FName, uint8> Key(TypeFrag->SKU, State);
+		case EPraxisInventoryOpType::Produce:
+		case EPraxisInventoryOpType::Scrap:
+		{
+			if (Op.bExplicitInputs)
+			{
+				// Made from its inputs, each drawn from the WIP of its own SKU
+				for (const TPair<FName, int32>& Input : Op.Inputs)
+				{
+					int32& Available = WIPBalance(Op.MachineId, Op.WorkOrderId, Input.Key);
+					if (Input.Value < 0 || Available < Input.Value)
+					{
+						return OpIndex;
+					}
+					Available -= Input.Value;
+					WIPBalance(Op.MachineId, Op.WorkOrderId, NAME_None) -= Input.Value;
+				}
+			}
+			else
+			{
+				// One WIP unit of any SKU per unit; which SKUs it takes isn't tracked, so
+				// per-SKU balances stay upper bounds for later ops in the batch
+				int32& Pending = WIPBalance(Op.MachineId, Op.WorkOrderId, NAME_None);
+				if (Pending < Op.Quantity)
+				{
+					return OpIndex;
+				}
+				Pending -= Op.Quantity;
+			}
+			if (Op.Type == EPraxisInventoryOpType::Produce)
+			{
+				UnreservedBalance(Op.SKU, Op.LocationId, AnyState) += Op.Quantity;
+				UnreservedBalance(Op.SKU, Op.LocationId, FGState) += Op.Quantity;
+			}
+			break;
+		}
 		
-		FLocationInventoryItem& Item = Aggregated.FindOrAdd(Key);
-		Item.SKU = TypeFrag->SKU;
-		Item.MaterialState = State;
-		Item.Quantity += QtyFrag->Quantity;
-		Item.Volume += QtyFrag->GetTotalVolume();
+		case EPraxisInventoryOpType::Transfer:
+		{
+			if (Op.LocationId == Op.DestinationLocationId)
+			{
+				return OpIndex;
+			}
+			int32& Available = UnreservedBalance(Op.SKU, Op.LocationId, AnyState);
+			if (Available < Op.Quantity)
+			{
+				return OpIndex;
+			}
+			
+			// Volume of the units TransferMaterial would pick, net of what earlier ops moved
+			// in or out of the destination, against the same capacity check it makes
+			float Volume = 0.0f;
+			int32 ToPick = Op.Quantity;
+			MaterialIndex.VisitLots(Op.SKU, Op.LocationId, [&](FMassEntityHandle Entity, const FPraxisMaterialIndex::FEntry& Entry)
+			{
+				const int32 Take = FMath::Min(GetUnclaimedQuantity(Entity, Entry), ToPick);
+				if (Take > 0 && Entry.Quantity > 0)
+				{
+					Volume += Take * (Entry.Volume / Entry.Quantity);
+					ToPick -= Take;
+				}
+				return ToPick > 0;
+			});
+			
+			float& DestinationDelta = VolumeDelta.FindOrAdd(Op.DestinationLocationId);
+			if (!HasCapacity(Op.DestinationLocationId, DestinationDelta + Volume))
+			{
+				return OpIndex;
+			}
+			DestinationDelta += Volume;
+			VolumeDelta.FindOrAdd(Op.LocationId) -= Volume;
+			
+			Available -= Op.Quantity;
+			UnreservedBalance(Op.SKU, Op.DestinationLocationId, AnyState) += Op.Quantity;
+			break;
+		}
 		
-		// Mark as reserved if any entity is reserved
-		if (ResFrag && ResFrag->bReserved)
+		case EPraxisInventoryOpType::Ship:
 		{
-			Item.bReserved = true;
+			int32& AvailableFG = UnreservedBalance(Op.SKU, Op.LocationId, FGState);
+			if (AvailableFG < Op.Quantity)
+			{
+				return OpIndex;
+			}
+			AvailableFG -= Op.Quantity;
+			UnreservedBalance(Op.SKU, Op.LocationId, AnyState) -= Op.Quantity;
+			break;
+		}
 		}
 	}
 	
-	// Convert map to array
-	for (const auto& Pair : Aggregated)
-	{
-		Result.Add(Pair.Value);
-	}
-	
-	return Result;
+	return INDEX_NONE;
 }
 
 // ════════════════════════════════════════════════════════════════════════════════
-// Configuration
+// Continuous Material
 // ════════════════════════════════════════════════════════════════════════════════
 
-void UPraxisInventoryService::RegisterBOM(const FBOMEntry& BOM)
+bool UPraxisInventoryService::RegisterFluidContainer(
+	FName ContainerId,
+	FName LocationId,
+	FName SKU,
+	EPraxisUnitOfMeasure UnitOfMeasure,
+	double Capacity,
+	double InitialLevel,
+	uint8 MaterialState)
 {
-	BOMs.Add(BOM.BOMId, BOM);
+	// Counted units (each, pack, case...) stay discrete
+	if (UnitOfMeasure != EPraxisUnitOfMeasure::Kilogram && UnitOfMeasure != EPraxisUnitOfMeasure::Liter
+		&& UnitOfMeasure != EPraxisUnitOfMeasure::Meter)
+	{
+		UE_LOG(LogPraxisSim, Warning, TEXT("Fluid container %s: %s is not a continuous unit of measure"),
+			*ContainerId.ToString(), *UEnum::GetValueAsString(UnitOfMeasure));
+		return false;
+	}
 	
-	UE_LOG(LogPraxisSim, Log, 
-		TEXT("Registered BOM %s: %s x%d (Inputs: %d types)"),
-		*BOM.BOMId.ToString(),
-		*BOM.OutputSKU.ToString(),
-		BOM.OutputQuantity,
-		BOM.InputRequirements.Num());
+	if (Capacity <= 0.0)
+	{
+		UE_LOG(LogPraxisSim, Warning, TEXT("Fluid container %s: capacity must be positive"), *ContainerId.ToString());
+		return false;
+	}
+	
+	const TConstArrayView<int32> Existing = FluidStore.GetContainersForSKU(SKU);
+	if (Existing.Num() > 0 && FluidStore.Get(Existing[0]).UnitOfMeasure != UnitOfMeasure)
+	{
+		UE_LOG(LogPraxisSim, Warning, TEXT("Fluid container %s: %s is already held in %s"),
+			*ContainerId.ToString(), *SKU.ToString(), *UEnum::GetValueAsString(FluidStore.Get(Existing[0]).UnitOfMeasure));
+		return false;
+	}
+	
+	if (FluidStore.AddContainer(ContainerId, LocationId, SKU, UnitOfMeasure, MaterialState, Capacity, InitialLevel) == INDEX_NONE)
+	{
+		UE_LOG(LogPraxisSim, Warning, TEXT("Fluid container %s is already registered"), *ContainerId.ToString());
+		return false;
+	}
+	
+	const EPraxisUnitOfMeasure* KnownUnit = SKUUnitsOfMeasure.Find(SKU);
+	if (!KnownUnit || *KnownUnit != UnitOfMeasure)
+	{
+		RegisterSKU(SKU, UnitOfMeasure);
+	}
+	
+	SyncFluidAggregate(SKU);
+	
+	UE_LOG(LogPraxisSim, Log, TEXT("Registered fluid container %s at %s: %s %.2f/%.2f %s"),
+		*ContainerId.ToString(), *LocationId.ToString(), *SKU.ToString(),
+		FluidStore.Get(FluidStore.Find(ContainerId)).Level, Capacity, *UEnum::GetValueAsString(UnitOfMeasure));
+	
+	return true;
 }
 
-void UPraxisInventoryService::RegisterLocation(
-	FName LocationId, 
-	EPraxisLocationType LocationType,
-	float MaxVolume, 
-	int32 MaxItems,
-	FName SubLocationId)
+bool UPraxisInventoryService::SetFluidFlow(FName ContainerId, FName FlowId, int64 WorkOrderId, double RatePerSecond)
 {
-	FLocationCapacity& Capacity = Locations.FindOrAdd(LocationId);
-	Capacity.LocationId = LocationId;
-	Capacity.SubLocationId = SubLocationId;
-	Capacity.LocationType = LocationType;
-	Capacity.MaxVolume = MaxVolume;
-	Capacity.MaxItems = MaxItems;
+	const int32 Container = FluidStore.Find(ContainerId);
+	if (Container == INDEX_NONE)
+	{
+		UE_LOG(LogPraxisSim, Warning, TEXT("SetFluidFlow: unknown container %s"), *ContainerId.ToString());
+		return false;
+	}
 	
-	UE_LOG(LogPraxisSim, Log, 
-		TEXT("Registered location %s (Type: %d): %.1f m³, %d batches max"),
-		*LocationId.ToString(), 
-		static_cast<int32>(LocationType),
-		MaxVolume, 
-		MaxItems);
+	FluidStore.SetFlow(Container, FlowId, WorkOrderId, RatePerSecond);
+	return true;
+}
+
+double UPraxisInventoryService::GetFluidFlowRate(FName ContainerId, FName FlowId) const
+{
+	const int32 Container = FluidStore.Find(ContainerId);
+	return Container != INDEX_NONE ? FluidStore.GetFlowRate(Container, FlowId) : 0.0;
+}
+
+void UPraxisInventoryService::StopFluidFlows(FName FlowId)
+{
+	FluidStore.ClearFlows(FlowId);
+}
+
+double UPraxisInventoryService::AddFluid(FName ContainerId, double Amount)
+{
+	const int32 Container = FluidStore.Find(ContainerId);
+	if (Container == INDEX_NONE || Amount <= 0.0)
+	{
+		return 0.0;
+	}
+	
+	const double Added = FluidStore.Move(Container, Amount);
+	if (Added > 0.0)
+	{
+		const FPraxisFluidStore::FContainer& Data = FluidStore.Get(Container);
+		SyncFluidAggregate(Data.SKU);
+		
+		FPraxisTransactionRecord Transaction(EPraxisInventoryTransactionType::Adjustment, Data.SKU, FMath::RoundToInt(Added), Data.LocationId);
+		Transaction.RefName = ContainerId;
+		Transaction.FluidDelta = Added;
+		LogTransaction(Transaction);
+	}
+	return Added;
+}
+
+double UPraxisInventoryService::DrawFluid(FName ContainerId, double Amount)
+{
+	const int32 Container = FluidStore.Find(ContainerId);
+	if (Container == INDEX_NONE || Amount <= 0.0)
+	{
+		return 0.0;
+	}
+	
+	const double Drawn = -FluidStore.Move(Container, -Amount);
+	if (Drawn > 0.0)
+	{
+		const FPraxisFluidStore::FContainer& Data = FluidStore.Get(Container);
+		SyncFluidAggregate(Data.SKU);
+		
+		FPraxisTransactionRecord Transaction(EPraxisInventoryTransactionType::Adjustment, Data.SKU, -FMath::RoundToInt(Drawn), Data.LocationId);
+		Transaction.RefName = ContainerId;
+		Transaction.FluidDelta = -Drawn;
+		LogTransaction(Transaction);
+	}
+	return Drawn;
+}
+
+double UPraxisInventoryService::GetFluidLevel(FName ContainerId) const
+{
+	const int32 Container = FluidStore.Find(ContainerId);
+	return Container != INDEX_NONE ? FluidStore.Get(Container).Level : 0.0;
+}
+
+double UPraxisInventoryService::GetFluidTimeToLimit(FName ContainerId) const
+{
+	const int32 Container = FluidStore.Find(ContainerId);
+	if (Container == INDEX_NONE || FluidStore.Get(Container).NetRate == 0.0)
+	{
+		return -1.0;
+	}
+	return FluidStore.Get(Container).GetTimeToLimit();
+}
+
+double UPraxisInventoryService::GetFluidQuantity(FName SKU, FName LocationId) const
+{
+	if (!IsInGameThread())
+	{
+		const FPraxisInventorySnapshotPtr Snapshot = GetInventorySnapshot();
+		return Snapshot ? Snapshot->GetFluidQuantity(SKU, LocationId) : 0.0;
+	}
+	
+	const FInventorySummary* Summary = InventoryCache.Find(SKU);
+	if (!Summary)
+	{
+		return 0.0;
+	}
+	return LocationId.IsNone() ? Summary->FluidQuantity : Summary->FluidByLocation.FindRef(LocationId);
+}
+
+FName UPraxisInventoryService::FindFluidContainer(FName SKU, FName PreferredLocationId, bool bForFilling) const
+{
+	int32 Best = INDEX_NONE;
+	bool bBestPreferred = false;
+	double BestRoom = 0.0;
+	
+	for (const int32 Id : FluidStore.GetContainersForSKU(SKU))
+	{
+		const FPraxisFluidStore::FContainer& Container = FluidStore.Get(Id);
+		const bool bPreferred = !PreferredLocationId.IsNone() && Container.LocationId == PreferredLocationId;
+		const double Room = bForFilling ? Container.Capacity - Container.Level : Container.Level;
+		
+		if (Best == INDEX_NONE || (bPreferred && !bBestPreferred) || (bPreferred == bBestPreferred && Room > BestRoom))
+		{
+			Best = Id;
+			bBestPreferred = bPreferred;
+			BestRoom = Room;
+		}
+	}
+	
+	return Best != INDEX_NONE ? FluidStore.Get(Best).ContainerId : NAME_None;
 }
 
 // ════════════════════════════════════════════════════════════════════════════════
-// Internal Helpers
+// Queries
 // ════════════════════════════════════════════════════════════════════════════════
 
-FMassEntityHandle UPraxisInventoryService::SpawnMaterialEntity(
-	FName SKU,
-	int32 Quantity,
-	FName LocationId,
-	FName SubLocationId,
-	float VolumePerUnit,
-	uint8 InitialState)
+int32 UPraxisInventoryService::GetReservedQuantity(FName MachineId, int64 WorkOrderId, FName SKU) const
+{
+	return ReservationLedger.GetClaimed(FPraxisMaterialReservationKey(WorkOrderId, MachineId), SKU);
+}
+
+int32 UPraxisInventoryService::GetWorkOrderReservedQuantity(int64 WorkOrderId, FName SKU) const
+{
+	return ReservationLedger.GetClaimedForWorkOrder(WorkOrderId, SKU);
+}
+
+int32 UPraxisInventoryService::GetWIPQuantity(FName MachineId, int64 WorkOrderId, FName SKU) const
+{
+	const FPraxisMachineLocations* Machine = FindMachineLocations(MachineId);
+	if (!Machine)
+	{
+		return 0;
+	}
+	const FName MachineWIPLocation = Machine->WIPName;
+	
+	int32 Total = 0;
+	for (const FMassEntityHandle& Entity : MaterialIndex.FindReserved(FPraxisMaterialReservationKey(WorkOrderId, MachineId)))
+	{
+		const FPraxisMaterialIndex::FEntry* Entry = MaterialIndex.FindEntry(Entity);
+		if (Entry
+			&& Entry->StockKey.MaterialState == static_cast<uint8>(EMaterialState::WorkInProcess)
+			&& Entry->StockKey.LocationId == MachineWIPLocation
+			&& (SKU.IsNone() || Entry->StockKey.SKU == SKU))
+		{
+			Total += Entry->Quantity;
+		}
+	}
+	return Total;
+}
+
+FInventorySummary UPraxisInventoryService::GetInventorySummary(FName SKU) const
+{
+	if (!IsInGameThread())
+	{
+		const FPraxisInventorySnapshotPtr Snapshot = GetInventorySnapshot();
+		return Snapshot ? Snapshot->GetInventorySummary(SKU) : FInventorySummary();
+	}
+	
+	if (const FInventorySummary* Summary = InventoryCache.Find(SKU))
+	{
+		return *Summary;
+	}
+	
+	return FInventorySummary();
+}
+
+int32 UPraxisInventoryService::GetAvailableQuantity(FName SKU, FName LocationId) const
+{
+	if (!IsInGameThread())
+	{
+		const FPraxisInventorySnapshotPtr Snapshot = GetInventorySnapshot();
+		return Snapshot ? Snapshot->GetAvailableQuantity(SKU, LocationId) : 0;
+	}
+	
+	if (const FInventorySummary* Summary = InventoryCache.Find(SKU))
+	{
+		return Summary->GetAvailableQuantity(LocationId);
+	}
+	
+	return 0;
+}
+
+bool UPraxisInventoryService::HasCapacity(FName LocationId, float RequiredVolume) const
+{
+	const FPraxisLocationHandle Location = LocationTable.Find(LocationId);
+	if (Location.IsValid())
+	{
+		return LocationCapacities[Location.Index].GetRemainingVolume() >= RequiredVolume;
+	}
+	
+	return true; // No capacity limit defined - allow anything
+}
+
+FLocationCapacity UPraxisInventoryService::GetLocationCapacity(FName LocationId) const
+{
+	if (!IsInGameThread())
+	{
+		const FPraxisInventorySnapshotPtr Snapshot = GetInventorySnapshot();
+		return Snapshot ? Snapshot->GetLocationCapacity(LocationId) : FLocationCapacity();
+	}
+	
+	const FPraxisLocationHandle Location = LocationTable.Find(LocationId);
+	if (Location.IsValid())
+	{
+		return LocationCapacities[Location.Index];
+	}
+	
+	return FLocationCapacity();
+}
+
+FPraxisPutawayResult UPraxisInventoryService::FindPutawayLocation(FName SKU, float Volume, EPraxisPutawayPolicy Policy, FVector NearPosition) const
+{
+	FPraxisPutawayResult Result;
+	
+	// Bins dedicated to the SKU first, then shared bins
+	const FPraxisPutawayIndex* Indexes[] =
+	{
+		SKU.IsNone() ? nullptr : PutawayIndexes.Find(SKU),
+		PutawayIndexes.Find(NAME_None)
+	};
+	
+	for (const FPraxisPutawayIndex* Index : Indexes)
+	{
+		if (!Index)
+		{
+			continue;
+		}
+		
+		int32 Slot = INDEX_NONE;
+		switch (Policy)
+		{
+		case EPraxisPutawayPolicy::FirstFit:
+			Slot = Index->FindFirstFit(Volume);
+			break;
+		case EPraxisPutawayPolicy::BestFit:
+			Slot = Index->FindBestFit(Volume);
+			break;
+		case EPraxisPutawayPolicy::Closest:
+			Slot = Index->FindClosest(Volume, NearPosition);
+			break;
+		}
+		
+		if (Slot != INDEX_NONE)
+		{
+			const FPraxisPutawayBin& Bin = PutawayBins[Index->GetBinId(Slot)];
+			const FLocationCapacity& Capacity = GetCapacityNode(Bin.Location, Bin.SubLocationNode);
+			Result.bFound = true;
+			Result.LocationId = Capacity.LocationId;
+			Result.SubLocationId = Capacity.SubLocationId;
+			Result.FreeVolume = Index->GetFreeVolume(Slot);
+			return Result;
+		}
+	}
+	
+	UE_LOG(LogPraxisSim, Verbose, TEXT("Putaway: no bin with %.3f m³ free for %s"), Volume, *SKU.ToString());
+	return Result;
+}
+
+bool UPraxisInventoryService::DedicatePutawayBin(FName LocationId, FName SubLocationId, FName SKU)
+{
+	const FPraxisLocationHandle Location = LocationTable.Find(LocationId);
+	const int32* SubLocationNode = SubLocationId.IsNone() ? nullptr
+		: SubLocationLookup.Find(TPair<int32, FName>(Location.Index, SubLocationId));
+	
+	const bool bNodeExists = Location.IsValid() && (SubLocationId.IsNone() || SubLocationNode);
+	const int32 BinId = bNodeExists ? GetPutawayBinId(Location, SubLocationNode ? *SubLocationNode : INDEX_NONE) : INDEX_NONE;
+	if (BinId == INDEX_NONE || PutawayBins[BinId].Slot == INDEX_NONE)
+	{
+		UE_LOG(LogPraxisSim, Warning, TEXT("DedicatePutawayBin: %s/%s is not a putaway bin"),
+			*LocationId.ToString(), *SubLocationId.ToString());
+		return false;
+	}
+	
+	FPraxisPutawayBin& Bin = PutawayBins[BinId];
+	if (Bin.SKU == SKU)
+	{
+		return true;
+	}
+	
+	// Move the bin to the other index; its old slot stays retired
+	PutawayIndexes[Bin.SKU].RetireBin(Bin.Slot);
+	Bin.SKU = SKU;
+	Bin.Slot = FindOrAddPutawayIndex(SKU).AddBin(BinId, GetLocationWorldPosition(LocationId));
+	SyncPutawayBin(Bin.Location, Bin.SubLocationNode, false);
+	return true;
+}
+
+FLocationCapacity UPraxisInventoryService::GetSubLocationCapacity(FName LocationId, FName SubLocationId) const
+{
+	if (SubLocationId.IsNone())
+	{
+		return GetLocationCapacity(LocationId);
+	}
+	
+	const FPraxisLocationHandle Location = LocationTable.Find(LocationId);
+	if (const int32* Node = SubLocationLookup.Find(TPair<int32, FName>(Location.Index, SubLocationId)))
+	{
+		return SubLocationCapacities[*Node];
+	}
+	
+	return FLocationCapacity();
+}
+
+TArray<FInventoryTransaction> UPraxisInventoryService::GetTransactionHistory(int32 MaxRecords) const
+{
+	TArray<FInventoryTransaction> Result;
+	const int32 StartIndex = FMath::Max(0, TransactionJournal.Num() - MaxRecords);
+	Result.Reserve(TransactionJournal.Num() - StartIndex);
+	
+	for (int32 i = StartIndex; i < TransactionJournal.Num(); ++i)
+	{
+		Result.Add(FormatTransaction(TransactionJournal[i]));
+	}
+	
+	return Result;
+}
+
+void UPraxisInventoryService::SetTransactionHistoryCapacity(int32 NewCapacity)
+{
+	TransactionHistoryCapacity = FMath::Max(1, NewCapacity);
+	TransactionJournal.SetCapacity(TransactionHistoryCapacity);
+}
+
+bool UPraxisInventoryService::ExportTransactionHistoryToCSV(const FString& FilePath) const
+{
+	if (TransactionJournal.Num() == 0)
+	{
+		UE_LOG(LogPraxisSim, Warning, TEXT("Cannot export transactions - journal is empty"));
+		return false;
+	}
+	
+	// Build CSV content
+	FString CSV = TEXT("Timestamp,Type,SKU,QuantityDelta,LocationId,SubLocationId,BatchId,Reference\n");
+	
+	for (int32 i = 0; i < TransactionJournal.Num(); ++i)
+	{
+		const FPraxisTransactionRecord& Record = TransactionJournal[i];
+		CSV += FString::Printf(TEXT("%s,%s,%s,%d,%s,%s,%s,%s\n"),
+			*FDateTime(Record.TimestampTicks).ToString(),
+			LexToString(Record.Type),
+			*Record.SKU.ToString(),
+			Record.QuantityDelta,
+			*Record.LocationId.ToString(),
+			*Record.SubLocationId.ToString(),
+			*Record.BatchId.ToString(),
+			*Record.FormatReference());
+	}
+	
+	// Write to file
+	const FString FullPath = FPaths::ProjectSavedDir() / FilePath;
+	
+	if (FFileHelper::SaveStringToFile(CSV, *FullPath))
+	{
+		UE_LOG(LogPraxisSim, Log, TEXT("Exported %d transactions to: %s"), TransactionJournal.Num(), *FullPath);
+		return true;
+	}
+	
+	UE_LOG(LogPraxisSim, Error, TEXT("Failed to export transactions to: %s"), *FullPath);
+	return false;
+}
+
+TArray<FPraxisBatchTraceEntry> UPraxisInventoryService::TraceBatchOrigins(FGuid BatchId) const
+{
+	TArray<FPraxisBatchTraceEntry> Result;
+	
+	const uint32 Id = Genealogy.FindBatch(BatchId);
+	if (!Genealogy.IsValidId(Id))
+	{
+		UE_LOG(LogPraxisSim, Warning, TEXT("TraceBatchOrigins: unknown batch %s"), *BatchId.ToString());
+		return Result;
+	}
+	
+	TArray<uint32> Ancestors;
+	Genealogy.TraceBackward(Id, Ancestors);
+	BuildTraceEntries(Ancestors, false, Result);
+	return Result;
+}
+
+TArray<FPraxisBatchTraceEntry> UPraxisInventoryService::TraceBatchDescendants(FGuid BatchId, bool bFinishedGoodsOnly) const
+{
+	TArray<FPraxisBatchTraceEntry> Result;
+	
+	const uint32 Id = Genealogy.FindBatch(BatchId);
+	if (!Genealogy.IsValidId(Id))
+	{
+		UE_LOG(LogPraxisSim, Warning, TEXT("TraceBatchDescendants: unknown batch %s"), *BatchId.ToString());
+		return Result;
+	}
+	
+	TArray<uint32> Descendants;
+	Genealogy.TraceForward(Id, Descendants);
+	BuildTraceEntries(Descendants, bFinishedGoodsOnly, Result);
+	return Result;
+}
+
+TArray<FLocationInventoryItem> UPraxisInventoryService::GetInventoryAtLocation(FName LocationId) const
+{
+	FPraxisMaterialQueryFilter Filter;
+	Filter.LocationId = LocationId;
+	Filter.bExactLocation = true;
+	return QueryInventory(Filter, bParallelInventoryReads);
+}
+
+TArray<FLocationInventoryItem> UPraxisInventoryService::QueryInventory(const FPraxisMaterialQueryFilter& Filter, bool bParallel) const
+{
+	// Aggregate inventory by SKU and state
+	TMap<TPair<FName, uint8>, FLocationInventoryItem> Aggregated;
+	FCriticalSection MergeLock;
+	
+	ForEachMaterialChunk([&Filter, &Aggregated, &MergeLock](FMassExecutionContext& Context)
+	{
+		// One SKU per chunk: other SKUs are rejected without touching their entities
+		const FName SKU = Context.GetConstSharedFragment<FMaterialSKUFragment>().SKU;
+		if (!Filter.SKU.IsNone() && Filter.SKU != SKU)
+		{
+			return;
+		}
+		
+		const TConstArrayView<FMaterialStateFragment> States = Context.GetFragmentView<FMaterialStateFragment>();
+		const TConstArrayView<FMaterialQuantityFragment> Quantities = Context.GetFragmentView<FMaterialQuantityFragment>();
+		const TConstArrayView<FMaterialLocationFragment> Locations = Context.GetFragmentView<FMaterialLocationFragment>();
+		const TConstArrayView<FMaterialReservationFragment> Reservations = Context.GetFragmentView<FMaterialReservationFragment>();
+		
+		// Accumulate per chunk, merge once
+		TMap<TPair<FName, uint8>, FLocationInventoryItem> ChunkItems;
+		
+		for (int32 i = 0; i < Context.GetNumEntities(); ++i)
+		{
+			// Empty batches hold no stock
+			if (Quantities[i].Quantity <= 0)
+			{
+				continue;
+			}
+			
+			const uint8 State = static_cast<uint8>(States[i].State);
+			const bool bIsReserved = Reservations[i].bReserved;
+			if (!Filter.Matches(SKU, Locations[i].LocationId, State, bIsReserved))
+			{
+				continue;
+			}
+			
+			FLocationInventoryItem& Item = ChunkItems.FindOrAdd(TPair<FName, uint8>(SKU, State));
+			Item.SKU = SKU;
+			Item.MaterialState = State;
+			Item.Quantity += Quantities[i].Quantity;
+			Item.Volume += Quantities[i].GetTotalVolume();
+			
+			// Mark as reserved if any entity is reserved
+			Item.bReserved |= bIsReserved;
+		}
+		
+		if (ChunkItems.Num() == 0)
+		{
+			return;
+		}
+		
+		FScopeLock Lock(&MergeLock);
+		for (const TPair<TPair<FName, uint8>, FLocationInventoryItem>& Pair : ChunkItems)
+		{
+			FLocationInventoryItem& Item = Aggregated.FindOrAdd(Pair.Key);
+			Item.SKU = Pair.Value.SKU;
+			Item.MaterialState = Pair.Value.MaterialState;
+			Item.Quantity += Pair.Value.Quantity;
+			Item.Volume += Pair.Value.Volume;
+			Item.bReserved |= Pair.Value.bReserved;
+		}
+	}, bParallel);
+	
+	// Continuous stock: a handful of containers, read directly
+	const TConstArrayView<int32> FluidContainers = !Filter.MatchesAnyLocation() ? FluidStore.GetContainersAtLocation(Filter.LocationId)
+		: !Filter.SKU.IsNone() ? FluidStore.GetContainersForSKU(Filter.SKU)
+		: TConstArrayView<int32>();
+	const bool bAllContainers = Filter.MatchesAnyLocation() && Filter.SKU.IsNone();
+	for (int32 i = 0, Num = bAllContainers ? FluidStore.Num() : FluidContainers.Num(); i < Num; ++i)
+	{
+		const FPraxisFluidStore::FContainer& Container = FluidStore.Get(bAllContainers ? i : FluidContainers[i]);
+		if (!Filter.Matches(Container.SKU, Container.LocationId, Container.MaterialState, false))
+		{
+			continue;
+		}
+		
+		FLocationInventoryItem& Item = Aggregated.FindOrAdd(TPair<FName, uint8>(Container.SKU, Container.MaterialState));
+		Item.SKU = Container.SKU;
+		Item.MaterialState = Container.MaterialState;
+		Item.UnitOfMeasure = Container.UnitOfMeasure;
+		Item.FluidQuantity += Container.Level;
+	}
+	
+	// Convert map to array
+	TArray<FLocationInventoryItem> Result;
+	Result.Reserve(Aggregated.Num());
+	for (const auto& Pair : Aggregated)
+	{
+		Result.Add(Pair.Value);
+	}
+	
+	return Result;
+}
+
+void UPraxisInventoryService::ForEachMaterialChunk(const FMassExecuteFunction& ChunkFunction, bool bParallel) const
+{
+	if (!MassSubsystem || !MassSubsystem->IsInitialized() || !bArchetypeInitialized)
+	{
+		return;
+	}
+	
+	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	FMassExecutionContext ExecContext(EntityManager);
+	
+	if (bParallel)
+	{
+		MaterialQuery.ParallelForEachEntityChunk(ExecContext, ChunkFunction);
+	}
+	else
+	{
+		MaterialQuery.ForEachEntityChunk(ExecContext, ChunkFunction);
+	}
+}
+
+// ════════════════════════════════════════════════════════════════════════════════
+// Configuration
+// ════════════════════════════════════════════════════════════════════════════════
+
+void UPraxisInventoryService::RegisterBOM(const FBOMEntry& BOM)
+{
+	BOMs.Add(BOM.BOMId, BOM);
+	
+	UE_LOG(LogPraxisSim, Log, 
+		TEXT("Registered BOM %s: %s x%d (Inputs: %d types)"),
+		*BOM.BOMId.ToString(),
+		*BOM.OutputSKU.ToString(),
+		BOM.OutputQuantity,
+		BOM.InputRequirements.Num());
+}
+
+const FBOMEntry* UPraxisInventoryService::FindBOMForOutput(FName OutputSKU) const
+{
+	for (const TPair<FName, FBOMEntry>& Pair : BOMs)
+	{
+		if (Pair.Value.OutputSKU == OutputSKU)
+		{
+			return &Pair.Value;
+		}
+	}
+	return nullptr;
+}
+
+void UPraxisInventoryService::RegisterLocation(
+	FName LocationId, 
+	EPraxisLocationType LocationType,
+	float MaxVolume, 
+	int32 MaxItems,
+	FName SubLocationId)
+{
+	const FPraxisLocationHandle Location = FindOrAddLocation(LocationId);
+	const int32 SubLocationNode = SubLocationId.IsNone() ? INDEX_NONE : FindOrAddSubLocation(Location, SubLocationId);
+	
+	FLocationCapacity& Capacity = SubLocationNode == INDEX_NONE
+		? LocationCapacities[Location.Index]
+		: SubLocationCapacities[SubLocationNode];
+	Capacity.LocationType = LocationType;
+	Capacity.MaxVolume = MaxVolume;
+	Capacity.MaxItems = MaxItems;
+	MarkLocationDirty(Location);
+	
+	// Volume-limited leaves are putaway bins
+	SyncPutawayBin(Location, SubLocationNode, true);
+	
+	UE_LOG(LogPraxisSim, Log, 
+		TEXT("Registered location %s%s%s (Type: %d): %.1f m³, %d batches max"),
+		*LocationId.ToString(), 
+		SubLocationId.IsNone() ? TEXT("") : TEXT("/"),
+		SubLocationId.IsNone() ? TEXT("") : *SubLocationId.ToString(),
+		static_cast<int32>(LocationType),
+		MaxVolume, 
+		MaxItems);
+}
+
+void UPraxisInventoryService::SetLotPickingPolicy(FName SKU, EPraxisLotPickingPolicy Policy)
+{
+	LotPickingPolicies.Add(SKU, Policy);
+	
+	// Re-key the SKU's existing lots under the new order
+	TArray<FMassEntityHandle> ToReindex;
+	for (const FMassEntityHandle& Entity : MaterialEntities)
+	{
+		const FPraxisMaterialIndex::FEntry* Entry = MaterialIndex.FindEntry(Entity);
+		if (Entry && Entry->StockKey.SKU == SKU && Entry->LotSlot != INDEX_NONE)
+		{
+			ToReindex.Add(Entity);
+		}
+	}
+	for (const FMassEntityHandle& Entity : ToReindex)
+	{
+		IndexMaterialEntity(Entity);
+	}
+	
+	UE_LOG(LogPraxisSim, Log, TEXT("Lot picking policy for %s set to %s (%d lots re-sorted)"),
+		*SKU.ToString(), *UEnum::GetValueAsString(Policy), ToReindex.Num());
+}
+
+void UPraxisInventoryService::SetShelfLife(FName SKU, double ShelfLifeSeconds)
+{
+	if (ShelfLifeSeconds > 0.0)
+	{
+		ShelfLives.Add(SKU, ShelfLifeSeconds);
+	}
+	else
+	{
+		ShelfLives.Remove(SKU);
+	}
+}
+
+void UPraxisInventoryService::SetLotFormingRule(FName SKU, const FPraxisLotFormingRule& Rule)
+{
+	LotFormingRules.Add(SKU, Rule);
+	
+	// Open lots were formed under the old rule
+	for (auto It = OpenLots.CreateIterator(); It; ++It)
+	{
+		if (It->Key.SKU == SKU)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UPraxisInventoryService::RegisterSKU(FName SKU, EPraxisUnitOfMeasure UnitOfMeasure)
+{
+	SKUUnitsOfMeasure.Add(SKU, UnitOfMeasure);
+	
+	// Cached shared values carry the old unit of measure, and so do the entities pooled under them
+	for (auto It = SKUSharedFragments.CreateIterator(); It; ++It)
+	{
+		if (It->Key.Key == SKU)
+		{
+			It.RemoveCurrent();
+		}
+	}
+	for (auto It = EntityPools.CreateIterator(); It; ++It)
+	{
+		if (It->Key.Key == SKU)
+		{
+			PooledEntityCount -= It->Value.Num();
+			PendingEntityDestroys.Append(It->Value.GetEntities().GetData(), It->Value.Num());
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UPraxisInventoryService::RegisterMachineLocations(FName MachineId)
+{
+	GetMachineLocations(MachineId);
+}
+
+const FPraxisMachineLocations& UPraxisInventoryService::GetMachineLocations(FName MachineId)
+{
+	if (const FPraxisMachineLocations* Existing = MachineLocations.Find(MachineId))
+	{
+		return *Existing;
+	}
+	
+	// Names are built once per machine; everything after this is a map hit
+	const FString MachineName = MachineId.ToString();
+	
+	FPraxisMachineLocations& Machine = MachineLocations.Add(MachineId);
+	Machine.WIPName = FName(*(MachineName + TEXT(".WIP")));
+	Machine.OutputName = FName(*(MachineName + TEXT(".Output")));
+	Machine.ScrapName = FName(*(MachineName + TEXT(".Scrap")));
+	Machine.WIP = FindOrAddLocation(Machine.WIPName);
+	Machine.Output = FindOrAddLocation(Machine.OutputName);
+	Machine.Scrap = FindOrAddLocation(Machine.ScrapName);
+	
+	UE_LOG(LogPraxisSim, Verbose, TEXT("Registered machine locations for %s (WIP:%d Output:%d Scrap:%d)"),
+		*MachineName, Machine.WIP.Index, Machine.Output.Index, Machine.Scrap.Index);
+	
+	return Machine;
+}
+
+// ════════════════════════════════════════════════════════════════════════════════
+// Snapshot
+// ════════════════════════════════════════════════════════════════════════════════
+
+FInventorySummary FPraxisInventorySnapshot::GetInventorySummary(FName SKU) const
+{
+	if (const FSummaryRef* Summary = Summaries.Find(SKU))
+	{
+		return Summary->Get();
+	}
+	
+	return FInventorySummary();
+}
+
+int32 FPraxisInventorySnapshot::GetAvailableQuantity(FName SKU, FName LocationId) const
+{
+	if (const FSummaryRef* Summary = Summaries.Find(SKU))
+	{
+		return (*Summary)->GetAvailableQuantity(LocationId);
+	}
+	
+	return 0;
+}
+
+double FPraxisInventorySnapshot::GetFluidQuantity(FName SKU, FName LocationId) const
+{
+	if (const FSummaryRef* Summary = Summaries.Find(SKU))
+	{
+		return LocationId.IsNone() ? (*Summary)->FluidQuantity : (*Summary)->FluidByLocation.FindRef(LocationId);
+	}
+	
+	return 0.0;
+}
+
+FLocationCapacity FPraxisInventorySnapshot::GetLocationCapacity(FName LocationId) const
+{
+	if (const int32* Index = LocationIndex->Find(LocationId))
+	{
+		return Locations[*Index].Get();
+	}
+	
+	return FLocationCapacity();
+}
+
+// ════════════════════════════════════════════════════════════════════════════════
+// Internal Helpers
+// ════════════════════════════════════════════════════════════════════════════════
+
+int32 UPraxisInventoryService::FindOrAddSubLocation(FPraxisLocationHandle Location, FName SubLocationId)
+{
+	if (const int32* Existing = SubLocationLookup.Find(TPair<int32, FName>(Location.Index, SubLocationId)))
+	{
+		return *Existing;
+	}
+	
+	// New path: make sure its parent exists first ("Zone/Rack/Bin" → "Zone/Rack")
+	const FString Path = SubLocationId.ToString();
+	int32 Separator = INDEX_NONE;
+	const int32 Parent = Path.FindLastChar(TEXT('/'), Separator)
+		? FindOrAddSubLocation(Location, FName(*Path.Left(Separator)))
+		: INDEX_NONE;
+	
+	const FName LocationId = LocationCapacities[Location.Index].LocationId;
+	
+	FPraxisSubLocationNode& Node = SubLocationNodes.AddDefaulted_GetRef();
+	Node.Location = Location;
+	Node.Parent = Parent;
+	Node.Depth = Parent == INDEX_NONE ? 1 : SubLocationNodes[Parent].Depth + 1;
+	Node.DisplayName = FName(*FString::Printf(TEXT("%s/%s"), *LocationId.ToString(), *Path));
+	
+	// Unlimited until RegisterLocation sets limits; usage still rolls up
+	FLocationCapacity& Capacity = SubLocationCapacities.AddDefaulted_GetRef();
+	Capacity.LocationId = LocationId;
+	Capacity.SubLocationId = SubLocationId;
+	Capacity.LocationType = LocationCapacities[Location.Index].LocationType;
+	Capacity.MaxVolume = 0.0f;
+	Capacity.MaxItems = 0;
+	
+	const int32 Index = SubLocationNodes.Num() - 1;
+	SubLocationLookup.Add(TPair<int32, FName>(Location.Index, SubLocationId), Index);
+	
+	// The parent now aggregates bins rather than being one
+	RetirePutawayBin(Location, Parent);
+	
+	return Index;
+}
+
+FPraxisPutawayIndex& UPraxisInventoryService::FindOrAddPutawayIndex(FName SKU)
+{
+	if (FPraxisPutawayIndex* Existing = PutawayIndexes.Find(SKU))
+	{
+		return *Existing;
+	}
+	return PutawayIndexes.Emplace(SKU, FPraxisPutawayIndex(PutawayVolumeResolution));
+}
+
+int32& UPraxisInventoryService::GetPutawayBinId(FPraxisLocationHandle Location, int32 SubLocationNode)
+{
+	TArray<int32>& BinIds = SubLocationNode == INDEX_NONE ? LocationPutawayBins : SubLocationPutawayBins;
+	const int32 Index = SubLocationNode == INDEX_NONE ? Location.Index : SubLocationNode;
+	while (BinIds.Num() <= Index)
+	{
+		BinIds.Add(INDEX_NONE);
+	}
+	return BinIds[Index];
+}
+
+void UPraxisInventoryService::SyncPutawayBin(FPraxisLocationHandle Location, int32 SubLocationNode, bool bCreate)
+{
+	int32& BinId = GetPutawayBinId(Location, SubLocationNode);
+	const FLocationCapacity& Capacity = GetCapacityNode(Location, SubLocationNode);
+	
+	if (BinId == INDEX_NONE)
+	{
+		if (!bCreate || Capacity.MaxVolume <= 0.0f)
+		{
+			return;
+		}
+		
+		BinId = PutawayBins.Num();
+		FPraxisPutawayBin& NewBin = PutawayBins.AddDefaulted_GetRef();
+		NewBin.Location = Location;
+		NewBin.SubLocationNode = SubLocationNode;
+		NewBin.Slot = FindOrAddPutawayIndex(NAME_None).AddBin(BinId, GetLocationWorldPosition(Capacity.LocationId));
+	}
+	
+	const FPraxisPutawayBin& Bin = PutawayBins[BinId];
+	if (Bin.Slot == INDEX_NONE)
+	{
+		return;  // Aggregate node
+	}
+	
+	const bool bAccepting = Capacity.MaxVolume > 0.0f && (Capacity.MaxItems <= 0 || Capacity.CurrentItems < Capacity.MaxItems);
+	PutawayIndexes[Bin.SKU].UpdateBin(Bin.Slot, bAccepting ? Capacity.GetRemainingVolume() : 0.0f);
+}
+
+void UPraxisInventoryService::RetirePutawayBin(FPraxisLocationHandle Location, int32 SubLocationNode)
+{
+	int32& BinId = GetPutawayBinId(Location, SubLocationNode);
+	if (BinId == INDEX_NONE)
+	{
+		// Record the node as an aggregate so it never becomes a bin
+		BinId = PutawayBins.Num();
+		FPraxisPutawayBin& Aggregate = PutawayBins.AddDefaulted_GetRef();
+		Aggregate.Location = Location;
+		Aggregate.SubLocationNode = SubLocationNode;
+		return;
+	}
+	
+	FPraxisPutawayBin& Bin = PutawayBins[BinId];
+	if (Bin.Slot != INDEX_NONE)
+	{
+		PutawayIndexes[Bin.SKU].RetireBin(Bin.Slot);
+		Bin.Slot = INDEX_NONE;
+	}
+}
+
+FPraxisLocationHandle UPraxisInventoryService::FindOrAddLocation(FName LocationId)
+{
+	const FPraxisLocationHandle Location = LocationTable.FindOrAdd(LocationId);
+	if (Location.Index >= LocationCapacities.Num())
+	{
+		// Unregistered locations get default limits until RegisterLocation overrides them
+		FLocationCapacity& Capacity = LocationCapacities.AddDefaulted_GetRef();
+		Capacity.LocationId = LocationId;
+		MarkLocationDirty(Location);
+	}
+	return Location;
+}
+
+FMassEntityHandle UPraxisInventoryService::SpawnMaterialEntity(
+	FName SKU,
+	int32 Quantity,
+	FName LocationId,
+	FName SubLocationId,
+	float VolumePerUnit,
+	uint8 InitialState,
+	TConstArrayView<FGuid> ParentBatchIds,
+	FName BOMId)
+{
+	if (!MassSubsystem || !MassSubsystem->IsInitialized() || !bArchetypeInitialized)
+	{
+		UE_LOG(LogPraxisSim, Error, TEXT("Cannot spawn entity - subsystem or archetype not ready"));
+		return FMassEntityHandle();
+	}
+	
+	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	
+	const FMassEntityHandle Entity = AcquireMaterialEntity(SKU, BOMId);
+	if (!Entity.IsSet())
+	{
+		UE_LOG(LogPraxisSim, Error, TEXT("Failed to create Mass entity for %s"), *SKU.ToString());
+		return FMassEntityHandle();
+	}
+	
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+	
+	// Set State Fragment
+	if (FMaterialStateFragment* StateFrag = EntityManager.GetFragmentDataPtr<FMaterialStateFragment>(Entity))
+	{
+		StateFrag->State = static_cast<EMaterialState>(InitialState);
+		StateFrag->StateEnterTime = CurrentTime;
+	}
+	
+	// Set Quantity Fragment
+	if (FMaterialQuantityFragment* QtyFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(Entity))
+	{
+		QtyFrag->Quantity = Quantity;
+		QtyFrag->VolumePerUnit = VolumePerUnit;
+	}
+	
+	// Set Location Fragment
+	if (FMaterialLocationFragment* LocFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(Entity))
+	{
+		LocFrag->LocationId = LocationId;
+		LocFrag->SubLocationId = SubLocationId;
+		LocFrag->LocationEnterTime = CurrentTime;
+	}
+	
+	// Set Genealogy Fragment
+	if (FMaterialGenealogyFragment* GenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(Entity))
+	{
+		GenFrag->BatchId = FGuid::NewGuid();
+		GenFrag->ParentBatchIds.Empty();
+		GenFrag->SourceMachineId = NAME_None;
+		GenFrag->SourceWorkOrderId = 0;
+		GenFrag->CreationTime = CurrentTime;
+		GenFrag->bPassedQuality = true;
+		
+		// Expiry: own shelf life, capped by the earliest-expiring parent
+		double ExpiryTime = FPraxisGenealogyGraph::NeverExpires;
+		if (const double* ShelfLife = ShelfLives.Find(SKU))
+		{
+			ExpiryTime = CurrentTime + *ShelfLife;
+		}
+		
+		// Parents live in the graph only, so the fragment stays allocation-free
+		TArray<uint32, TInlineAllocator<8>> ParentIds;
+		for (const FGuid& ParentBatchId : ParentBatchIds)
+		{
+			const uint32 ParentId = Genealogy.FindBatch(ParentBatchId);
+			if (Genealogy.IsValidId(ParentId))
+			{
+				ParentIds.Add(ParentId);
+				ExpiryTime = FMath::Min(ExpiryTime, Genealogy.GetExpiryTime(ParentId));
+			}
+		}
+		Genealogy.AddBatch(GenFrag->BatchId, SKU, InitialState, CurrentTime, ParentIds, ExpiryTime);
+	}
+	
+	// Set Reservation Fragment (unreserved by default)
+	if (FMaterialReservationFragment* ResFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(Entity))
+	{
+		ResFrag->bReserved = false;
+		ResFrag->ReservedForWorkOrder = 0;
+		ResFrag->ReservedForMachine = NAME_None;
+		ResFrag->ReservationTime = 0.0;
+	}
+	
+	return Entity;
+}
+
+FMassEntityHandle UPraxisInventoryService::AcquireMaterialEntity(FName SKU, FName BOMId)
+{
+	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	
+	// Reuse a parked entity of this SKU when available; pools are refilled in batches at tick end
+	FPraxisMaterialEntityPool& Pool = EntityPools.FindOrAdd(TPair<FName, FName>(SKU, BOMId));
+	++Pool.DemandThisTick;
+	FMassEntityHandle Pooled;
+	while (Pool.Pop(Pooled))
+	{
+		--PooledEntityCount;
+		if (EntityManager.IsEntityValid(Pooled))
+		{
+			// Already in the SKU's chunks: only the pooled tag changes
+			EntityManager.RemoveTagFromEntity(Pooled, FMaterialPooledTag::StaticStruct());
+			return Pooled;
+		}
+	}
+	
+	// Fresh entities go straight into the SKU's chunks; the caller indexes them once filled in
+	FMassArchetypeSharedFragmentValues SharedValues;
+	SharedValues.Add(GetSKUSharedFragment(SKU, BOMId));
+	SharedValues.Sort();
+	TGuardValue<bool> ObserverGuard(bIgnoreMaterialObservers, true);
+	return EntityManager.CreateEntity(MaterialArchetype, SharedValues);
+}
+
+FConstSharedStruct UPraxisInventoryService::GetSKUSharedFragment(FName SKU, FName BOMId)
+{
+	const TPair<FName, FName> Key(SKU, BOMId);
+	if (const FConstSharedStruct* Cached = SKUSharedFragments.Find(Key))
+	{
+		return *Cached;
+	}
+	
+	FMaterialSKUFragment Fragment;
+	Fragment.SKU = SKU;
+	Fragment.BOMId = BOMId;
+	if (const EPraxisUnitOfMeasure* UnitOfMeasure = SKUUnitsOfMeasure.Find(SKU))
+	{
+		Fragment.UnitOfMeasure = *UnitOfMeasure;
+	}
+	
+	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	return SKUSharedFragments.Add(Key, EntityManager.GetOrCreateConstSharedFragment(Fragment));
+}
+
+FPraxisMaterialEntityPool* UPraxisInventoryService::FindEntityPool(const FMassEntityHandle& Entity)
+{
+	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	const FMaterialSKUFragment* SKUFrag = EntityManager.GetConstSharedFragmentDataPtr<FMaterialSKUFragment>(Entity);
+	return SKUFrag ? &EntityPools.FindOrAdd(TPair<FName, FName>(SKUFrag->SKU, SKUFrag->BOMId)) : nullptr;
+}
+
+void UPraxisInventoryService::DespawnMaterialEntities(const TArray<FMassEntityHandle>& Entities)
+{
+	if (!MassSubsystem || !MassSubsystem->IsInitialized())
+	{
+		return;
+	}
+	
+	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	
+	for (const FMassEntityHandle& Entity : Entities)
+	{
+		if (EntityManager.IsEntityValid(Entity))
+		{
+			DestroyMaterialEntity(Entity);
+		}
+	}
+}
+
+void UPraxisInventoryService::DestroyMaterialEntity(const FMassEntityHandle& Entity)
+{
+	// Copy first: callers often pass a reference into a container this mutates
+	const FMassEntityHandle EntityToDestroy = Entity;
+	
+	UntrackMaterialEntity(EntityToDestroy);
+	
+	if (!MassSubsystem || !MassSubsystem->IsInitialized())
+	{
+		return;
+	}
+	
+	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	if (!EntityManager.IsEntityValid(EntityToDestroy))
+	{
+		return;
+	}
+	
+	// Park the entity: empty, nowhere, and tagged so chunk reads skip it
+	if (FMaterialQuantityFragment* QtyFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(EntityToDestroy))
+	{
+		QtyFrag->Quantity = 0;
+	}
+	if (FMaterialLocationFragment* LocFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(EntityToDestroy))
+	{
+		LocFrag->LocationId = NAME_None;
+		LocFrag->SubLocationId = NAME_None;
+	}
+	
+	FPraxisMaterialEntityPool* Pool = PooledEntityCount < EntityPoolMaxSize ? FindEntityPool(EntityToDestroy) : nullptr;
+	if (Pool)
+	{
+		EntityManager.AddTagToEntity(EntityToDestroy, FMaterialPooledTag::StaticStruct());
+		Pool->Add(EntityToDestroy);
+		++PooledEntityCount;
+	}
+	else
+	{
+		// Pools are full - destroy in one batch at tick end
+		PendingEntityDestroys.Add(EntityToDestroy);
+	}
+}
+
+void UPraxisInventoryService::UntrackMaterialEntity(FMassEntityHandle Entity)
+{
+	// Claims normally drain before their batch empties; drop any left over
+	TArray<FPraxisReservationLedger::FClaim> OrphanedClaims;
+	ReservationLedger.ReleaseBatch(Entity, OrphanedClaims);
+	for (const FPraxisReservationLedger::FClaim& Claim : OrphanedClaims)
+	{
+		ApplyReservedDelta(Claim.StockKey.SKU, Claim.StockKey.LocationId, -Claim.Quantity);
+	}
+	
+	if (const FPraxisMaterialIndex::FEntry* Entry = MaterialIndex.FindEntry(Entity))
+	{
+		ApplyAggregateDelta(Entry->StockKey, -Entry->Quantity, -Entry->Volume);
+		BookLocationCapacity(Entry, nullptr);
+	}
+	
+	MaterialIndex.Remove(Entity);
+	MaterialEntities.Remove(Entity);
+	CompactionCandidates.Remove(Entity);
+}
+
+void UPraxisInventoryService::HandleMaterialEntitiesAdded(TConstArrayView<FMassEntityHandle> Entities)
+{
+	for (const FMassEntityHandle& Entity : Entities)
+	{
+		MaterialEntities.Add(Entity);
+		IndexMaterialEntity(Entity);
+	}
+}
+
+void UPraxisInventoryService::HandleMaterialEntitiesRemoved(TConstArrayView<FMassEntityHandle> Entities)
+{
+	// Pooled and pending entities were untracked when the service retired them
+	for (const FMassEntityHandle& Entity : Entities)
+	{
+		if (MaterialEntities.Contains(Entity))
+		{
+			UntrackMaterialEntity(Entity);
+		}
+	}
+}
+
+void UPraxisInventoryService::HandleMaterialEntitiesChanged(TConstArrayView<FMassEntityHandle> Entities)
+{
+	for (const FMassEntityHandle& Entity : Entities)
+	{
+		// A parked entity filled in by another system becomes stock like any other
+		if (!MaterialEntities.Contains(Entity))
+		{
+			FPraxisMaterialEntityPool* Pool = FindEntityPool(Entity);
+			if (Pool && Pool->Remove(Entity))
+			{
+				--PooledEntityCount;
+			}
+			MaterialEntities.Add(Entity);
+		}
+		
+		IndexMaterialEntity(Entity);
+		SyncGenealogyNode(Entity);
+	}
+}
+
+FMassEntityHandle UPraxisInventoryService::TransitionWIPEntity(
+	const FMassEntityHandle& Entity,
+	FName OutputSKU,
+	FName OutputLocationId,
+	uint8 NewState,
+	bool bPassedQuality,
+	FName MachineId,
+	int64 WorkOrderId)
+{
+	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+	
+	// Swapping an entity's shared SKU value moves it between archetypes; the batch moves onto
+	// an entity already in the output SKU's chunks instead
+	const FMassEntityHandle Output = AcquireMaterialEntity(OutputSKU, NAME_None);
+	if (!Output.IsSet())
+	{
+		UE_LOG(LogPraxisSim, Error, TEXT("Failed to create Mass entity for %s"), *OutputSKU.ToString());
+		return FMassEntityHandle();
+	}
+	
+	EntityManager.GetFragmentDataChecked<FMaterialQuantityFragment>(Output) = EntityManager.GetFragmentDataChecked<FMaterialQuantityFragment>(Entity);
+	
+	FMaterialStateFragment& StateFrag = EntityManager.GetFragmentDataChecked<FMaterialStateFragment>(Output);
+	StateFrag.State = static_cast<EMaterialState>(NewState);
+	StateFrag.StateEnterTime = CurrentTime;
+	
+	FMaterialLocationFragment& LocFrag = EntityManager.GetFragmentDataChecked<FMaterialLocationFragment>(Output);
+	LocFrag.LocationId = OutputLocationId;
+	LocFrag.SubLocationId = NAME_None;
+	LocFrag.LocationEnterTime = CurrentTime;
+	
+	// Batch identity and parents carry over from WIP
+	FMaterialGenealogyFragment& GenFrag = EntityManager.GetFragmentDataChecked<FMaterialGenealogyFragment>(Output);
+	GenFrag = EntityManager.GetFragmentDataChecked<FMaterialGenealogyFragment>(Entity);
+	GenFrag.SourceMachineId = MachineId;
+	GenFrag.SourceWorkOrderId = WorkOrderId;
+	GenFrag.bPassedQuality = bPassedQuality;
+	
+	// Output is free stock
+	FMaterialReservationFragment& ResFrag = EntityManager.GetFragmentDataChecked<FMaterialReservationFragment>(Output);
+	ResFrag.bReserved = false;
+	ResFrag.ReservedForWorkOrder = 0;
+	ResFrag.ReservedForMachine = NAME_None;
+	ResFrag.ReservationTime = 0.0;
+	
+	DestroyMaterialEntity(Entity);
+	MaterialEntities.Add(Output);
+	SyncGenealogyNode(Output);
+	IndexMaterialEntity(Output);
+	return Output;
+}
+
+void UPraxisInventoryService::EndTick(int32 TickCount, double SimDeltaSeconds)
+{
+	if (!MassSubsystem || !MassSubsystem->IsInitialized() || !bArchetypeInitialized)
+	{
+		return;
+	}
+	
+	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	
+	if (SimDeltaSeconds > 0.0)
+	{
+		SimTickSeconds = SimDeltaSeconds;
+	}
+	AdvanceFluids(TickCount, SimTickSeconds);
+	ExpireReservations(TickCount);
+	CompactLots(TickCount);
+	CompactGenealogy(TickCount);
+	TickInventoryAudit(TickCount);
+	
+	// Batched destroys of entities the pool had no room for
+	if (PendingEntityDestroys.Num() > 0)
+	{
+		EntityManager.BatchDestroyEntities(PendingEntityDestroys);
+		PendingEntityDestroys.Reset();
+	}
+	
+	// Batched refill so next tick's spawns don't hit CreateEntity one by one; only what this
+	// tick used, so an idle inventory doesn't carry full pools it never draws on
+	int32 Refilled = 0;
+	for (TPair<TPair<FName, FName>, FPraxisMaterialEntityPool>& Pair : EntityPools)
+	{
+		FPraxisMaterialEntityPool& Pool = Pair.Value;
+		const int32 Refill = FMath::Min3(Pool.DemandThisTick, EntityPoolTargetSize - Pool.Num(), EntityPoolMaxSize - PooledEntityCount);
+		Pool.DemandThisTick = 0;
+		if (Refill <= 0)
+		{
+			continue;
+		}
+		
+		// Created parked and with the SKU's shared value, so reuse is only a tag change
+		FMassArchetypeSharedFragmentValues SharedValues;
+		SharedValues.Add(GetSKUSharedFragment(Pair.Key.Key, Pair.Key.Value));
+		SharedValues.Sort();
+		
+		TArray<FMassEntityHandle> NewEntities;
+		EntityManager.BatchCreateEntities(PooledMaterialArchetype, SharedValues, Refill, NewEntities);
+		
+		for (const FMassEntityHandle& Entity : NewEntities)
+		{
+			if (FMaterialQuantityFragment* QtyFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(Entity))
+			{
+				QtyFrag->Quantity = 0;
+			}
+			Pool.Add(Entity);
+		}
+		PooledEntityCount += NewEntities.Num();
+		Refilled += NewEntities.Num();
+	}
+	
+	if (Refilled > 0)
+	{
+		UE_LOG(LogPraxisSim, VeryVerbose, TEXT("Tick %d: refilled material entity pools with %d entities"), TickCount, Refilled);
+	}
+	
+	PublishSnapshot(TickCount);
+}
+
+void UPraxisInventoryService::AdvanceFluids(int32 TickCount, double Seconds)
+{
+	if (FluidStore.NumActive() == 0)
+	{
+		return;
+	}
+	
+	TArray<FPraxisFluidStore::FLevelChange> Changes;
+	TArray<FPraxisFluidStore::FLimitEvent> Limits;
+	FluidStore.Advance(Seconds, Changes, Limits);
+	
+	TSet<FName, DefaultKeyFuncs<FName>, TInlineSetAllocator<8>> ChangedSKUs;
+	for (const FPraxisFluidStore::FLevelChange& Change : Changes)
+	{
+		ChangedSKUs.Add(FluidStore.Get(Change.Container).SKU);
+	}
+	for (const FName& SKU : ChangedSKUs)
+	{
+		SyncFluidAggregate(SKU);
+	}
+	
+	for (const FPraxisFluidStore::FLimitEvent& Limit : Limits)
+	{
+		const FPraxisFluidStore::FContainer& Container = FluidStore.Get(Limit.Container);
+		
+		FPraxisFluidLimitEvent Event;
+		Event.ContainerId = Container.ContainerId;
+		Event.SKU = Container.SKU;
+		Event.LocationId = Container.LocationId;
+		Event.bFull = Limit.bFull;
+		Event.TickCount = TickCount;
+		Event.TimeIntoTick = Limit.TimeIntoStep;
+		
+		UE_LOG(LogPraxisSim, Log, TEXT("Tick %d: fluid container %s ran %s %.2fs into the tick"),
+			TickCount, *Container.ContainerId.ToString(), Limit.bFull ? TEXT("full") : TEXT("empty"), Limit.TimeIntoStep);
+		OnFluidContainerLimit.Broadcast(Event);
+	}
+}
+
+void UPraxisInventoryService::SyncFluidAggregate(FName SKU)
+{
+	DirtySnapshotSKUs.Add(SKU);
+	
+	FInventorySummary& Summary = InventoryCache.FindOrAdd(SKU);
+	Summary.SKU = SKU;
+	Summary.FluidQuantity = 0.0;
+	Summary.FluidByLocation.Reset();
+	AddFluidAggregate(SKU, Summary);
+}
+
+void UPraxisInventoryService::AddFluidAggregate(FName SKU, FInventorySummary& Summary) const
+{
+	for (const int32 Id : FluidStore.GetContainersForSKU(SKU))
+	{
+		const FPraxisFluidStore::FContainer& Container = FluidStore.Get(Id);
+		Summary.UnitOfMeasure = Container.UnitOfMeasure;
+		Summary.FluidQuantity += Container.Level;
+		Summary.FluidByLocation.FindOrAdd(Container.LocationId) += Container.Level;
+	}
+}
+
+void UPraxisInventoryService::TickInventoryAudit(int32 TickCount)
+{
+	// Collect the previous pass; skip this tick if it is still running
+	if (AuditTask.IsValid())
+	{
+		if (!AuditTask.IsCompleted())
+		{
+			return;
+		}
+		
+		ReportAuditFindings(*AuditInFlight, AuditTask.GetResult(), AuditInFlightSince);
+		AuditTask = UE::Tasks::TTask<TArray<FPraxisAuditFinding>>();
+		AuditInFlight.Reset();
+	}
+	
+	if (!bBackgroundAudit || MaterialEntities.Num() == 0)
+	{
+		return;
+	}
+	
+	TSharedRef<FPraxisAuditSlice, ESPMode::ThreadSafe> Slice = MakeShared<FPraxisAuditSlice, ESPMode::ThreadSafe>();
+	Slice->TickCount = TickCount;
+	BuildAuditSlice(*Slice);
+	
+	AuditInFlight = Slice;
+	AuditInFlightSince = AuditPreviousRoundSequence;
+	AuditTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Slice]()
+	{
+		TArray<FPraxisAuditFinding> Findings;
+		Slice->Run(Findings);
+		return Findings;
+	});
+}
+
+void UPraxisInventoryService::BuildAuditSlice(FPraxisAuditSlice& OutSlice)
+{
+	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	
+	// Round-robin over the tracked entities. Removals swap handles around, so an entity
+	// can be skipped or seen twice in a round; the next round covers it.
+	if (AuditCursor >= MaterialEntities.Num())
+	{
+		AuditCursor = 0;
+	}
+	
+	// Each round starts with the aggregate checks (one chunk pass over the stock)
+	if (AuditCursor == 0)
+	{
+		AuditPreviousRoundSequence = AuditRoundStartSequence;
+		AuditRoundStartSequence = TransactionJournal.GetTotalAppended();
+		
+		OutSlice.bAuditAggregates = true;
+		
+		// Recount from the fragments: the index totals move in step with the cache, so
+		// comparing against them would only catch the two disagreeing with each other
+		TMap<FPraxisMaterialStockKey, FPraxisMaterialIndex::FStockTotals> Recount;
+		FCriticalSection MergeLock;
+		ForEachMaterialChunk([&Recount, &MergeLock](FMassExecutionContext& Context)
+		{
+			const FName SKU = Context.GetConstSharedFragment<FMaterialSKUFragment>().SKU;
+			const TConstArrayView<FMaterialStateFragment> States = Context.GetFragmentView<FMaterialStateFragment>();
+			const TConstArrayView<FMaterialQuantityFragment> Quantities = Context.GetFragmentView<FMaterialQuantityFragment>();
+			const TConstArrayView<FMaterialLocationFragment> Locations = Context.GetFragmentView<FMaterialLocationFragment>();
+			const TConstArrayView<FMaterialReservationFragment> Reservations = Context.GetFragmentView<FMaterialReservationFragment>();
+			
+			TMap<FPraxisMaterialStockKey, FPraxisMaterialIndex::FStockTotals> ChunkTotals;
+			for (int32 i = 0; i < Context.GetNumEntities(); ++i)
+			{
+				// Empty batches hold no stock
+				if (Quantities[i].Quantity <= 0)
+				{
+					continue;
+				}
+				
+				FPraxisMaterialIndex::FStockTotals& Totals = ChunkTotals.FindOrAdd(FPraxisMaterialStockKey(
+					SKU, Locations[i].LocationId, static_cast<uint8>(States[i].State), Reservations[i].bReserved));
+				++Totals.Entities;
+				Totals.Quantity += Quantities[i].Quantity;
+				Totals.Volume += Quantities[i].GetTotalVolume();
+			}
+			
+			FScopeLock Lock(&MergeLock);
+			for (const TPair<FPraxisMaterialStockKey, FPraxisMaterialIndex::FStockTotals>& Pair : ChunkTotals)
+			{
+				FPraxisMaterialIndex::FStockTotals& Totals = Recount.FindOrAdd(Pair.Key);
+				Totals.Entities += Pair.Value.Entities;
+				Totals.Quantity += Pair.Value.Quantity;
+				Totals.Volume += Pair.Value.Volume;
+			}
+		}, bParallelInventoryReads);
+		OutSlice.StockTotals = Recount.Array();
+		OutSlice.ClaimedTotals = ReservationLedger.GetStockTotals().Array();
+		
+		OutSlice.SKUs.Reserve(InventoryCache.Num());
+		for (const TPair<FName, FInventorySummary>& Pair : InventoryCache)
+		{
+			FPraxisAuditSKURecord& Record = OutSlice.SKUs.AddDefaulted_GetRef();
+			Record.SKU = Pair.Key;
+			Record.TotalQuantity = Pair.Value.TotalQuantity;
+			Record.ReservedQuantity = Pair.Value.ReservedQuantity;
+			Record.TotalVolume = Pair.Value.TotalVolume;
+			Record.QuantityByLocation = Pair.Value.QuantityByLocation.Array();
+		}
+		
+		OutSlice.Locations.Reserve(LocationCapacities.Num());
+		for (const FLocationCapacity& Capacity : LocationCapacities)
+		{
+			FPraxisAuditLocationRecord& Record = OutSlice.Locations.AddDefaulted_GetRef();
+			Record.LocationId = Capacity.LocationId;
+			Record.CurrentVolume = Capacity.CurrentVolume;
+			Record.CurrentItems = Capacity.CurrentItems;
+		}
+	}
+	
+	const int32 End = FMath::Min(AuditCursor + AuditEntitiesPerTick, MaterialEntities.Num());
+	OutSlice.Entities.Reserve(End - AuditCursor);
+	
+	for (; AuditCursor < End; ++AuditCursor)
+	{
+		const FMassEntityHandle Entity = MaterialEntities[AuditCursor];
+		FPraxisAuditEntityRecord& Record = OutSlice.Entities.AddDefaulted_GetRef();
+		Record.Entity = Entity;
+		
+		if (const FPraxisMaterialIndex::FEntry* Entry = MaterialIndex.FindEntry(Entity))
+		{
+			Record.bIndexed = true;
+			Record.bInLotIndex = Entry->LotSlot != INDEX_NONE;
+			Record.IndexKey = Entry->StockKey;
+			Record.IndexQuantity = Entry->Quantity;
+			Record.IndexVolume = Entry->Volume;
+		}
+		Record.ClaimedQuantity = ReservationLedger.GetClaimedFromBatch(Entity);
+		
+		if (!EntityManager.IsEntityValid(Entity))
+		{
+			continue;
+		}
+		
+		const FMaterialSKUFragment* SKUFrag = EntityManager.GetConstSharedFragmentDataPtr<FMaterialSKUFragment>(Entity);
+		const FMaterialStateFragment* StateFrag = EntityManager.GetFragmentDataPtr<FMaterialStateFragment>(Entity);
+		const FMaterialQuantityFragment* QtyFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(Entity);
+		const FMaterialLocationFragment* LocFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(Entity);
+		const FMaterialReservationFragment* ResFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(Entity);
+		
+		// Same derivation as IndexMaterialEntity, from the fragments alone
+		Record.bExists = true;
+		Record.FragmentKey = FPraxisMaterialStockKey(
+			SKUFrag ? SKUFrag->SKU : NAME_None,
+			LocFrag ? LocFrag->LocationId : NAME_None,
+			StateFrag ? static_cast<uint8>(StateFrag->State) : 0,
+			ResFrag && ResFrag->bReserved);
+		if (SKUFrag && QtyFrag)
+		{
+			Record.FragmentQuantity = QtyFrag->Quantity;
+			Record.FragmentVolume = QtyFrag->GetTotalVolume();
+		}
+	}
+}
+
+void UPraxisInventoryService::ReportAuditFindings(const FPraxisAuditSlice& Slice, const TArray<FPraxisAuditFinding>& Findings, int64 SinceSequence)
+{
+	if (Findings.Num() == 0)
+	{
+		return;
+	}
+	
+	const int32 ReportCount = FMath::Min(Findings.Num(), AuditMaxReportsPerPass);
+	for (int32 i = 0; i < ReportCount; ++i)
+	{
+		const FPraxisAuditFinding& Finding = Findings[i];
+		
+		FPraxisInventoryDiscrepancy Discrepancy;
+		Discrepancy.Check = LexToString(Finding.Check);
+		Discrepancy.SKU = Finding.SKU;
+		Discrepancy.LocationId = Finding.LocationId;
+		Discrepancy.Expected = static_cast<float>(Finding.Expected);
+		Discrepancy.Actual = static_cast<float>(Finding.Actual);
+		Discrepancy.TickCount = Slice.TickCount;
+		
+		FString SuspectText = TEXT("no transaction since last audit");
+		const int32 SuspectIndex = FindFirstTransactionSince(SinceSequence, Finding.SKU, Finding.LocationId);
+		if (SuspectIndex != INDEX_NONE)
+		{
+			const FInventoryTransaction& Suspect = Discrepancy.SuspectTransaction = FormatTransaction(TransactionJournal[SuspectIndex]);
+			Discrepancy.bHasSuspectTransaction = true;
+			SuspectText = FString::Printf(TEXT("first suspect transaction: %s %s %+d @ %s (%s)"),
+				*Suspect.TransactionType, *Suspect.SKU.ToString(), Suspect.QuantityDelta,
+				*Suspect.LocationId.ToString(), *Suspect.Reference);
+		}
+		
+		UE_LOG(LogPraxisSim, Error, TEXT("Inventory audit (tick %d): %s for %s @ %s - cached %.3f, actual %.3f; %s"),
+			Slice.TickCount, *Discrepancy.Check, *Finding.SKU.ToString(), *Finding.LocationId.ToString(),
+			Finding.Expected, Finding.Actual, *SuspectText);
+		
+		OnInventoryDiscrepancy.Broadcast(Discrepancy);
+	}
+	
+	if (Findings.Num() > ReportCount)
+	{
+		UE_LOG(LogPraxisSim, Error, TEXT("Inventory audit (tick %d): %d more discrepancies not reported"),
+			Slice.TickCount, Findings.Num() - ReportCount);
+	}
+}
+
+int32 UPraxisInventoryService::FindFirstTransactionSince(int64 Sequence, FName SKU, FName LocationId) const
+{
+	// Logical index 0 holds sequence TotalAppended - Num (older records were overwritten)
+	const int64 OldestSequence = TransactionJournal.GetTotalAppended() - TransactionJournal.Num();
+	for (int32 Index = static_cast<int32>(FMath::Max<int64>(Sequence - OldestSequence, 0)); Index < TransactionJournal.Num(); ++Index)
+	{
+		const FPraxisTransactionRecord& Record = TransactionJournal[Index];
+		const bool bSKUMatches = SKU.IsNone() || Record.SKU == SKU;
+		const bool bLocationMatches = LocationId.IsNone() || Record.LocationId == LocationId || Record.RefName == LocationId;
+		if (bSKUMatches && bLocationMatches)
+		{
+			return Index;
+		}
+	}
+	return INDEX_NONE;
+}
+
+FPraxisInventorySnapshotPtr UPraxisInventoryService::GetInventorySnapshot() const
+{
+	// Pin the published slot, then check it is still the published one. Once it is, the
+	// publisher can't overwrite it until it is unpinned; if it flipped meanwhile, try again.
+	for (;;)
+	{
+		const int32 Slot = PublishedSlot.load();
+		SnapshotReaders[Slot].fetch_add(1);
+		if (PublishedSlot.load() == Slot)
+		{
+			FPraxisInventorySnapshotPtr Snapshot = SnapshotSlots[Slot];
+			SnapshotReaders[Slot].fetch_sub(1);
+			return Snapshot;
+		}
+		SnapshotReaders[Slot].fetch_sub(1);
+	}
+}
+
+void UPraxisInventoryService::PublishSnapshot(int32 TickCount)
+{
+	// Only this thread publishes, so the published slot can't change under us
+	const int32 PreviousSlot = PublishedSlot.load(std::memory_order_relaxed);
+	const FPraxisInventorySnapshot* Previous = SnapshotSlots[PreviousSlot].Get();
+	
+	const bool bLocationsAdded = !Previous || Previous->Locations.Num() != LocationCapacities.Num();
+	if (Previous && !bSnapshotAllSKUsDirty && !bLocationsAdded
+		&& DirtySnapshotSKUs.Num() == 0 && !DirtySnapshotLocations.Contains(true))
+	{
+		return;  // Nothing changed - readers keep the current snapshot
+	}
+	
+	TSharedRef<FPraxisInventorySnapshot, ESPMode::ThreadSafe> Next = MakeShared<FPraxisInventorySnapshot, ESPMode::ThreadSafe>();
+	Next->TickCount = TickCount;
+	
+	// SKUs: share unchanged summaries, copy the dirty ones
+	if (!Previous || bSnapshotAllSKUsDirty)
+	{
+		Next->Summaries.Reserve(InventoryCache.Num());
+		for (const TPair<FName, FInventorySummary>& Pair : InventoryCache)
+		{
+			Next->Summaries.Add(Pair.Key, MakeShared<const FInventorySummary, ESPMode::ThreadSafe>(Pair.Value));
+		}
+	}
+	else
+	{
+		Next->Summaries = Previous->Summaries;
+		for (const FName& SKU : DirtySnapshotSKUs)
+		{
+			if (const FInventorySummary* Summary = InventoryCache.Find(SKU))
+			{
+				Next->Summaries.Add(SKU, MakeShared<const FInventorySummary, ESPMode::ThreadSafe>(*Summary));
+			}
+			else
+			{
+				Next->Summaries.Remove(SKU);
+			}
+		}
+	}
+	
+	// Locations: share unchanged capacities, copy dirty and new ones
+	const int32 PreviousLocationCount = Previous ? Previous->Locations.Num() : 0;
+	Next->Locations.Reserve(LocationCapacities.Num());
+	for (int32 Index = 0; Index < LocationCapacities.Num(); ++Index)
+	{
+		const bool bDirty = Index >= PreviousLocationCount
+			|| (DirtySnapshotLocations.IsValidIndex(Index) && DirtySnapshotLocations[Index]);
+		if (bDirty)
+		{
+			Next->Locations.Add(MakeShared<const FLocationCapacity, ESPMode::ThreadSafe>(LocationCapacities[Index]));
+		}
+		else
+		{
+			Next->Locations.Add(Previous->Locations[Index]);
+		}
+	}
+	
+	if (bLocationsAdded)
+	{
+		TMap<FName, int32> LocationIndex;
+		LocationIndex.Reserve(LocationCapacities.Num());
+		for (int32 Index = 0; Index < LocationCapacities.Num(); ++Index)
+		{
+			LocationIndex.Add(LocationTable.GetName(FPraxisLocationHandle(Index)), Index);
+		}
+		Next->LocationIndex = MakeShared<const TMap<FName, int32>, ESPMode::ThreadSafe>(MoveTemp(LocationIndex));
+	}
+	else
+	{
+		Next->LocationIndex = Previous->LocationIndex;
+	}
+	
+	// Write the spare slot, then publish it. Readers that pinned the spare before the last flip
+	// are only copying a pointer out, so the wait is a few instructions at most. The snapshot
+	// the slot held is released by its last holder.
+	const int32 SpareSlot = 1 - PreviousSlot;
+	while (SnapshotReaders[SpareSlot].load() != 0)
+	{
+		FPlatformProcess::Sleep(0.0f);
+	}
+	SnapshotSlots[SpareSlot] = Next;
+	PublishedSlot.store(SpareSlot);
+	
+	DirtySnapshotSKUs.Reset();
+	DirtySnapshotLocations.Init(false, LocationCapacities.Num());
+	bSnapshotAllSKUsDirty = false;
+}
+
+void UPraxisInventoryService::SyncGenealogyNode(const FMassEntityHandle& Entity)
+{
+	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	
+	const FMaterialGenealogyFragment* GenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(Entity);
+	if (!GenFrag)
+	{
+		return;
+	}
+	
+	const uint32 Id = Genealogy.FindBatch(GenFrag->BatchId);
+	if (!Genealogy.IsValidId(Id))
+	{
+		return;
+	}
+	
+	if (const FMaterialSKUFragment* SKUFrag = EntityManager.GetConstSharedFragmentDataPtr<FMaterialSKUFragment>(Entity))
+	{
+		Genealogy.SetSKU(Id, SKUFrag->SKU);
+	}
+	if (const FMaterialStateFragment* StateFrag = EntityManager.GetFragmentDataPtr<FMaterialStateFragment>(Entity))
+	{
+		Genealogy.SetMaterialState(Id, static_cast<uint8>(StateFrag->State), GenFrag->bPassedQuality);
+	}
+	Genealogy.SetSource(Id, GenFrag->SourceMachineId, GenFrag->SourceWorkOrderId);
+}
+
+void UPraxisInventoryService::BuildTraceEntries(TConstArrayView<uint32> BatchIds, bool bFinishedGoodsOnly, TArray<FPraxisBatchTraceEntry>& OutEntries) const
+{
+	OutEntries.Reserve(OutEntries.Num() + BatchIds.Num());
+	
+	for (const uint32 Id : BatchIds)
+	{
+		const uint8 State = Genealogy.GetMaterialState(Id);
+		if (bFinishedGoodsOnly && State != static_cast<uint8>(EMaterialState::FinishedGoods))
+		{
+			continue;
+		}
+		
+		FPraxisBatchTraceEntry& Entry = OutEntries.AddDefaulted_GetRef();
+		Entry.BatchId = Genealogy.GetGuid(Id);
+		Entry.SKU = Genealogy.GetSKU(Id);
+		Entry.MaterialState = State;
+		Entry.SourceMachineId = Genealogy.GetSourceMachine(Id);
+		Entry.SourceWorkOrderId = Genealogy.GetSourceWorkOrder(Id);
+		Entry.CreationTime = Genealogy.GetCreationTime(Id);
+		Entry.bPassedQuality = Genealogy.HasPassedQuality(Id);
+		Entry.bShipped = Genealogy.IsShipped(Id);
+	}
+}
+
+void UPraxisInventoryService::IndexMaterialEntity(const FMassEntityHandle& Entity)
+{
+	if (!MassSubsystem || !MassSubsystem->IsInitialized())
+	{
+		return;
+	}
+	
+	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	
+	// Take back whatever this entity was last counted as (copied: the update below moves entries)
+	TOptional<FPraxisMaterialIndex::FEntry> OldEntry;
+	if (const FPraxisMaterialIndex::FEntry* Found = MaterialIndex.FindEntry(Entity))
+	{
+		OldEntry = *Found;
+		ApplyAggregateDelta(Found->StockKey, -Found->Quantity, -Found->Volume);
+	}
+	
+	if (!EntityManager.IsEntityValid(Entity))
+	{
+		BookLocationCapacity(OldEntry.GetPtrOrNull(), nullptr);
+		MaterialIndex.Remove(Entity);
+		return;
+	}
+	
+	const FMaterialSKUFragment* SKUFrag = EntityManager.GetConstSharedFragmentDataPtr<FMaterialSKUFragment>(Entity);
+	const FMaterialStateFragment* StateFrag = EntityManager.GetFragmentDataPtr<FMaterialStateFragment>(Entity);
+	const FMaterialQuantityFragment* QtyFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(Entity);
+	const FMaterialLocationFragment* LocFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(Entity);
+	const FMaterialReservationFragment* ResFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(Entity);
+	
+	const bool bReserved = ResFrag && ResFrag->bReserved;
+	const FPraxisMaterialStockKey StockKey(
+		SKUFrag ? SKUFrag->SKU : NAME_None,
+		LocFrag ? LocFrag->LocationId : NAME_None,
+		StateFrag ? static_cast<uint8>(StateFrag->State) : 0,
+		bReserved);
+	
+	// Entities without type/quantity data are indexed but never counted (matches RebuildAggregates)
+	const bool bCounted = SKUFrag && QtyFrag;
+	const int32 Quantity = bCounted ? QtyFrag->Quantity : 0;
+	const float Volume = bCounted ? QtyFrag->GetTotalVolume() : 0.0f;
+	const FName SubLocationId = LocFrag ? LocFrag->SubLocationId : NAME_None;
+	
+	if (bReserved)
+	{
+		const FPraxisMaterialReservationKey ReservationKey(ResFrag->ReservedForWorkOrder, ResFrag->ReservedForMachine);
+		MaterialIndex.Update(Entity, StockKey, &ReservationKey, Quantity, Volume, FPraxisLotSortKey(), SubLocationId);
+	}
+	else
+	{
+		const FMaterialGenealogyFragment* GenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(Entity);
+		const FPraxisLotSortKey LotKey = GenFrag
+			? MakeLotSortKey(StockKey.SKU, GenFrag->BatchId, GenFrag->CreationTime)
+			: FPraxisLotSortKey();
+		MaterialIndex.Update(Entity, StockKey, nullptr, Quantity, Volume, LotKey, SubLocationId);
+	}
+	
+	ApplyAggregateDelta(StockKey, Quantity, Volume);
+	BookLocationCapacity(OldEntry.GetPtrOrNull(), MaterialIndex.FindEntry(Entity));
+	
+	// Stored stock may now be mergeable; compaction decides at tick end
+	const bool bStoredState = StockKey.MaterialState != static_cast<uint8>(EMaterialState::WorkInProcess)
+		&& StockKey.MaterialState != static_cast<uint8>(EMaterialState::InTransit);
+	if (bCompactLots && bStoredState && Quantity > 0)
+	{
+		CompactionCandidates.Add(Entity);
+	}
+}
+
+void UPraxisInventoryService::ApplyAggregateDelta(const FPraxisMaterialStockKey& StockKey, int32 QuantityDelta, float VolumeDelta)
+{
+	if (QuantityDelta == 0 && VolumeDelta == 0.0f)
+	{
+		return;
+	}
+	
+	DirtySnapshotSKUs.Add(StockKey.SKU);
+	
+	FInventorySummary& Summary = InventoryCache.FindOrAdd(StockKey.SKU);
+	Summary.SKU = StockKey.SKU;
+	
+	Summary.TotalQuantity += QuantityDelta;
+	Summary.TotalVolume += VolumeDelta;
+	
+	// Drop empty buckets so the cache matches what a full rebuild would produce
+	int32& LocationQty = Summary.QuantityByLocation.FindOrAdd(StockKey.LocationId);
+	LocationQty += QuantityDelta;
+	if (LocationQty == 0)
+	{
+		Summary.QuantityByLocation.Remove(StockKey.LocationId);
+	}
+	
+	int32& StateQty = Summary.QuantityByState.FindOrAdd(StockKey.MaterialState);
+	StateQty += QuantityDelta;
+	if (StateQty == 0)
+	{
+		Summary.QuantityByState.Remove(StockKey.MaterialState);
+	}
+	
+	if (StockKey.bReserved)
+	{
+		Summary.ReservedQuantity += QuantityDelta;
+		
+		int32& ReservedQty = Summary.ReservedByLocation.FindOrAdd(StockKey.LocationId);
+		ReservedQty += QuantityDelta;
+		if (ReservedQty == 0)
+		{
+			Summary.ReservedByLocation.Remove(StockKey.LocationId);
+		}
+	}
+	
+	// SKUs with fluid containers always keep a summary (matches RebuildAggregates)
+	if (Summary.TotalQuantity == 0 && Summary.ReservedQuantity == 0 && Summary.FluidByLocation.Num() == 0
+		&& Summary.QuantityByLocation.Num() == 0 && Summary.QuantityByState.Num() == 0 && Summary.ReservedByLocation.Num() == 0)
+	{
+		InventoryCache.Remove(StockKey.SKU);
+	}
+}
+
+void UPraxisInventoryService::ApplyReservedDelta(FName SKU, FName LocationId, int32 QuantityDelta)
+{
+	if (QuantityDelta == 0)
+	{
+		return;
+	}
+	
+	DirtySnapshotSKUs.Add(SKU);
+	
+	FInventorySummary& Summary = InventoryCache.FindOrAdd(SKU);
+	Summary.SKU = SKU;
+	Summary.ReservedQuantity += QuantityDelta;
+	
+	int32& ReservedQty = Summary.ReservedByLocation.FindOrAdd(LocationId);
+	ReservedQty += QuantityDelta;
+	if (ReservedQty == 0)
+	{
+		Summary.ReservedByLocation.Remove(LocationId);
+	}
+	
+	// SKUs with fluid containers always keep a summary (matches RebuildAggregates)
+	if (Summary.TotalQuantity == 0 && Summary.ReservedQuantity == 0 && Summary.FluidByLocation.Num() == 0
+		&& Summary.QuantityByLocation.Num() == 0 && Summary.QuantityByState.Num() == 0 && Summary.ReservedByLocation.Num() == 0)
+	{
+		InventoryCache.Remove(SKU);
+	}
+}
+
+void UPraxisInventoryService::ReduceReservationClaim(int32 ClaimId, int32 Quantity)
+{
+	const FPraxisMaterialStockKey StockKey = ReservationLedger.GetClaim(ClaimId).StockKey;
+	const int32 Taken = ReservationLedger.ReduceClaim(ClaimId, Quantity);
+	ApplyReservedDelta(StockKey.SKU, StockKey.LocationId, -Taken);
+}
+
+TArray<FPraxisReservationLedger::FClaim> UPraxisInventoryService::ReleaseReservationClaims(const FPraxisMaterialReservationKey& Owner)
+{
+	TArray<FPraxisReservationLedger::FClaim> Released;
+	ReservationLedger.ReleaseOwner(Owner, Released);
+	for (const FPraxisReservationLedger::FClaim& Claim : Released)
+	{
+		ApplyReservedDelta(Claim.StockKey.SKU, Claim.StockKey.LocationId, -Claim.Quantity);
+	}
+	return Released;
+}
+
+void UPraxisInventoryService::ScheduleReservationExpiry(const FPraxisMaterialReservationKey& Owner, float TimeToLiveSeconds)
+{
+	const int64 TtlTicks = FMath::Max<int64>(1, FMath::CeilToInt64(TimeToLiveSeconds / SimTickSeconds));
+	const int64 Deadline = ReservationExpiryWheel.GetCurrentTick() + TtlTicks;
+	
+	if (const int32* ExistingTimer = ReservationExpiryTimers.Find(Owner))
+	{
+		if (ReservationExpiryWheel.GetDeadline(*ExistingTimer) >= Deadline)
+		{
+			return;  // Already expires later
+		}
+		ReservationExpiryWheel.Cancel(*ExistingTimer);
+		ReservationExpiryOwners.Remove(*ExistingTimer);
+	}
+	
+	const int32 Timer = ReservationExpiryWheel.Schedule(Deadline);
+	ReservationExpiryTimers.Add(Owner, Timer);
+	ReservationExpiryOwners.Add(Timer, Owner);
+}
+
+void UPraxisInventoryService::ExpireReservations(int32 TickCount)
+{
+	TArray<int32> ExpiredTimers;
+	ReservationExpiryWheel.Advance(TickCount, ExpiredTimers);
+	if (ExpiredTimers.Num() == 0)
+	{
+		return;
+	}
+	
+	TArray<FPraxisReservationExpiredEvent> Events;
+	for (const int32 Timer : ExpiredTimers)
+	{
+		FPraxisMaterialReservationKey Owner;
+		if (!ReservationExpiryOwners.RemoveAndCopyValue(Timer, Owner))
+		{
+			continue;
+		}
+		ReservationExpiryTimers.Remove(Owner);
+		
+		// One event per (SKU, location) the work order had units claimed at
+		const int32 FirstEvent = Events.Num();
+		for (const FPraxisReservationLedger::FClaim& Claim : ReleaseReservationClaims(Owner))
+		{
+			FPraxisReservationExpiredEvent* Event = nullptr;
+			for (int32 i = FirstEvent; i < Events.Num() && !Event; ++i)
+			{
+				if (Events[i].SKU == Claim.StockKey.SKU && Events[i].LocationId == Claim.StockKey.LocationId)
+				{
+					Event = &Events[i];
+				}
+			}
+			if (!Event)
+			{
+				Event = &Events.AddDefaulted_GetRef();
+				Event->WorkOrderId = Owner.WorkOrderId;
+				Event->MachineId = Owner.MachineId;
+				Event->SKU = Claim.StockKey.SKU;
+				Event->LocationId = Claim.StockKey.LocationId;
+				Event->TickCount = TickCount;
+			}
+			Event->Quantity += Claim.Quantity;
+		}
+	}
+	
+	if (Events.Num() == 0)
+	{
+		return;  // Everything had already been consumed
+	}
+	
+	OnTransactionCommitted();
+	
+	for (const FPraxisReservationExpiredEvent& Event : Events)
+	{
+		UE_LOG(LogPraxisSim, Log, TEXT("Reservation expired: %d units of %s at %s for WO:%lld (Machine: %s)"),
+			Event.Quantity, *Event.SKU.ToString(), *Event.LocationId.ToString(), Event.WorkOrderId, *Event.MachineId.ToString());
+		OnReservationExpired.Broadcast(Event);
+	}
+}
+
+void UPraxisInventoryService::CompactLots(int32 TickCount)
 {
-	if (!MassSubsystem || !MassSubsystem->IsInitialized() || !bArchetypeInitialized)
+	if (!bCompactLots || CompactionCandidates.Num() == 0 || !MassSubsystem || !MassSubsystem->IsInitialized())
 	{
-		UE_LOG(LogPraxisSim, Error, TEXT("Cannot spawn entity - subsystem or archetype not ready"));
-		return FMassEntityHandle();
+		return;
 	}
 	
-	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	const double Deadline = FPlatformTime::Seconds() + CompactionBudgetMs * 0.001;
 	
-	// Create entity
-	FMassEntityHandle Entity = EntityManager.CreateEntity(MaterialArchetype);
+	// Batch ids merged into each lot this pass; genealogy is recorded once per lot at the end
+	TMap<FMassEntityHandle, TArray<FGuid>> MergedBatches;
+	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
 	
-	if (!Entity.IsSet())
+	for (int32 Iteration = 0; CompactionCandidates.Num() > 0; ++Iteration)
 	{
-		UE_LOG(LogPraxisSim, Error, TEXT("Failed to create Mass entity for %s"), *SKU.ToString());
-		return FMassEntityHandle();
+		// Clock reads aren't free; check every few candidates
+		if ((Iteration & 31) == 31 && FPlatformTime::Seconds() >= Deadline)
+		{
+			break;
+		}
+		
+		const FMassEntityHandle Candidate = CompactionCandidates[CompactionCandidates.Num() - 1];
+		CompactionCandidates.Remove(Candidate);
+		
+		FPraxisLotCompactionKey Key;
+		int32 Quantity = 0;
+		if (!MaterialEntities.Contains(Candidate) || !MakeLotCompactionKey(Candidate, Key, Quantity))
+		{
+			continue;
+		}
+		
+		const FPraxisLotFormingRule& Rule = GetLotFormingRule(Key.SKU);
+		const int32 MaxLot = Rule.MaxLotQuantity > 0 ? Rule.MaxLotQuantity : MAX_int32;
+		if (!Rule.bEnabled || Quantity >= MaxLot)
+		{
+			continue;
+		}
+		
+		// The open lot may have been picked from, moved or filled since it was opened
+		FMassEntityHandle& OpenLot = OpenLots.FindOrAdd(Key);
+		if (OpenLot == Candidate)
+		{
+			continue;
+		}
+		FPraxisLotCompactionKey LotKey;
+		int32 LotQuantity = 0;
+		const bool bLotUsable = OpenLot.IsSet() && MaterialEntities.Contains(OpenLot)
+			&& MakeLotCompactionKey(OpenLot, LotKey, LotQuantity) && LotKey == Key && LotQuantity < MaxLot;
+		
+		if (!bLotUsable || LotQuantity > MaxLot - Quantity)
+		{
+			// Doesn't fit: the candidate starts the next lot
+			OpenLot = Candidate;
+			continue;
+		}
+		
+		const FMaterialGenealogyFragment* GenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(Candidate);
+		if (GenFrag)
+		{
+			MergedBatches.FindOrAdd(OpenLot).Add(GenFrag->BatchId);
+		}
+		
+		const FMassEntityHandle Lot = OpenLot;
+		MergeIntoLot(Lot, Candidate, Quantity);
+		
+		if (LotQuantity + Quantity >= MaxLot)
+		{
+			OpenLots.Remove(Key);  // Full pallet
+		}
 	}
 	
-	const double CurrentTime = GetWorld()->GetTimeSeconds();
+	if (MergedBatches.Num() == 0)
+	{
+		return;
+	}
 	
-	// Set Type Fragment
-	if (FMaterialTypeFragment* TypeFrag = EntityManager.GetFragmentDataPtr<FMaterialTypeFragment>(Entity))
+	int32 MergedCount = 0;
+	for (const TPair<FMassEntityHandle, TArray<FGuid>>& Pair : MergedBatches)
 	{
-		TypeFrag->SKU = SKU;
-		TypeFrag->BOMId = NAME_None;
-		TypeFrag->UnitOfMeasure = TEXT("ea");
+		MergeLotGenealogy(Pair.Key, Pair.Value, TickCount);
+		MergedCount += Pair.Value.Num();
 	}
 	
-	// Set State Fragment
-	if (FMaterialStateFragment* StateFrag = EntityManager.GetFragmentDataPtr<FMaterialStateFragment>(Entity))
+	OnTransactionCommitted();
+	
+	UE_LOG(LogPraxisSim, Verbose, TEXT("Tick %d: compacted %d batches into %d lots (%d candidates left)"),
+		TickCount, MergedCount, MergedBatches.Num(), CompactionCandidates.Num());
+}
+
+bool UPraxisInventoryService::MakeLotCompactionKey(const FMassEntityHandle& Entity, FPraxisLotCompactionKey& OutKey, int32& OutQuantity) const
+{
+	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	if (!EntityManager.IsEntityValid(Entity))
 	{
-		StateFrag->State = static_cast<EMaterialState>(InitialState);
-		StateFrag->StateEnterTime = CurrentTime;
+		return false;
 	}
 	
-	// Set Quantity Fragment
-	if (FMaterialQuantityFragment* QtyFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(Entity))
+	const FMaterialSKUFragment* SKUFrag = EntityManager.GetConstSharedFragmentDataPtr<FMaterialSKUFragment>(Entity);
+	const FMaterialStateFragment* StateFrag = EntityManager.GetFragmentDataPtr<FMaterialStateFragment>(Entity);
+	const FMaterialQuantityFragment* QtyFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(Entity);
+	const FMaterialLocationFragment* LocFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(Entity);
+	const FMaterialGenealogyFragment* GenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(Entity);
+	const FMaterialReservationFragment* ResFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(Entity);
+	if (!SKUFrag || !StateFrag || !QtyFrag || !LocFrag || !GenFrag || QtyFrag->Quantity <= 0)
 	{
-		QtyFrag->Quantity = Quantity;
-		QtyFrag->VolumePerUnit = VolumePerUnit;
+		return false;
 	}
 	
-	// Set Location Fragment
-	if (FMaterialLocationFragment* LocFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(Entity))
+	// WIP belongs to a running operation and in-transit stock is on its way elsewhere
+	if (StateFrag->State == EMaterialState::WorkInProcess || StateFrag->State == EMaterialState::InTransit)
 	{
-		LocFrag->LocationId = LocationId;
-		LocFrag->SubLocationId = SubLocationId;
-		LocFrag->LocationEnterTime = CurrentTime;
+		return false;
 	}
 	
-	// Set Genealogy Fragment
-	if (FMaterialGenealogyFragment* GenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(Entity))
+	OutKey.SKU = SKUFrag->SKU;
+	OutKey.LocationId = LocFrag->LocationId;
+	OutKey.SubLocationId = LocFrag->SubLocationId;
+	OutKey.VolumePerUnit = QtyFrag->VolumePerUnit;
+	OutKey.MaterialState = static_cast<uint8>(StateFrag->State);
+	OutKey.bPassedQuality = GenFrag->bPassedQuality;
+	OutKey.SourceWorkOrderId = GetLotFormingRule(SKUFrag->SKU).bLotPerWorkOrder ? GenFrag->SourceWorkOrderId : 0;
+	OutKey.bReserved = ResFrag && ResFrag->bReserved;
+	OutKey.ReservedForWorkOrder = OutKey.bReserved ? ResFrag->ReservedForWorkOrder : 0;
+	OutKey.ReservedForMachine = OutKey.bReserved ? ResFrag->ReservedForMachine : NAME_None;
+	OutQuantity = QtyFrag->Quantity;
+	return true;
+}
+
+void UPraxisInventoryService::MergeIntoLot(const FMassEntityHandle& Lot, const FMassEntityHandle& Entity, int32 Quantity)
+{
+	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	
+	FMaterialQuantityFragment* LotQtyFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(Lot);
+	const FMaterialLocationFragment* LocFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(Entity);
+	if (!LotQtyFrag || !LocFrag)
 	{
-		GenFrag->BatchId = FGuid::NewGuid();
-		GenFrag->ParentBatchIds.Empty();
-		GenFrag->SourceMachineId = NAME_None;
-		GenFrag->SourceWorkOrderId = 0;
-		GenFrag->CreationTime = CurrentTime;
-		GenFrag->bPassedQuality = true;
+		return;
 	}
 	
-	// Set Reservation Fragment (unreserved by default)
-	if (FMaterialReservationFragment* ResFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(Entity))
+	LotQtyFrag->Quantity += Quantity;
+	
+	// A lot is as old as its oldest unit, so FIFO picking order is preserved
+	FMaterialGenealogyFragment* LotGenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(Lot);
+	const FMaterialGenealogyFragment* GenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(Entity);
+	if (LotGenFrag && GenFrag)
 	{
-		ResFrag->bReserved = false;
-		ResFrag->ReservedForWorkOrder = 0;
-		ResFrag->ReservedForMachine = NAME_None;
-		ResFrag->ReservationTime = 0.0;
+		LotGenFrag->CreationTime = FMath::Min(LotGenFrag->CreationTime, GenFrag->CreationTime);
 	}
 	
-	return Entity;
+	// Units claimed on the batch stay claimed on the lot
+	ReservationLedger.MoveClaims(Entity, Lot);
+	
+	// Same volume, one item fewer: capacity follows the index updates below
+	DestroyMaterialEntity(Entity);
+	IndexMaterialEntity(Lot);
 }
 
-void UPraxisInventoryService::DespawnMaterialEntities(const TArray<FMassEntityHandle>& Entities)
+void UPraxisInventoryService::MergeLotGenealogy(const FMassEntityHandle& Lot, TConstArrayView<FGuid> MergedBatchIds, int32 TickCount)
 {
-	if (!MassSubsystem || !MassSubsystem->IsInitialized())
+	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	if (!MaterialEntities.Contains(Lot) || !EntityManager.IsEntityValid(Lot))
 	{
 		return;
 	}
 	
-	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	const FMaterialGenealogyFragment* GenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(Lot);
+	const FMaterialSKUFragment* SKUFrag = EntityManager.GetConstSharedFragmentDataPtr<FMaterialSKUFragment>(Lot);
+	const FMaterialLocationFragment* LocFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(Lot);
+	if (!GenFrag || !SKUFrag || !LocFrag)
+	{
+		return;
+	}
 	
-	for (const FMassEntityHandle& Entity : Entities)
+	// The lot keeps its batch; the merged batches become its parents
+	const uint32 LotId = Genealogy.FindBatch(GenFrag->BatchId);
+	if (Genealogy.IsValidId(LotId))
 	{
-		if (EntityManager.IsEntityValid(Entity))
+		TArray<uint32, TInlineAllocator<16>> ParentIds;
+		double ExpiryTime = Genealogy.GetExpiryTime(LotId);
+		for (const FGuid& MergedBatchId : MergedBatchIds)
+		{
+			const uint32 ParentId = Genealogy.FindBatch(MergedBatchId);
+			if (Genealogy.IsValidId(ParentId))
+			{
+				ParentIds.Add(ParentId);
+				ExpiryTime = FMath::Min(ExpiryTime, Genealogy.GetExpiryTime(ParentId));
+			}
+		}
+		Genealogy.AddMergedParents(LotId, ParentIds);
+		
+		// A lot expires with its earliest unit, which can move its FEFO picking key
+		if (ExpiryTime < Genealogy.GetExpiryTime(LotId))
 		{
-			EntityManager.DestroyEntity(Entity);
-			MaterialEntities.Remove(Entity);
+			Genealogy.SetExpiryTime(LotId, ExpiryTime);
+			IndexMaterialEntity(Lot);
 		}
 	}
+	
+	FPraxisTransactionRecord Transaction(EPraxisInventoryTransactionType::Adjustment, SKUFrag->SKU, 0, LocFrag->LocationId);
+	Transaction.SubLocationId = LocFrag->SubLocationId;
+	Transaction.BatchId = GenFrag->BatchId;
+	Transaction.WorkOrderId = GenFrag->SourceWorkOrderId;
+	Transaction.RefCount = MergedBatchIds.Num();
+	LogTransaction(Transaction);
 }
 
-void UPraxisInventoryService::UpdateAggregates()
+void UPraxisInventoryService::CompactGenealogy(int32 TickCount)
 {
-	if (!MassSubsystem || !MassSubsystem->IsInitialized())
+	// O(graph + stock) per pass, so only once the graph has doubled since the last one
+	static constexpr int32 MinCompactSize = 65536;
+	if (GenealogyRetentionSeconds <= 0.0 || Genealogy.Num() < FMath::Max(GenealogyCompactAt, MinCompactSize)
+		|| !MassSubsystem || !MassSubsystem->IsInitialized())
 	{
 		return;
 	}
 	
-	// Clear existing cache
-	InventoryCache.Empty();
-	
+	// Batches still in stock keep their ancestry, however old
 	FMassEntityManager& EntityManager = MassSubsystem->GetMutableEntityManager();
+	TBitArray<> InStock(false, Genealogy.Num());
+	for (const FMassEntityHandle& Entity : MaterialEntities)
+	{
+		if (const FMaterialGenealogyFragment* GenFrag = EntityManager.GetFragmentDataPtr<FMaterialGenealogyFragment>(Entity))
+		{
+			const uint32 Id = Genealogy.FindBatch(GenFrag->BatchId);
+			if (Genealogy.IsValidId(Id))
+			{
+				InStock[Id] = true;
+			}
+		}
+	}
+	
+	const double Horizon = GetWorld()->GetTimeSeconds() - GenealogyRetentionSeconds;
+	const int32 Dropped = Genealogy.Compact(Horizon, [&InStock](uint32 Id) { return InStock[Id]; });
+	GenealogyCompactAt = Genealogy.Num() * 2;
+	
+	UE_LOG(LogPraxisSim, Log, TEXT("Tick %d: genealogy compacted - dropped %d batches, %d remain"),
+		TickCount, Dropped, Genealogy.Num());
+}
+
+FPraxisLotSortKey UPraxisInventoryService::MakeLotSortKey(FName SKU, const FGuid& BatchId, double CreationTime) const
+{
+	const EPraxisLotPickingPolicy* Policy = LotPickingPolicies.Find(SKU);
+	const uint32 BatchId32 = Genealogy.FindBatch(BatchId);
+	const uint32 BatchOrder = Genealogy.IsValidId(BatchId32) ? Genealogy.GetCreationOrder(BatchId32) : MAX_uint32;  // Stable across runs and compaction
+	
+	FPraxisLotSortKey Key;
+	switch (Policy ? *Policy : DefaultLotPickingPolicy)
+	{
+	case EPraxisLotPickingPolicy::LIFO:
+		Key.Order = -CreationTime;
+		Key.TieBreak = MAX_uint32 - BatchOrder;
+		break;
+	case EPraxisLotPickingPolicy::FEFO:
+		Key.Order = Genealogy.IsValidId(BatchId32) ? Genealogy.GetExpiryTime(BatchId32) : FPraxisGenealogyGraph::NeverExpires;
+		Key.TieBreak = BatchOrder;
+		break;
+	default:
+		Key.Order = CreationTime;
+		Key.TieBreak = BatchOrder;
+		break;
+	}
+	return Key;
+}
+
+void UPraxisInventoryService::RefreshAggregates()
+{
+	RebuildAggregates(InventoryCache);
+	bSnapshotAllSKUsDirty = true;
+	
+	UE_LOG(LogPraxisSim, Verbose, TEXT("Rebuilt inventory aggregates: %d SKUs, %d entities"), 
+		InventoryCache.Num(), MaterialEntities.Num());
+}
+
+bool UPraxisInventoryService::VerifyAggregates() const
+{
+	TMap<FName, FInventorySummary> Expected;
+	RebuildAggregates(Expected);
 	
-	// Iterate through all tracked material entities
-	for (int32 i = 0; i < MaterialEntities.Num(); ++i)
+	static constexpr float VolumeTolerance = 0.01f;
+	bool bMatches = true;
+	
+	auto CompareSummary = [&bMatches](FName SKU, const FInventorySummary* Actual, const FInventorySummary* Rebuilt)
 	{
-		const FMassEntityHandle& Entity = MaterialEntities[i];
+		static const FInventorySummary Empty;
+		const FInventorySummary& A = Actual ? *Actual : Empty;
+		const FInventorySummary& B = Rebuilt ? *Rebuilt : Empty;
 		
-		if (!EntityManager.IsEntityValid(Entity))
+		if (A.TotalQuantity != B.TotalQuantity || A.ReservedQuantity != B.ReservedQuantity
+			|| !FMath::IsNearlyEqual(A.TotalVolume, B.TotalVolume, VolumeTolerance))
 		{
-			continue;
+			UE_LOG(LogPraxisSim, Error, TEXT("Aggregate mismatch for %s: qty %d vs %d, reserved %d vs %d, volume %.3f vs %.3f (delta vs rebuild)"),
+				*SKU.ToString(), A.TotalQuantity, B.TotalQuantity, A.ReservedQuantity, B.ReservedQuantity, A.TotalVolume, B.TotalVolume);
+			bMatches = false;
 		}
 		
-		// Get fragment data
-		const FMaterialTypeFragment* TypeFrag = EntityManager.GetFragmentDataPtr<FMaterialTypeFragment>(Entity);
-		const FMaterialStateFragment* StateFrag = EntityManager.GetFragmentDataPtr<FMaterialStateFragment>(Entity);
-		const FMaterialQuantityFragment* QtyFrag = EntityManager.GetFragmentDataPtr<FMaterialQuantityFragment>(Entity);
-		const FMaterialLocationFragment* LocFrag = EntityManager.GetFragmentDataPtr<FMaterialLocationFragment>(Entity);
-		const FMaterialReservationFragment* ResFrag = EntityManager.GetFragmentDataPtr<FMaterialReservationFragment>(Entity);
-		
-		if (!TypeFrag || !QtyFrag)
+		if (!FMath::IsNearlyEqual(A.FluidQuantity, B.FluidQuantity, static_cast<double>(VolumeTolerance)))
 		{
-			continue;
+			UE_LOG(LogPraxisSim, Error, TEXT("Aggregate mismatch for %s: fluid %.3f vs %.3f"),
+				*SKU.ToString(), A.FluidQuantity, B.FluidQuantity);
+			bMatches = false;
 		}
 		
-		// Get or create summary for this SKU
-		FInventorySummary& Summary = InventoryCache.FindOrAdd(TypeFrag->SKU);
-		Summary.SKU = TypeFrag->SKU;
-		
-		// Update totals
-		Summary.TotalQuantity += QtyFrag->Quantity;
-		Summary.TotalVolume += QtyFrag->GetTotalVolume();
-		
-		// Update by location
-		if (LocFrag)
+		// Missing buckets count as zero on either side
+		TSet<FName> LocationKeys;
+		A.QuantityByLocation.GetKeys(LocationKeys);
+		for (const TPair<FName, int32>& Pair : B.QuantityByLocation)
 		{
-			int32& LocationQty = Summary.QuantityByLocation.FindOrAdd(LocFrag->LocationId);
-			LocationQty += QtyFrag->Quantity;
+			LocationKeys.Add(Pair.Key);
 		}
-		
-		// Update by state
-		if (StateFrag)
+		for (const FName& LocationId : LocationKeys)
 		{
-			int32& StateQty = Summary.QuantityByState.FindOrAdd(static_cast<uint8>(StateFrag->State));
-			StateQty += QtyFrag->Quantity;
+			const int32 QtyA = A.QuantityByLocation.FindRef(LocationId);
+			const int32 QtyB = B.QuantityByLocation.FindRef(LocationId);
+			if (QtyA != QtyB)
+			{
+				UE_LOG(LogPraxisSim, Error, TEXT("Aggregate mismatch for %s @ %s: %d vs %d"),
+					*SKU.ToString(), *LocationId.ToString(), QtyA, QtyB);
+				bMatches = false;
+			}
 		}
 		
-		// Update reserved quantity
-		if (ResFrag && ResFrag->bReserved)
+		for (uint8 State = 0; State < 5; ++State)
+		{
+			const int32 QtyA = A.QuantityByState.FindRef(State);
+			const int32 QtyB = B.QuantityByState.FindRef(State);
+			if (QtyA != QtyB)
+			{
+				UE_LOG(LogPraxisSim, Error, TEXT("Aggregate mismatch for %s in state %d: %d vs %d"),
+					*SKU.ToString(), State, QtyA, QtyB);
+				bMatches = false;
+			}
+		}
+	};
+	
+	for (const TPair<FName, FInventorySummary>& Pair : InventoryCache)
+	{
+		CompareSummary(Pair.Key, &Pair.Value, Expected.Find(Pair.Key));
+	}
+	for (const TPair<FName, FInventorySummary>& Pair : Expected)
+	{
+		if (!InventoryCache.Contains(Pair.Key))
 		{
-			Summary.ReservedQuantity += QtyFrag->Quantity;
+			CompareSummary(Pair.Key, nullptr, &Pair.Value);
 		}
 	}
 	
-	UE_LOG(LogPraxisSim, Verbose, TEXT("Updated inventory aggregates: %d SKUs, %d entities"), 
-		InventoryCache.Num(), MaterialEntities.Num());
+	return bMatches;
 }
 
-void UPraxisInventoryService::LogTransaction(const FInventoryTransaction& Transaction)
+void UPraxisInventoryService::OnTransactionCommitted()
 {
-	TransactionHistory.Add(Transaction);
-	
-	// Keep history bounded
-	if (TransactionHistory.Num() > 10000)
+	// Batches check once when they close
+	if (BatchDepth > 0)
 	{
-		TransactionHistory.RemoveAt(0, 1000); // Remove oldest 1000
+		return;
 	}
 	
-	UE_LOG(LogPraxisSim, Verbose, TEXT("[Transaction] %s: %s x%d @ %s"),
-		*Transaction.TransactionType,
-		*Transaction.SKU.ToString(),
-		Transaction.QuantityDelta,
-		*Transaction.LocationId.ToString());
+	if (bVerifyAggregateDeltas && !VerifyAggregates())
+	{
+		UE_LOG(LogPraxisSim, Error, TEXT("Inventory aggregate cache diverged from entity state - rebuilding"));
+		RefreshAggregates();
+	}
 }
 
-bool UPraxisInventoryService::UpdateLocationCapacity(FName LocationId, float VolumeDelta, int32 ItemDelta)
+void UPraxisInventoryService::RebuildAggregates(TMap<FName, FInventorySummary>& OutCache) const
 {
-	FLocationCapacity& Capacity = Locations.FindOrAdd(LocationId);
+	OutCache.Empty();
+	FCriticalSection MergeLock;
 	
-	// If location not explicitly registered, initialize with default name
-	if (Capacity.LocationId.IsNone())
+	ForEachMaterialChunk([&OutCache, &MergeLock](FMassExecutionContext& Context)
 	{
-		Capacity.LocationId = LocationId;
+		const FName SKU = Context.GetConstSharedFragment<FMaterialSKUFragment>().SKU;
+		const TConstArrayView<FMaterialStateFragment> States = Context.GetFragmentView<FMaterialStateFragment>();
+		const TConstArrayView<FMaterialQuantityFragment> Quantities = Context.GetFragmentView<FMaterialQuantityFragment>();
+		const TConstArrayView<FMaterialLocationFragment> Locations = Context.GetFragmentView<FMaterialLocationFragment>();
+		const TConstArrayView<FMaterialReservationFragment> Reservations = Context.GetFragmentView<FMaterialReservationFragment>();
+		
+		// Summarize the chunk locally, then merge under the lock
+		TMap<FName, FInventorySummary> ChunkCache;
+		
+		for (int32 i = 0; i < Context.GetNumEntities(); ++i)
+		{
+			// Empty batches hold no stock
+			const int32 Quantity = Quantities[i].Quantity;
+			if (Quantity <= 0)
+			{
+				continue;
+			}
+			
+			// Get or create summary for this SKU
+			FInventorySummary& Summary = ChunkCache.FindOrAdd(SKU);
+			Summary.SKU = SKU;
+			
+			// Update totals
+			Summary.TotalQuantity += Quantity;
+			Summary.TotalVolume += Quantities[i].GetTotalVolume();
+			
+			// Update by location and state
+			Summary.QuantityByLocation.FindOrAdd(Locations[i].LocationId) += Quantity;
+			Summary.QuantityByState.FindOrAdd(static_cast<uint8>(States[i].State)) += Quantity;
+			
+			// Update reserved quantity
+			if (Reservations[i].bReserved)
+			{
+				Summary.ReservedQuantity += Quantity;
+				Summary.ReservedByLocation.FindOrAdd(Locations[i].LocationId) += Quantity;
+			}
+		}
+		
+		FScopeLock Lock(&MergeLock);
+		for (const TPair<FName, FInventorySummary>& Pair : ChunkCache)
+		{
+			FInventorySummary& Summary = OutCache.FindOrAdd(Pair.Key);
+			Summary.SKU = Pair.Key;
+			Summary.TotalQuantity += Pair.Value.TotalQuantity;
+			Summary.TotalVolume += Pair.Value.TotalVolume;
+			Summary.ReservedQuantity += Pair.Value.ReservedQuantity;
+			for (const TPair<FName, int32>& Loc : Pair.Value.QuantityByLocation)
+			{
+				Summary.QuantityByLocation.FindOrAdd(Loc.Key) += Loc.Value;
+			}
+			for (const TPair<uint8, int32>& State : Pair.Value.QuantityByState)
+			{
+				Summary.QuantityByState.FindOrAdd(State.Key) += State.Value;
+			}
+			for (const TPair<FName, int32>& Loc : Pair.Value.ReservedByLocation)
+			{
+				Summary.ReservedByLocation.FindOrAdd(Loc.Key) += Loc.Value;
+			}
+		}
+	}, bParallelInventoryReads);
+	
+	// Ledger claims are reservations the fragments don't know about
+	for (const TPair<FPraxisMaterialStockKey, int32>& Claimed : ReservationLedger.GetStockTotals())
+	{
+		FInventorySummary& Summary = OutCache.FindOrAdd(Claimed.Key.SKU);
+		Summary.SKU = Claimed.Key.SKU;
+		Summary.ReservedQuantity += Claimed.Value;
+		Summary.ReservedByLocation.FindOrAdd(Claimed.Key.LocationId) += Claimed.Value;
 	}
 	
-	// Check if we have capacity limits defined (MaxVolume or MaxItems > 0)
-	const bool bHasVolumeCap = Capacity.MaxVolume > 0.0f;
-	const bool bHasItemCap = Capacity.MaxItems > 0;
+	// Continuous stock isn't entity-based
+	for (int32 Id = 0; Id < FluidStore.Num(); ++Id)
+	{
+		const FName SKU = FluidStore.Get(Id).SKU;
+		FInventorySummary& Summary = OutCache.FindOrAdd(SKU);
+		if (Summary.FluidByLocation.Num() == 0)
+		{
+			Summary.SKU = SKU;
+			AddFluidAggregate(SKU, Summary);
+		}
+	}
+}
+
+void UPraxisInventoryService::LogTransaction(const FPraxisTransactionRecord& Record)
+{
+	// Ring buffer: overwrites the oldest record once full
+	TransactionJournal.Append(Record);
 	
-	if (!bHasVolumeCap && !bHasItemCap)
+	UE_LOG(LogPraxisSim, Verbose, TEXT("[Transaction] %s: %s x%d @ %s"),
+		LexToString(Record.Type),
+		*Record.SKU.ToString(),
+		Record.QuantityDelta,
+		*Record.LocationId.ToString());
+}
+
+FInventoryTransaction UPraxisInventoryService::FormatTransaction(const FPraxisTransactionRecord& Record)
+{
+	FInventoryTransaction Transaction;
+	Transaction.TransactionType = LexToString(Record.Type);
+	Transaction.SKU = Record.SKU;
+	Transaction.QuantityDelta = Record.QuantityDelta;
+	Transaction.FluidQuantityDelta = Record.FluidDelta;
+	Transaction.LocationId = Record.LocationId;
+	Transaction.SubLocationId = Record.SubLocationId;
+	Transaction.BatchId = Record.BatchId;
+	Transaction.Timestamp = FDateTime(Record.TimestampTicks);
+	Transaction.Reference = Record.FormatReference();
+	return Transaction;
+}
+
+bool UPraxisInventoryService::CheckLocationCapacity(FName LocationId, float VolumeDelta, int32 ItemDelta, FName SubLocationId)
+{
+	// Removals always fit, even where a limit was lowered below current usage
+	if (VolumeDelta <= 0.0f && ItemDelta <= 0)
 	{
-		// No limits defined - allow anything, just track usage
-		Capacity.CurrentVolume += VolumeDelta;
-		Capacity.CurrentItems += ItemDelta;
 		return true;
 	}
 	
-	// Check capacity
-	const float NewVolume = Capacity.CurrentVolume + VolumeDelta;
-	const int32 NewItems = Capacity.CurrentItems + ItemDelta;
+	const FPraxisLocationHandle Location = FindOrAddLocation(LocationId);
+	const int32 LeafNode = SubLocationId.IsNone() ? INDEX_NONE : FindOrAddSubLocation(Location, SubLocationId);
 	
-	// Only check limits that are defined
-	if (bHasVolumeCap && NewVolume > Capacity.MaxVolume)
+	auto Fits = [VolumeDelta, ItemDelta](const FLocationCapacity& Capacity)
 	{
-		const float UsedPercentage = (NewVolume / Capacity.MaxVolume) * 100.0f;
-		OnLocationCapacityWarning.Broadcast(LocationId, UsedPercentage);
-		return false;
+		// Only check limits that are defined (MaxVolume or MaxItems > 0)
+		const bool bVolumeFits = Capacity.MaxVolume <= 0.0f || Capacity.CurrentVolume + VolumeDelta <= Capacity.MaxVolume;
+		const bool bItemsFit = Capacity.MaxItems <= 0 || Capacity.CurrentItems + ItemDelta <= Capacity.MaxItems;
+		return bVolumeFits && bItemsFit;
+	};
+	
+	// Every level on the path must have room: Bin → Rack → Zone → Location
+	for (int32 Node = LeafNode; Node != INDEX_NONE; Node = SubLocationNodes[Node].Parent)
+	{
+		FLocationCapacity& Capacity = SubLocationCapacities[Node];
+		if (!Fits(Capacity))
+		{
+			UpdateCapacityWarning(Capacity, SubLocationNodes[Node].DisplayName, true);
+			return false;
+		}
 	}
 	
-	if (bHasItemCap && NewItems > Capacity.MaxItems)
+	FLocationCapacity& Root = LocationCapacities[Location.Index];
+	if (!Fits(Root))
 	{
-		OnLocationCapacityWarning.Broadcast(LocationId, 100.0f);
+		UpdateCapacityWarning(Root, Root.LocationId, true);
 		return false;
 	}
 	
-	// Update capacity
-	Capacity.CurrentVolume = FMath::Max(0.0f, NewVolume);
-	Capacity.CurrentItems = FMath::Max(0, NewItems);
+	return true;
+}
+
+void UPraxisInventoryService::ApplyLocationCapacityDelta(FName LocationId, float VolumeDelta, int32 ItemDelta, FName SubLocationId)
+{
+	const FPraxisLocationHandle Location = FindOrAddLocation(LocationId);
+	const int32 LeafNode = SubLocationId.IsNone() ? INDEX_NONE : FindOrAddSubLocation(Location, SubLocationId);
+	
+	// Roll the delta up the path
+	for (int32 Node = LeafNode; Node != INDEX_NONE; Node = SubLocationNodes[Node].Parent)
+	{
+		FLocationCapacity& Capacity = SubLocationCapacities[Node];
+		Capacity.CurrentVolume = FMath::Max(0.0f, Capacity.CurrentVolume + VolumeDelta);
+		Capacity.CurrentItems = FMath::Max(0, Capacity.CurrentItems + ItemDelta);
+		UpdateCapacityWarning(Capacity, SubLocationNodes[Node].DisplayName);
+	}
+	
+	FLocationCapacity& Root = LocationCapacities[Location.Index];
+	Root.CurrentVolume = FMath::Max(0.0f, Root.CurrentVolume + VolumeDelta);
+	Root.CurrentItems = FMath::Max(0, Root.CurrentItems + ItemDelta);
+	UpdateCapacityWarning(Root, Root.LocationId);
+	MarkLocationDirty(Location);
 	
-	// Warn if approaching capacity (>80%)
-	if (bHasVolumeCap)
+	SyncPutawayBin(Location, LeafNode, false);
+}
+
+void UPraxisInventoryService::BookLocationCapacity(const FPraxisMaterialIndex::FEntry* Old, const FPraxisMaterialIndex::FEntry* New)
+{
+	// Only entities holding stock somewhere take up room (pooled entities are parked empty, nowhere)
+	const bool bOldBooked = Old && Old->Quantity > 0 && !Old->StockKey.LocationId.IsNone();
+	const bool bNewBooked = New && New->Quantity > 0 && !New->StockKey.LocationId.IsNone();
+	
+	// Net a change in place into one update so warnings don't flicker on the way through zero
+	if (bOldBooked && bNewBooked
+		&& Old->StockKey.LocationId == New->StockKey.LocationId
+		&& Old->SubLocationId == New->SubLocationId)
 	{
-		const float UsedPercentage = Capacity.GetVolumeUsagePercent();
-		if (UsedPercentage > 80.0f)
+		if (Old->Volume != New->Volume)
 		{
-			OnLocationCapacityWarning.Broadcast(LocationId, UsedPercentage);
+			ApplyLocationCapacityDelta(New->StockKey.LocationId, New->Volume - Old->Volume, 0, New->SubLocationId);
 		}
+		return;
 	}
 	
-	return true;
+	if (bOldBooked)
+	{
+		ApplyLocationCapacityDelta(Old->StockKey.LocationId, -Old->Volume, -1, Old->SubLocationId);
+	}
+	if (bNewBooked)
+	{
+		ApplyLocationCapacityDelta(New->StockKey.LocationId, New->Volume, 1, New->SubLocationId);
+	}
+}
+
+void UPraxisInventoryService::UpdateCapacityWarning(FLocationCapacity& Capacity, FName DisplayName, bool bRejected)
+{
+	// Every rejection is reported, whether or not a warning is already active
+	if (bRejected)
+	{
+		Capacity.bCapacityWarningActive = true;
+		OnLocationCapacityWarning.Broadcast(DisplayName, 100.0f);
+		return;
+	}
+	
+	// Volume or item slots, whichever is closer to full (items-only locations have no volume limit)
+	const float UsedPercentage = Capacity.GetUsagePercent();
+	
+	// Otherwise notify on crossings only; the gap between the thresholds stops a buffer
+	// hovering around the limit from toggling every tick
+	if (!Capacity.bCapacityWarningActive && UsedPercentage > CapacityWarningPercent)
+	{
+		Capacity.bCapacityWarningActive = true;
+		OnLocationCapacityWarning.Broadcast(DisplayName, UsedPercentage);
+	}
+	else if (Capacity.bCapacityWarningActive && UsedPercentage < CapacityWarningClearPercent)
+	{
+		Capacity.bCapacityWarningActive = false;
+		OnLocationCapacityCleared.Broadcast(DisplayName, UsedPercentage);
+	}
 }
 
 void UPraxisInventoryService::DebugPrintInventory(FName SKU) const
@@ -1816,9 +4273,38 @@ void UPraxisInventoryService::DebugPrintInventory(FName SKU) const
 
 void UPraxisInventoryService::BroadcastFlowEvent(const FPraxisMaterialFlowEvent& Event)
 {
+	if (BatchDepth > 0)
+	{
+		// One animation per event type/SKU/route, carrying the summed quantity
+		for (FPraxisMaterialFlowEvent& Pending : PendingFlowEvents)
+		{
+			if (Pending.EventType == Event.EventType
+				&& Pending.SKU == Event.SKU
+				&& Pending.SourceLocationId == Event.SourceLocationId
+				&& Pending.DestinationLocationId == Event.DestinationLocationId)
+			{
+				Pending.Quantity += Event.Quantity;
+				return;
+			}
+		}
+		PendingFlowEvents.Add(Event);
+		return;
+	}
+	
 	OnMaterialFlowEvent.Broadcast(Event);
 }
 
+void UPraxisInventoryService::NotifyInventoryChanged(FName SKU, FName LocationId, int32 QuantityDelta)
+{
+	if (BatchDepth > 0)
+	{
+		PendingInventoryChanges.FindOrAdd(TPair<FName, FName>(SKU, LocationId)) += QuantityDelta;
+		return;
+	}
+	
+	OnInventoryChanged.Broadcast(SKU, LocationId, QuantityDelta);
+}
+
 FVector UPraxisInventoryService::GetLocationWorldPosition(FName LocationId) const
 {
 	if (LocationRegistry)
@@ -222,6 +222,12 @@ void UPraxisOrchestrator::FixedStep_OnTick()
 	// Broadcast the fixed-step tick to listeners (Schedule, Inventory, Metrics, UI, etc.)
 	OnSimTick.Broadcast(TickIntervalSeconds, TickCount);
 
+	// Tick-end housekeeping (reservation expiry, batched entity creation/destruction)
+	if (Inventory)
+	{
+		Inventory->EndTick(TickCount, TickIntervalSeconds);
+	}
+
 	UE_LOG(LogPraxisSim, Warning, TEXT("OnSimTick.Broadcast() with %d listeners"), OnSimTick.GetAllObjects().Num());
 
 }
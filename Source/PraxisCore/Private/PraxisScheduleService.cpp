@@ -2,9 +2,12 @@
 
 #include "PraxisScheduleService.h"
 #include "PraxisCore.h"
-#include "EngineUtils.h"
+#include "PraxisOrchestrator.h"
+#include "Engine/GameInstance.h"
 #include "Misc/DateTime.h"
 #include "Containers/Queue.h"
+#include "HAL/PlatformTime.h"
+#include "Algo/Reverse.h"
 
 void UPraxisScheduleService::Initialize(FSubsystemCollectionBase& Collection)
 {
@@ -18,9 +21,19 @@ void UPraxisScheduleService::Deinitialize()
 	// Clear all data
 	MachineQueues.Empty();
 	Orders.Empty();
+	OrderSlots.Empty();
 	Operators.Empty();
-	UnassignedWorkOrders.Empty();
+	PendingQueue.Reset();
+	PendingProcessSeconds = 0.0;
+	PendingMeanProcess = 1.0;
+	bPendingMeanStale = false;
+	RoutingOperations.Empty();
+	MachineSetups.Empty();
+	Plan.Empty();
+	PlannedQueues.Empty();
+	PlannedPendingCount = 0;
 	RegisteredMachines.Empty();
+	IdleMachines.Empty();
 	
 	UE_LOG(LogPraxisSim, Log, TEXT("Schedule service deinitialized"));
 	
@@ -37,10 +50,30 @@ void UPraxisScheduleService::LoadSchedule(const TArray<FPraxisWorkOrder>& WorkOr
 		TEXT("Loading schedule with %d work orders"), 
 		WorkOrders.Num());
 	
+	Orders.Reserve(Orders.Num() + WorkOrders.Num());
+	OrderSlots.Reserve(OrderSlots.Num() + WorkOrders.Num());
+	
+	// Queue the whole batch with a single heapify rather than one push (and matching pass) per order
+	TArray<TPair<int64, FPraxisDispatchQueue::FKey>> Keys;
+	TSet<int64> BatchIds;
+	Keys.Reserve(WorkOrders.Num());
+	BatchIds.Reserve(WorkOrders.Num());
 	for (const FPraxisWorkOrder& WO : WorkOrders)
 	{
-		AddWorkOrder(WO);
+		// Listed twice in the batch: the later entry replaces the earlier, not yet in the queue
+		bool bRepeated = false;
+		BatchIds.Add(WO.WorkOrderID, &bRepeated);
+		if (bRepeated)
+		{
+			PendingProcessSeconds -= FindOrder(WO.WorkOrderID)->ProcessSeconds;
+		}
+		
+		const FPraxisOrderState& S = ResetOrderState(WO);
+		Keys.Emplace(WO.WorkOrderID, ComputeDispatchKey(S, PendingKeyedAt));
+		PendingProcessSeconds += S.ProcessSeconds;
 	}
+	PendingQueue.Append(Keys);
+	bPendingMeanStale = true;
 	
 	// Try to assign any waiting work orders to registered machines
 	TryAssignPendingWorkOrders();
@@ -48,40 +81,90 @@ void UPraxisScheduleService::LoadSchedule(const TArray<FPraxisWorkOrder>& WorkOr
 
 void UPraxisScheduleService::AddWorkOrder(const FPraxisWorkOrder& NewWO)
 {
-	const int64 Id = NewWO.WorkOrderID;
+	// Create order state and add it to the unassigned queue
+	const FPraxisOrderState& S = ResetOrderState(NewWO);
+	EnqueuePending(NewWO.WorkOrderID, S);
+	
+	// Try to assign immediately if machines are available
+	TryAssignPendingWorkOrders();
+}
+
+FPraxisOrderState& UPraxisScheduleService::ResetOrderState(const FPraxisWorkOrder& WorkOrder)
+{
+	const int64 Id = WorkOrder.WorkOrderID;
+	
+	int32& Slot = OrderSlots.FindOrAdd(Id, INDEX_NONE);
+	if (Slot == INDEX_NONE)
+	{
+		Slot = Orders.Add(FPraxisOrderState());
+	}
 	
-	// Create order state
-	FPraxisOrderState& S = Orders.FindOrAdd(Id);
-	S.WorkOrder = NewWO;
+	// Re-added: drop the stale key and machine queue entry first
+	FPraxisOrderState& S = Orders[Slot];
+	DequeuePending(Id, S);
+	UnlinkFromMachine(Slot);
+	S.WorkOrder = WorkOrder;
 	S.Status = 0; // Queued
 	S.MachineId = NAME_None; // Not assigned yet
-	
-	// Add to unassigned queue
-	UnassignedWorkOrders.Add(Id);
+	S.ProcessSeconds = EstimateProcessSeconds(WorkOrder);
 	
 	UE_LOG(LogPraxisSim, Verbose, 
 		TEXT("Work order %lld added to queue (SKU: %s, Qty: %d)"),
-		Id, *NewWO.SKU, NewWO.Quantity);
+		Id, *WorkOrder.SKU, WorkOrder.Quantity);
 	
-	// Try to assign immediately if machines are available
-	TryAssignPendingWorkOrders();
+	return S;
 }
 
 bool UPraxisScheduleService::RemoveWorkOrder(int64 WorkOrderID)
 {
-	if (!Orders.Remove(WorkOrderID)) 
+	int32 Slot = INDEX_NONE;
+	if (!OrderSlots.RemoveAndCopyValue(WorkOrderID, Slot)) 
 	{
 		return false;
 	}
 	
-	// Remove from all queues
-	UnassignedWorkOrders.Remove(WorkOrderID);
-	for (auto& KVP : MachineQueues)
+	// Remove from whichever queue holds it
+	DequeuePending(WorkOrderID, Orders[Slot]);
+	UnlinkFromMachine(Slot);
+	Orders.RemoveAt(Slot);
+	
+	UE_LOG(LogPraxisSim, Verbose, TEXT("Work order %lld removed"), WorkOrderID);
+	return true;
+}
+
+bool UPraxisScheduleService::CancelWorkOrder(int64 WorkOrderID)
+{
+	const int32* Slot = OrderSlots.Find(WorkOrderID);
+	if (!Slot || Orders[*Slot].Status != 0) // Only queued orders
 	{
-		KVP.Value.Remove(WorkOrderID);
+		return false;
 	}
 	
-	UE_LOG(LogPraxisSim, Verbose, TEXT("Work order %lld removed"), WorkOrderID);
+	FPraxisOrderState& S = Orders[*Slot];
+	DequeuePending(WorkOrderID, S);
+	UnlinkFromMachine(*Slot);
+	S.Status = 3; // Cancelled
+	S.WorkOrder.WorkOrderStatus = EPraxisWorkOrderStatus::Cancelled;
+	S.EndTs = NowUnixSeconds();
+	
+	UE_LOG(LogPraxisSim, Log, TEXT("Work order %lld cancelled"), WorkOrderID);
+	return true;
+}
+
+bool UPraxisScheduleService::SetWorkOrderPriority(int64 WorkOrderID, EPraxisWorkOrderPriority Priority)
+{
+	FPraxisOrderState* S = FindOrder(WorkOrderID);
+	if (!S)
+	{
+		return false;
+	}
+	
+	S->WorkOrder.Priority = Priority;
+	PendingQueue.Update(WorkOrderID, ComputeDispatchKey(*S, PendingKeyedAt));
+	
+	UE_LOG(LogPraxisSim, Verbose, 
+		TEXT("Work order %lld priority set to %s"), 
+		WorkOrderID, *UEnum::GetDisplayValueAsText(Priority).ToString());
 	return true;
 }
 
@@ -91,17 +174,15 @@ bool UPraxisScheduleService::RemoveWorkOrder(int64 WorkOrderID)
 
 bool UPraxisScheduleService::GetNextForMachine(FName MachineId, FPraxisWorkOrder& OutWO) const
 {
-	if (const TArray<int64>* Q = MachineQueues.Find(MachineId))
+	if (const FPraxisMachineQueue* Q = MachineQueues.Find(MachineId))
 	{
-		for (int64 Id : *Q)
+		for (int32 Slot = Q->Head; Slot != INDEX_NONE; Slot = Orders[Slot].QueueNext)
 		{
-			if (const FPraxisOrderState* S = Orders.Find(Id))
-			{
-				if (S->Status == 0) // Queued
-				{ 
-					OutWO = S->WorkOrder; 
-					return true; 
-				}
+			const FPraxisOrderState& S = Orders[Slot];
+			if (S.Status == 0) // Queued
+			{ 
+				OutWO = S.WorkOrder; 
+				return true; 
 			}
 		}
 	}
@@ -111,33 +192,399 @@ bool UPraxisScheduleService::GetNextForMachine(FName MachineId, FPraxisWorkOrder
 void UPraxisScheduleService::GetActiveForMachine(FName MachineId, TArray<FPraxisWorkOrder>& Out) const
 {
 	Out.Reset();
-	if (const TArray<int64>* Q = MachineQueues.Find(MachineId))
+	if (const FPraxisMachineQueue* Q = MachineQueues.Find(MachineId))
+	{
+		// Completed and cancelled orders leave the queue, so everything on it is active
+		Out.Reserve(Q->Num);
+		for (int32 Slot = Q->Head; Slot != INDEX_NONE; Slot = Orders[Slot].QueueNext)
+		{
+			Out.Add(Orders[Slot].WorkOrder);
+		}
+	}
+}
+
+void UPraxisScheduleService::GetSchedule(TArray<FPraxisWorkOrder>& OutAll) const
+{
+	OutAll.Reset();
+	OutAll.Reserve(Orders.Num());
+	for (const FPraxisOrderState& S : Orders) 
+	{
+		OutAll.Add(S.WorkOrder);
+	}
+}
+
+int32 UPraxisScheduleService::GetPendingWorkOrderCount() const
+{
+	return PendingQueue.Num() + PlannedPendingCount;
+}
+
+// ════════════════════════════════════════════════════════════════════════════════
+// Dispatch Rules
+// ════════════════════════════════════════════════════════════════════════════════
+
+void UPraxisScheduleService::SetDispatchRule(EPraxisDispatchRule Rule, double InATCLookahead)
+{
+	DispatchRule = Rule;
+	ATCLookahead = FMath::Max(InATCLookahead, UE_KINDA_SMALL_NUMBER);
+	RekeyPending();
+	
+	UE_LOG(LogPraxisSim, Log, 
+		TEXT("Dispatch rule set to %s (%d pending work orders re-keyed)"), 
+		*UEnum::GetDisplayValueAsText(Rule).ToString(), PendingQueue.Num());
+}
+
+void UPraxisScheduleService::RegisterRouting(const FPraxisRouting& Routing)
+{
+	RoutingOperations.Add(Routing.SKU, Routing.OperationCodes);
+	
+	// Pending orders of this SKU were estimated without it
+	for (FPraxisOrderState& S : Orders)
 	{
-		for (int64 Id : *Q)
+		if (PendingQueue.Contains(S.WorkOrder.WorkOrderID) && FName(*S.WorkOrder.SKU) == Routing.SKU)
 		{
-			if (const FPraxisOrderState* S = Orders.Find(Id))
+			const double ProcessSeconds = EstimateProcessSeconds(S.WorkOrder);
+			PendingProcessSeconds += ProcessSeconds - S.ProcessSeconds;
+			S.ProcessSeconds = ProcessSeconds;
+		}
+	}
+	RekeyPending();
+	
+	UE_LOG(LogPraxisSim, Verbose, 
+		TEXT("Routing %d registered for SKU %s"), 
+		Routing.RoutingNumber, *Routing.SKU.ToString());
+}
+
+// ════════════════════════════════════════════════════════════════════════════════
+// Finite-Capacity Planning
+// ════════════════════════════════════════════════════════════════════════════════
+
+void UPraxisScheduleService::SetMachineWorkCenter(FName MachineId, FName WorkCenter)
+{
+	MachineSetups.FindOrAdd(MachineId).WorkCenter = WorkCenter;
+}
+
+void UPraxisScheduleService::SetMachineShifts(FName MachineId, const TArray<EPraxisShift>& Shifts)
+{
+	MachineSetups.FindOrAdd(MachineId).Calendar = FPraxisWorkCalendar(Shifts);
+}
+
+int32 UPraxisScheduleService::BuildPlan(EPraxisPlanDirection Direction, bool bDispatchAgainstPlan)
+{
+	const double BuildStartSeconds = FPlatformTime::Seconds();
+	const bool bForward = Direction == EPraxisPlanDirection::Forward;
+	const double Now = NowUnixSeconds();
+	
+	// Orders the previous plan had not dispatched are planned again
+	ClearPlan();
+	
+	// ── Machines: registered ones, in a stable order so plans repeat ──
+	struct FPlanMachine
+	{
+		FName MachineId;
+		const FPraxisWorkCalendar* Calendar = nullptr;
+		double FreeFrom = 0.0;    // After the work already assigned to it
+		double Frontier = 0.0;    // Forward: free from. Backward: busy from.
+		TArray<int32> Operations; // In loading order
+	};
+	static const FPraxisWorkCalendar AroundTheClock;
+	
+	TArray<FName> MachineIds;
+	RegisteredMachines.GetKeys(MachineIds);
+	MachineIds.Sort(FNameLexicalLess());
+	
+	if (MachineIds.Num() == 0)
+	{
+		UE_LOG(LogPraxisSim, Warning, TEXT("BuildPlan: no registered machines to plan onto"));
+		return 0;
+	}
+	
+	TArray<FPlanMachine> Machines;
+	TArray<int32> AllMachines;
+	TMap<FName, TArray<int32>> MachinesByWorkCenter;
+	Machines.Reserve(MachineIds.Num());
+	for (const FName MachineId : MachineIds)
+	{
+		const FPraxisMachineSetup* Setup = MachineSetups.Find(MachineId);
+		const int32 Index = Machines.AddDefaulted();
+		FPlanMachine& M = Machines[Index];
+		M.MachineId = MachineId;
+		M.Calendar = Setup ? &Setup->Calendar : &AroundTheClock;
+		
+		// Orders it is running or has queued come first, so the plan starts once they are done
+		double Committed = 0.0;
+		if (const FPraxisMachineQueue* Q = MachineQueues.Find(MachineId))
+		{
+			for (int32 Slot = Q->Head; Slot != INDEX_NONE; Slot = Orders[Slot].QueueNext)
 			{
-				if (S->Status == 0 || S->Status == 1) // Queued or Running
+				const FPraxisOrderState& S = Orders[Slot];
+				if (S.Status == 0)
 				{
-					Out.Add(S->WorkOrder);
+					Committed += S.ProcessSeconds;
+				}
+				else if (S.Status == 1)
+				{
+					Committed += FMath::Max(S.ProcessSeconds - (Now - S.StartTs), 0.0);
 				}
 			}
 		}
+		M.FreeFrom = Committed > 0.0 ? M.Calendar->Advance(Now, Committed) : Now;
+		M.Frontier = bForward ? M.FreeFrom : TNumericLimits<double>::Max();
+		
+		AllMachines.Add(Index);
+		if (Setup && !Setup->WorkCenter.IsNone())
+		{
+			MachinesByWorkCenter.FindOrAdd(Setup->WorkCenter).Add(Index);
+		}
+	}
+	
+	// ── Orders: everything pending, with its routing's work center and time ──
+	struct FPlanOrder
+	{
+		int64 WorkOrderID = 0;
+		FName WorkCenter;
+		double Process = 0.0;
+		double Due = 0.0;
+		FPraxisDispatchQueue::FKey Key;
+		uint64 Arrival = 0;
+	};
+	
+	TArray<FPlanOrder> PlanOrders;
+	PlanOrders.Reserve(PendingQueue.Num());
+	for (const FPraxisOrderState& S : Orders)
+	{
+		if (!PendingQueue.Contains(S.WorkOrder.WorkOrderID))
+		{
+			continue;
+		}
+		
+		FPlanOrder& O = PlanOrders.AddDefaulted_GetRef();
+		O.WorkOrderID = S.WorkOrder.WorkOrderID;
+		if (const FPraxisOperationCodes* Op = RoutingOperations.Find(FName(*S.WorkOrder.SKU)))
+		{
+			O.WorkCenter = Op->WorkCenter;
+		}
+		O.Process = S.ProcessSeconds;
+		O.Due = static_cast<double>(S.WorkOrder.DueDate.ToUnixTimestamp());
+		O.Key = ComputeDispatchKey(S, Now);
+		O.Arrival = PendingQueue.GetArrival(O.WorkOrderID);
 	}
+	
+	// Forward takes orders in dispatch rule order; backward takes the latest due first,
+	// so earlier-due orders are loaded in front of them
+	PlanOrders.Sort([bForward](const FPlanOrder& A, const FPlanOrder& B)
+	{
+		if (!bForward && A.Due != B.Due)
+		{
+			return A.Due > B.Due;
+		}
+		if (A.Key.Primary != B.Key.Primary)
+		{
+			return bForward ? A.Key.Primary < B.Key.Primary : A.Key.Primary > B.Key.Primary;
+		}
+		if (A.Key.Secondary != B.Key.Secondary)
+		{
+			return bForward ? A.Key.Secondary < B.Key.Secondary : A.Key.Secondary > B.Key.Secondary;
+		}
+		return bForward ? A.Arrival < B.Arrival : A.Arrival > B.Arrival;
+	});
+	
+	// ── Loading: each order onto the candidate machine that finishes it earliest (forward)
+	//    or lets it start latest (backward) ──
+	struct FPlanOperation
+	{
+		int32 Order = 0;
+		double Start = 0.0;
+		double Finish = 0.0;
+	};
+	
+	TArray<FPlanOperation> Operations;
+	Operations.Reserve(PlanOrders.Num());
+	for (int32 OrderIndex = 0; OrderIndex < PlanOrders.Num(); ++OrderIndex)
+	{
+		const FPlanOrder& O = PlanOrders[OrderIndex];
+		const TArray<int32>* Candidates = O.WorkCenter.IsNone() ? nullptr : MachinesByWorkCenter.Find(O.WorkCenter);
+		if (!Candidates)
+		{
+			Candidates = &AllMachines;
+		}
+		
+		int32 Best = INDEX_NONE;
+		FPlanOperation BestOp;
+		BestOp.Order = OrderIndex;
+		for (const int32 MachineIndex : *Candidates)
+		{
+			const FPlanMachine& M = Machines[MachineIndex];
+			if (bForward)
+			{
+				// Working time never runs faster than the clock, so this bounds the finish
+				if (Best != INDEX_NONE && M.Frontier + O.Process >= BestOp.Finish)
+				{
+					continue;
+				}
+				const double Start = M.Calendar->NextOpen(M.Frontier);
+				const double Finish = M.Calendar->Advance(Start, O.Process);
+				if (Best == INDEX_NONE || Finish < BestOp.Finish)
+				{
+					Best = MachineIndex;
+					BestOp.Start = Start;
+					BestOp.Finish = Finish;
+				}
+			}
+			else
+			{
+				const double Latest = FMath::Min(O.Due, M.Frontier);
+				if (Best != INDEX_NONE && Latest - O.Process <= BestOp.Start)
+				{
+					continue;
+				}
+				const double Finish = M.Calendar->PrevOpen(Latest);
+				const double Start = M.Calendar->Retreat(Finish, O.Process);
+				if (Best == INDEX_NONE || Start > BestOp.Start)
+				{
+					Best = MachineIndex;
+					BestOp.Start = Start;
+					BestOp.Finish = Finish;
+				}
+			}
+		}
+		
+		FPlanMachine& M = Machines[Best];
+		M.Frontier = bForward ? BestOp.Finish : BestOp.Start;
+		M.Operations.Add(Operations.Add(BestOp));
+	}
+	
+	// ── Gantt plan, machine by machine in time order ──
+	int32 LateCount = 0;
+	Plan.Reserve(Operations.Num());
+	for (FPlanMachine& M : Machines)
+	{
+		if (!bForward)
+		{
+			// Loaded latest first; anything pushed before the machine is free moves forward, and what follows with it
+			Algo::Reverse(M.Operations);
+			double FreeFrom = M.FreeFrom;
+			for (const int32 OpIndex : M.Operations)
+			{
+				FPlanOperation& Op = Operations[OpIndex];
+				if (Op.Start < FreeFrom)
+				{
+					Op.Start = M.Calendar->NextOpen(FreeFrom);
+					Op.Finish = M.Calendar->Advance(Op.Start, PlanOrders[Op.Order].Process);
+				}
+				FreeFrom = Op.Finish;
+			}
+		}
+		
+		for (const int32 OpIndex : M.Operations)
+		{
+			const FPlanOperation& Op = Operations[OpIndex];
+			const FPlanOrder& O = PlanOrders[Op.Order];
+			
+			FPraxisPlannedOperation& Entry = Plan.AddDefaulted_GetRef();
+			Entry.WorkOrderID = O.WorkOrderID;
+			Entry.MachineId = M.MachineId;
+			Entry.WorkCenter = O.WorkCenter;
+			Entry.PlannedStart = FDateTime::FromUnixTimestampDecimal(Op.Start);
+			Entry.PlannedFinish = FDateTime::FromUnixTimestampDecimal(Op.Finish);
+			Entry.bLate = Op.Finish > O.Due;
+			LateCount += Entry.bLate ? 1 : 0;
+			
+			if (bDispatchAgainstPlan)
+			{
+				FPraxisOrderState& S = *FindOrder(O.WorkOrderID);
+				DequeuePending(O.WorkOrderID, S);
+				S.PlannedOn = M.MachineId;
+				S.Arrival = O.Arrival;
+				++PlannedPendingCount;
+				PlannedQueues.FindOrAdd(M.MachineId).WorkOrders.Add(O.WorkOrderID);
+			}
+		}
+	}
+	
+	UE_LOG(LogPraxisSim, Log, 
+		TEXT("Built %s plan: %d work orders on %d machines, %d late, in %.1f ms"), 
+		bForward ? TEXT("forward") : TEXT("backward"),
+		Plan.Num(), Machines.Num(), LateCount,
+		(FPlatformTime::Seconds() - BuildStartSeconds) * 1000.0);
+	
+	// Machines already waiting start on their planned work
+	if (bDispatchAgainstPlan)
+	{
+		for (const FName MachineId : IdleMachines.Array())
+		{
+			TryAssignToMachine(MachineId);
+		}
+	}
+	
+	return Plan.Num();
 }
 
-void UPraxisScheduleService::GetSchedule(TArray<FPraxisWorkOrder>& OutAll) const
+void UPraxisScheduleService::ClearPlan()
 {
-	OutAll.Reset();
-	for (const auto& KVP : Orders) 
+	// Orders the plan still holds go back to the dispatch rule where they were before planning
+	TArray<TPair<int64, FPraxisDispatchQueue::FKey>> Keys;
+	TArray<uint64> Arrivals;
+	Keys.Reserve(PlannedPendingCount);
+	Arrivals.Reserve(PlannedPendingCount);
+	for (const TPair<FName, FPraxisPlannedQueue>& KVP : PlannedQueues)
 	{
-		OutAll.Add(KVP.Value.WorkOrder);
+		ReturnPlannedWorkOrders(KVP.Key, KVP.Value, Keys, Arrivals);
 	}
+	PendingQueue.Append(Keys, Arrivals);
+	
+	PlannedQueues.Empty();
+	PlannedPendingCount = 0;
+	Plan.Empty();
 }
 
-int32 UPraxisScheduleService::GetPendingWorkOrderCount() const
+void UPraxisScheduleService::ReturnPlannedWorkOrders(FName MachineId, const FPraxisPlannedQueue& Queue, TArray<TPair<int64, FPraxisDispatchQueue::FKey>>& OutKeys, TArray<uint64>& OutArrivals)
+{
+	for (int32 Index = Queue.Next; Index < Queue.WorkOrders.Num(); ++Index)
+	{
+		FPraxisOrderState* S = FindOrder(Queue.WorkOrders[Index]);
+		if (S && S->PlannedOn == MachineId)
+		{
+			S->PlannedOn = NAME_None;
+			--PlannedPendingCount;
+			OutKeys.Emplace(Queue.WorkOrders[Index], ComputeDispatchKey(*S, PendingKeyedAt));
+			OutArrivals.Add(S->Arrival);
+			PendingProcessSeconds += S->ProcessSeconds;
+			bPendingMeanStale = true;
+		}
+	}
+}
+
+void UPraxisScheduleService::ReturnAssignedWorkOrders(FName MachineId, TArray<TPair<int64, FPraxisDispatchQueue::FKey>>& OutKeys, TArray<uint64>& OutArrivals)
 {
-	return UnassignedWorkOrders.Num();
+	const FPraxisMachineQueue* Q = MachineQueues.Find(MachineId);
+	int32 Slot = Q ? Q->Head : INDEX_NONE;
+	while (Slot != INDEX_NONE)
+	{
+		FPraxisOrderState& S = Orders[Slot];
+		const int32 Next = S.QueueNext;
+		if (S.Status == 0) // Queued, not started
+		{
+			UnlinkFromMachine(Slot);
+			S.MachineId = NAME_None;
+			OutKeys.Emplace(S.WorkOrder.WorkOrderID, ComputeDispatchKey(S, PendingKeyedAt));
+			OutArrivals.Add(S.Arrival);
+			PendingProcessSeconds += S.ProcessSeconds;
+			bPendingMeanStale = true;
+		}
+		Slot = Next;
+	}
+}
+
+void UPraxisScheduleService::GetPlanForMachine(FName MachineId, TArray<FPraxisPlannedOperation>& OutPlan) const
+{
+	OutPlan.Reset();
+	for (const FPraxisPlannedOperation& Entry : Plan)
+	{
+		if (Entry.MachineId == MachineId)
+		{
+			OutPlan.Add(Entry);
+		}
+	}
 }
 
 // ════════════════════════════════════════════════════════════════════════════════
@@ -146,7 +593,8 @@ int32 UPraxisScheduleService::GetPendingWorkOrderCount() const
 
 bool UPraxisScheduleService::StartWorkOrder(int64 WorkOrderID, FName MachineId)
 {
-	if (FPraxisOrderState* S = Orders.Find(WorkOrderID))
+	FPraxisOrderState* S = FindOrder(WorkOrderID);
+	if (S && S->Status != 3) // Not cancelled
 	{
 		S->Status = 1; // Running
 		S->MachineId = MachineId; 
@@ -164,19 +612,28 @@ bool UPraxisScheduleService::StartWorkOrder(int64 WorkOrderID, FName MachineId)
 
 bool UPraxisScheduleService::CompleteWorkOrder(int64 WorkOrderID)
 {
-	if (FPraxisOrderState* S = Orders.Find(WorkOrderID))
+	const int32* Slot = OrderSlots.Find(WorkOrderID);
+	if (Slot && Orders[*Slot].Status != 3) // Not cancelled
 	{
-		S->Status = 2; // Done
-		S->EndTs = NowUnixSeconds();
+		FPraxisOrderState& S = Orders[*Slot];
+		S.Status = 2; // Done
+		S.EndTs = NowUnixSeconds();
+		
+		// Completed without being dispatched (e.g. reported externally): it leaves the queues too
+		DequeuePending(WorkOrderID, S);
+		UnlinkFromMachine(*Slot);
+		
+		// Listeners may add orders, which can move the state table
+		const FName MachineId = S.MachineId;
 		
 		UE_LOG(LogPraxisSim, Log, 
 			TEXT("Work order %lld completed on machine %s"), 
-			WorkOrderID, *S->MachineId.ToString());
+			WorkOrderID, *MachineId.ToString());
 		
 		OnWorkOrderCompleted.Broadcast(WorkOrderID);
 		
 		// Try to assign next work order to the now-idle machine
-		TryAssignToMachine(S->MachineId);
+		TryAssignToMachine(MachineId);
 		
 		return true;
 	}
@@ -189,9 +646,54 @@ bool UPraxisScheduleService::CompleteWorkOrder(int64 WorkOrderID)
 
 void UPraxisScheduleService::RegisterMachine(FName MachineId)
 {
-	if (!RegisteredMachines.Contains(MachineId))
+	AddMachine(MachineId, TWeakInterfacePtr<IPraxisMachine>());
+}
+
+void UPraxisScheduleService::RegisterMachine(FName MachineId, IPraxisMachine& Machine)
+{
+	AddMachine(MachineId, TWeakInterfacePtr<IPraxisMachine>(&Machine));
+}
+
+void UPraxisScheduleService::UnregisterMachine(FName MachineId)
+{
+	if (RegisteredMachines.Remove(MachineId) > 0)
+	{
+		IdleMachines.Remove(MachineId);
+		
+		// Work planned or assigned to the machine but not started goes back to the dispatch
+		// rule at its original arrival, for the machines still here
+		TArray<TPair<int64, FPraxisDispatchQueue::FKey>> Keys;
+		TArray<uint64> Arrivals;
+		FPraxisPlannedQueue PlannedQueue;
+		if (PlannedQueues.RemoveAndCopyValue(MachineId, PlannedQueue))
+		{
+			ReturnPlannedWorkOrders(MachineId, PlannedQueue, Keys, Arrivals);
+			Plan.RemoveAll([MachineId](const FPraxisPlannedOperation& Entry) { return Entry.MachineId == MachineId; });
+		}
+		ReturnAssignedWorkOrders(MachineId, Keys, Arrivals);
+		PendingQueue.Append(Keys, Arrivals);
+		
+		UE_LOG(LogPraxisSim, Log, 
+			TEXT("Machine %s unregistered from schedule service"), 
+			*MachineId.ToString());
+		
+		TryAssignPendingWorkOrders();
+	}
+}
+
+void UPraxisScheduleService::AddMachine(FName MachineId, TWeakInterfacePtr<IPraxisMachine> Receiver)
+{
+	const bool bNew = !RegisteredMachines.Contains(MachineId);
+	
+	// Set the receiver before assigning so the first work order reaches it
+	TWeakInterfacePtr<IPraxisMachine>& Entry = RegisteredMachines.FindOrAdd(MachineId);
+	if (Receiver.IsValid())
+	{
+		Entry = Receiver;
+	}
+	
+	if (bNew)
 	{
-		RegisteredMachines.Add(MachineId);
 		MachineQueues.FindOrAdd(MachineId);
 		
 		UE_LOG(LogPraxisSim, Log, 
@@ -214,105 +716,302 @@ void UPraxisScheduleService::NotifyMachineIdle(FName MachineId)
 
 void UPraxisScheduleService::TryAssignToMachine(FName MachineId)
 {
-	// Get next unassigned work order
-	if (UnassignedWorkOrders.Num() == 0)
+	// Orders only go to machines that are here to run them
+	if (!RegisteredMachines.Contains(MachineId))
+	{
+		return;
+	}
+	
+	// Get the machine's next planned work order, else the next unassigned one
+	int64 WorkOrderID = 0;
+	if (!TakePlannedWorkOrder(MachineId, WorkOrderID) && !TakePendingWorkOrder(WorkOrderID))
 	{
 		UE_LOG(LogPraxisSim, Verbose, 
 			TEXT("No pending work orders to assign to %s"), 
 			*MachineId.ToString());
+		
+		// Wait for the next order to come in
+		IdleMachines.Add(MachineId);
 		return;
 	}
+	IdleMachines.Remove(MachineId);
 	
-	// Get first unassigned work order (FIFO)
-	const int64 WorkOrderID = UnassignedWorkOrders[0];
-	UnassignedWorkOrders.RemoveAt(0);
-	
-	if (FPraxisOrderState* S = Orders.Find(WorkOrderID))
+	if (const int32* Slot = OrderSlots.Find(WorkOrderID))
 	{
+		FPraxisOrderState* S = &Orders[*Slot];
+		
 		// Assign to machine
 		S->MachineId = MachineId;
-		MachineQueues.FindOrAdd(MachineId).Add(WorkOrderID);
+		LinkToMachine(*Slot, MachineId);
+		
+		// Listeners may add orders, which can move the state table
+		const FPraxisWorkOrder WorkOrder = S->WorkOrder;
 		
 		UE_LOG(LogPraxisSim, Log, 
 			TEXT("Assigned work order %lld (SKU: %s, Qty: %d) to machine %s"),
 			WorkOrderID, 
-			*S->WorkOrder.SKU, 
-			S->WorkOrder.Quantity,
+			*WorkOrder.SKU, 
+			WorkOrder.Quantity,
 			*MachineId.ToString());
 		
 		OnWorkOrderAssigned.Broadcast(WorkOrderID, MachineId);
 		
 		// Notify the machine via MachineLogicComponent
-		NotifyMachineOfAssignment(MachineId, S->WorkOrder);
+		NotifyMachineOfAssignment(MachineId, WorkOrder);
 	}
 }
 
-void UPraxisScheduleService::TryAssignPendingWorkOrders()
+bool UPraxisScheduleService::TakePlannedWorkOrder(FName MachineId, int64& OutWorkOrderID)
 {
-	// Try to assign work orders to all registered idle machines
-	for (const FName& MachineId : RegisteredMachines)
+	FPraxisPlannedQueue* Q = PlannedQueues.Find(MachineId);
+	if (!Q)
 	{
-		if (UnassignedWorkOrders.Num() == 0)
-		{
-			break; // No more work orders to assign
-		}
+		return false;
+	}
+	
+	while (Q->Next < Q->WorkOrders.Num())
+	{
+		const int64 WorkOrderID = Q->WorkOrders[Q->Next++];
 		
-		// Check if machine already has queued work
-		const TArray<int64>* MachineQueue = MachineQueues.Find(MachineId);
-		if (!MachineQueue || MachineQueue->Num() == 0)
+		// Skip orders removed, cancelled or re-added since planning
+		FPraxisOrderState* S = FindOrder(WorkOrderID);
+		if (S && S->PlannedOn == MachineId)
 		{
-			// Machine is idle, assign work
-			TryAssignToMachine(MachineId);
+			S->PlannedOn = NAME_None;
+			--PlannedPendingCount;
+			OutWorkOrderID = WorkOrderID;
+			return true;
 		}
 	}
+	return false;
 }
 
-void UPraxisScheduleService::NotifyMachineOfAssignment(FName MachineId, const FPraxisWorkOrder& WorkOrder)
+bool UPraxisScheduleService::TakePendingWorkOrder(int64& OutWorkOrderID)
 {
-	// Find the machine actor and call AssignWorkOrder using reflection
-	// This avoids circular dependency by not including MachineLogicComponent.h
-	if (UWorld* World = GetWorld())
+	if (PendingQueue.Num() == 0)
 	{
-		for (TActorIterator<AActor> It(World); It; ++It)
-		{
-			// Find MachineLogicComponent by class name (reflection)
-			UActorComponent* Component = It->FindComponentByClass(
-				FindObject<UClass>(nullptr, TEXT("/Script/PraxisSimulationKernel.MachineLogicComponent"))
-			);
-			
-			if (Component)
-			{
-				// Check if MachineId matches using reflection
-				FName* CompMachineId = Component->GetClass()->FindPropertyByName(TEXT("MachineId"))->ContainerPtrToValuePtr<FName>(Component);
-				
-				if (CompMachineId && *CompMachineId == MachineId)
-				{
-					// Call AssignWorkOrder using reflection
-					UFunction* Func = Component->FindFunction(TEXT("AssignWorkOrder"));
-					if (Func)
-					{
-						struct
-						{
-							int64 WorkOrderId;
-							FString SKU;
-							int32 Quantity;
-						} Params;
-						
-						Params.WorkOrderId = WorkOrder.WorkOrderID;
-						Params.SKU = WorkOrder.SKU;
-						Params.Quantity = WorkOrder.Quantity;
-						
-						Component->ProcessEvent(Func, &Params);
-						return;
-					}
-				}
-			}
-		}
+		return false;
+	}
+	
+	// Keys taken at another time, or (ATC) against a pending set that has since been added to or removed from
+	if ((IsDispatchRuleTimeDependent() && PendingKeyedAt != NowUnixSeconds())
+		|| (DispatchRule == EPraxisDispatchRule::ATC && bPendingMeanStale))
+	{
+		RekeyPending();
+	}
+	
+	// The unassigned work order the dispatch rule puts first
+	uint64 Arrival = 0;
+	PendingQueue.Pop(OutWorkOrderID, Arrival);
+	if (FPraxisOrderState* S = FindOrder(OutWorkOrderID))
+	{
+		PendingProcessSeconds -= S->ProcessSeconds;
+		S->Arrival = Arrival;
+	}
+	return true;
+}
+
+void UPraxisScheduleService::TryAssignPendingWorkOrders()
+{
+	// Each pass takes one idle machine out of the set, so this is O(min(pending, idle))
+	while (PendingQueue.Num() > 0 && IdleMachines.Num() > 0)
+	{
+		TSet<FName>::TIterator It = IdleMachines.CreateIterator();
+		const FName MachineId = *It;
+		It.RemoveCurrent();
 		
-		UE_LOG(LogPraxisSim, Warning, 
-			TEXT("Could not find machine actor for MachineId: %s"), 
+		TryAssignToMachine(MachineId);
+	}
+}
+
+void UPraxisScheduleService::NotifyMachineOfAssignment(FName MachineId, const FPraxisWorkOrder& WorkOrder)
+{
+	const TWeakInterfacePtr<IPraxisMachine>* Machine = RegisteredMachines.Find(MachineId);
+	if (!Machine || !Machine->IsValid())
+	{
+		// Polling machines pick the order up through GetNextForMachine
+		UE_LOG(LogPraxisSim, Verbose, 
+			TEXT("No machine receiver registered for MachineId: %s"), 
 			*MachineId.ToString());
+		return;
+	}
+	
+	Machine->Get()->AssignWorkOrder(WorkOrder.WorkOrderID, WorkOrder.SKU, WorkOrder.Quantity);
+}
+
+// ════════════════════════════════════════════════════════════════════════════════
+// Order Slots & Machine Queues
+// ════════════════════════════════════════════════════════════════════════════════
+
+FPraxisOrderState* UPraxisScheduleService::FindOrder(int64 WorkOrderID)
+{
+	const int32* Slot = OrderSlots.Find(WorkOrderID);
+	return Slot ? &Orders[*Slot] : nullptr;
+}
+
+const FPraxisOrderState* UPraxisScheduleService::FindOrder(int64 WorkOrderID) const
+{
+	const int32* Slot = OrderSlots.Find(WorkOrderID);
+	return Slot ? &Orders[*Slot] : nullptr;
+}
+
+void UPraxisScheduleService::LinkToMachine(int32 Slot, FName MachineId)
+{
+	if (!RegisteredMachines.Contains(MachineId))
+	{
+		return;
 	}
+	
+	UnlinkFromMachine(Slot);
+	
+	FPraxisMachineQueue& Q = MachineQueues.FindOrAdd(MachineId);
+	FPraxisOrderState& S = Orders[Slot];
+	S.QueuedOn = MachineId;
+	S.QueuePrev = Q.Tail;
+	S.QueueNext = INDEX_NONE;
+	
+	if (Q.Tail != INDEX_NONE)
+	{
+		Orders[Q.Tail].QueueNext = Slot;
+	}
+	else
+	{
+		Q.Head = Slot;
+	}
+	Q.Tail = Slot;
+	++Q.Num;
+}
+
+void UPraxisScheduleService::UnlinkFromMachine(int32 Slot)
+{
+	FPraxisOrderState& S = Orders[Slot];
+	if (S.QueuedOn.IsNone())
+	{
+		return;
+	}
+	
+	FPraxisMachineQueue& Q = MachineQueues.FindChecked(S.QueuedOn);
+	if (S.QueuePrev != INDEX_NONE)
+	{
+		Orders[S.QueuePrev].QueueNext = S.QueueNext;
+	}
+	else
+	{
+		Q.Head = S.QueueNext;
+	}
+	if (S.QueueNext != INDEX_NONE)
+	{
+		Orders[S.QueueNext].QueuePrev = S.QueuePrev;
+	}
+	else
+	{
+		Q.Tail = S.QueuePrev;
+	}
+	--Q.Num;
+	
+	S.QueuedOn = NAME_None;
+	S.QueuePrev = INDEX_NONE;
+	S.QueueNext = INDEX_NONE;
+}
+
+// ════════════════════════════════════════════════════════════════════════════════
+// Dispatch Keys
+// ════════════════════════════════════════════════════════════════════════════════
+
+double UPraxisScheduleService::EstimateProcessSeconds(const FPraxisWorkOrder& WorkOrder) const
+{
+	double Seconds = WorkOrder.Quantity;
+	if (const FPraxisOperationCodes* Op = RoutingOperations.Find(FName(*WorkOrder.SKU)))
+	{
+		Seconds = Op->SetupTime + Op->StandardTime * WorkOrder.Quantity + Op->TeardownTime;
+	}
+	
+	// Keep ratios finite for zero-quantity or untimed orders
+	return FMath::Max(Seconds, 1.0);
+}
+
+FPraxisDispatchQueue::FKey UPraxisScheduleService::ComputeDispatchKey(const FPraxisOrderState& State, int64 AtUnixSeconds) const
+{
+	const FPraxisWorkOrder& WO = State.WorkOrder;
+	const double Due = static_cast<double>(WO.DueDate.ToUnixTimestamp());
+	const double Process = State.ProcessSeconds;
+	
+	FPraxisDispatchQueue::FKey Key;
+	switch (DispatchRule)
+	{
+	case EPraxisDispatchRule::FIFO:
+		break; // Arrival order breaks the tie
+		
+	case EPraxisDispatchRule::EDD:
+		Key.Primary = Due;
+		break;
+		
+	case EPraxisDispatchRule::SPT:
+		Key.Primary = Process;
+		break;
+		
+	case EPraxisDispatchRule::CriticalRatio:
+		// Time left over work left; below 1 the order is already behind
+		Key.Primary = (Due - AtUnixSeconds) / Process;
+		Key.Secondary = Due;
+		break;
+		
+	case EPraxisDispatchRule::ATC:
+	{
+		// Weighted SPT, discounted by slack relative to the mean pending processing time as of
+		// the last re-key, so every key in the queue is scaled by the same mean
+		const double Weight = 1.0 + static_cast<uint8>(WO.Priority);
+		const double Slack = FMath::Max(Due - Process - AtUnixSeconds, 0.0);
+		Key.Primary = -(Weight / Process) * FMath::Exp(-Slack / (ATCLookahead * PendingMeanProcess));
+		Key.Secondary = Due;
+		break;
+	}
+		
+	case EPraxisDispatchRule::PriorityThenEDD:
+		Key.Primary = -static_cast<uint8>(WO.Priority);
+		Key.Secondary = Due;
+		break;
+	}
+	return Key;
+}
+
+void UPraxisScheduleService::EnqueuePending(int64 WorkOrderID, const FPraxisOrderState& State)
+{
+	PendingQueue.Push(WorkOrderID, ComputeDispatchKey(State, PendingKeyedAt));
+	PendingProcessSeconds += State.ProcessSeconds;
+	bPendingMeanStale = true;
+}
+
+void UPraxisScheduleService::DequeuePending(int64 WorkOrderID, FPraxisOrderState& State)
+{
+	if (PendingQueue.Remove(WorkOrderID))
+	{
+		PendingProcessSeconds -= State.ProcessSeconds;
+		bPendingMeanStale = true;
+	}
+	else if (!State.PlannedOn.IsNone())
+	{
+		// Its planned queue entry is skipped when reached
+		State.PlannedOn = NAME_None;
+		--PlannedPendingCount;
+	}
+}
+
+void UPraxisScheduleService::RekeyPending()
+{
+	PendingKeyedAt = NowUnixSeconds();
+	PendingMeanProcess = PendingQueue.Num() > 0 ? FMath::Max(PendingProcessSeconds / PendingQueue.Num(), 1.0) : 1.0;
+	bPendingMeanStale = false;
+	PendingQueue.Rekey([this](int64 WorkOrderID)
+	{
+		const FPraxisOrderState* S = FindOrder(WorkOrderID);
+		return S ? ComputeDispatchKey(*S, PendingKeyedAt) : FPraxisDispatchQueue::FKey();
+	});
+}
+
+bool UPraxisScheduleService::IsDispatchRuleTimeDependent() const
+{
+	return DispatchRule == EPraxisDispatchRule::CriticalRatio || DispatchRule == EPraxisDispatchRule::ATC;
 }
 
 // ════════════════════════════════════════════════════════════════════════════════
@@ -362,6 +1061,14 @@ void UPraxisScheduleService::RegisterOperator(FName OperatorId)
 
 int64 UPraxisScheduleService::NowUnixSeconds() const
 {
-	// Placeholder - Orchestrator should provide sim time; swap in later
+	// Sim time, so time-dependent dispatch keys only move when the simulation does
+	const UGameInstance* GameInstance = GetGameInstance();
+	const UPraxisOrchestrator* Orchestrator = GameInstance ? GameInstance->GetSubsystem<UPraxisOrchestrator>() : nullptr;
+	if (Orchestrator && Orchestrator->GetSimDateTimeUTC().GetTicks() > 0)
+	{
+		return Orchestrator->GetSimDateTimeUTC().ToUnixTimestamp();
+	}
+	
+	// No clock running yet (or no orchestrator, as in tests)
 	return FDateTime::UtcNow().ToUnixTimestamp();
 }
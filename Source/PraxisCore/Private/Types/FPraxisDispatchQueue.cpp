@@ -0,0 +1,193 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Types/FPraxisDispatchQueue.h"
+
+void FPraxisDispatchQueue::Push(int64 WorkOrderId, const FKey& Key)
+{
+	Remove(WorkOrderId);
+
+	FNode Node;
+	Node.WorkOrderId = WorkOrderId;
+	Node.Key = Key;
+	Node.Arrival = NextArrival++;
+
+	const int32 Index = Heap.AddUninitialized();
+	Place(Index, Node);
+	SiftUp(Index);
+}
+
+void FPraxisDispatchQueue::Append(TConstArrayView<TPair<int64, FKey>> Entries)
+{
+	Heap.Reserve(Heap.Num() + Entries.Num());
+	Slots.Reserve(Slots.Num() + Entries.Num());
+
+	// Heap order is restored once at the end, whatever the removals below leave behind
+	for (const TPair<int64, FKey>& Entry : Entries)
+	{
+		AddNode(Entry.Key, Entry.Value, NextArrival++);
+	}
+	Heapify();
+}
+
+void FPraxisDispatchQueue::Append(TConstArrayView<TPair<int64, FKey>> Entries, TConstArrayView<uint64> Arrivals)
+{
+	check(Entries.Num() == Arrivals.Num());
+
+	Heap.Reserve(Heap.Num() + Entries.Num());
+	Slots.Reserve(Slots.Num() + Entries.Num());
+
+	for (int32 Index = 0; Index < Entries.Num(); ++Index)
+	{
+		AddNode(Entries[Index].Key, Entries[Index].Value, Arrivals[Index]);
+	}
+	Heapify();
+}
+
+bool FPraxisDispatchQueue::Pop(int64& OutWorkOrderId)
+{
+	uint64 Arrival = 0;
+	return Pop(OutWorkOrderId, Arrival);
+}
+
+bool FPraxisDispatchQueue::Pop(int64& OutWorkOrderId, uint64& OutArrival)
+{
+	if (Heap.Num() == 0)
+	{
+		return false;
+	}
+
+	OutWorkOrderId = Heap[0].WorkOrderId;
+	OutArrival = Heap[0].Arrival;
+	Remove(OutWorkOrderId);
+	return true;
+}
+
+bool FPraxisDispatchQueue::Update(int64 WorkOrderId, const FKey& Key)
+{
+	const int32* Index = Slots.Find(WorkOrderId);
+	if (!Index)
+	{
+		return false;
+	}
+
+	const int32 Start = *Index;
+	Heap[Start].Key = Key;
+	SiftUp(Start);
+	SiftDown(Slots[WorkOrderId]);
+	return true;
+}
+
+bool FPraxisDispatchQueue::Remove(int64 WorkOrderId)
+{
+	int32 Index = INDEX_NONE;
+	if (!Slots.RemoveAndCopyValue(WorkOrderId, Index))
+	{
+		return false;
+	}
+
+	// Move the last node into the hole and let it settle whichever way it needs to
+	const FNode Last = Heap.Pop(EAllowShrinking::No);
+	if (Index < Heap.Num())
+	{
+		Place(Index, Last);
+		SiftUp(Index);
+		SiftDown(Slots[Last.WorkOrderId]);
+	}
+	return true;
+}
+
+void FPraxisDispatchQueue::Rekey(TFunctionRef<FKey(int64 WorkOrderId)> KeyOf)
+{
+	for (FNode& Node : Heap)
+	{
+		Node.Key = KeyOf(Node.WorkOrderId);
+	}
+	Heapify();
+}
+
+void FPraxisDispatchQueue::Reset()
+{
+	Heap.Reset();
+	Slots.Reset();
+	NextArrival = 0;
+}
+
+bool FPraxisDispatchQueue::Before(const FNode& A, const FNode& B)
+{
+	if (A.Key.Primary != B.Key.Primary)
+	{
+		return A.Key.Primary < B.Key.Primary;
+	}
+	if (A.Key.Secondary != B.Key.Secondary)
+	{
+		return A.Key.Secondary < B.Key.Secondary;
+	}
+	return A.Arrival < B.Arrival;
+}
+
+void FPraxisDispatchQueue::AddNode(int64 WorkOrderId, const FKey& Key, uint64 Arrival)
+{
+	Remove(WorkOrderId);
+
+	FNode Node;
+	Node.WorkOrderId = WorkOrderId;
+	Node.Key = Key;
+	Node.Arrival = Arrival;
+	Place(Heap.AddUninitialized(), Node);
+}
+
+void FPraxisDispatchQueue::Heapify()
+{
+	// Floyd's heapify: sift down every parent, last first
+	for (int32 Index = Heap.Num() / 2 - 1; Index >= 0; --Index)
+	{
+		SiftDown(Index);
+	}
+}
+
+void FPraxisDispatchQueue::SiftUp(int32 Index)
+{
+	const FNode Node = Heap[Index];
+	while (Index > 0)
+	{
+		const int32 Parent = (Index - 1) / 2;
+		if (!Before(Node, Heap[Parent]))
+		{
+			break;
+		}
+		Place(Index, Heap[Parent]);
+		Index = Parent;
+	}
+	Place(Index, Node);
+}
+
+void FPraxisDispatchQueue::SiftDown(int32 Index)
+{
+	const FNode Node = Heap[Index];
+	const int32 Count = Heap.Num();
+	for (;;)
+	{
+		int32 Child = 2 * Index + 1;
+		if (Child >= Count)
+		{
+			break;
+		}
+		if (Child + 1 < Count && Before(Heap[Child + 1], Heap[Child]))
+		{
+			++Child;
+		}
+		if (!Before(Heap[Child], Node))
+		{
+			break;
+		}
+		Place(Index, Heap[Child]);
+		Index = Child;
+	}
+	Place(Index, Node);
+}
+
+void FPraxisDispatchQueue::Place(int32 Index, const FNode& Node)
+{
+	Heap[Index] = Node;
+	Slots.Add(Node.WorkOrderId, Index);
+}
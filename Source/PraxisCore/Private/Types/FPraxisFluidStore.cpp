@@ -0,0 +1,192 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Types/FPraxisFluidStore.h"
+
+double FPraxisFluidStore::FContainer::GetTimeToLimit() const
+{
+	if (NetRate > 0.0)
+	{
+		return (Capacity - Level) / NetRate;
+	}
+	if (NetRate < 0.0)
+	{
+		return Level / -NetRate;
+	}
+	return TNumericLimits<double>::Max();
+}
+
+int32 FPraxisFluidStore::AddContainer(FName ContainerId, FName LocationId, FName SKU, EPraxisUnitOfMeasure UnitOfMeasure, uint8 MaterialState, double Capacity, double InitialLevel)
+{
+	if (ContainerId.IsNone() || ContainerLookup.Contains(ContainerId))
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 Id = Containers.AddDefaulted();
+	FContainer& Container = Containers[Id];
+	Container.ContainerId = ContainerId;
+	Container.LocationId = LocationId;
+	Container.SKU = SKU;
+	Container.UnitOfMeasure = UnitOfMeasure;
+	Container.MaterialState = MaterialState;
+	Container.Capacity = FMath::Max(0.0, Capacity);
+	Container.Level = FMath::Clamp(InitialLevel, 0.0, Container.Capacity);
+
+	ContainerLookup.Add(ContainerId, Id);
+	ContainersBySKU.FindOrAdd(SKU).Add(Id);
+	ContainersByLocation.FindOrAdd(LocationId).Add(Id);
+	ActiveSlots.Add(INDEX_NONE);
+	return Id;
+}
+
+void FPraxisFluidStore::SetFlow(int32 Id, FName FlowId, int64 WorkOrderId, double Rate)
+{
+	FContainer& Container = Containers[Id];
+
+	const int32 Index = Container.Flows.IndexOfByPredicate([FlowId](const FFlow& Flow) { return Flow.FlowId == FlowId; });
+	if (Rate == 0.0)
+	{
+		if (Index == INDEX_NONE)
+		{
+			return;
+		}
+		Container.Flows.RemoveAtSwap(Index, EAllowShrinking::No);
+	}
+	else
+	{
+		FFlow& Flow = Index != INDEX_NONE ? Container.Flows[Index] : Container.Flows.AddDefaulted_GetRef();
+		Flow.FlowId = FlowId;
+		Flow.WorkOrderId = WorkOrderId;
+		Flow.Rate = Rate;
+	}
+
+	RefreshNetRate(Id);
+}
+
+double FPraxisFluidStore::GetFlowRate(int32 Id, FName FlowId) const
+{
+	const FFlow* Flow = Containers[Id].Flows.FindByPredicate([FlowId](const FFlow& Flow) { return Flow.FlowId == FlowId; });
+	return Flow ? Flow->Rate : 0.0;
+}
+
+int32 FPraxisFluidStore::ClearFlows(FName FlowId)
+{
+	// Balanced containers hold flows too, so this can't be limited to the active list
+	int32 Touched = 0;
+	for (int32 Id = 0; Id < Containers.Num(); ++Id)
+	{
+		if (GetFlowRate(Id, FlowId) != 0.0)
+		{
+			SetFlow(Id, FlowId, 0, 0.0);
+			++Touched;
+		}
+	}
+	return Touched;
+}
+
+double FPraxisFluidStore::Move(int32 Id, double Amount)
+{
+	FContainer& Container = Containers[Id];
+	const double NewLevel = FMath::Clamp(Container.Level + Amount, 0.0, Container.Capacity);
+	const double Moved = NewLevel - Container.Level;
+	Container.Level = NewLevel;
+	return Moved;
+}
+
+void FPraxisFluidStore::Advance(double Seconds, TArray<FLevelChange>& OutChanges, TArray<FLimitEvent>& OutLimits)
+{
+	if (Seconds <= 0.0)
+	{
+		return;
+	}
+
+	// Limits can remove containers from the active list; walk backwards so swap-removes don't skip any
+	for (int32 Slot = ActiveContainers.Num() - 1; Slot >= 0; --Slot)
+	{
+		const int32 Id = ActiveContainers[Slot];
+		FContainer& Container = Containers[Id];
+
+		const double OldLevel = Container.Level;
+		const double TimeToLimit = Container.GetTimeToLimit();
+		if (TimeToLimit > Seconds)
+		{
+			Container.Level = Container.ProjectLevel(Seconds);
+		}
+		else
+		{
+			// Hit a limit: stop whatever pushes past it (inflows at full, draws at empty)
+			const bool bFull = Container.NetRate > 0.0;
+			for (int32 i = Container.Flows.Num() - 1; i >= 0; --i)
+			{
+				if (bFull ? Container.Flows[i].Rate > 0.0 : Container.Flows[i].Rate < 0.0)
+				{
+					Container.Flows.RemoveAtSwap(i, EAllowShrinking::No);
+				}
+			}
+			RefreshNetRate(Id);
+
+			// The remaining flows run for the rest of the step from the limit
+			const double HitTime = FMath::Max(0.0, TimeToLimit);
+			Container.Level = bFull ? Container.Capacity : 0.0;
+			Container.Level = Container.ProjectLevel(Seconds - HitTime);
+
+			OutLimits.Add({ Id, bFull, HitTime });
+		}
+
+		if (Container.Level != OldLevel)
+		{
+			OutChanges.Add({ Id, Container.Level - OldLevel });
+		}
+	}
+}
+
+TConstArrayView<int32> FPraxisFluidStore::GetContainersForSKU(FName SKU) const
+{
+	const TArray<int32>* Ids = ContainersBySKU.Find(SKU);
+	return Ids ? TConstArrayView<int32>(*Ids) : TConstArrayView<int32>();
+}
+
+TConstArrayView<int32> FPraxisFluidStore::GetContainersAtLocation(FName LocationId) const
+{
+	const TArray<int32>* Ids = ContainersByLocation.Find(LocationId);
+	return Ids ? TConstArrayView<int32>(*Ids) : TConstArrayView<int32>();
+}
+
+void FPraxisFluidStore::RefreshNetRate(int32 Id)
+{
+	FContainer& Container = Containers[Id];
+
+	Container.NetRate = 0.0;
+	for (const FFlow& Flow : Container.Flows)
+	{
+		Container.NetRate += Flow.Rate;
+	}
+
+	// Balanced flows leave the level unchanged: no need to visit the container
+	const bool bActive = Container.NetRate != 0.0;
+	int32& Slot = ActiveSlots[Id];
+	if (bActive && Slot == INDEX_NONE)
+	{
+		Slot = ActiveContainers.Add(Id);
+	}
+	else if (!bActive && Slot != INDEX_NONE)
+	{
+		const int32 LastId = ActiveContainers.Last();
+		ActiveContainers.RemoveAtSwap(Slot, EAllowShrinking::No);
+		if (LastId != Id)
+		{
+			ActiveSlots[LastId] = Slot;
+		}
+		Slot = INDEX_NONE;
+	}
+}
+
+void FPraxisFluidStore::Reset()
+{
+	Containers.Reset();
+	ContainerLookup.Reset();
+	ContainersBySKU.Reset();
+	ContainersByLocation.Reset();
+	ActiveContainers.Reset();
+	ActiveSlots.Reset();
+}
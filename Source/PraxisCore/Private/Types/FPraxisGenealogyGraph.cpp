@@ -0,0 +1,351 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Types/FPraxisGenealogyGraph.h"
+
+namespace PraxisGenealogy
+{
+	/** Child links pending before the child CSR is rebuilt, at least */
+	constexpr int32 MinPendingChildLinks = 1024;
+}
+
+template<typename NeighbourFunc>
+void FPraxisGenealogyGraph::Trace(uint32 Id, TArray<uint32>& OutVisited, NeighbourFunc&& ForEachNeighbour) const
+{
+	OutVisited.Reset();
+	if (!IsValidId(Id))
+	{
+		return;
+	}
+
+	TBitArray<> Seen(false, Guids.Num());
+	Seen[Id] = true;
+
+	// OutVisited doubles as the BFS queue
+	int32 Cursor = 0;
+	uint32 Current = Id;
+	while (true)
+	{
+		ForEachNeighbour(Current, [&Seen, &OutVisited](uint32 Next)
+		{
+			if (!Seen[Next])
+			{
+				Seen[Next] = true;
+				OutVisited.Add(Next);
+			}
+		});
+
+		if (Cursor >= OutVisited.Num())
+		{
+			break;
+		}
+		Current = OutVisited[Cursor++];
+	}
+}
+
+uint32 FPraxisGenealogyGraph::AddBatch(const FGuid& Guid, FName SKU, uint8 MaterialState, double CreationTime, TConstArrayView<uint32> Parents, double ExpiryTime)
+{
+	if (const uint32* Existing = IdByGuid.Find(Guid))
+	{
+		return *Existing;
+	}
+
+	const uint32 Id = static_cast<uint32>(Guids.Add(Guid));
+	SKUs.Add(SKU);
+	MaterialStates.Add(MaterialState);
+	CreationTimes.Add(CreationTime);
+	ExpiryTimes.Add(ExpiryTime);
+	CreationOrders.Add(NextCreationOrder++);
+	SourceMachines.Add(NAME_None);
+	SourceWorkOrders.Add(0);
+	Flags.Add(0);
+
+	const int32 FirstEdge = ParentOffsets[Id];
+	for (const uint32 Parent : Parents)
+	{
+		// Parents precede children, which keeps the graph acyclic
+		if (Parent >= Id)
+		{
+			continue;
+		}
+
+		bool bDuplicate = false;
+		for (int32 Edge = FirstEdge; Edge < ParentEdges.Num() && !bDuplicate; ++Edge)
+		{
+			bDuplicate = ParentEdges[Edge] == Parent;
+		}
+		if (!bDuplicate)
+		{
+			ParentEdges.Add(Parent);
+		}
+	}
+	ParentOffsets.Add(ParentEdges.Num());
+
+	// Child side: append to each parent's list of children added since the last rebuild
+	ChildLinkHeads.Add(INDEX_NONE);
+	ChildLinkTails.Add(INDEX_NONE);
+	MergeLinkHeadsByParent.Add(INDEX_NONE);
+	MergeLinkHeadsByChild.Add(INDEX_NONE);
+	for (int32 Edge = FirstEdge; Edge < ParentEdges.Num(); ++Edge)
+	{
+		const uint32 Parent = ParentEdges[Edge];
+		const int32 Link = ChildLinks.Add({ Id, INDEX_NONE });
+		if (ChildLinkTails[Parent] == INDEX_NONE)
+		{
+			ChildLinkHeads[Parent] = Link;
+		}
+		else
+		{
+			ChildLinks[ChildLinkTails[Parent]].Next = Link;
+		}
+		ChildLinkTails[Parent] = Link;
+	}
+
+	// Rebuild once the lists are a fair fraction of the graph, so the cost is amortized per edge
+	if (ChildLinks.Num() > FMath::Max(PraxisGenealogy::MinPendingChildLinks, (Guids.Num() + ParentEdges.Num()) / 2))
+	{
+		RebuildChildIndex();
+	}
+
+	IdByGuid.Add(Guid, Id);
+	return Id;
+}
+
+void FPraxisGenealogyGraph::AddMergedParents(uint32 Id, TConstArrayView<uint32> Parents)
+{
+	if (!IsValidId(Id))
+	{
+		return;
+	}
+
+	// A batch is merged away once, so no duplicate check beyond the creation parents
+	const TConstArrayView<uint32> CreationParents = GetParents(Id);
+	for (const uint32 Parent : Parents)
+	{
+		if (IsValidId(Parent) && Parent != Id && !CreationParents.Contains(Parent))
+		{
+			LinkMerge(Parent, Id);
+		}
+	}
+}
+
+void FPraxisGenealogyGraph::LinkMerge(uint32 Parent, uint32 Child)
+{
+	FMergeLink MergeLink;
+	MergeLink.Parent = Parent;
+	MergeLink.Child = Child;
+	MergeLink.NextOfParent = MergeLinkHeadsByParent[Parent];
+	MergeLink.NextOfChild = MergeLinkHeadsByChild[Child];
+
+	const int32 Link = MergeLinks.Add(MergeLink);
+	MergeLinkHeadsByParent[Parent] = Link;
+	MergeLinkHeadsByChild[Child] = Link;
+}
+
+void FPraxisGenealogyGraph::SetSource(uint32 Id, FName MachineId, int64 WorkOrderId)
+{
+	SourceMachines[Id] = MachineId;
+	SourceWorkOrders[Id] = WorkOrderId;
+}
+
+void FPraxisGenealogyGraph::SetMaterialState(uint32 Id, uint8 MaterialState, bool bPassedQuality)
+{
+	MaterialStates[Id] = MaterialState;
+	if (bPassedQuality)
+	{
+		Flags[Id] &= ~FlagFailedQuality;
+	}
+	else
+	{
+		Flags[Id] |= FlagFailedQuality;
+	}
+}
+
+void FPraxisGenealogyGraph::TraceBackward(uint32 Id, TArray<uint32>& OutAncestors) const
+{
+	Trace(Id, OutAncestors, [this](uint32 Node, auto&& Visit)
+	{
+		ForEachParent(Node, Visit);
+	});
+}
+
+void FPraxisGenealogyGraph::TraceForward(uint32 Id, TArray<uint32>& OutDescendants) const
+{
+	Trace(Id, OutDescendants, [this](uint32 Node, auto&& Visit)
+	{
+		ForEachChild(Node, Visit);
+	});
+}
+
+void FPraxisGenealogyGraph::RebuildChildIndex()
+{
+	const int32 NodeCount = Guids.Num();
+
+	// Counting sort of parent edges by parent id
+	ChildOffsets.Reset();
+	ChildOffsets.SetNumZeroed(NodeCount + 1);
+	for (const uint32 Parent : ParentEdges)
+	{
+		++ChildOffsets[Parent + 1];
+	}
+	for (int32 i = 0; i < NodeCount; ++i)
+	{
+		ChildOffsets[i + 1] += ChildOffsets[i];
+	}
+
+	ChildEdges.SetNumUninitialized(ParentEdges.Num());
+	TArray<int32> Cursor(ChildOffsets.GetData(), NodeCount);
+	for (int32 Child = 0; Child < NodeCount; ++Child)
+	{
+		for (int32 Edge = ParentOffsets[Child]; Edge < ParentOffsets[Child + 1]; ++Edge)
+		{
+			ChildEdges[Cursor[ParentEdges[Edge]]++] = static_cast<uint32>(Child);
+		}
+	}
+
+	ChildIndexedNum = NodeCount;
+	ChildLinks.Reset();
+	ChildLinkHeads.Init(INDEX_NONE, NodeCount);
+	ChildLinkTails.Init(INDEX_NONE, NodeCount);
+}
+
+int32 FPraxisGenealogyGraph::Compact(double Horizon, TFunctionRef<bool(uint32 Id)> IsRetained)
+{
+	const int32 NodeCount = Guids.Num();
+
+	// Carry retention up through every ancestor; merge edges can point to newer batches,
+	// so walk a worklist rather than relying on id order
+	TBitArray<> Retained(false, NodeCount);
+	TArray<uint32> Pending;
+	for (int32 Id = 0; Id < NodeCount; ++Id)
+	{
+		if (IsRetained(static_cast<uint32>(Id)))
+		{
+			Retained[Id] = true;
+			Pending.Add(static_cast<uint32>(Id));
+		}
+	}
+	while (Pending.Num() > 0)
+	{
+		ForEachParent(Pending.Pop(EAllowShrinking::No), [&Retained, &Pending](uint32 Parent)
+		{
+			if (!Retained[Parent])
+			{
+				Retained[Parent] = true;
+				Pending.Add(Parent);
+			}
+		});
+	}
+
+	// Survivors keep their relative order, so every new id is at most the old one
+	TArray<uint32> Remap;
+	Remap.SetNumUninitialized(NodeCount);
+	int32 Kept = 0;
+	for (int32 Id = 0; Id < NodeCount; ++Id)
+	{
+		const bool bKeep = Retained[Id] || CreationTimes[Id] >= Horizon;
+		Remap[Id] = bKeep ? static_cast<uint32>(Kept++) : InvalidId;
+	}
+
+	const int32 Dropped = NodeCount - Kept;
+	if (Dropped == 0)
+	{
+		return 0;
+	}
+
+	TArray<int32> NewParentOffsets;
+	TArray<uint32> NewParentEdges;
+	NewParentOffsets.Reserve(Kept + 1);
+	NewParentEdges.Reserve(ParentEdges.Num());
+	NewParentOffsets.Add(0);
+	IdByGuid.Reset();
+
+	for (int32 Id = 0; Id < NodeCount; ++Id)
+	{
+		const uint32 NewId = Remap[Id];
+		if (NewId == InvalidId)
+		{
+			continue;
+		}
+
+		// Moving down in place never overwrites a survivor not yet visited
+		Guids[NewId] = Guids[Id];
+		SKUs[NewId] = SKUs[Id];
+		MaterialStates[NewId] = MaterialStates[Id];
+		CreationTimes[NewId] = CreationTimes[Id];
+		ExpiryTimes[NewId] = ExpiryTimes[Id];
+		CreationOrders[NewId] = CreationOrders[Id];
+		SourceMachines[NewId] = SourceMachines[Id];
+		SourceWorkOrders[NewId] = SourceWorkOrders[Id];
+		Flags[NewId] = Flags[Id];
+		IdByGuid.Add(Guids[NewId], NewId);
+
+		// Edges to dropped parents go with them
+		for (int32 Edge = ParentOffsets[Id]; Edge < ParentOffsets[Id + 1]; ++Edge)
+		{
+			const uint32 NewParent = Remap[ParentEdges[Edge]];
+			if (NewParent != InvalidId)
+			{
+				NewParentEdges.Add(NewParent);
+			}
+		}
+		NewParentOffsets.Add(NewParentEdges.Num());
+	}
+
+	Guids.SetNum(Kept);
+	SKUs.SetNum(Kept);
+	MaterialStates.SetNum(Kept);
+	CreationTimes.SetNum(Kept);
+	ExpiryTimes.SetNum(Kept);
+	CreationOrders.SetNum(Kept);
+	SourceMachines.SetNum(Kept);
+	SourceWorkOrders.SetNum(Kept);
+	Flags.SetNum(Kept);
+	ParentOffsets = MoveTemp(NewParentOffsets);
+	ParentEdges = MoveTemp(NewParentEdges);
+
+	// Merge edges survive when both ends do
+	const TArray<FMergeLink> OldMergeLinks = MoveTemp(MergeLinks);
+	MergeLinks.Reset();
+	MergeLinkHeadsByParent.Init(INDEX_NONE, Kept);
+	MergeLinkHeadsByChild.Init(INDEX_NONE, Kept);
+	for (const FMergeLink& MergeLink : OldMergeLinks)
+	{
+		const uint32 NewParent = Remap[MergeLink.Parent];
+		const uint32 NewChild = Remap[MergeLink.Child];
+		if (NewParent != InvalidId && NewChild != InvalidId)
+		{
+			LinkMerge(NewParent, NewChild);
+		}
+	}
+
+	RebuildChildIndex();
+	return Dropped;
+}
+
+void FPraxisGenealogyGraph::Reset()
+{
+	Guids.Reset();
+	SKUs.Reset();
+	MaterialStates.Reset();
+	CreationTimes.Reset();
+	ExpiryTimes.Reset();
+	CreationOrders.Reset();
+	SourceMachines.Reset();
+	SourceWorkOrders.Reset();
+	Flags.Reset();
+	ParentOffsets.Reset();
+	ParentOffsets.Add(0);
+	ParentEdges.Reset();
+	ChildOffsets.Reset();
+	ChildOffsets.Add(0);
+	ChildEdges.Reset();
+	ChildIndexedNum = 0;
+	ChildLinks.Reset();
+	ChildLinkHeads.Reset();
+	ChildLinkTails.Reset();
+	MergeLinks.Reset();
+	MergeLinkHeadsByParent.Reset();
+	MergeLinkHeadsByChild.Reset();
+	NextCreationOrder = 0;
+	IdByGuid.Reset();
+}
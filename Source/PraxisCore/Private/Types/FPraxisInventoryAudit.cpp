@@ -0,0 +1,216 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Types/FPraxisInventoryAudit.h"
+
+namespace PraxisInventoryAudit
+{
+	/** Volumes are float sums built in different orders; allow for rounding */
+	bool VolumesMatch(double A, double B)
+	{
+		return FMath::Abs(A - B) <= FMath::Max(0.01, 1e-4 * FMath::Max(FMath::Abs(A), FMath::Abs(B)));
+	}
+
+	void AddFinding(TArray<FPraxisAuditFinding>& OutFindings, EPraxisAuditCheck Check, FMassEntityHandle Entity, FName SKU, FName LocationId, double Expected, double Actual)
+	{
+		FPraxisAuditFinding& Finding = OutFindings.AddDefaulted_GetRef();
+		Finding.Check = Check;
+		Finding.Entity = Entity;
+		Finding.SKU = SKU;
+		Finding.LocationId = LocationId;
+		Finding.Expected = Expected;
+		Finding.Actual = Actual;
+	}
+}
+
+const TCHAR* LexToString(EPraxisAuditCheck Check)
+{
+	switch (Check)
+	{
+	case EPraxisAuditCheck::StaleEntity:            return TEXT("StaleEntity");
+	case EPraxisAuditCheck::EntityNotIndexed:       return TEXT("EntityNotIndexed");
+	case EPraxisAuditCheck::EntityKeyMismatch:      return TEXT("EntityKeyMismatch");
+	case EPraxisAuditCheck::EntityQuantityMismatch: return TEXT("EntityQuantityMismatch");
+	case EPraxisAuditCheck::EntityVolumeMismatch:   return TEXT("EntityVolumeMismatch");
+	case EPraxisAuditCheck::LotIndexMismatch:       return TEXT("LotIndexMismatch");
+	case EPraxisAuditCheck::OverClaimed:            return TEXT("OverClaimed");
+	case EPraxisAuditCheck::SKUQuantityMismatch:    return TEXT("SKUQuantityMismatch");
+	case EPraxisAuditCheck::SKUReservedMismatch:    return TEXT("SKUReservedMismatch");
+	case EPraxisAuditCheck::SKUVolumeMismatch:      return TEXT("SKUVolumeMismatch");
+	case EPraxisAuditCheck::SKULocationMismatch:    return TEXT("SKULocationMismatch");
+	case EPraxisAuditCheck::LocationVolumeMismatch: return TEXT("LocationVolumeMismatch");
+	case EPraxisAuditCheck::LocationItemsMismatch:  return TEXT("LocationItemsMismatch");
+	}
+	return TEXT("Unknown");
+}
+
+void FPraxisAuditSlice::Run(TArray<FPraxisAuditFinding>& OutFindings) const
+{
+	for (const FPraxisAuditEntityRecord& Record : Entities)
+	{
+		AuditEntity(Record, OutFindings);
+	}
+
+	if (bAuditAggregates)
+	{
+		AuditAggregates(OutFindings);
+	}
+}
+
+void FPraxisAuditSlice::AuditEntity(const FPraxisAuditEntityRecord& Record, TArray<FPraxisAuditFinding>& OutFindings) const
+{
+	using namespace PraxisInventoryAudit;
+
+	const FPraxisMaterialStockKey& Key = Record.bIndexed ? Record.IndexKey : Record.FragmentKey;
+
+	if (!Record.bExists)
+	{
+		AddFinding(OutFindings, EPraxisAuditCheck::StaleEntity, Record.Entity, Key.SKU, Key.LocationId, Record.IndexQuantity, 0);
+		return;
+	}
+
+	if (!Record.bIndexed)
+	{
+		if (Record.FragmentQuantity > 0)
+		{
+			AddFinding(OutFindings, EPraxisAuditCheck::EntityNotIndexed, Record.Entity, Key.SKU, Key.LocationId, 0, Record.FragmentQuantity);
+		}
+		return;
+	}
+
+	if (!(Record.FragmentKey == Record.IndexKey))
+	{
+		AddFinding(OutFindings, EPraxisAuditCheck::EntityKeyMismatch, Record.Entity, Key.SKU, Key.LocationId, Record.IndexKey.MaterialState, Record.FragmentKey.MaterialState);
+	}
+
+	if (Record.FragmentQuantity != Record.IndexQuantity)
+	{
+		AddFinding(OutFindings, EPraxisAuditCheck::EntityQuantityMismatch, Record.Entity, Key.SKU, Key.LocationId, Record.IndexQuantity, Record.FragmentQuantity);
+	}
+
+	if (!VolumesMatch(Record.FragmentVolume, Record.IndexVolume))
+	{
+		AddFinding(OutFindings, EPraxisAuditCheck::EntityVolumeMismatch, Record.Entity, Key.SKU, Key.LocationId, Record.IndexVolume, Record.FragmentVolume);
+	}
+
+	const bool bPickable = !Record.IndexKey.bReserved && Record.IndexQuantity > 0;
+	if (bPickable != Record.bInLotIndex)
+	{
+		AddFinding(OutFindings, EPraxisAuditCheck::LotIndexMismatch, Record.Entity, Key.SKU, Key.LocationId, Record.bInLotIndex ? 1 : 0, bPickable ? 1 : 0);
+	}
+
+	if (Record.ClaimedQuantity > Record.FragmentQuantity)
+	{
+		AddFinding(OutFindings, EPraxisAuditCheck::OverClaimed, Record.Entity, Key.SKU, Key.LocationId, Record.ClaimedQuantity, Record.FragmentQuantity);
+	}
+}
+
+void FPraxisAuditSlice::AuditAggregates(TArray<FPraxisAuditFinding>& OutFindings) const
+{
+	using namespace PraxisInventoryAudit;
+
+	struct FSKUSums
+	{
+		int32 Quantity = 0;
+		int32 Reserved = 0;
+		double Volume = 0.0;
+		TMap<FName, int32> ByLocation;
+	};
+	struct FLocationSums
+	{
+		double Volume = 0.0;
+		int32 Items = 0;
+	};
+
+	// Recompute from the recounted stock
+	TMap<FName, FSKUSums> SKUSums;
+	TMap<FName, FLocationSums> LocationSums;
+	for (const TPair<FPraxisMaterialStockKey, FPraxisMaterialIndex::FStockTotals>& Pair : StockTotals)
+	{
+		const FPraxisMaterialStockKey& Key = Pair.Key;
+		const FPraxisMaterialIndex::FStockTotals& Totals = Pair.Value;
+
+		FSKUSums& Sums = SKUSums.FindOrAdd(Key.SKU);
+		Sums.Quantity += Totals.Quantity;
+		Sums.Volume += Totals.Volume;
+		Sums.ByLocation.FindOrAdd(Key.LocationId) += Totals.Quantity;
+		if (Key.bReserved)
+		{
+			Sums.Reserved += Totals.Quantity;
+		}
+
+		// Empty batches never take up capacity
+		if (Totals.Quantity > 0)
+		{
+			FLocationSums& Location = LocationSums.FindOrAdd(Key.LocationId);
+			Location.Volume += Totals.Volume;
+			Location.Items += Totals.Entities;
+		}
+	}
+	for (const TPair<FPraxisMaterialStockKey, int32>& Claimed : ClaimedTotals)
+	{
+		SKUSums.FindOrAdd(Claimed.Key.SKU).Reserved += Claimed.Value;
+	}
+
+	// Aggregate cache vs. recomputed
+	static const FSKUSums NoSums;
+	TSet<FName> CachedSKUs;
+	for (const FPraxisAuditSKURecord& Cached : SKUs)
+	{
+		CachedSKUs.Add(Cached.SKU);
+		const FSKUSums* Found = SKUSums.Find(Cached.SKU);
+		const FSKUSums& Sums = Found ? *Found : NoSums;
+
+		if (Cached.TotalQuantity != Sums.Quantity)
+		{
+			AddFinding(OutFindings, EPraxisAuditCheck::SKUQuantityMismatch, FMassEntityHandle(), Cached.SKU, NAME_None, Cached.TotalQuantity, Sums.Quantity);
+		}
+		if (Cached.ReservedQuantity != Sums.Reserved)
+		{
+			AddFinding(OutFindings, EPraxisAuditCheck::SKUReservedMismatch, FMassEntityHandle(), Cached.SKU, NAME_None, Cached.ReservedQuantity, Sums.Reserved);
+		}
+		if (!VolumesMatch(Cached.TotalVolume, Sums.Volume))
+		{
+			AddFinding(OutFindings, EPraxisAuditCheck::SKUVolumeMismatch, FMassEntityHandle(), Cached.SKU, NAME_None, Cached.TotalVolume, Sums.Volume);
+		}
+
+		// Locations on either side; a missing bucket counts as zero
+		TMap<FName, int32> Remaining = Sums.ByLocation;
+		for (const TPair<FName, int32>& Location : Cached.QuantityByLocation)
+		{
+			const int32 Actual = Remaining.FindRef(Location.Key);
+			Remaining.Remove(Location.Key);
+			if (Location.Value != Actual)
+			{
+				AddFinding(OutFindings, EPraxisAuditCheck::SKULocationMismatch, FMassEntityHandle(), Cached.SKU, Location.Key, Location.Value, Actual);
+			}
+		}
+		for (const TPair<FName, int32>& Location : Remaining)
+		{
+			if (Location.Value != 0)
+			{
+				AddFinding(OutFindings, EPraxisAuditCheck::SKULocationMismatch, FMassEntityHandle(), Cached.SKU, Location.Key, 0, Location.Value);
+			}
+		}
+	}
+	for (const TPair<FName, FSKUSums>& Pair : SKUSums)
+	{
+		if (!CachedSKUs.Contains(Pair.Key) && (Pair.Value.Quantity != 0 || Pair.Value.Reserved != 0))
+		{
+			AddFinding(OutFindings, EPraxisAuditCheck::SKUQuantityMismatch, FMassEntityHandle(), Pair.Key, NAME_None, 0, Pair.Value.Quantity);
+		}
+	}
+
+	// Location capacities vs. recomputed (only locations that track capacity)
+	for (const FPraxisAuditLocationRecord& Cached : Locations)
+	{
+		const FLocationSums Sums = LocationSums.FindRef(Cached.LocationId);
+		if (!VolumesMatch(Cached.CurrentVolume, Sums.Volume))
+		{
+			AddFinding(OutFindings, EPraxisAuditCheck::LocationVolumeMismatch, FMassEntityHandle(), NAME_None, Cached.LocationId, Cached.CurrentVolume, Sums.Volume);
+		}
+		if (Cached.CurrentItems != Sums.Items)
+		{
+			AddFinding(OutFindings, EPraxisAuditCheck::LocationItemsMismatch, FMassEntityHandle(), NAME_None, Cached.LocationId, Cached.CurrentItems, Sums.Items);
+		}
+	}
+}
@@ -0,0 +1,320 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Types/FPraxisMaterialIndex.h"
+
+template<typename KeyType>
+int32 FPraxisMaterialIndex::AddToBucket(
+	TMap<KeyType, TArray<FMassEntityHandle>>& Buckets,
+	const KeyType& Key,
+	FMassEntityHandle Entity)
+{
+	return Buckets.FindOrAdd(Key).Add(Entity);
+}
+
+template<typename KeyType>
+FMassEntityHandle FPraxisMaterialIndex::RemoveFromBucket(
+	TMap<KeyType, TArray<FMassEntityHandle>>& Buckets,
+	const KeyType& Key,
+	int32 Slot)
+{
+	TArray<FMassEntityHandle>* Bucket = Buckets.Find(Key);
+	if (!Bucket || !Bucket->IsValidIndex(Slot))
+	{
+		return FMassEntityHandle();
+	}
+
+	const int32 LastSlot = Bucket->Num() - 1;
+	const FMassEntityHandle Moved = (Slot != LastSlot) ? (*Bucket)[LastSlot] : FMassEntityHandle();
+	Bucket->RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+
+	if (Bucket->Num() == 0)
+	{
+		Buckets.Remove(Key);
+	}
+
+	return Moved;
+}
+
+void FPraxisMaterialIndex::AddStockTotals(const FPraxisMaterialStockKey& Key, int32 EntityDelta, int32 QuantityDelta, double VolumeDelta)
+{
+	FStockTotals& Totals = StockTotals.FindOrAdd(Key);
+	Totals.Entities += EntityDelta;
+	Totals.Quantity += QuantityDelta;
+	Totals.Volume += VolumeDelta;
+
+	if (Totals.Entities == 0)
+	{
+		StockTotals.Remove(Key);
+	}
+}
+
+void FPraxisMaterialIndex::Update(
+	FMassEntityHandle Entity,
+	const FPraxisMaterialStockKey& StockKey,
+	const FPraxisMaterialReservationKey* ReservationKey,
+	int32 Quantity,
+	float Volume,
+	const FPraxisLotSortKey& LotKey,
+	FName SubLocationId)
+{
+	FEntry* Entry = Entries.Find(Entity);
+	if (!Entry)
+	{
+		Entry = &Entries.Add(Entity);
+	}
+	
+	// Out of the lot heap while keys change; re-filed below if still pickable
+	RemoveLot(*Entry);
+
+	if (Entry->StockSlot != INDEX_NONE)
+	{
+		AddStockTotals(Entry->StockKey, -1, -Entry->Quantity, -Entry->Volume);
+	}
+	AddStockTotals(StockKey, 1, Quantity, Volume);
+
+	Entry->Quantity = Quantity;
+	Entry->Volume = Volume;
+	Entry->SubLocationId = SubLocationId;
+
+	// Stock index
+	if (Entry->StockSlot == INDEX_NONE || !(Entry->StockKey == StockKey))
+	{
+		if (Entry->StockSlot != INDEX_NONE)
+		{
+			const FMassEntityHandle Moved = RemoveFromBucket(StockBuckets, Entry->StockKey, Entry->StockSlot);
+			if (Moved.IsSet())
+			{
+				Entries.FindChecked(Moved).StockSlot = Entry->StockSlot;
+			}
+		}
+
+		Entry->StockKey = StockKey;
+		Entry->StockSlot = AddToBucket(StockBuckets, StockKey, Entity);
+	}
+
+	// Reservation index
+	const bool bWasReserved = Entry->IsReserved();
+	const bool bKeyChanged = ReservationKey && bWasReserved && !(Entry->ReservationKey == *ReservationKey);
+
+	if (bWasReserved && (!ReservationKey || bKeyChanged))
+	{
+		const FMassEntityHandle Moved = RemoveFromBucket(ReservationBuckets, Entry->ReservationKey, Entry->ReservationSlot);
+		if (Moved.IsSet())
+		{
+			Entries.FindChecked(Moved).ReservationSlot = Entry->ReservationSlot;
+		}
+		Entry->ReservationKey = FPraxisMaterialReservationKey();
+		Entry->ReservationSlot = INDEX_NONE;
+	}
+
+	if (ReservationKey && !Entry->IsReserved())
+	{
+		Entry->ReservationKey = *ReservationKey;
+		Entry->ReservationSlot = AddToBucket(ReservationBuckets, *ReservationKey, Entity);
+	}
+
+	// Lot index: unreserved stock that still holds something
+	Entry->LotKey = LotKey;
+	if (!Entry->IsReserved() && Quantity > 0)
+	{
+		AddLot(Entity, *Entry);
+	}
+}
+
+bool FPraxisMaterialIndex::Remove(FMassEntityHandle Entity)
+{
+	if (FEntry* Existing = Entries.Find(Entity))
+	{
+		RemoveLot(*Existing);
+	}
+
+	FEntry Entry;
+	if (!Entries.RemoveAndCopyValue(Entity, Entry))
+	{
+		return false;
+	}
+
+	if (Entry.StockSlot != INDEX_NONE)
+	{
+		AddStockTotals(Entry.StockKey, -1, -Entry.Quantity, -Entry.Volume);
+		
+		const FMassEntityHandle Moved = RemoveFromBucket(StockBuckets, Entry.StockKey, Entry.StockSlot);
+		if (Moved.IsSet())
+		{
+			Entries.FindChecked(Moved).StockSlot = Entry.StockSlot;
+		}
+	}
+
+	if (Entry.IsReserved())
+	{
+		const FMassEntityHandle Moved = RemoveFromBucket(ReservationBuckets, Entry.ReservationKey, Entry.ReservationSlot);
+		if (Moved.IsSet())
+		{
+			Entries.FindChecked(Moved).ReservationSlot = Entry.ReservationSlot;
+		}
+	}
+
+	return true;
+}
+
+TConstArrayView<FMassEntityHandle> FPraxisMaterialIndex::FindStock(const FPraxisMaterialStockKey& Key) const
+{
+	if (const TArray<FMassEntityHandle>* Bucket = StockBuckets.Find(Key))
+	{
+		return *Bucket;
+	}
+	return TConstArrayView<FMassEntityHandle>();
+}
+
+TConstArrayView<FMassEntityHandle> FPraxisMaterialIndex::FindReserved(const FPraxisMaterialReservationKey& Key) const
+{
+	if (const TArray<FMassEntityHandle>* Bucket = ReservationBuckets.Find(Key))
+	{
+		return *Bucket;
+	}
+	return TConstArrayView<FMassEntityHandle>();
+}
+
+FMassEntityHandle FPraxisMaterialIndex::PeekLot(FName SKU, FName LocationId) const
+{
+	const TArray<FMassEntityHandle>* Heap = LotHeaps.Find(FLotBucketKey(SKU, LocationId));
+	return Heap ? (*Heap)[0] : FMassEntityHandle();
+}
+
+void FPraxisMaterialIndex::VisitLots(FName SKU, FName LocationId, TFunctionRef<bool(FMassEntityHandle, const FEntry&)> Visitor) const
+{
+	const TArray<FMassEntityHandle>* Heap = LotHeaps.Find(FLotBucketKey(SKU, LocationId));
+	if (!Heap)
+	{
+		return;
+	}
+
+	// Best-first walk of the heap: a small frontier heap of slots yields lots in order
+	// without touching the index
+	auto FrontierLess = [this, Heap](int32 A, int32 B) { return LotLess((*Heap)[A], (*Heap)[B]); };
+
+	TArray<int32, TInlineAllocator<32>> Frontier;
+	Frontier.HeapPush(0, FrontierLess);
+	while (Frontier.Num() > 0)
+	{
+		int32 Slot;
+		Frontier.HeapPop(Slot, FrontierLess, EAllowShrinking::No);
+
+		const FMassEntityHandle Entity = (*Heap)[Slot];
+		if (!Visitor(Entity, Entries.FindChecked(Entity)))
+		{
+			return;
+		}
+
+		for (int32 Child = 2 * Slot + 1; Child <= 2 * Slot + 2 && Child < Heap->Num(); ++Child)
+		{
+			Frontier.HeapPush(Child, FrontierLess);
+		}
+	}
+}
+
+bool FPraxisMaterialIndex::LotLess(FMassEntityHandle A, FMassEntityHandle B) const
+{
+	const FPraxisLotSortKey& KeyA = Entries.FindChecked(A).LotKey;
+	const FPraxisLotSortKey& KeyB = Entries.FindChecked(B).LotKey;
+	if (KeyA < KeyB)
+	{
+		return true;
+	}
+	if (KeyB < KeyA)
+	{
+		return false;
+	}
+	return A.Index < B.Index;
+}
+
+void FPraxisMaterialIndex::AddLot(FMassEntityHandle Entity, FEntry& Entry)
+{
+	TArray<FMassEntityHandle>& Heap = LotHeaps.FindOrAdd(FLotBucketKey(Entry.StockKey.SKU, Entry.StockKey.LocationId));
+	Entry.LotSlot = Heap.Add(Entity);
+	SiftLotUp(Heap, Entry.LotSlot);
+}
+
+void FPraxisMaterialIndex::RemoveLot(FEntry& Entry)
+{
+	if (Entry.LotSlot == INDEX_NONE)
+	{
+		return;
+	}
+
+	const FLotBucketKey BucketKey(Entry.StockKey.SKU, Entry.StockKey.LocationId);
+	TArray<FMassEntityHandle>& Heap = LotHeaps.FindChecked(BucketKey);
+	const int32 Slot = Entry.LotSlot;
+	Entry.LotSlot = INDEX_NONE;
+
+	const FMassEntityHandle Last = Heap.Pop(EAllowShrinking::No);
+	if (Slot < Heap.Num())
+	{
+		// Move the last lot into the hole and restore heap order in whichever direction it needs
+		PlaceLot(Heap, Slot, Last);
+		SiftLotUp(Heap, Slot);
+		SiftLotDown(Heap, Entries.FindChecked(Last).LotSlot);
+	}
+
+	if (Heap.Num() == 0)
+	{
+		LotHeaps.Remove(BucketKey);
+	}
+}
+
+void FPraxisMaterialIndex::PlaceLot(TArray<FMassEntityHandle>& Heap, int32 Slot, FMassEntityHandle Entity)
+{
+	Heap[Slot] = Entity;
+	Entries.FindChecked(Entity).LotSlot = Slot;
+}
+
+void FPraxisMaterialIndex::SiftLotUp(TArray<FMassEntityHandle>& Heap, int32 Slot)
+{
+	const FMassEntityHandle Entity = Heap[Slot];
+	while (Slot > 0)
+	{
+		const int32 Parent = (Slot - 1) / 2;
+		if (!LotLess(Entity, Heap[Parent]))
+		{
+			break;
+		}
+		PlaceLot(Heap, Slot, Heap[Parent]);
+		Slot = Parent;
+	}
+	PlaceLot(Heap, Slot, Entity);
+}
+
+void FPraxisMaterialIndex::SiftLotDown(TArray<FMassEntityHandle>& Heap, int32 Slot)
+{
+	const FMassEntityHandle Entity = Heap[Slot];
+	const int32 Count = Heap.Num();
+	while (true)
+	{
+		int32 Smallest = Slot;
+		FMassEntityHandle SmallestEntity = Entity;
+		for (int32 Child = 2 * Slot + 1; Child <= 2 * Slot + 2 && Child < Count; ++Child)
+		{
+			if (LotLess(Heap[Child], SmallestEntity))
+			{
+				Smallest = Child;
+				SmallestEntity = Heap[Child];
+			}
+		}
+		if (Smallest == Slot)
+		{
+			break;
+		}
+		PlaceLot(Heap, Slot, SmallestEntity);
+		Slot = Smallest;
+	}
+	PlaceLot(Heap, Slot, Entity);
+}
+
+void FPraxisMaterialIndex::Reset()
+{
+	StockBuckets.Empty();
+	StockTotals.Empty();
+	LotHeaps.Empty();
+	ReservationBuckets.Empty();
+	Entries.Empty();
+}
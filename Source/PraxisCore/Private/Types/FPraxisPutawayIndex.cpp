@@ -0,0 +1,433 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Types/FPraxisPutawayIndex.h"
+#include "Algo/LowerBound.h"
+
+namespace
+{
+	/** Spread the low 21 bits of a value so two zero bits follow each one */
+	uint64 SpreadBits3(uint64 Value)
+	{
+		Value &= 0x1fffff;
+		Value = (Value | (Value << 32)) & 0x001f00000000ffffull;
+		Value = (Value | (Value << 16)) & 0x001f0000ff0000ffull;
+		Value = (Value | (Value << 8))  & 0x100f00f00f00f00full;
+		Value = (Value | (Value << 4))  & 0x10c30c30c30c30c3ull;
+		Value = (Value | (Value << 2))  & 0x1249249249249249ull;
+		return Value;
+	}
+
+	/** Fitting bins compared by real distance on each side of the query's Z-order rank */
+	constexpr int32 ClosestCandidatesPerSide = 4;
+}
+
+// ════════════════════════════════════════════════════════════════════════════════
+// Bins
+// ════════════════════════════════════════════════════════════════════════════════
+
+int32 FPraxisPutawayIndex::AddBin(int32 BinId, const FVector& Position)
+{
+	FSlot& Slot = Slots.AddDefaulted_GetRef();
+	Slot.BinId = BinId;
+	Slot.Position = Position;
+
+	const int32 SlotIndex = Slots.Num() - 1;
+	if (SlotIndex >= OrderLeaves)
+	{
+		GrowOrderTree();
+	}
+	SetLeaf(OrderTree, OrderLeaves, SlotIndex, -1.0f);
+
+	bSpatialDirty = true;
+	return SlotIndex;
+}
+
+void FPraxisPutawayIndex::UpdateBin(int32 SlotIndex, float FreeVolume)
+{
+	FSlot& Slot = Slots[SlotIndex];
+	if (Slot.bRetired)
+	{
+		return;
+	}
+
+	Slot.FreeVolume = FMath::Max(0.0f, FreeVolume);
+
+	const int32 NewBucket = GetBucket(Slot.FreeVolume);
+	if (NewBucket != Slot.Bucket)
+	{
+		RemoveFromBucket(SlotIndex);
+		AddToBucket(SlotIndex, NewBucket);
+	}
+
+	const float Value = GetTreeValue(Slot);
+	SetLeaf(OrderTree, OrderLeaves, SlotIndex, Value);
+	if (!bSpatialDirty)
+	{
+		SetLeaf(SpatialTree, SpatialLeaves, SpatialRanks[SlotIndex], Value);
+	}
+}
+
+void FPraxisPutawayIndex::RetireBin(int32 SlotIndex)
+{
+	UpdateBin(SlotIndex, 0.0f);
+	Slots[SlotIndex].bRetired = true;
+}
+
+void FPraxisPutawayIndex::Reset()
+{
+	Slots.Reset();
+	OrderTree.Reset();
+	OrderLeaves = 0;
+	SpatialTree.Reset();
+	SpatialLeaves = 0;
+	SpatialSlots.Reset();
+	SpatialRanks.Reset();
+	SpatialCodes.Reset();
+	SpatialBounds = FBox(ForceInit);
+	bSpatialDirty = false;
+	Buckets.Reset();
+	BucketFenwick.Reset();
+	EligibleCount = 0;
+}
+
+// ════════════════════════════════════════════════════════════════════════════════
+// Queries
+// ════════════════════════════════════════════════════════════════════════════════
+
+int32 FPraxisPutawayIndex::FindFirstFit(float Volume) const
+{
+	if (OrderLeaves == 0)
+	{
+		return INDEX_NONE;
+	}
+	return FindFirstAtOrAfter(OrderTree, 1, 0, OrderLeaves, 0, FMath::Max(0.0f, Volume));
+}
+
+int32 FPraxisPutawayIndex::FindBestFit(float Volume) const
+{
+	// The bucket the volume falls in holds bins either side of it: check each exactly
+	const int32 FloorBucket = Volume > 0.0f ? GetBucket(Volume) : 0;
+	if (FloorBucket >= Buckets.Num())
+	{
+		return INDEX_NONE;
+	}
+
+	int32 Best = INDEX_NONE;
+	for (const int32 SlotIndex : Buckets[FloorBucket])
+	{
+		const float FreeVolume = Slots[SlotIndex].FreeVolume;
+		if (FreeVolume >= Volume && (Best == INDEX_NONE || FreeVolume < Slots[Best].FreeVolume))
+		{
+			Best = SlotIndex;
+		}
+	}
+	if (Best != INDEX_NONE)
+	{
+		return Best;
+	}
+
+	// Every bin in a higher bucket fits; the lowest occupied one holds the tightest
+	const int32 Below = FenwickPrefix(FloorBucket + 1);
+	if (Below >= EligibleCount)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 Bucket = FenwickFindByOrder(Below);
+	return Buckets[Bucket][0];
+}
+
+int32 FPraxisPutawayIndex::FindClosest(float Volume, const FVector& From) const
+{
+	if (Slots.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	if (bSpatialDirty)
+	{
+		RebuildSpatialIndex();
+	}
+
+	const float MinVolume = FMath::Max(0.0f, Volume);
+	const int32 Origin = Algo::LowerBound(SpatialCodes, GetMortonCode(From));
+
+	int32 BestSlot = INDEX_NONE;
+	double BestDistSq = TNumericLimits<double>::Max();
+	auto Consider = [&](int32 Rank)
+	{
+		const int32 SlotIndex = SpatialSlots[Rank];
+		const double DistSq = FVector::DistSquared(Slots[SlotIndex].Position, From);
+		if (DistSq < BestDistSq || (DistSq == BestDistSq && SlotIndex < BestSlot))
+		{
+			BestDistSq = DistSq;
+			BestSlot = SlotIndex;
+		}
+	};
+
+	int32 Next = Origin;
+	for (int32 i = 0; i < ClosestCandidatesPerSide && Next < SpatialLeaves; ++i)
+	{
+		const int32 Rank = FindFirstAtOrAfter(SpatialTree, 1, 0, SpatialLeaves, Next, MinVolume);
+		if (Rank == INDEX_NONE)
+		{
+			break;
+		}
+		Consider(Rank);
+		Next = Rank + 1;
+	}
+
+	int32 Before = Origin;
+	for (int32 i = 0; i < ClosestCandidatesPerSide && Before > 0; ++i)
+	{
+		const int32 Rank = FindLastBefore(SpatialTree, 1, 0, SpatialLeaves, Before, MinVolume);
+		if (Rank == INDEX_NONE)
+		{
+			break;
+		}
+		Consider(Rank);
+		Before = Rank;
+	}
+
+	return BestSlot;
+}
+
+// ════════════════════════════════════════════════════════════════════════════════
+// Segment Trees
+// ════════════════════════════════════════════════════════════════════════════════
+
+void FPraxisPutawayIndex::SetLeaf(TArray<float>& Tree, int32 Leaves, int32 Index, float Value)
+{
+	int32 Node = Leaves + Index;
+	Tree[Node] = Value;
+	for (Node >>= 1; Node >= 1; Node >>= 1)
+	{
+		Tree[Node] = FMath::Max(Tree[2 * Node], Tree[2 * Node + 1]);
+	}
+}
+
+int32 FPraxisPutawayIndex::FindFirstAtOrAfter(const TArray<float>& Tree, int32 Node, int32 Lo, int32 Hi, int32 From, float Volume)
+{
+	if (Hi <= From || Tree[Node] < Volume)
+	{
+		return INDEX_NONE;
+	}
+	if (Hi - Lo == 1)
+	{
+		return Lo;
+	}
+
+	const int32 Mid = (Lo + Hi) / 2;
+	const int32 Left = FindFirstAtOrAfter(Tree, 2 * Node, Lo, Mid, From, Volume);
+	return Left != INDEX_NONE ? Left : FindFirstAtOrAfter(Tree, 2 * Node + 1, Mid, Hi, From, Volume);
+}
+
+int32 FPraxisPutawayIndex::FindLastBefore(const TArray<float>& Tree, int32 Node, int32 Lo, int32 Hi, int32 Before, float Volume)
+{
+	if (Lo >= Before || Tree[Node] < Volume)
+	{
+		return INDEX_NONE;
+	}
+	if (Hi - Lo == 1)
+	{
+		return Lo;
+	}
+
+	const int32 Mid = (Lo + Hi) / 2;
+	const int32 Right = FindLastBefore(Tree, 2 * Node + 1, Mid, Hi, Before, Volume);
+	return Right != INDEX_NONE ? Right : FindLastBefore(Tree, 2 * Node, Lo, Mid, Before, Volume);
+}
+
+void FPraxisPutawayIndex::GrowOrderTree()
+{
+	int32 NewLeaves = FMath::Max(16, OrderLeaves);
+	while (NewLeaves < Slots.Num())
+	{
+		NewLeaves *= 2;
+	}
+
+	OrderTree.Init(-1.0f, 2 * NewLeaves);
+	for (int32 i = 0; i < Slots.Num(); ++i)
+	{
+		OrderTree[NewLeaves + i] = GetTreeValue(Slots[i]);
+	}
+	for (int32 Node = NewLeaves - 1; Node >= 1; --Node)
+	{
+		OrderTree[Node] = FMath::Max(OrderTree[2 * Node], OrderTree[2 * Node + 1]);
+	}
+	OrderLeaves = NewLeaves;
+}
+
+void FPraxisPutawayIndex::RebuildSpatialIndex() const
+{
+	SpatialBounds = FBox(ForceInit);
+	for (const FSlot& Slot : Slots)
+	{
+		SpatialBounds += Slot.Position;
+	}
+
+	// Sort slots by Morton code (slot index breaks ties, so the order is deterministic)
+	TArray<TPair<uint64, int32>> Ordered;
+	Ordered.Reserve(Slots.Num());
+	for (int32 i = 0; i < Slots.Num(); ++i)
+	{
+		Ordered.Emplace(GetMortonCode(Slots[i].Position), i);
+	}
+	Ordered.Sort([](const TPair<uint64, int32>& A, const TPair<uint64, int32>& B)
+	{
+		return A.Key != B.Key ? A.Key < B.Key : A.Value < B.Value;
+	});
+
+	SpatialLeaves = 16;
+	while (SpatialLeaves < Slots.Num())
+	{
+		SpatialLeaves *= 2;
+	}
+
+	SpatialSlots.SetNumUninitialized(Slots.Num());
+	SpatialRanks.SetNumUninitialized(Slots.Num());
+	SpatialCodes.SetNumUninitialized(Slots.Num());
+	SpatialTree.Init(-1.0f, 2 * SpatialLeaves);
+	for (int32 Rank = 0; Rank < Ordered.Num(); ++Rank)
+	{
+		const int32 SlotIndex = Ordered[Rank].Value;
+		SpatialCodes[Rank] = Ordered[Rank].Key;
+		SpatialSlots[Rank] = SlotIndex;
+		SpatialRanks[SlotIndex] = Rank;
+		SpatialTree[SpatialLeaves + Rank] = GetTreeValue(Slots[SlotIndex]);
+	}
+	for (int32 Node = SpatialLeaves - 1; Node >= 1; --Node)
+	{
+		SpatialTree[Node] = FMath::Max(SpatialTree[2 * Node], SpatialTree[2 * Node + 1]);
+	}
+
+	bSpatialDirty = false;
+}
+
+uint64 FPraxisPutawayIndex::GetMortonCode(const FVector& Position) const
+{
+	static constexpr double CellsPerAxis = double((1 << 21) - 1);
+
+	const FVector Extent = SpatialBounds.GetSize();
+	auto Quantize = [](double Value, double Min, double Size)
+	{
+		const double Normalized = Size > UE_KINDA_SMALL_NUMBER ? FMath::Clamp((Value - Min) / Size, 0.0, 1.0) : 0.0;
+		return static_cast<uint64>(Normalized * CellsPerAxis);
+	};
+
+	const uint64 X = Quantize(Position.X, SpatialBounds.Min.X, Extent.X);
+	const uint64 Y = Quantize(Position.Y, SpatialBounds.Min.Y, Extent.Y);
+	const uint64 Z = Quantize(Position.Z, SpatialBounds.Min.Z, Extent.Z);
+	return SpreadBits3(X) | (SpreadBits3(Y) << 1) | (SpreadBits3(Z) << 2);
+}
+
+// ════════════════════════════════════════════════════════════════════════════════
+// Best-Fit Buckets
+// ════════════════════════════════════════════════════════════════════════════════
+
+int32 FPraxisPutawayIndex::GetBucket(float FreeVolume) const
+{
+	if (FreeVolume <= 0.0f)
+	{
+		return INDEX_NONE;
+	}
+	return FMath::Max(0, FMath::FloorToInt(FMath::Log2(FreeVolume / MinBucketVolume) * BucketsPerDoubling));
+}
+
+void FPraxisPutawayIndex::EnsureBucket(int32 Bucket)
+{
+	if (Bucket < Buckets.Num())
+	{
+		return;
+	}
+
+	Buckets.SetNum(FMath::Max(Bucket + 1, Buckets.Num() * 2));
+
+	// Fenwick tree has to be rebuilt for the new size
+	BucketFenwick.Reset();
+	BucketFenwick.SetNumZeroed(Buckets.Num() + 1);
+	for (int32 i = 0; i < Buckets.Num(); ++i)
+	{
+		if (Buckets[i].Num() > 0)
+		{
+			FenwickAdd(i, Buckets[i].Num());
+		}
+	}
+}
+
+void FPraxisPutawayIndex::AddToBucket(int32 SlotIndex, int32 Bucket)
+{
+	FSlot& Slot = Slots[SlotIndex];
+	Slot.Bucket = Bucket;
+	if (Bucket == INDEX_NONE)
+	{
+		return;
+	}
+
+	EnsureBucket(Bucket);
+	Slot.BucketPosition = Buckets[Bucket].Add(SlotIndex);
+	FenwickAdd(Bucket, 1);
+	++EligibleCount;
+}
+
+void FPraxisPutawayIndex::RemoveFromBucket(int32 SlotIndex)
+{
+	FSlot& Slot = Slots[SlotIndex];
+	if (Slot.Bucket == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Swap-remove, fixing up the moved slot's position
+	TArray<int32>& Bucket = Buckets[Slot.Bucket];
+	const int32 Last = Bucket.Last();
+	Bucket[Slot.BucketPosition] = Last;
+	Slots[Last].BucketPosition = Slot.BucketPosition;
+	Bucket.Pop(EAllowShrinking::No);
+
+	FenwickAdd(Slot.Bucket, -1);
+	--EligibleCount;
+
+	Slot.Bucket = INDEX_NONE;
+	Slot.BucketPosition = INDEX_NONE;
+}
+
+void FPraxisPutawayIndex::FenwickAdd(int32 Bucket, int32 Delta)
+{
+	for (int32 i = Bucket + 1; i < BucketFenwick.Num(); i += i & -i)
+	{
+		BucketFenwick[i] += Delta;
+	}
+}
+
+int32 FPraxisPutawayIndex::FenwickPrefix(int32 Count) const
+{
+	int32 Sum = 0;
+	for (int32 i = FMath::Min(Count, BucketFenwick.Num() - 1); i > 0; i -= i & -i)
+	{
+		Sum += BucketFenwick[i];
+	}
+	return Sum;
+}
+
+int32 FPraxisPutawayIndex::FenwickFindByOrder(int32 Order) const
+{
+	// Binary lifting: largest prefix holding <= Order bins; the next bucket holds bin #Order
+	const int32 Size = BucketFenwick.Num() - 1;
+	int32 HighStep = 1;
+	while (HighStep * 2 <= Size)
+	{
+		HighStep *= 2;
+	}
+
+	int32 Position = 0;
+	for (int32 Step = HighStep; Step > 0; Step >>= 1)
+	{
+		if (Position + Step <= Size && BucketFenwick[Position + Step] <= Order)
+		{
+			Position += Step;
+			Order -= BucketFenwick[Position];
+		}
+	}
+	return Position;
+}
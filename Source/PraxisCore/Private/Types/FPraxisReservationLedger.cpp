@@ -0,0 +1,182 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Types/FPraxisReservationLedger.h"
+
+template<typename KeyType>
+void FPraxisReservationLedger::AddTotal(TMap<KeyType, int32>& Totals, const KeyType& Key, int32 Delta)
+{
+	int32& Total = Totals.FindOrAdd(Key);
+	Total += Delta;
+	if (Total == 0)
+	{
+		Totals.Remove(Key);
+	}
+}
+
+int32 FPraxisReservationLedger::AddClaim(FMassEntityHandle Batch, const FPraxisMaterialStockKey& StockKey, const FPraxisMaterialReservationKey& Owner, int32 Quantity, double ClaimTime)
+{
+	check(Quantity > 0);
+
+	FClaimList& BatchClaims = ClaimsByBatch.FindOrAdd(Batch);
+
+	// One claim per (batch, owner): top it up
+	for (const int32 ClaimId : BatchClaims)
+	{
+		FClaim& Existing = Claims[ClaimId];
+		if (Existing.Owner == Owner)
+		{
+			Existing.Quantity += Quantity;
+			ApplyTotals(Existing, Quantity);
+			return ClaimId;
+		}
+	}
+
+	const int32 ClaimId = FreeClaims.Num() > 0 ? FreeClaims.Pop(EAllowShrinking::No) : Claims.AddDefaulted();
+	FClaim& Claim = Claims[ClaimId];
+	Claim.Batch = Batch;
+	Claim.StockKey = FPraxisMaterialStockKey(StockKey.SKU, StockKey.LocationId, StockKey.MaterialState, false);
+	Claim.Owner = Owner;
+	Claim.Quantity = Quantity;
+	Claim.ClaimTime = ClaimTime;
+
+	BatchClaims.Add(ClaimId);
+	ClaimsByOwner.FindOrAdd(Owner).Add(ClaimId);
+	ApplyTotals(Claim, Quantity);
+	return ClaimId;
+}
+
+int32 FPraxisReservationLedger::ReduceClaim(int32 ClaimId, int32 Quantity)
+{
+	if (!Claims.IsValidIndex(ClaimId) || Claims[ClaimId].Quantity <= 0)
+	{
+		return 0;
+	}
+
+	FClaim& Claim = Claims[ClaimId];
+	const int32 Taken = FMath::Clamp(Quantity, 0, Claim.Quantity);
+	Claim.Quantity -= Taken;
+	ApplyTotals(Claim, -Taken);
+
+	if (Claim.Quantity == 0)
+	{
+		RemoveClaim(ClaimId);
+	}
+	return Taken;
+}
+
+void FPraxisReservationLedger::ReleaseOwner(const FPraxisMaterialReservationKey& Owner, TArray<FClaim>& OutReleased)
+{
+	const FClaimList* OwnerClaims = ClaimsByOwner.Find(Owner);
+	if (!OwnerClaims)
+	{
+		return;
+	}
+
+	const FClaimList ToRelease = *OwnerClaims;
+	for (const int32 ClaimId : ToRelease)
+	{
+		OutReleased.Add(Claims[ClaimId]);
+		ReduceClaim(ClaimId, Claims[ClaimId].Quantity);
+	}
+}
+
+void FPraxisReservationLedger::ReleaseBatch(FMassEntityHandle Batch, TArray<FClaim>& OutReleased)
+{
+	const FClaimList* BatchClaims = ClaimsByBatch.Find(Batch);
+	if (!BatchClaims)
+	{
+		return;
+	}
+
+	const FClaimList ToRelease = *BatchClaims;
+	for (const int32 ClaimId : ToRelease)
+	{
+		OutReleased.Add(Claims[ClaimId]);
+		ReduceClaim(ClaimId, Claims[ClaimId].Quantity);
+	}
+}
+
+void FPraxisReservationLedger::MoveClaims(FMassEntityHandle FromBatch, FMassEntityHandle ToBatch)
+{
+	const FClaimList* BatchClaims = ClaimsByBatch.Find(FromBatch);
+	if (!BatchClaims || FromBatch == ToBatch)
+	{
+		return;
+	}
+
+	// Re-add under the new batch (merging with its own claims by the same owner), then drop the old ones
+	const FClaimList ToMove = *BatchClaims;
+	for (const int32 ClaimId : ToMove)
+	{
+		const FClaim Claim = Claims[ClaimId];
+		ReduceClaim(ClaimId, Claim.Quantity);
+		AddClaim(ToBatch, Claim.StockKey, Claim.Owner, Claim.Quantity, Claim.ClaimTime);
+	}
+}
+
+int32 FPraxisReservationLedger::FindClaim(const FPraxisMaterialReservationKey& Owner, FName SKU) const
+{
+	if (const FClaimList* OwnerClaims = ClaimsByOwner.Find(Owner))
+	{
+		for (const int32 ClaimId : *OwnerClaims)
+		{
+			if (Claims[ClaimId].StockKey.SKU == SKU)
+			{
+				return ClaimId;
+			}
+		}
+	}
+	return INDEX_NONE;
+}
+
+void FPraxisReservationLedger::ApplyTotals(const FClaim& Claim, int32 Delta)
+{
+	if (Delta == 0)
+	{
+		return;
+	}
+
+	AddTotal(BatchTotals, Claim.Batch, Delta);
+	AddTotal(OwnerTotals, FOwnerSKUKey(Claim.Owner, Claim.StockKey.SKU), Delta);
+	AddTotal(WorkOrderTotals, FWorkOrderSKUKey(Claim.Owner.WorkOrderId, Claim.StockKey.SKU), Delta);
+	AddTotal(StockTotals, Claim.StockKey, Delta);
+}
+
+void FPraxisReservationLedger::RemoveClaim(int32 ClaimId)
+{
+	FClaim& Claim = Claims[ClaimId];
+
+	// Lists are short (a few claimants per batch, a few SKUs per owner); keep them oldest-first
+	if (FClaimList* BatchClaims = ClaimsByBatch.Find(Claim.Batch))
+	{
+		BatchClaims->Remove(ClaimId);
+		if (BatchClaims->Num() == 0)
+		{
+			ClaimsByBatch.Remove(Claim.Batch);
+		}
+	}
+
+	if (FClaimList* OwnerClaims = ClaimsByOwner.Find(Claim.Owner))
+	{
+		OwnerClaims->Remove(ClaimId);
+		if (OwnerClaims->Num() == 0)
+		{
+			ClaimsByOwner.Remove(Claim.Owner);
+		}
+	}
+
+	Claim = FClaim();
+	FreeClaims.Add(ClaimId);
+}
+
+void FPraxisReservationLedger::Reset()
+{
+	Claims.Reset();
+	FreeClaims.Reset();
+	ClaimsByBatch.Reset();
+	ClaimsByOwner.Reset();
+	BatchTotals.Reset();
+	OwnerTotals.Reset();
+	WorkOrderTotals.Reset();
+	StockTotals.Reset();
+}
@@ -0,0 +1,157 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Types/FPraxisTimingWheel.h"
+
+namespace PraxisTimingWheel
+{
+	constexpr int64 SlotMask = FPraxisTimingWheel::SlotsPerLevel - 1;
+
+	/** Ticks covered by one full turn of the wheels up to and including Level */
+	constexpr int64 LevelSpan(int32 Level)
+	{
+		return int64(1) << (FPraxisTimingWheel::SlotBits * (Level + 1));
+	}
+}
+
+FPraxisTimingWheel::FPraxisTimingWheel()
+{
+	SlotHeads.Init(INDEX_NONE, NumLevels * SlotsPerLevel);
+}
+
+int32 FPraxisTimingWheel::Schedule(int64 DeadlineTick)
+{
+	const int32 TimerId = FreeTimers.Num() > 0 ? FreeTimers.Pop(EAllowShrinking::No) : Timers.AddDefaulted();
+	Timers[TimerId].Deadline = FMath::Max(DeadlineTick, CurrentTick + 1);
+	Place(TimerId);
+	++PendingCount;
+	return TimerId;
+}
+
+bool FPraxisTimingWheel::Cancel(int32 TimerId)
+{
+	if (!IsPending(TimerId))
+	{
+		return false;
+	}
+
+	Unlink(TimerId);
+	FreeTimers.Add(TimerId);
+	--PendingCount;
+	return true;
+}
+
+void FPraxisTimingWheel::Advance(int64 ToTick, TArray<int32>& OutExpired)
+{
+	using namespace PraxisTimingWheel;
+
+	while (CurrentTick < ToTick)
+	{
+		++CurrentTick;
+
+		// Nothing pending: jump straight to the target (slot positions are derived from ticks)
+		if (PendingCount == 0)
+		{
+			CurrentTick = ToTick;
+			return;
+		}
+
+		// Lower wheel wrapped: pull the next slot of each wheel above down a level
+		for (int32 Level = 1; Level < NumLevels; ++Level)
+		{
+			if ((CurrentTick & (LevelSpan(Level - 1) - 1)) != 0)
+			{
+				break;
+			}
+
+			const int32 Index = static_cast<int32>((CurrentTick >> (SlotBits * Level)) & SlotMask);
+			for (int32 TimerId = TakeSlot(Level * SlotsPerLevel + Index); TimerId != INDEX_NONE; )
+			{
+				const int32 Next = Timers[TimerId].Next;
+				Place(TimerId);
+				TimerId = Next;
+			}
+		}
+
+		// Everything in the current level-0 slot is due now
+		for (int32 TimerId = TakeSlot(static_cast<int32>(CurrentTick & SlotMask)); TimerId != INDEX_NONE; )
+		{
+			FTimer& Timer = Timers[TimerId];
+			const int32 Next = Timer.Next;
+			Timer.Slot = INDEX_NONE;
+			Timer.Prev = INDEX_NONE;
+			Timer.Next = INDEX_NONE;
+			FreeTimers.Add(TimerId);
+			--PendingCount;
+			OutExpired.Add(TimerId);
+			TimerId = Next;
+		}
+	}
+}
+
+void FPraxisTimingWheel::Place(int32 TimerId)
+{
+	using namespace PraxisTimingWheel;
+
+	const int64 Deadline = Timers[TimerId].Deadline;
+	const int64 Delta = Deadline - CurrentTick;
+
+	int32 Level = 0;
+	while (Level < NumLevels - 1 && Delta >= LevelSpan(Level))
+	{
+		++Level;
+	}
+
+	// Beyond the horizon: park in the top wheel's last slot before wrapping, re-placed when it cascades
+	const int64 SlotTick = Delta < LevelSpan(NumLevels - 1) ? Deadline : CurrentTick + LevelSpan(NumLevels - 1) - 1;
+	const int32 Index = static_cast<int32>((SlotTick >> (SlotBits * Level)) & SlotMask);
+	Link(TimerId, Level * SlotsPerLevel + Index);
+}
+
+void FPraxisTimingWheel::Link(int32 TimerId, int32 Slot)
+{
+	FTimer& Timer = Timers[TimerId];
+	Timer.Slot = Slot;
+	Timer.Prev = INDEX_NONE;
+	Timer.Next = SlotHeads[Slot];
+	if (Timer.Next != INDEX_NONE)
+	{
+		Timers[Timer.Next].Prev = TimerId;
+	}
+	SlotHeads[Slot] = TimerId;
+}
+
+void FPraxisTimingWheel::Unlink(int32 TimerId)
+{
+	FTimer& Timer = Timers[TimerId];
+	if (Timer.Prev != INDEX_NONE)
+	{
+		Timers[Timer.Prev].Next = Timer.Next;
+	}
+	else
+	{
+		SlotHeads[Timer.Slot] = Timer.Next;
+	}
+	if (Timer.Next != INDEX_NONE)
+	{
+		Timers[Timer.Next].Prev = Timer.Prev;
+	}
+	Timer.Slot = INDEX_NONE;
+	Timer.Prev = INDEX_NONE;
+	Timer.Next = INDEX_NONE;
+}
+
+int32 FPraxisTimingWheel::TakeSlot(int32 Slot)
+{
+	const int32 Head = SlotHeads[Slot];
+	SlotHeads[Slot] = INDEX_NONE;
+	return Head;
+}
+
+void FPraxisTimingWheel::Reset(int64 StartTick)
+{
+	Timers.Reset();
+	FreeTimers.Reset();
+	SlotHeads.Init(INDEX_NONE, NumLevels * SlotsPerLevel);
+	CurrentTick = StartTick;
+	PendingCount = 0;
+}
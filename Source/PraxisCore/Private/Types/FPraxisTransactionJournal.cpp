@@ -0,0 +1,103 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Types/FPraxisTransactionJournal.h"
+
+const TCHAR* LexToString(EPraxisInventoryTransactionType Type)
+{
+	switch (Type)
+	{
+	case EPraxisInventoryTransactionType::Purchase:       return TEXT("Purchase");
+	case EPraxisInventoryTransactionType::Reservation:    return TEXT("Reservation");
+	case EPraxisInventoryTransactionType::Consumption:    return TEXT("Consumption");
+	case EPraxisInventoryTransactionType::Production:     return TEXT("Production");
+	case EPraxisInventoryTransactionType::Scrap:          return TEXT("Scrap");
+	case EPraxisInventoryTransactionType::BOMConsumption: return TEXT("BOMConsumption");
+	case EPraxisInventoryTransactionType::BOMProduction:  return TEXT("BOMProduction");
+	case EPraxisInventoryTransactionType::Shipment:       return TEXT("Shipment");
+	case EPraxisInventoryTransactionType::Transfer:       return TEXT("Transfer");
+	case EPraxisInventoryTransactionType::Release:        return TEXT("Release");
+	case EPraxisInventoryTransactionType::Adjustment:     return TEXT("Adjustment");
+	default:                                              return TEXT("Unknown");
+	}
+}
+
+FString FPraxisTransactionRecord::FormatReference() const
+{
+	switch (Type)
+	{
+	case EPraxisInventoryTransactionType::Reservation:
+	case EPraxisInventoryTransactionType::Consumption:
+	case EPraxisInventoryTransactionType::Production:
+	case EPraxisInventoryTransactionType::Scrap:
+	case EPraxisInventoryTransactionType::Release:
+		return FString::Printf(TEXT("WO:%lld Machine:%s"), WorkOrderId, *RefName.ToString());
+
+	case EPraxisInventoryTransactionType::BOMConsumption:
+		return FString::Printf(TEXT("BOM:%s WO:%lld"), *RefName.ToString(), WorkOrderId);
+
+	case EPraxisInventoryTransactionType::BOMProduction:
+		return FString::Printf(TEXT("BOM:%s WO:%lld Inputs:%d"), *RefName.ToString(), WorkOrderId, RefCount);
+
+	case EPraxisInventoryTransactionType::Shipment:
+		return FString::Printf(TEXT("Batches:%d"), RefCount);
+
+	case EPraxisInventoryTransactionType::Transfer:
+		return FString::Printf(TEXT("From: %s"), *RefName.ToString());
+
+	case EPraxisInventoryTransactionType::Adjustment:
+		if (!RefName.IsNone())
+		{
+			return FString::Printf(TEXT("Container:%s Amount:%.6f"), *RefName.ToString(), FluidDelta);
+		}
+		return RefCount > 0 ? FString::Printf(TEXT("Merged batches:%d"), RefCount) : FString();
+
+	default:
+		return FString();
+	}
+}
+
+void FPraxisTransactionJournal::SetCapacity(int32 NewCapacity)
+{
+	NewCapacity = FMath::Max(1, NewCapacity);
+	if (NewCapacity == Records.Num())
+	{
+		return;
+	}
+
+	// Linearize the newest records into the new buffer
+	const int32 Keep = FMath::Min(Count, NewCapacity);
+	TArray<FPraxisTransactionRecord> NewRecords;
+	NewRecords.SetNum(NewCapacity);
+	for (int32 i = 0; i < Keep; ++i)
+	{
+		NewRecords[i] = (*this)[Count - Keep + i];
+	}
+
+	Records = MoveTemp(NewRecords);
+	Head = 0;
+	Count = Keep;
+}
+
+void FPraxisTransactionJournal::Append(const FPraxisTransactionRecord& Record)
+{
+	const int32 Capacity = Records.Num();
+	if (Count < Capacity)
+	{
+		Records[(Head + Count) % Capacity] = Record;
+		++Count;
+	}
+	else
+	{
+		// Full: overwrite the oldest
+		Records[Head] = Record;
+		Head = (Head + 1) % Capacity;
+	}
+	++TotalAppended;
+}
+
+void FPraxisTransactionJournal::Reset()
+{
+	Head = 0;
+	Count = 0;
+	TotalAppended = 0;
+}
@@ -0,0 +1,191 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Types/FPraxisWorkCalendar.h"
+
+namespace PraxisWorkCalendar
+{
+	constexpr double Hour = 3600.0;
+}
+
+FPraxisWorkCalendar::FPraxisWorkCalendar(TConstArrayView<EPraxisShift> Shifts)
+{
+	using namespace PraxisWorkCalendar;
+
+	for (const EPraxisShift Shift : Shifts)
+	{
+		switch (Shift)
+		{
+		case EPraxisShift::Day:
+			Windows.Add({ 6 * Hour, 14 * Hour });
+			break;
+		case EPraxisShift::Afternoon:
+			Windows.Add({ 14 * Hour, 22 * Hour });
+			break;
+		case EPraxisShift::Night:
+			// Crosses midnight: the end of one day and the start of the next
+			Windows.Add({ 22 * Hour, SecondsPerDay });
+			Windows.Add({ 0.0, 6 * Hour });
+			break;
+		}
+	}
+
+	Windows.Sort([](const FWindow& A, const FWindow& B) { return A.Begin < B.Begin; });
+
+	// Merge overlapping and adjacent windows
+	int32 Merged = 0;
+	for (int32 Index = 0; Index < Windows.Num(); ++Index)
+	{
+		if (Merged > 0 && Windows[Index].Begin <= Windows[Merged - 1].End)
+		{
+			Windows[Merged - 1].End = FMath::Max(Windows[Merged - 1].End, Windows[Index].End);
+		}
+		else
+		{
+			Windows[Merged++] = Windows[Index];
+		}
+	}
+	Windows.SetNum(Merged);
+
+	OpenSecondsPerDay = 0.0;
+	for (const FWindow& Window : Windows)
+	{
+		OpenSecondsPerDay += Window.End - Window.Begin;
+	}
+
+	// All three shifts, or none: around the clock
+	if (Windows.Num() == 0 || OpenSecondsPerDay >= SecondsPerDay)
+	{
+		Windows.Empty();
+		OpenSecondsPerDay = SecondsPerDay;
+	}
+}
+
+double FPraxisWorkCalendar::NextOpen(double T) const
+{
+	if (IsAlwaysOpen())
+	{
+		return T;
+	}
+
+	// Time of day in [0, SecondsPerDay)
+	const double DayStart = FMath::FloorToDouble(T / SecondsPerDay) * SecondsPerDay;
+	const double TimeOfDay = T - DayStart;
+	for (const FWindow& Window : Windows)
+	{
+		if (TimeOfDay < Window.End)
+		{
+			return DayStart + FMath::Max(TimeOfDay, Window.Begin);
+		}
+	}
+	return DayStart + SecondsPerDay + Windows[0].Begin;
+}
+
+double FPraxisWorkCalendar::PrevOpen(double T) const
+{
+	if (IsAlwaysOpen())
+	{
+		return T;
+	}
+
+	// Time of day in (0, SecondsPerDay], so midnight belongs to the day that ends there
+	const double DayStart = (FMath::CeilToDouble(T / SecondsPerDay) - 1.0) * SecondsPerDay;
+	const double TimeOfDay = T - DayStart;
+	for (int32 Index = Windows.Num() - 1; Index >= 0; --Index)
+	{
+		if (TimeOfDay > Windows[Index].Begin)
+		{
+			return DayStart + FMath::Min(TimeOfDay, Windows[Index].End);
+		}
+	}
+	return DayStart - SecondsPerDay + Windows.Last().End;
+}
+
+double FPraxisWorkCalendar::Advance(double Start, double WorkSeconds) const
+{
+	if (IsAlwaysOpen())
+	{
+		return Start + WorkSeconds;
+	}
+
+	double T = NextOpen(Start);
+	double Remaining = WorkSeconds;
+
+	// A whole day from any working instant holds exactly one day's working time; keep
+	// a remainder so the finish lands inside a window rather than at the next one's start
+	double FullDays = FMath::FloorToDouble(Remaining / OpenSecondsPerDay);
+	if (FullDays > 0.0 && Remaining - FullDays * OpenSecondsPerDay <= 0.0)
+	{
+		FullDays -= 1.0;
+	}
+	T += FullDays * SecondsPerDay;
+	Remaining -= FullDays * OpenSecondsPerDay;
+
+	for (;;)
+	{
+		T = NextOpen(T);
+		const double DayStart = FMath::FloorToDouble(T / SecondsPerDay) * SecondsPerDay;
+		const double TimeOfDay = T - DayStart;
+
+		double WindowEnd = DayStart + SecondsPerDay;
+		for (const FWindow& Window : Windows)
+		{
+			if (TimeOfDay < Window.End)
+			{
+				WindowEnd = DayStart + Window.End;
+				break;
+			}
+		}
+
+		const double Available = WindowEnd - T;
+		if (Remaining <= Available)
+		{
+			return T + Remaining;
+		}
+		Remaining -= Available;
+		T = WindowEnd;
+	}
+}
+
+double FPraxisWorkCalendar::Retreat(double Finish, double WorkSeconds) const
+{
+	if (IsAlwaysOpen())
+	{
+		return Finish - WorkSeconds;
+	}
+
+	double T = PrevOpen(Finish);
+	double Remaining = WorkSeconds;
+
+	double FullDays = FMath::FloorToDouble(Remaining / OpenSecondsPerDay);
+	if (FullDays > 0.0 && Remaining - FullDays * OpenSecondsPerDay <= 0.0)
+	{
+		FullDays -= 1.0;
+	}
+	T -= FullDays * SecondsPerDay;
+	Remaining -= FullDays * OpenSecondsPerDay;
+
+	for (;;)
+	{
+		T = PrevOpen(T);
+		const double DayStart = (FMath::CeilToDouble(T / SecondsPerDay) - 1.0) * SecondsPerDay;
+		const double TimeOfDay = T - DayStart;
+
+		double WindowBegin = DayStart;
+		for (int32 Index = Windows.Num() - 1; Index >= 0; --Index)
+		{
+			if (TimeOfDay > Windows[Index].Begin)
+			{
+				WindowBegin = DayStart + Windows[Index].Begin;
+				break;
+			}
+		}
+
+		const double Available = T - WindowBegin;
+		if (Remaining <= Available)
+		{
+			return T - Remaining;
+		}
+		Remaining -= Available;
+		T = WindowBegin;
+	}
+}
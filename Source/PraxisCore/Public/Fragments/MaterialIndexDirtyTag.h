@@ -0,0 +1,21 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "MaterialIndexDirtyTag.generated.h"
+
+/**
+ * Marks a material entity whose fragments were changed outside the inventory service.
+ *
+ * A processor that edits SKU, state, quantity, location or reservation directly adds
+ * this tag (e.g. Context.Defer().AddTag<FMaterialIndexDirtyTag>(Entity)). An observer
+ * re-indexes the flagged entities chunk by chunk - stock/lot/reservation indexes,
+ * aggregates and location capacity - and removes the tag again.
+ */
+USTRUCT()
+struct PRAXISCORE_API FMaterialIndexDirtyTag : public FMassTag
+{
+	GENERATED_BODY()
+};
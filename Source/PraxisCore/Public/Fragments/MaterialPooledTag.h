@@ -0,0 +1,20 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "MaterialPooledTag.generated.h"
+
+/**
+ * Marks a material entity parked in the inventory service's entity pool.
+ *
+ * Parked entities hold no stock (zero quantity, no location) and wait to be reused by
+ * the next spawn. The service's chunk query and the added observer exclude this tag, so
+ * bulk reads never see them; the service removes it when it hands the entity out again.
+ */
+USTRUCT()
+struct PRAXISCORE_API FMaterialPooledTag : public FMassTag
+{
+	GENERATED_BODY()
+};
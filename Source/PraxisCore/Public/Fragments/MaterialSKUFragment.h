@@ -0,0 +1,32 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "Types/EPraxisUnitOfMeasure.h"
+#include "MaterialSKUFragment.generated.h"
+
+/**
+ * SKU master data of a material entity, shared by every batch of the SKU.
+ *
+ * A const shared fragment: entities with the same value are chunked together,
+ * so chunk reads get the SKU once per chunk (and can skip whole chunks of other
+ * SKUs) and entities don't each carry their own copy. Changing an entity's value
+ * moves it to the chunks of the new value.
+ */
+USTRUCT()
+struct PRAXISCORE_API FMaterialSKUFragment : public FMassConstSharedFragment
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FName SKU;
+	
+	/** BOM the batches were produced by (None for purchased/consumed material) */
+	UPROPERTY()
+	FName BOMId;
+	
+	UPROPERTY()
+	EPraxisUnitOfMeasure UnitOfMeasure = EPraxisUnitOfMeasure::Each;
+};
@@ -0,0 +1,78 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassObserverProcessor.h"
+#include "MassEntityQuery.h"
+#include "PraxisInventoryObservers.generated.h"
+
+class UPraxisInventoryService;
+
+/**
+ * UPraxisMaterialObserver
+ *
+ * Base for the observers that keep UPraxisInventoryService's indexes, aggregates and
+ * location capacities in step with material entities, whichever system changed them.
+ * Matching entities are handed to the service one chunk at a time.
+ *
+ * The service's own spawns and destroys are filed directly and ignored here.
+ */
+UCLASS(Abstract)
+class PRAXISCORE_API UPraxisMaterialObserver : public UMassObserverProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UPraxisMaterialObserver();
+
+protected:
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	/** Hand one chunk of observed entities to the service */
+	virtual void HandleChunk(UPraxisInventoryService& InventoryService, FMassExecutionContext& Context) const PURE_VIRTUAL(UPraxisMaterialObserver::HandleChunk, );
+
+	FMassEntityQuery EntityQuery;
+};
+
+/** Material entities created outside the service: track and index them */
+UCLASS()
+class PRAXISCORE_API UPraxisMaterialAddedObserver : public UPraxisMaterialObserver
+{
+	GENERATED_BODY()
+
+public:
+	UPraxisMaterialAddedObserver();
+
+protected:
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+	virtual void HandleChunk(UPraxisInventoryService& InventoryService, FMassExecutionContext& Context) const override;
+};
+
+/** Material entities destroyed outside the service: take them out of indexes, aggregates and capacity */
+UCLASS()
+class PRAXISCORE_API UPraxisMaterialRemovedObserver : public UPraxisMaterialObserver
+{
+	GENERATED_BODY()
+
+public:
+	UPraxisMaterialRemovedObserver();
+
+protected:
+	virtual void HandleChunk(UPraxisInventoryService& InventoryService, FMassExecutionContext& Context) const override;
+};
+
+/** Material entities flagged with FMaterialIndexDirtyTag: re-index them and clear the tag */
+UCLASS()
+class PRAXISCORE_API UPraxisMaterialChangedObserver : public UPraxisMaterialObserver
+{
+	GENERATED_BODY()
+
+public:
+	UPraxisMaterialChangedObserver();
+
+protected:
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+	virtual void HandleChunk(UPraxisInventoryService& InventoryService, FMassExecutionContext& Context) const override;
+};
@@ -3,12 +3,25 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include <atomic>
+#include "Tasks/Task.h"
 #include "Subsystems/WorldSubsystem.h"
 #include "MassEntityTypes.h"
 #include "MassEntityManager.h"
 #include "MassArchetypeTypes.h"
+#include "MassEntityQuery.h"
 #include "Types/EPraxisLocationType.h"
 #include "Types/FPraxisMaterialFlowEvent.h"
+#include "Types/FPraxisEntityHandleSet.h"
+#include "Types/FPraxisFluidStore.h"
+#include "Types/FPraxisGenealogyGraph.h"
+#include "Types/FPraxisInventoryAudit.h"
+#include "Types/FPraxisLocationTable.h"
+#include "Types/FPraxisMaterialIndex.h"
+#include "Types/FPraxisPutawayIndex.h"
+#include "Types/FPraxisReservationLedger.h"
+#include "Types/FPraxisTimingWheel.h"
+#include "Types/FPraxisTransactionJournal.h"
 #include "PraxisInventoryService.generated.h"
 
 // Forward declarations
@@ -28,7 +41,7 @@ struct PRAXISCORE_API FLocationCapacity
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FName LocationId;
 	
-	/** Sub-location identifier (Zone, Rack, Bin, etc.) */
+	/** Sub-location path within the location ("Zone/Rack/Bin"); None for the location itself */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FName SubLocationId;
 	
@@ -52,6 +65,10 @@ struct PRAXISCORE_API FLocationCapacity
 	UPROPERTY(BlueprintReadOnly)
 	int32 CurrentItems = 0;
 	
+	/** Above the warning threshold and not yet back below the clear threshold */
+	UPROPERTY(BlueprintReadOnly)
+	bool bCapacityWarningActive = false;
+	
 	/** Is this location at capacity? */
 	bool IsAtCapacity() const
 	{
@@ -75,6 +92,18 @@ struct PRAXISCORE_API FLocationCapacity
 	{
 		return MaxVolume > 0.0f ? (CurrentVolume / MaxVolume) * 100.0f : 0.0f;
 	}
+	
+	/** Get item slot usage percentage */
+	float GetItemUsagePercent() const
+	{
+		return MaxItems > 0 ? (static_cast<float>(CurrentItems) / MaxItems) * 100.0f : 0.0f;
+	}
+	
+	/** Usage of whichever limit is closer to full */
+	float GetUsagePercent() const
+	{
+		return FMath::Max(GetVolumeUsagePercent(), GetItemUsagePercent());
+	}
 };
 
 /**
@@ -109,6 +138,9 @@ struct PRAXISCORE_API FBOMEntry
 
 /**
  * Inventory Transaction Record
+ * 
+ * Blueprint/export view of a journal entry. The service stores compact
+ * FPraxisTransactionRecord entries and formats these on request.
  */
 USTRUCT(BlueprintType)
 struct PRAXISCORE_API FInventoryTransaction
@@ -127,6 +159,10 @@ struct PRAXISCORE_API FInventoryTransaction
 	UPROPERTY(BlueprintReadOnly)
 	int32 QuantityDelta = 0;
 	
+	/** Exact amount of a fluid fill/draw (QuantityDelta is it rounded to whole units) */
+	UPROPERTY(BlueprintReadOnly)
+	double FluidQuantityDelta = 0.0;
+	
 	/** Location */
 	UPROPERTY(BlueprintReadOnly)
 	FName LocationId;
@@ -148,6 +184,47 @@ struct PRAXISCORE_API FInventoryTransaction
 	FString Reference;
 };
 
+/**
+ * One batch in a genealogy trace (Blueprint view of a genealogy graph node)
+ */
+USTRUCT(BlueprintType)
+struct PRAXISCORE_API FPraxisBatchTraceEntry
+{
+	GENERATED_BODY()
+
+	/** Batch ID */
+	UPROPERTY(BlueprintReadOnly)
+	FGuid BatchId;
+	
+	/** SKU of the batch */
+	UPROPERTY(BlueprintReadOnly)
+	FName SKU;
+	
+	/** Last known material state (EMaterialState as uint8) */
+	UPROPERTY(BlueprintReadOnly)
+	uint8 MaterialState = 0;
+	
+	/** Machine that produced/consumed into this batch */
+	UPROPERTY(BlueprintReadOnly)
+	FName SourceMachineId;
+	
+	/** Work order that produced this batch */
+	UPROPERTY(BlueprintReadOnly)
+	int64 SourceWorkOrderId = 0;
+	
+	/** Sim time the batch was created */
+	UPROPERTY(BlueprintReadOnly)
+	double CreationTime = 0.0;
+	
+	/** Quality result */
+	UPROPERTY(BlueprintReadOnly)
+	bool bPassedQuality = true;
+	
+	/** Has (some of) the batch been shipped */
+	UPROPERTY(BlueprintReadOnly)
+	bool bShipped = false;
+};
+
 /**
  * Aggregate Inventory Summary (for fast queries)
  */
@@ -176,15 +253,37 @@ struct PRAXISCORE_API FInventorySummary
 	UPROPERTY(BlueprintReadOnly)
 	int32 ReservedQuantity = 0;
 	
+	/** Reserved quantity by location */
+	UPROPERTY(BlueprintReadOnly)
+	TMap<FName, int32> ReservedByLocation;
+	
 	/** Total volume occupied */
 	UPROPERTY(BlueprintReadOnly)
 	float TotalVolume = 0.0f;
 	
+	/** Unit of measure of the fluid quantities (Each for purely discrete SKUs) */
+	UPROPERTY(BlueprintReadOnly)
+	EPraxisUnitOfMeasure UnitOfMeasure = EPraxisUnitOfMeasure::Each;
+	
+	/** Continuous stock held in fluid containers (tanks/silos/coils); not part of TotalQuantity */
+	UPROPERTY(BlueprintReadOnly)
+	double FluidQuantity = 0.0;
+	
+	/** Continuous stock by location (one entry per location with a container of this SKU) */
+	UPROPERTY(BlueprintReadOnly)
+	TMap<FName, double> FluidByLocation;
+	
 	/** Available quantity (Total - Reserved) */
 	int32 GetAvailableQuantity() const
 	{
 		return TotalQuantity - ReservedQuantity;
 	}
+	
+	/** Available quantity at a location */
+	int32 GetAvailableQuantity(FName LocationId) const
+	{
+		return QuantityByLocation.FindRef(LocationId) - ReservedByLocation.FindRef(LocationId);
+	}
 };
 
 /**
@@ -214,17 +313,446 @@ struct PRAXISCORE_API FLocationInventoryItem
 	/** Is this material reserved? */
 	UPROPERTY(BlueprintReadOnly)
 	bool bReserved = false;
+	
+	/** Continuous stock in fluid containers (not counted in Quantity) */
+	UPROPERTY(BlueprintReadOnly)
+	double FluidQuantity = 0.0;
+	
+	/** Unit of measure of FluidQuantity (Each for discrete items) */
+	UPROPERTY(BlueprintReadOnly)
+	EPraxisUnitOfMeasure UnitOfMeasure = EPraxisUnitOfMeasure::Each;
+};
+
+/**
+ * Filter for chunk-based inventory queries. Unset fields match anything.
+ */
+USTRUCT(BlueprintType)
+struct PRAXISCORE_API FPraxisMaterialQueryFilter
+{
+	GENERATED_BODY()
+
+	/** SKU to match (None = any) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName SKU;
+	
+	/** Location to match (None = any, unless bExactLocation is set) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName LocationId;
+	
+	/** Match LocationId literally, so None matches only stock with no location */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bExactLocation = false;
+	
+	/** Material state to match (0=RM, 1=WIP, 2=FG, 3=Scrap, 4=InTransit; -1 = any) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MaterialState = -1;
+	
+	/** Filter on reservation status */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bFilterReserved = false;
+	
+	/** Required reservation status when bFilterReserved is set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bReserved = false;
+	
+	bool MatchesAnyLocation() const { return LocationId.IsNone() && !bExactLocation; }
+	
+	bool Matches(FName InSKU, FName InLocationId, uint8 InState, bool bInReserved) const
+	{
+		return (SKU.IsNone() || SKU == InSKU)
+			&& (MatchesAnyLocation() || LocationId == InLocationId)
+			&& (MaterialState < 0 || MaterialState == InState)
+			&& (!bFilterReserved || bReserved == bInReserved);
+	}
+};
+
+/**
+ * Inventory batch operation type
+ */
+UENUM(BlueprintType)
+enum class EPraxisInventoryOpType : uint8
+{
+	Consume     UMETA(DisplayName="Consume"),     // Reserved RM → WIP (MachineId, WorkOrderId, SKU)
+	Produce     UMETA(DisplayName="Produce"),     // WIP → FG at LocationId (Inputs: the WIP each unit uses up)
+	Scrap       UMETA(DisplayName="Scrap"),       // WIP → Scrap at LocationId (Inputs as for Produce)
+	Transfer    UMETA(DisplayName="Transfer"),    // LocationId → DestinationLocationId
+	Ship        UMETA(DisplayName="Ship"),        // FG out of LocationId
+	Reserve     UMETA(DisplayName="Reserve")      // Unreserved at LocationId → (WorkOrderId, MachineId)
+};
+
+/**
+ * One operation in an inventory batch (see UPraxisInventoryService::ApplyInventoryBatch)
+ */
+USTRUCT(BlueprintType)
+struct PRAXISCORE_API FPraxisInventoryOp
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EPraxisInventoryOpType Type = EPraxisInventoryOpType::Consume;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName SKU;
+	
+	/** Units; each op moves its whole quantity at once (Consume takes it from the claims as one WIP batch) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 Quantity = 1;
+	
+	/** Output location (Produce/Scrap), source location (Transfer/Ship/Reserve) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName LocationId;
+	
+	/** Destination location (Transfer only) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName DestinationLocationId;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName MachineId;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int64 WorkOrderId = 0;
+	
+	/** Produce/Scrap: the output is made from Inputs rather than from Quantity WIP units of any SKU, one for one */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bExplicitInputs = false;
+	
+	/** Produce/Scrap with bExplicitInputs: WIP units of each SKU (SKU → units, possibly none) used up by
+	 *  the whole Quantity. The output is one batch with every WIP batch drawn on as a parent. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TMap<FName, int32> Inputs;
+	
+	static FPraxisInventoryOp MakeConsume(FName InMachineId, int64 InWorkOrderId, FName InSKU, int32 InQuantity)
+	{
+		FPraxisInventoryOp Op;
+		Op.Type = EPraxisInventoryOpType::Consume;
+		Op.MachineId = InMachineId;
+		Op.WorkOrderId = InWorkOrderId;
+		Op.SKU = InSKU;
+		Op.Quantity = InQuantity;
+		return Op;
+	}
+	
+	static FPraxisInventoryOp MakeProduce(FName InMachineId, int64 InWorkOrderId, FName InSKU, int32 InQuantity, FName InLocationId, bool bScrap = false)
+	{
+		FPraxisInventoryOp Op;
+		Op.Type = bScrap ? EPraxisInventoryOpType::Scrap : EPraxisInventoryOpType::Produce;
+		Op.MachineId = InMachineId;
+		Op.WorkOrderId = InWorkOrderId;
+		Op.SKU = InSKU;
+		Op.Quantity = InQuantity;
+		Op.LocationId = InLocationId;
+		return Op;
+	}
+	
+	/** Produce (or scrap) Quantity units made from the given WIP inputs, e.g. a BOM's worth per unit */
+	static FPraxisInventoryOp MakeProduceFromInputs(FName InMachineId, int64 InWorkOrderId, FName InSKU, int32 InQuantity, FName InLocationId, const TMap<FName, int32>& InInputs, bool bScrap = false)
+	{
+		FPraxisInventoryOp Op = MakeProduce(InMachineId, InWorkOrderId, InSKU, InQuantity, InLocationId, bScrap);
+		Op.bExplicitInputs = true;
+		Op.Inputs = InInputs;
+		return Op;
+	}
+};
+
+/**
+ * Lot rotation when picking stock of a SKU at a location
+ */
+UENUM(BlueprintType)
+enum class EPraxisLotPickingPolicy : uint8
+{
+	FIFO    UMETA(DisplayName="FIFO"),   // Oldest batch first (creation time)
+	LIFO    UMETA(DisplayName="LIFO"),   // Newest batch first
+	FEFO    UMETA(DisplayName="FEFO")    // Earliest expiry first (see SetShelfLife); batches without expiry last
+};
+
+/**
+ * Putaway bin selection policy
+ */
+UENUM(BlueprintType)
+enum class EPraxisPutawayPolicy : uint8
+{
+	FirstFit    UMETA(DisplayName="First Fit"),   // First registered bin with room
+	BestFit     UMETA(DisplayName="Best Fit"),    // Bin with the least room that still fits
+	Closest     UMETA(DisplayName="Closest")      // Bin nearest a position (LocationRegistry positions)
+};
+
+/**
+ * Result of a putaway search
+ */
+USTRUCT(BlueprintType)
+struct PRAXISCORE_API FPraxisPutawayResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	bool bFound = false;
+	
+	UPROPERTY(BlueprintReadOnly)
+	FName LocationId;
+	
+	/** Bin path within the location (None if the location itself is the bin) */
+	UPROPERTY(BlueprintReadOnly)
+	FName SubLocationId;
+	
+	/** Free volume of the bin before putaway */
+	UPROPERTY(BlueprintReadOnly)
+	float FreeVolume = 0.0f;
+};
+
+/**
+ * A reservation that ran out its time-to-live (one per SKU and location released)
+ */
+USTRUCT(BlueprintType)
+struct PRAXISCORE_API FPraxisReservationExpiredEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 WorkOrderId = 0;
+	
+	UPROPERTY(BlueprintReadOnly)
+	FName MachineId;
+	
+	UPROPERTY(BlueprintReadOnly)
+	FName SKU;
+	
+	UPROPERTY(BlueprintReadOnly)
+	FName LocationId;
+	
+	/** Units returned to available stock */
+	UPROPERTY(BlueprintReadOnly)
+	int32 Quantity = 0;
+	
+	/** Sim tick the reservation expired on */
+	UPROPERTY(BlueprintReadOnly)
+	int32 TickCount = 0;
+};
+
+/**
+ * A fluid container ran empty or full; the flows pushing it past the limit were stopped
+ */
+USTRUCT(BlueprintType)
+struct PRAXISCORE_API FPraxisFluidLimitEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	FName ContainerId;
+	
+	UPROPERTY(BlueprintReadOnly)
+	FName SKU;
+	
+	UPROPERTY(BlueprintReadOnly)
+	FName LocationId;
+	
+	/** Full (inflows stopped) rather than empty (draws stopped) */
+	UPROPERTY(BlueprintReadOnly)
+	bool bFull = false;
+	
+	/** Sim tick the limit was reached in */
+	UPROPERTY(BlueprintReadOnly)
+	int32 TickCount = 0;
+	
+	/** Sim seconds into that tick */
+	UPROPERTY(BlueprintReadOnly)
+	double TimeIntoTick = 0.0;
+};
+
+/**
+ * How lot compaction groups small batches of a SKU into lots
+ */
+USTRUCT(BlueprintType)
+struct PRAXISCORE_API FPraxisLotFormingRule
+{
+	GENERATED_BODY()
+
+	/** Merge small batches of this SKU at all */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bEnabled = true;
+	
+	/** Units per lot (pallet size); batches at or above it are left alone. 0 = no limit */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	int32 MaxLotQuantity = 1000;
+	
+	/** Only merge batches produced by the same work order */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bLotPerWorkOrder = true;
+};
+
+/**
+ * Batches that may be merged into one lot: same SKU, place, state, reservation,
+ * quality result and unit volume (and source work order if the rule asks for it)
+ */
+struct FPraxisLotCompactionKey
+{
+	FName SKU;
+	FName LocationId;
+	FName SubLocationId;
+	FName ReservedForMachine;
+	int64 ReservedForWorkOrder = 0;
+	int64 SourceWorkOrderId = 0;
+	float VolumePerUnit = 0.0f;
+	uint8 MaterialState = 0;
+	bool bReserved = false;
+	bool bPassedQuality = true;
+
+	bool operator==(const FPraxisLotCompactionKey& Other) const
+	{
+		return SKU == Other.SKU && LocationId == Other.LocationId && SubLocationId == Other.SubLocationId
+			&& ReservedForMachine == Other.ReservedForMachine && ReservedForWorkOrder == Other.ReservedForWorkOrder
+			&& SourceWorkOrderId == Other.SourceWorkOrderId && VolumePerUnit == Other.VolumePerUnit
+			&& MaterialState == Other.MaterialState && bReserved == Other.bReserved && bPassedQuality == Other.bPassedQuality;
+	}
+
+	friend uint32 GetTypeHash(const FPraxisLotCompactionKey& Key)
+	{
+		uint32 Hash = HashCombineFast(GetTypeHash(Key.SKU), GetTypeHash(Key.LocationId));
+		Hash = HashCombineFast(Hash, GetTypeHash(Key.SubLocationId));
+		Hash = HashCombineFast(Hash, GetTypeHash(Key.SourceWorkOrderId));
+		return HashCombineFast(Hash, (static_cast<uint32>(Key.MaterialState) << 2) | (Key.bReserved ? 2u : 0u) | (Key.bPassedQuality ? 1u : 0u));
+	}
+};
+
+/**
+ * Parked material entities of one SKU/BOM shared value, ready for reuse without a chunk move.
+ * Entities are zero quantity, untracked and tagged FMaterialPooledTag. A slot map makes
+ * membership tests and removal O(1), for entities another system takes out of the pool.
+ */
+struct FPraxisMaterialEntityPool
+{
+	/** Spawns since the last refill; EndTick tops the pool up by no more than this */
+	int32 DemandThisTick = 0;
+	
+	int32 Num() const { return Entities.Num(); }
+	bool Contains(const FMassEntityHandle& Entity) const { return Slots.Contains(Entity); }
+	TConstArrayView<FMassEntityHandle> GetEntities() const { return Entities; }
+	
+	/** Park an entity. Returns false if it already is. */
+	bool Add(const FMassEntityHandle& Entity)
+	{
+		if (Slots.Contains(Entity))
+		{
+			return false;
+		}
+		Slots.Add(Entity, Entities.Add(Entity));
+		return true;
+	}
+	
+	/** Take the most recently parked entity. Returns false when empty. */
+	bool Pop(FMassEntityHandle& OutEntity)
+	{
+		if (Entities.Num() == 0)
+		{
+			return false;
+		}
+		OutEntity = Entities.Last();
+		return Remove(OutEntity);
+	}
+	
+	/** Drop an entity, swapping the last one into its slot. Returns false if it wasn't parked. */
+	bool Remove(const FMassEntityHandle& Entity)
+	{
+		int32 Slot = INDEX_NONE;
+		if (!Slots.RemoveAndCopyValue(Entity, Slot))
+		{
+			return false;
+		}
+		Entities.RemoveAtSwap(Slot, EAllowShrinking::No);
+		if (Slot < Entities.Num())
+		{
+			Slots[Entities[Slot]] = Slot;
+		}
+		return true;
+	}
+	
+private:
+	TArray<FMassEntityHandle> Entities;
+	TMap<FMassEntityHandle, int32> Slots;
+};
+
+/**
+ * Inconsistency found by the background inventory auditor
+ */
+USTRUCT(BlueprintType)
+struct PRAXISCORE_API FPraxisInventoryDiscrepancy
+{
+	GENERATED_BODY()
+
+	/** Rule that failed (EPraxisAuditCheck name) */
+	UPROPERTY(BlueprintReadOnly)
+	FString Check;
+	
+	UPROPERTY(BlueprintReadOnly)
+	FName SKU;
+	
+	UPROPERTY(BlueprintReadOnly)
+	FName LocationId;
+	
+	/** Value held by the cache (index entry, aggregate cache or location capacity) */
+	UPROPERTY(BlueprintReadOnly)
+	float Expected = 0.0f;
+	
+	/** Value recomputed from the source data */
+	UPROPERTY(BlueprintReadOnly)
+	float Actual = 0.0f;
+	
+	/** Sim tick the audited data was captured on */
+	UPROPERTY(BlueprintReadOnly)
+	int32 TickCount = 0;
+	
+	/** First journal transaction touching this SKU/location since the data was last audited */
+	UPROPERTY(BlueprintReadOnly)
+	bool bHasSuspectTransaction = false;
+	
+	UPROPERTY(BlueprintReadOnly)
+	FInventoryTransaction SuspectTransaction;
+};
+
+/**
+ * Immutable inventory state published at the end of a sim tick.
+ * 
+ * Safe to read from any thread. Per-SKU summaries and per-location capacities
+ * are shared with the previous snapshot unless they changed during the tick
+ * (copy-on-write), so publishing does not deep-copy the inventory.
+ */
+struct PRAXISCORE_API FPraxisInventorySnapshot
+{
+	using FSummaryRef = TSharedRef<const FInventorySummary, ESPMode::ThreadSafe>;
+	using FCapacityRef = TSharedRef<const FLocationCapacity, ESPMode::ThreadSafe>;
+	using FLocationIndexRef = TSharedRef<const TMap<FName, int32>, ESPMode::ThreadSafe>;
+
+	/** Last sim tick that changed inventory before this was published */
+	int32 TickCount = INDEX_NONE;
+	
+	/** Aggregates by SKU */
+	TMap<FName, FSummaryRef> Summaries;
+	
+	/** Capacities indexed by location handle */
+	TArray<FCapacityRef> Locations;
+	
+	/** Location name → index into Locations (shared until a location is added) */
+	FLocationIndexRef LocationIndex = MakeShared<const TMap<FName, int32>, ESPMode::ThreadSafe>();
+	
+	FInventorySummary GetInventorySummary(FName SKU) const;
+	int32 GetAvailableQuantity(FName SKU, FName LocationId) const;
+	double GetFluidQuantity(FName SKU, FName LocationId) const;
+	FLocationCapacity GetLocationCapacity(FName LocationId) const;
 };
 
+using FPraxisInventorySnapshotPtr = TSharedPtr<const FPraxisInventorySnapshot, ESPMode::ThreadSafe>;
+
 /**
  * UPraxisInventoryService
  * 
  * Manages material inventory using Mass entities with:
  * - BOM-based transformations
- * - Location capacity management (two-level: Location.SubLocation)
+ * - Location capacity tree (Location → Zone → Rack → Bin) with rolled-up usage, booked from the index
  * - Batch genealogy tracking
  * - Transaction history
- * - Aggregate caching for fast queries
+ * - Aggregate caching for fast queries, maintained by per-entity deltas (full rebuild kept for verification)
+ * - Secondary indexes (stock key, reservation key) for O(matches) lookups
+ * - Immutable per-tick snapshot, double-buffered so other threads read it without taking a lock
+ * - Mass observers that file material entities created, destroyed or flagged dirty by other systems
  * 
  * Material Flow:
  *   RM (Warehouse) → Reserved → WIP (Machine) → FG/Scrap (Output Buffer)
@@ -255,14 +783,21 @@ public:
 		FName SubLocationId = NAME_None,
 		float VolumePerUnit = 0.01f);
 	
-	/** Reserve material for a work order */
+	/**
+	 * Reserve material for a work order.
+	 * Records quantity claims against batches in the reservation ledger; batches are not
+	 * split until the claimed units are consumed, so the rest of a batch stays available.
+	 * @param TimeToLiveSeconds Sim seconds until the work order/machine's unconsumed claims
+	 *        are released (0 = never). Applies to all of its claims; the later deadline wins.
+	 */
 	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
 	bool ReserveMaterial(
 		FName SKU,
 		int32 Quantity,
 		FName LocationId,
 		int64 WorkOrderId,
-		FName MachineId);
+		FName MachineId,
+		float TimeToLiveSeconds = 0.0f);
 	
 	/** Transform material (production) using BOM */
 	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
@@ -286,6 +821,18 @@ public:
 		int32 Quantity,
 		FName FromLocation,
 		FName ToLocation);
+	
+	/**
+	 * Apply a list of operations as one commit.
+	 * All operations are validated together first (in order, so a Consume can feed a later
+	 * Produce), stock and destination capacity alike; if any would fail nothing is applied.
+	 * Each operation applies whole, with one journal record per source or destination, and
+	 * OnInventoryChanged fires once per touched (SKU, location) with the net delta.
+	 * @param OutAppliedCount Operations that applied successfully
+	 * @return true if every operation applied
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
+	bool ApplyInventoryBatch(const TArray<FPraxisInventoryOp>& Ops, int32& OutAppliedCount);
 
 	// ═══════════════════════════════════════════════════════════════════════════
 	// Production Operations (for StateTree integration)
@@ -305,6 +852,14 @@ public:
 		int64 WorkOrderId,
 		FName SKU);
 	
+	/** Units of SKU reserved for a work order/machine that have not yet been pulled into WIP; O(1) */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
+	int32 GetReservedQuantity(FName MachineId, int64 WorkOrderId, FName SKU) const;
+	
+	/** Units of SKU reserved for a work order across all machines, not yet pulled into WIP; O(1) */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
+	int32 GetWorkOrderReservedQuantity(int64 WorkOrderId, FName SKU) const;
+	
 	/**
 	 * Convert WIP to finished good
 	 * Called by STTask_Production when unit passes quality check
@@ -348,15 +903,87 @@ public:
 		FName MachineId,
 		int64 WorkOrderId);
 
+	// ═══════════════════════════════════════════════════════════════════════════
+	// Continuous Material (tanks, silos, coils)
+	// ═══════════════════════════════════════════════════════════════════════════
+	
+	/**
+	 * Register a container holding a SKU as a continuous level (kg, L, m) rather than as batches.
+	 * A SKU becomes a fluid SKU with its first container; all its containers share one unit of measure.
+	 * @param MaterialState State reported for the contents (0=RM, 2=FG, ...)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory|Fluid")
+	bool RegisterFluidContainer(
+		FName ContainerId,
+		FName LocationId,
+		FName SKU,
+		EPraxisUnitOfMeasure UnitOfMeasure,
+		double Capacity,
+		double InitialLevel = 0.0,
+		uint8 MaterialState = 0);
+	
+	/**
+	 * Set a flow into (+) or out of (-) a container, in units per sim second; 0 stops it.
+	 * Rates hold until changed and are applied analytically at tick end, covering the whole tick.
+	 * A flow is stopped automatically when it runs its container empty or full (OnFluidContainerLimit).
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory|Fluid")
+	bool SetFluidFlow(FName ContainerId, FName FlowId, int64 WorkOrderId, double RatePerSecond);
+	
+	/** Current rate of a flow (0 if unset or stopped at a limit) */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory|Fluid")
+	double GetFluidFlowRate(FName ContainerId, FName FlowId) const;
+	
+	/** Stop a flow (e.g. a machine's) on every container */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory|Fluid")
+	void StopFluidFlows(FName FlowId);
+	
+	/** Fill a container at once (delivery). Clamped to its free space; returns the amount added. */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory|Fluid")
+	double AddFluid(FName ContainerId, double Amount);
+	
+	/** Draw from a container at once. Clamped to its level; returns the amount drawn. */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory|Fluid")
+	double DrawFluid(FName ContainerId, double Amount);
+	
+	/** Level of a container as of the last tick end (or instant fill/draw) */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory|Fluid")
+	double GetFluidLevel(FName ContainerId) const;
+	
+	/** Sim seconds until a container runs empty or full at its current flows (-1 if it never does) */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory|Fluid")
+	double GetFluidTimeToLimit(FName ContainerId) const;
+	
+	/** Continuous stock of a SKU at a location (None = everywhere); O(1) (off the game thread: from the published snapshot) */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory|Fluid")
+	double GetFluidQuantity(FName SKU, FName LocationId = NAME_None) const;
+	
+	/**
+	 * A container of SKU to fill (bForFilling: most free space) or draw from (most stock).
+	 * Containers at PreferredLocationId win over others. None if the SKU has no containers.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory|Fluid")
+	FName FindFluidContainer(FName SKU, FName PreferredLocationId, bool bForFilling) const;
+	
+	/** Is this SKU held in fluid containers */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory|Fluid")
+	bool IsFluidSKU(FName SKU) const { return FluidStore.HasSKU(SKU); }
+	
+	/** Read-only access to the fluid containers */
+	const FPraxisFluidStore& GetFluidStore() const { return FluidStore; }
+	
+	/** Sim seconds the fluid flows are advanced by at each tick end */
+	double GetSimTickSeconds() const { return SimTickSeconds; }
+
 	// ═══════════════════════════════════════════════════════════════════════════
 	// Queries
 	// ═══════════════════════════════════════════════════════════════════════════
 	
-	/** Get inventory summary for a SKU */
+	/** Get inventory summary for a SKU (off the game thread: from the published snapshot) */
 	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
 	FInventorySummary GetInventorySummary(FName SKU) const;
 	
-	/** Get available quantity at a location */
+	/** Unreserved quantity at a location; O(1) (off the game thread: from the published snapshot) */
 	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
 	int32 GetAvailableQuantity(FName SKU, FName LocationId) const;
 	
@@ -364,18 +991,90 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
 	bool HasCapacity(FName LocationId, float RequiredVolume) const;
 	
-	/** Get location capacity info */
+	/** Get location capacity info (off the game thread: from the published snapshot) */
 	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
 	FLocationCapacity GetLocationCapacity(FName LocationId) const;
 	
-	/** Get transaction history */
+	/**
+	 * Pick a bin for incoming material. Bins are locations/sub-locations registered with a
+	 * volume limit and no sub-locations of their own; bins dedicated to the SKU are tried
+	 * before shared ones. Limits above the bin are enforced when the material is added.
+	 * @param NearPosition Reference position for the Closest policy
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
+	FPraxisPutawayResult FindPutawayLocation(FName SKU, float Volume, EPraxisPutawayPolicy Policy, FVector NearPosition) const;
+	
+	/** Reserve a registered bin for one SKU (None returns it to the shared pool) */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
+	bool DedicatePutawayBin(FName LocationId, FName SubLocationId, FName SKU);
+	
+	/** Capacity of a zone/rack/bin (usage includes everything below it); O(1) */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
+	FLocationCapacity GetSubLocationCapacity(FName LocationId, FName SubLocationId) const;
+	
+	/**
+	 * Latest inventory snapshot, published at the end of each sim tick.
+	 * Callable from any thread without a lock, and never waits on the publisher; hold the
+	 * pointer for as long as a consistent view is needed. Null until the first tick has ended.
+	 */
+	FPraxisInventorySnapshotPtr GetInventorySnapshot() const;
+	
+	/** Get transaction history (newest MaxRecords, oldest first) */
 	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
 	TArray<FInventoryTransaction> GetTransactionHistory(int32 MaxRecords = 100) const;
 	
-	/** Get all inventory items at a specific location (for visualization) */
+	/** Resize the transaction journal; keeps the newest records that fit */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
+	void SetTransactionHistoryCapacity(int32 NewCapacity);
+	
+	/** Export the transaction journal to CSV (path relative to Saved/) */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
+	bool ExportTransactionHistoryToCSV(const FString& FilePath) const;
+	
+	/**
+	 * Where did this batch come from: every ancestor batch, nearest first.
+	 * Served from the genealogy graph, so it works after the batches are consumed or shipped.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory|Genealogy")
+	TArray<FPraxisBatchTraceEntry> TraceBatchOrigins(FGuid BatchId) const;
+	
+	/**
+	 * Which batches were made from this batch, nearest first.
+	 * @param bFinishedGoodsOnly Only return FG descendants (e.g. "which FG lots consumed this RM batch")
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory|Genealogy")
+	TArray<FPraxisBatchTraceEntry> TraceBatchDescendants(FGuid BatchId, bool bFinishedGoodsOnly = true) const;
+	
+	/** Read-only access to the genealogy graph */
+	const FPraxisGenealogyGraph& GetGenealogyGraph() const { return Genealogy; }
+	
+	/** Read-only access to the reservation ledger */
+	const FPraxisReservationLedger& GetReservationLedger() const { return ReservationLedger; }
+	
+	/** Get all inventory items at a specific location (for visualization); None is no location, not a wildcard */
 	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
 	TArray<FLocationInventoryItem> GetInventoryAtLocation(FName LocationId) const;
 	
+	/**
+	 * Filtered inventory read over the material archetype's chunks.
+	 * Results are aggregated by (SKU, state); bReserved is set if any matching batch is reserved.
+	 * Fluid containers matching the filter are included as FluidQuantity (never reserved).
+	 * @param bParallel Process chunks on worker threads (worth it for whole-inventory reads)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
+	TArray<FLocationInventoryItem> QueryInventory(const FPraxisMaterialQueryFilter& Filter, bool bParallel = false) const;
+	
+	/**
+	 * Run a function over every material chunk (state, quantity, location,
+	 * genealogy and reservation fragments are all readable via the context).
+	 * Chunks hold a single SKU: read it once per chunk with
+	 * Context.GetConstSharedFragment<FMaterialSKUFragment>().
+	 * Entities parked in the pool (FMaterialPooledTag) are not visited.
+	 * With bParallel the function runs concurrently on worker threads and must
+	 * synchronize any shared output itself.
+	 */
+	void ForEachMaterialChunk(const FMassExecuteFunction& ChunkFunction, bool bParallel = false) const;
+	
 	/** Get total entity count (for debugging) */
 	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
 	int32 GetTotalEntityCount() const { return MaterialEntities.Num(); }
@@ -392,7 +1091,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
 	void RegisterBOM(const FBOMEntry& BOM);
 	
-	/** Register a location with capacity */
+	/** BOM producing a SKU, or null; O(BOMs) */
+	const FBOMEntry* FindBOMForOutput(FName OutputSKU) const;
+	
+	/** Register a location with capacity.
+	 *  With a SubLocationId ("Zone", "Zone/Rack", "Zone/Rack/Bin") the limits apply to
+	 *  that node of the location's capacity tree; missing parent nodes are created unlimited. */
 	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
 	void RegisterLocation(
 		FName LocationId, 
@@ -401,9 +1105,59 @@ public:
 		int32 MaxItems,
 		FName SubLocationId = NAME_None);
 	
-	/** Force aggregate cache refresh */
+	/** Lot rotation used by ReserveMaterial, ShipFinishedGoods and TransferMaterial for a SKU.
+	 *  Re-sorts the SKU's existing lots (O(entities)). */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
+	void SetLotPickingPolicy(FName SKU, EPraxisLotPickingPolicy Policy);
+	
+	/** Shelf life for batches of a SKU created from now on (expiry = creation + shelf life;
+	 *  derived batches keep the earliest expiry of their parents). <= 0 clears it. */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
+	void SetShelfLife(FName SKU, double ShelfLifeSeconds);
+	
+	/** SKU master data. Batches spawned from now on carry the unit of measure
+	 *  (existing batches keep the value they were spawned with). */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
+	void RegisterSKU(FName SKU, EPraxisUnitOfMeasure UnitOfMeasure);
+	
+	/** Lot-forming rule used when compacting small batches of a SKU */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
+	void SetLotFormingRule(FName SKU, const FPraxisLotFormingRule& Rule);
+	
+	/** Pre-create a machine's WIP/Output/Scrap locations (called when the machine registers) */
 	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
-	void RefreshAggregates() { UpdateAggregates(); }
+	void RegisterMachineLocations(FName MachineId);
+	
+	/** A machine's WIP/Output/Scrap locations; registers them on first use */
+	const FPraxisMachineLocations& GetMachineLocations(FName MachineId);
+	
+	/** A machine's locations, or nullptr if the machine never registered */
+	const FPraxisMachineLocations* FindMachineLocations(FName MachineId) const { return MachineLocations.Find(MachineId); }
+	
+	/** Force aggregate cache refresh (full rebuild from entities; normally maintained by deltas) */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory")
+	void RefreshAggregates();
+	
+	/** Cross-check the delta-maintained aggregate cache against a full rebuild.
+	 *  @return true if both agree; mismatches are logged */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory|Debug")
+	bool VerifyAggregates() const;
+	
+	/** Enable/disable cross-checking the aggregate cache after every transaction (slow) */
+	UFUNCTION(BlueprintCallable, Category = "Praxis|Inventory|Debug")
+	void SetVerifyAggregateDeltas(bool bEnabled) { bVerifyAggregateDeltas = bEnabled; }
+
+	// ═══════════════════════════════════════════════════════════════════════════
+	// Simulation Tick
+	// ═══════════════════════════════════════════════════════════════════════════
+	
+	/**
+	 * Tick-end housekeeping, called by the orchestrator after OnSimTick has been broadcast.
+	 * Advances fluid container levels by the tick's flows, expires reservations whose time-to-live ran out, merges small batches into lots
+	 * (time-budgeted), runs the background audit, flushes batched entity destroys,
+	 * refills the entity pool in one batch and publishes the inventory snapshot.
+	 */
+	void EndTick(int32 TickCount, double SimDeltaSeconds);
 
 	// ═══════════════════════════════════════════════════════════════════════════
 	// Events
@@ -412,6 +1166,9 @@ public:
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnInventoryChanged, FName, SKU, FName, LocationId, int32, NewQuantity);
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnLocationCapacityWarning, FName, LocationId, float, UsedPercentage);
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnLowStock, FName, SKU, int32, RemainingQuantity);
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnReservationExpired, const FPraxisReservationExpiredEvent&, Event);
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInventoryDiscrepancy, const FPraxisInventoryDiscrepancy&, Discrepancy);
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnFluidContainerLimit, const FPraxisFluidLimitEvent&, Event);
 	
 	// Flow event delegate for visualization (non-dynamic for struct support)
 	DECLARE_MULTICAST_DELEGATE_OneParam(FOnMaterialFlowEvent, const FPraxisMaterialFlowEvent&);
@@ -419,22 +1176,58 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Praxis|Inventory")
 	FOnInventoryChanged OnInventoryChanged;
 	
+	/** Fired when a location/sub-location rises above CapacityWarningPercent of its volume or
+	 *  item slots, and on every add it rejects */
 	UPROPERTY(BlueprintAssignable, Category = "Praxis|Inventory")
 	FOnLocationCapacityWarning OnLocationCapacityWarning;
 	
+	/** Fired when a warned location/sub-location drops back below CapacityWarningClearPercent */
+	UPROPERTY(BlueprintAssignable, Category = "Praxis|Inventory")
+	FOnLocationCapacityWarning OnLocationCapacityCleared;
+	
 	UPROPERTY(BlueprintAssignable, Category = "Praxis|Inventory")
 	FOnLowStock OnLowStock;
 	
+	/** Fired at tick end for reservations released by their time-to-live */
+	UPROPERTY(BlueprintAssignable, Category = "Praxis|Inventory")
+	FOnReservationExpired OnReservationExpired;
+	
+	/** Fired at tick end for each fluid container that ran empty or full during the tick */
+	UPROPERTY(BlueprintAssignable, Category = "Praxis|Inventory|Fluid")
+	FOnFluidContainerLimit OnFluidContainerLimit;
+	
+	/** Fired for each inconsistency the background auditor finds */
+	UPROPERTY(BlueprintAssignable, Category = "Praxis|Inventory|Debug")
+	FOnInventoryDiscrepancy OnInventoryDiscrepancy;
+	
 	/** Flow event for visualization animations (transfers, production, consumption) */
 	FOnMaterialFlowEvent OnMaterialFlowEvent;
 
+	// ═══════════════════════════════════════════════════════════════════════════
+	// Mass Observer Hooks (see PraxisInventoryObservers.h)
+	// ═══════════════════════════════════════════════════════════════════════════
+	
+	/** Material entities created by another system: track and index them */
+	void HandleMaterialEntitiesAdded(TConstArrayView<FMassEntityHandle> Entities);
+	
+	/** Tracked material entities destroyed by another system: drop them from indexes, aggregates and capacity */
+	void HandleMaterialEntitiesRemoved(TConstArrayView<FMassEntityHandle> Entities);
+	
+	/** Material entities flagged with FMaterialIndexDirtyTag: re-index them from their fragments */
+	void HandleMaterialEntitiesChanged(TConstArrayView<FMassEntityHandle> Entities);
+	
+	/** True while the service makes structural changes it files itself */
+	bool IsIgnoringMaterialObservers() const { return bIgnoreMaterialObservers; }
+
 private:
 	// ═══════════════════════════════════════════════════════════════════════════
 	// Internal Helpers
 	// ═══════════════════════════════════════════════════════════════════════════
 	
-	/** Spawn a material entity with all fragments
+	/** Spawn a material entity with all fragments and register its batch in the genealogy graph
 	 * @param InitialState Material state (0=RawMaterial, 1=WIP, 2=FG, 3=Scrap, 4=InTransit)
+	 * @param ParentBatchIds Batches this one was made or split from
+	 * @param BOMId Recipe that produced the batch (NAME_None for received/split stock)
 	 */
 	FMassEntityHandle SpawnMaterialEntity(
 		FName SKU,
@@ -442,28 +1235,236 @@ private:
 		FName LocationId,
 		FName SubLocationId,
 		float VolumePerUnit,
-		uint8 InitialState = 0);
+		uint8 InitialState = 0,
+		TConstArrayView<FGuid> ParentBatchIds = TConstArrayView<FGuid>(),
+		FName BOMId = NAME_None);
+	
+	/** Shared SKU fragment value for a SKU/BOM pair (created once, then cached) */
+	FConstSharedStruct GetSKUSharedFragment(FName SKU, FName BOMId);
+	
+	/** An untracked, empty entity in a SKU/BOM's chunks: from its pool, else created */
+	FMassEntityHandle AcquireMaterialEntity(FName SKU, FName BOMId);
+	
+	/** Pool an entity belongs in: the one for its SKU/BOM shared value */
+	FPraxisMaterialEntityPool* FindEntityPool(const FMassEntityHandle& Entity);
 	
 	/** Despawn material entities */
 	void DespawnMaterialEntities(const TArray<FMassEntityHandle>& Entities);
 	
-	/** Update aggregate cache from Mass entities */
-	void UpdateAggregates();
+	/** Retire a material entity: drop it from tracking and indexes and park it in the pool */
+	void DestroyMaterialEntity(const FMassEntityHandle& Entity);
+	
+	/** Drop an entity from tracking, indexes, aggregates, capacity and the reservation ledger */
+	void UntrackMaterialEntity(FMassEntityHandle Entity);
+	
+	/** Pull Quantity reserved units of SKU into WIP at the machine, one WIP batch per source batch
+	 *  @return false if the reservation ran out first (units already drawn stay in WIP) */
+	bool ConsumeReservedUnits(FName MachineId, int64 WorkOrderId, FName SKU, int32 Quantity);
+	
+	/** Complete Quantity units of a machine's WIP as FG (or scrap). Whole WIP batches convert in
+	 *  place; a partly used batch has the completed units split off as a child batch.
+	 *  With Inputs, the units are instead made from that much WIP of each SKU: the inputs are
+	 *  used up and the output is one new batch with every input batch as a parent.
+	 *  @return false if the WIP ran out first (with Inputs, nothing is changed then) */
+	bool CompleteWIPUnits(
+		FName MachineId,
+		int64 WorkOrderId,
+		FName OutputSKU,
+		FName OutputLocationId,
+		int32 Quantity,
+		bool bScrap,
+		const TMap<FName, int32>* Inputs = nullptr);
+	
+	/** CompleteWIPUnits with Inputs: use up that much of the machine's WIP of each SKU and spawn the
+	 *  output as one batch parented on every WIP batch drawn on. All-or-nothing. */
+	bool MakeFromWIPInputs(
+		FName MachineId,
+		int64 WorkOrderId,
+		FName OutputSKU,
+		FName OutputLocationId,
+		int32 Quantity,
+		bool bScrap,
+		const TMap<FName, int32>& Inputs);
+	
+	/**
+	 * Turn a WIP batch into its output (FG/Scrap), keeping the batch. The batch moves to an
+	 * entity already in the output SKU's chunks and the WIP entity is retired to its pool.
+	 * @return the entity now holding the batch
+	 */
+	FMassEntityHandle TransitionWIPEntity(
+		const FMassEntityHandle& Entity,
+		FName OutputSKU,
+		FName OutputLocationId,
+		uint8 NewState,
+		bool bPassedQuality,
+		FName MachineId,
+		int64 WorkOrderId);
+	
+	/** Copy an entity's state, source and quality onto its genealogy graph node */
+	void SyncGenealogyNode(const FMassEntityHandle& Entity);
+	
+	/** Expand graph nodes into trace entries */
+	void BuildTraceEntries(TConstArrayView<uint32> BatchIds, bool bFinishedGoodsOnly, TArray<FPraxisBatchTraceEntry>& OutEntries) const;
+	
+	/** (Re)file an entity in the secondary indexes from its current fragments and
+	 *  apply the resulting delta to the aggregate cache and location capacities.
+	 *  Call after spawning and after any change to SKU, location, state, reservation or quantity
+	 *  (other systems add FMaterialIndexDirtyTag instead; an observer calls this). */
+	void IndexMaterialEntity(const FMassEntityHandle& Entity);
+	
+	/** Apply a signed quantity/volume delta for one stock key to the aggregate cache */
+	void ApplyAggregateDelta(const FPraxisMaterialStockKey& StockKey, int32 QuantityDelta, float VolumeDelta);
+	
+	/** Apply a signed reserved-quantity delta to the aggregate cache */
+	void ApplyReservedDelta(FName SKU, FName LocationId, int32 QuantityDelta);
+	
+	/** Units of an indexed batch not claimed in the reservation ledger */
+	int32 GetUnclaimedQuantity(FMassEntityHandle Entity, const FPraxisMaterialIndex::FEntry& Entry) const
+	{
+		return Entry.Quantity - ReservationLedger.GetClaimedFromBatch(Entity);
+	}
+	
+	/** Take units off a ledger claim and keep aggregates in step */
+	void ReduceReservationClaim(int32 ClaimId, int32 Quantity);
+	
+	/** Drop a work order/machine's ledger claims; returns the claims released */
+	TArray<FPraxisReservationLedger::FClaim> ReleaseReservationClaims(const FPraxisMaterialReservationKey& Owner);
+	
+	/** Set or extend the expiry of a work order/machine's reservations */
+	void ScheduleReservationExpiry(const FPraxisMaterialReservationKey& Owner, float TimeToLiveSeconds);
+	
+	/** Release reservations whose expiry tick has been reached; O(expired) */
+	void ExpireReservations(int32 TickCount);
+	
+	/**
+	 * Merge small compatible batches into lots, within CompactionBudgetMs.
+	 * Each lot that grew keeps its genealogy batch, which gains every batch merged
+	 * into it as a parent.
+	 */
+	void CompactLots(int32 TickCount);
+	
+	/** Drop genealogy past GenealogyRetentionSeconds once the graph has doubled since the last pass */
+	void CompactGenealogy(int32 TickCount);
+	
+	/** Compaction grouping of an entity; false if it is not a candidate (WIP, in transit, empty) */
+	bool MakeLotCompactionKey(const FMassEntityHandle& Entity, FPraxisLotCompactionKey& OutKey, int32& OutQuantity) const;
+	
+	/** Move a batch's units (and ledger claims) into a lot and retire the batch */
+	void MergeIntoLot(const FMassEntityHandle& Lot, const FMassEntityHandle& Entity, int32 Quantity);
+	
+	/** Record the merged batches as parents of the lot's batch and log the merge */
+	void MergeLotGenealogy(const FMassEntityHandle& Lot, TConstArrayView<FGuid> MergedBatchIds, int32 TickCount);
+	
+	const FPraxisLotFormingRule& GetLotFormingRule(FName SKU) const
+	{
+		const FPraxisLotFormingRule* Rule = LotFormingRules.Find(SKU);
+		return Rule ? *Rule : DefaultLotFormingRule;
+	}
+	
+	/** Advance fluid levels by one tick of flows and publish the changed SKUs' aggregates */
+	void AdvanceFluids(int32 TickCount, double Seconds);
+	
+	/** Recompute a SKU's fluid aggregates from its containers; O(containers of the SKU) */
+	void SyncFluidAggregate(FName SKU);
+	
+	/** Add a SKU's containers to an aggregate cache (shared by sync and full rebuild) */
+	void AddFluidAggregate(FName SKU, FInventorySummary& Summary) const;
+	
+	/** Collect the previous audit pass and launch the next one on a worker */
+	void TickInventoryAudit(int32 TickCount);
+	
+	/** Copy the next slice of entities (and, at round start, the aggregates) for the auditor */
+	void BuildAuditSlice(FPraxisAuditSlice& OutSlice);
+	
+	/** Log and broadcast a finished pass's findings */
+	void ReportAuditFindings(const FPraxisAuditSlice& Slice, const TArray<FPraxisAuditFinding>& Findings, int64 SinceSequence);
+	
+	/** Logical journal index of the first record since a sequence number touching SKU/location (None = any), or INDEX_NONE */
+	int32 FindFirstTransactionSince(int64 Sequence, FName SKU, FName LocationId) const;
+	
+	/** Pick-order key of a batch under its SKU's lot picking policy */
+	FPraxisLotSortKey MakeLotSortKey(FName SKU, const FGuid& BatchId, double CreationTime) const;
+	
+	/** Build an aggregate cache from scratch by visiting every chunk (verification/recovery path) */
+	void RebuildAggregates(TMap<FName, FInventorySummary>& OutCache) const;
+	
+	/** Post-transaction hook: cross-checks aggregates when bVerifyAggregateDeltas is set */
+	void OnTransactionCommitted();
 	
 	/** Log transaction */
-	void LogTransaction(const FInventoryTransaction& Transaction);
+	void LogTransaction(const FPraxisTransactionRecord& Record);
+	
+	/** Expand a journal record into its Blueprint/export form */
+	static FInventoryTransaction FormatTransaction(const FPraxisTransactionRecord& Record);
 	
-	/** Check and update location capacity */
-	bool UpdateLocationCapacity(FName LocationId, float VolumeDelta, int32 ItemDelta);
+	/** Check a delta fits along Bin → Rack → Zone → Location (warns if it doesn't).
+	 *  Usage itself is booked from the material index when the stock is filed. */
+	bool CheckLocationCapacity(FName LocationId, float VolumeDelta, int32 ItemDelta, FName SubLocationId = NAME_None);
+	
+	/** Roll a usage delta up Bin → Rack → Zone → Location, without limit checks */
+	void ApplyLocationCapacityDelta(FName LocationId, float VolumeDelta, int32 ItemDelta, FName SubLocationId);
+	
+	/** Move an entity's capacity booking from its old index entry to its new one (either may be null) */
+	void BookLocationCapacity(const FPraxisMaterialIndex::FEntry* Old, const FPraxisMaterialIndex::FEntry* New);
+	
+	/** Edge-triggered warning with hysteresis for one capacity node; rejections always fire */
+	void UpdateCapacityWarning(FLocationCapacity& Capacity, FName DisplayName, bool bRejected = false);
+	
+	/** Intern a location name, creating its capacity slot on first use */
+	FPraxisLocationHandle FindOrAddLocation(FName LocationId);
+	
+	/** Sub-location tree node for a path, creating it and its parents on first use */
+	int32 FindOrAddSubLocation(FPraxisLocationHandle Location, FName SubLocationId);
+	
+	/** Capacity record of a location (SubLocationNode == INDEX_NONE) or sub-location node */
+	const FLocationCapacity& GetCapacityNode(FPraxisLocationHandle Location, int32 SubLocationNode) const
+	{
+		return SubLocationNode == INDEX_NONE ? LocationCapacities[Location.Index] : SubLocationCapacities[SubLocationNode];
+	}
+	
+	/** Putaway index for a dedicated SKU (None = shared bins) */
+	FPraxisPutawayIndex& FindOrAddPutawayIndex(FName SKU);
+	
+	/** Putaway bin id of a location/sub-location node (INDEX_NONE if it is not a bin) */
+	int32& GetPutawayBinId(FPraxisLocationHandle Location, int32 SubLocationNode);
+	
+	/** Create the node's putaway bin if it has a volume limit; refresh its free volume */
+	void SyncPutawayBin(FPraxisLocationHandle Location, int32 SubLocationNode, bool bCreate);
+	
+	/** The node got child bins: it is no longer a putaway target */
+	void RetirePutawayBin(FPraxisLocationHandle Location, int32 SubLocationNode);
 	
 	/** Build the entity template for material batches */
 	void BuildMaterialEntityTemplate();
 	
-	/** Broadcast a flow event to visualizers */
+	/** Broadcast a flow event to visualizers (coalesced while a batch is open) */
 	void BroadcastFlowEvent(const FPraxisMaterialFlowEvent& Event);
 	
+	/** Broadcast OnInventoryChanged, or accumulate the delta while a batch is open */
+	void NotifyInventoryChanged(FName SKU, FName LocationId, int32 QuantityDelta);
+	
+	/** Check a batch against current stock and destination capacity without touching it
+	 *  @return index of the first operation that would fail, or INDEX_NONE */
+	int32 ValidateInventoryBatch(const TArray<FPraxisInventoryOp>& Ops) const;
+	
+	/** Units of a machine's WIP for a work order, of one SKU or (NAME_None) of any */
+	int32 GetWIPQuantity(FName MachineId, int64 WorkOrderId, FName SKU = NAME_None) const;
+	
 	/** Get world position for a location (queries LocationRegistry) */
 	FVector GetLocationWorldPosition(FName LocationId) const;
+	
+	/** Publish a snapshot of the SKUs/locations that changed since the last one */
+	void PublishSnapshot(int32 TickCount);
+	
+	/** Flag a location's capacity for the next snapshot */
+	void MarkLocationDirty(FPraxisLocationHandle Location)
+	{
+		if (Location.Index >= DirtySnapshotLocations.Num())
+		{
+			DirtySnapshotLocations.SetNum(LocationCapacities.Num(), false);
+		}
+		DirtySnapshotLocations[Location.Index] = true;
+	}
 
 	// ═══════════════════════════════════════════════════════════════════════════
 	// Data
@@ -477,28 +1478,222 @@ private:
 	UPROPERTY()
 	TObjectPtr<UPraxisLocationRegistry> LocationRegistry = nullptr;
 	
-	/** Archetype handle for material entities */
+	/** Archetype handle for material entities; the SKU shared fragment is part of it, so each
+	 *  SKU/BOM value gets its own chunks from creation on */
 	FMassArchetypeHandle MaterialArchetype;
 	
+	/** Material archetype plus FMaterialPooledTag, for pool refills */
+	FMassArchetypeHandle PooledMaterialArchetype;
+	
+	/** SKU master data: unit of measure per SKU (unregistered SKUs count in Each) */
+	TMap<FName, EPraxisUnitOfMeasure> SKUUnitsOfMeasure;
+	
+	/** Shared SKU fragment values by SKU/BOM; entities sharing a value share chunks */
+	TMap<TPair<FName, FName>, FConstSharedStruct> SKUSharedFragments;
+	
+	/** Read-only query over all material fragments (mutable: Mass queries cache archetype matches) */
+	mutable FMassEntityQuery MaterialQuery;
+	
+	/** Process chunks in parallel for internal whole-inventory reads (aggregate rebuild, location view) */
+	UPROPERTY(EditAnywhere, Category = "Praxis|Inventory")
+	bool bParallelInventoryReads = false;
+	
 	/** BOM registry */
 	UPROPERTY()
 	TMap<FName, FBOMEntry> BOMs;
 	
-	/** Location capacity tracking */
+	/** Location name ↔ dense handle table */
+	FPraxisLocationTable LocationTable;
+	
+	/** Location capacity tracking, indexed by location handle */
+	UPROPERTY()
+	TArray<FLocationCapacity> LocationCapacities;
+	
+	/** Sub-location capacity tree: capacities and structure by node index */
+	TArray<FLocationCapacity> SubLocationCapacities;
+	TArray<FPraxisSubLocationNode> SubLocationNodes;
+	
+	/** (location handle, sub-location path) → node index */
+	TMap<TPair<int32, FName>, int32> SubLocationLookup;
+	
+	/** Putaway bins (bin id = index) and their free-volume indexes by dedicated SKU (None = shared) */
+	TArray<FPraxisPutawayBin> PutawayBins;
+	TMap<FName, FPraxisPutawayIndex> PutawayIndexes;
+	
+	/** Putaway bin id by location handle / sub-location node */
+	TArray<int32> LocationPutawayBins;
+	TArray<int32> SubLocationPutawayBins;
+	
+	/** Lot picking policy for SKUs without an explicit one */
+	UPROPERTY(EditAnywhere, Category = "Praxis|Inventory")
+	EPraxisLotPickingPolicy DefaultLotPickingPolicy = EPraxisLotPickingPolicy::FIFO;
+	
+	/** Per-SKU lot picking policies */
+	UPROPERTY()
+	TMap<FName, EPraxisLotPickingPolicy> LotPickingPolicies;
+	
+	/** Per-SKU shelf life (seconds) for FEFO expiry dates */
+	UPROPERTY()
+	TMap<FName, double> ShelfLives;
+	
+	/** Merge small batches (e.g. one-unit FG) into lots at tick end */
+	UPROPERTY(EditAnywhere, Category = "Praxis|Inventory")
+	bool bCompactLots = false;
+	
+	/** How long genealogy is kept for batches no longer in stock (seconds); 0 keeps it all.
+	 *  Batches in stock keep their whole ancestry regardless. */
+	UPROPERTY(EditAnywhere, Category = "Praxis|Inventory", meta = (ClampMin = "0"))
+	double GenealogyRetentionSeconds = 30.0 * 86400.0;
+	
+	/** Graph size at which EndTick next compacts the genealogy */
+	int32 GenealogyCompactAt = 0;
+	
+	/** Time budget per tick for lot compaction (milliseconds) */
+	UPROPERTY(EditAnywhere, Category = "Praxis|Inventory", meta = (ClampMin = "0"))
+	float CompactionBudgetMs = 0.5f;
+	
+	/** Lot-forming rule for SKUs without their own */
+	UPROPERTY(EditAnywhere, Category = "Praxis|Inventory")
+	FPraxisLotFormingRule DefaultLotFormingRule;
+	
+	/** Per-SKU lot-forming rules */
 	UPROPERTY()
-	TMap<FName, FLocationCapacity> Locations;
+	TMap<FName, FPraxisLotFormingRule> LotFormingRules;
+	
+	/** Entities whose stock changed since compaction last looked at them */
+	FPraxisEntityHandleSet CompactionCandidates;
+	
+	/** Lot currently accepting batches, per compaction group */
+	TMap<FPraxisLotCompactionKey, FMassEntityHandle> OpenLots;
+	
+	/** Free-volume granularity of best-fit putaway, as a fraction of the volume (0.01 = 1%) */
+	UPROPERTY(EditAnywhere, Category = "Praxis|Inventory", meta = (ClampMin = "0.0001"))
+	float PutawayVolumeResolution = 0.01f;
+	
+	/** Volume usage that raises OnLocationCapacityWarning */
+	UPROPERTY(EditAnywhere, Category = "Praxis|Inventory", meta = (ClampMin = "0", ClampMax = "100"))
+	float CapacityWarningPercent = 80.0f;
+	
+	/** Volume usage a warned location must drop below before it can warn again */
+	UPROPERTY(EditAnywhere, Category = "Praxis|Inventory", meta = (ClampMin = "0", ClampMax = "100"))
+	float CapacityWarningClearPercent = 70.0f;
+	
+	/** Pre-built machine WIP/Output/Scrap locations by machine id */
+	TMap<FName, FPraxisMachineLocations> MachineLocations;
 	
 	/** Aggregate inventory cache (for fast queries) */
 	UPROPERTY()
 	TMap<FName, FInventorySummary> InventoryCache;
 	
-	/** Transaction history */
-	UPROPERTY()
-	TArray<FInventoryTransaction> TransactionHistory;
+	/** Transaction history (ring buffer of compact records) */
+	FPraxisTransactionJournal TransactionJournal;
+	
+	/** Number of transactions kept in the journal */
+	UPROPERTY(EditAnywhere, Category = "Praxis|Inventory", meta = (ClampMin = "1"))
+	int32 TransactionHistoryCapacity = 10000;
+	
+	/** Entity handle tracking (for cleanup and queries); sparse set, O(1) add/remove */
+	FPraxisEntityHandleSet MaterialEntities;
+	
+	/** Set while the service creates/destroys entities it files itself, so the observers skip them */
+	bool bIgnoreMaterialObservers = false;
+	
+	/** Secondary indexes by stock key and reservation key */
+	FPraxisMaterialIndex MaterialIndex;
+	
+	/** Batch genealogy; outlives the entities (fragments no longer carry parent lists) */
+	FPraxisGenealogyGraph Genealogy;
+	
+	/** Continuous material: container levels and flows */
+	FPraxisFluidStore FluidStore;
+	
+	/** Quantity-level reservations against unreserved batches (reserved entities are WIP only) */
+	FPraxisReservationLedger ReservationLedger;
 	
-	/** Entity handle tracking (for cleanup and queries) */
-	TArray<FMassEntityHandle> MaterialEntities;
+	/** Reservation expiry deadlines, in sim ticks */
+	FPraxisTimingWheel ReservationExpiryWheel;
+	
+	/** Pending expiry timer per work order/machine, and the reverse */
+	TMap<FPraxisMaterialReservationKey, int32> ReservationExpiryTimers;
+	TMap<int32, FPraxisMaterialReservationKey> ReservationExpiryOwners;
+	
+	/** Sim seconds per tick, learned from EndTick (orchestrator default until the first tick) */
+	double SimTickSeconds = 5.0;
+	
+	/** Parked material entities by SKU/BOM, so reuse never changes an entity's shared fragment */
+	TMap<TPair<FName, FName>, FPraxisMaterialEntityPool> EntityPools;
+	
+	/** Entities across all pools */
+	int32 PooledEntityCount = 0;
+	
+	/** Entities retired while the pools were full; destroyed in one batch at tick end */
+	TArray<FMassEntityHandle> PendingEntityDestroys;
+	
+	/** Per-SKU pool size EndTick refills to */
+	UPROPERTY(EditAnywhere, Category = "Praxis|Inventory|Pool", meta = (ClampMin = "0"))
+	int32 EntityPoolTargetSize = 256;
+	
+	/** Retired entities beyond this many pooled (across all SKUs) are destroyed rather than pooled */
+	UPROPERTY(EditAnywhere, Category = "Praxis|Inventory|Pool", meta = (ClampMin = "0"))
+	int32 EntityPoolMaxSize = 4096;
 	
 	/** Flag to track if archetype is initialized */
 	bool bArchetypeInitialized = false;
+	
+	/** Nesting depth of ApplyInventoryBatch; > 0 defers commit hooks and notifications */
+	int32 BatchDepth = 0;
+	
+	/** Net OnInventoryChanged deltas accumulated during a batch, keyed by (SKU, LocationId) */
+	TMap<TPair<FName, FName>, int32> PendingInventoryChanges;
+	
+	/** Flow events accumulated during a batch (one per event type/SKU/route) */
+	TArray<FPraxisMaterialFlowEvent> PendingFlowEvents;
+	
+	/** Published snapshots, double-buffered: readers copy the pointer out of the slot PublishedSlot
+	 *  names, the publisher only writes the other one. Each snapshot is immutable and kept alive by
+	 *  whoever holds it. */
+	FPraxisInventorySnapshotPtr SnapshotSlots[2];
+	std::atomic<int32> PublishedSlot{0};
+	
+	/** Readers copying the pointer out of each slot; the publisher overwrites a slot only once it has none */
+	mutable std::atomic<int32> SnapshotReaders[2] = {0, 0};
+	
+	/** SKUs whose aggregates changed since the last snapshot */
+	TSet<FName> DirtySnapshotSKUs;
+	
+	/** Locations whose capacity changed since the last snapshot (by handle) */
+	TBitArray<> DirtySnapshotLocations;
+	
+	/** Aggregates were rebuilt wholesale; the next snapshot re-copies every SKU */
+	bool bSnapshotAllSKUsDirty = false;
+	
+	/** Debug: rebuild and compare aggregates after every transaction */
+	UPROPERTY(EditAnywhere, Category = "Praxis|Inventory|Debug")
+	bool bVerifyAggregateDeltas = false;
+	
+	/** Audit a slice of entities against the caches each tick on a worker thread */
+	UPROPERTY(EditAnywhere, Category = "Praxis|Inventory|Debug")
+	bool bBackgroundAudit = false;
+	
+	/** Entities checked per tick by the background auditor */
+	UPROPERTY(EditAnywhere, Category = "Praxis|Inventory|Debug", meta = (ClampMin = "1"))
+	int32 AuditEntitiesPerTick = 256;
+	
+	/** Findings reported per audit pass (the rest are counted in the log) */
+	UPROPERTY(EditAnywhere, Category = "Praxis|Inventory|Debug", meta = (ClampMin = "1"))
+	int32 AuditMaxReportsPerPass = 16;
+	
+	/** Audit pass running on a worker, and the slice it checks */
+	UE::Tasks::TTask<TArray<FPraxisAuditFinding>> AuditTask;
+	TSharedPtr<const FPraxisAuditSlice, ESPMode::ThreadSafe> AuditInFlight;
+	
+	/** Journal position findings of the in-flight pass are traced back from */
+	int64 AuditInFlightSince = 0;
+	
+	/** Round-robin position in MaterialEntities */
+	int32 AuditCursor = 0;
+	
+	/** Journal sequence when the current and previous audit rounds started */
+	int64 AuditRoundStartSequence = 0;
+	int64 AuditPreviousRoundSequence = 0;
 };
@@ -0,0 +1,30 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "PraxisMachineInterface.generated.h"
+
+UINTERFACE(MinimalAPI, meta = (CannotImplementInterfaceInBlueprint))
+class UPraxisMachine : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * IPraxisMachine
+ *
+ * What the schedule service needs from a machine, without depending on the
+ * simulation kernel. Machines register themselves with the schedule service
+ * (UMachineLogicComponent does so on BeginPlay); work order dispatch is then
+ * a map lookup and a native call.
+ */
+class PRAXISCORE_API IPraxisMachine
+{
+	GENERATED_BODY()
+
+public:
+	/** Hand the machine a work order assigned to it */
+	virtual void AssignWorkOrder(int64 WorkOrderId, const FString& SKU, int32 Quantity) = 0;
+};
@@ -4,6 +4,14 @@
 
 #include "CoreMinimal.h"
 #include "Types/FPraxisWorkOrder.h"
+#include "Types/FPraxisRouting.h"
+#include "Types/FPraxisDispatchQueue.h"
+#include "Types/EPraxisDispatchRule.h"
+#include "Types/EPraxisPlanDirection.h"
+#include "Types/FPraxisPlannedOperation.h"
+#include "Types/FPraxisWorkCalendar.h"
+#include "UObject/WeakInterfacePtr.h"
+#include "PraxisMachineInterface.h"
 #include "UObject/NoExportTypes.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "PraxisScheduleService.generated.h"
@@ -17,9 +25,45 @@ struct FPraxisOrderState
 	GENERATED_BODY()
 	UPROPERTY() FPraxisWorkOrder WorkOrder;
 	UPROPERTY() FName MachineId;     // bound machine (if any)
-	UPROPERTY() uint8 Status = 0;    // 0=Queued,1=Running,2=Done
+	UPROPERTY() uint8 Status = 0;    // 0=Queued,1=Running,2=Done,3=Cancelled
 	UPROPERTY() int64 StartTs = 0;   // unix seconds (sim time)
 	UPROPERTY() int64 EndTs   = 0;
+	UPROPERTY() double ProcessSeconds = 0.0; // estimate the dispatch rules use
+
+	// Machine queue membership: the machine whose queue holds the order and its
+	// neighbours there (order slots), so it can be unlinked without a search
+	FName QueuedOn;
+	int32 QueuePrev = INDEX_NONE;
+	int32 QueueNext = INDEX_NONE;
+
+	// Machine the current plan dispatches the order to, until it is dispatched
+	FName PlannedOn;
+
+	// Dispatch queue arrival, kept once the order leaves the pending queue (planned or
+	// assigned) so it goes back in its place if its plan or machine returns it
+	uint64 Arrival = 0;
+};
+
+/** A machine's queue: an intrusive list through the service's order slots, in assignment order */
+struct FPraxisMachineQueue
+{
+	int32 Head = INDEX_NONE;
+	int32 Tail = INDEX_NONE;
+	int32 Num = 0;
+};
+
+/** What the planner knows about a machine beyond its id */
+struct FPraxisMachineSetup
+{
+	FName WorkCenter;
+	FPraxisWorkCalendar Calendar;
+};
+
+/** A machine's planned work orders in planned start order; Next is the first not yet dispatched */
+struct FPraxisPlannedQueue
+{
+	TArray<int64> WorkOrders;
+	int32 Next = 0;
 };
 
 USTRUCT()
@@ -45,7 +89,10 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam  (FOnOperatorReleased,  FName, Opera
  * 
  * Features:
  * - Load schedules from external sources (CSV, Blueprint, algorithms)
- * - Auto-assign work orders to idle machines (FIFO for MVP)
+ * - Auto-assign work orders to idle machines, in the order of a switchable dispatch
+ *   rule (FIFO, EDD, SPT, critical ratio, ATC, priority then EDD)
+ * - Finite-capacity forward/backward planning against machine calendars, producing
+ *   a Gantt plan the machines are then dispatched from
  * - Track work order state (Queued → Running → Complete)
  * - Support for future scheduling algorithms
  */
@@ -66,7 +113,7 @@ public:
 	// Schedule Loading (Student/Algorithm Interface)
 	// ═══════════════════════════════════════════════════════════════════════════
 	
-	/** Load a batch of work orders (from CSV, algorithm, etc.) */
+	/** Load a batch of work orders (from CSV, algorithm, etc.); queued in one go, then matched to idle machines */
 	UFUNCTION(BlueprintCallable, Category="Praxis|Schedule")
 	void LoadSchedule(const TArray<FPraxisWorkOrder>& WorkOrders);
 	
@@ -78,6 +125,75 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Praxis|Schedule")
 	bool RemoveWorkOrder(int64 WorkOrderID);
 
+	/** Cancel a work order that has not started; it leaves every queue but stays in the schedule */
+	UFUNCTION(BlueprintCallable, Category="Praxis|Schedule")
+	bool CancelWorkOrder(int64 WorkOrderID);
+
+	/** Change a work order's priority; a pending order is re-keyed in place, keeping its arrival */
+	UFUNCTION(BlueprintCallable, Category="Praxis|Schedule")
+	bool SetWorkOrderPriority(int64 WorkOrderID, EPraxisWorkOrderPriority Priority);
+
+	// ═══════════════════════════════════════════════════════════════════════════
+	// Dispatch Rules
+	// ═══════════════════════════════════════════════════════════════════════════
+	
+	/**
+	 * Choose the rule pending work orders are dispatched by; queued orders are re-keyed.
+	 * ATCLookahead is the K of the apparent tardiness cost rule (ignored by the others).
+	 */
+	UFUNCTION(BlueprintCallable, Category="Praxis|Schedule")
+	void SetDispatchRule(EPraxisDispatchRule Rule, double ATCLookahead = 2.0);
+	
+	UFUNCTION(BlueprintPure, Category="Praxis|Schedule")
+	EPraxisDispatchRule GetDispatchRule() const { return DispatchRule; }
+	
+	/**
+	 * Register a SKU's routing so processing time (setup + standard time per unit + teardown)
+	 * can be estimated for SPT, critical ratio and ATC. Orders of unrouted SKUs are
+	 * estimated at one second per unit.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Praxis|Schedule")
+	void RegisterRouting(const FPraxisRouting& Routing);
+
+	// ═══════════════════════════════════════════════════════════════════════════
+	// Finite-Capacity Planning
+	// ═══════════════════════════════════════════════════════════════════════════
+	
+	/** Put a machine in a work center; routed operations only plan onto machines of their work center */
+	UFUNCTION(BlueprintCallable, Category="Praxis|Schedule")
+	void SetMachineWorkCenter(FName MachineId, FName WorkCenter);
+	
+	/** Set the shifts a machine works; none means around the clock */
+	UFUNCTION(BlueprintCallable, Category="Praxis|Schedule")
+	void SetMachineShifts(FName MachineId, const TArray<EPraxisShift>& Shifts);
+	
+	/**
+	 * Plan every pending work order onto registered machines, one operation each, timed from its
+	 * routing and loaded against machine calendars without overlaps.
+	 * Each machine is free once the orders already assigned to it (running or queued) are done.
+	 * Forward loads from then in dispatch rule order; backward loads latest due first,
+	 * finishing each order as close to its due date as capacity allows, then pushes
+	 * anything that would have to start before its machine is free forward again.
+	 * Work centers with no machine set up for them plan onto any machine.
+	 * When dispatching against the plan, each machine is handed its planned orders in
+	 * planned order; orders added afterwards go through the dispatch rule.
+	 * Returns the number of operations planned.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Praxis|Schedule")
+	int32 BuildPlan(EPraxisPlanDirection Direction, bool bDispatchAgainstPlan = true);
+	
+	/** Drop the plan; orders it had not dispatched go back to the dispatch rule */
+	UFUNCTION(BlueprintCallable, Category="Praxis|Schedule")
+	void ClearPlan();
+	
+	/** The Gantt plan, by machine and then planned start */
+	UFUNCTION(BlueprintPure, Category="Praxis|Schedule")
+	void GetPlan(TArray<FPraxisPlannedOperation>& OutPlan) const { OutPlan = Plan; }
+	
+	/** One machine's row of the Gantt plan */
+	UFUNCTION(BlueprintPure, Category="Praxis|Schedule")
+	void GetPlanForMachine(FName MachineId, TArray<FPraxisPlannedOperation>& OutPlan) const;
+
 	// ═══════════════════════════════════════════════════════════════════════════
 	// Query Methods
 	// ═══════════════════════════════════════════════════════════════════════════
@@ -106,7 +222,7 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Praxis|Schedule")
 	bool StartWorkOrder(int64 WorkOrderID, FName MachineId);
 
-	/** Mark a work order as completed */
+	/** Mark a work order as completed, taking it off any queue; false for unknown or cancelled orders */
 	UFUNCTION(BlueprintCallable, Category="Praxis|Schedule")
 	bool CompleteWorkOrder(int64 WorkOrderID);
 
@@ -114,10 +230,17 @@ public:
 	// Machine Registration & Assignment
 	// ═══════════════════════════════════════════════════════════════════════════
 	
-	/** Register a machine (called by MachineLogicComponent on BeginPlay) */
+	/** Register a machine that polls for its work (GetNextForMachine) rather than receiving it */
 	UFUNCTION(BlueprintCallable, Category="Praxis|Schedule")
 	void RegisterMachine(FName MachineId);
 	
+	/** Register a machine that is handed its work orders (called by MachineLogicComponent on BeginPlay) */
+	void RegisterMachine(FName MachineId, IPraxisMachine& Machine);
+	
+	/** Forget a machine (called by MachineLogicComponent on EndPlay); its planned work and the orders assigned to it but not started go back to the dispatch rule at their arrivals */
+	UFUNCTION(BlueprintCallable, Category="Praxis|Schedule")
+	void UnregisterMachine(FName MachineId);
+	
 	/** Notify that a machine is now idle and ready for work */
 	UFUNCTION(BlueprintCallable, Category="Praxis|Schedule")
 	void NotifyMachineIdle(FName MachineId);
@@ -158,7 +281,7 @@ public:
 	// Utility
 	// ═══════════════════════════════════════════════════════════════════════════
 	
-	/** Get current simulation time as Unix timestamp */
+	/** Get current simulation time as Unix timestamp; wall-clock time until the orchestrator starts its clock. Critical ratio and ATC keys are taken at this time, so they only move when the simulation does. */
 	UFUNCTION(BlueprintPure, Category="Praxis|Schedule")
 	int64 NowUnixSeconds() const;
 
@@ -167,30 +290,108 @@ private:
 	// Internal Assignment Logic
 	// ═══════════════════════════════════════════════════════════════════════════
 	
-	/** Try to assign a work order to a specific machine */
+	/** Add a machine (once) and set its receiver if given */
+	void AddMachine(FName MachineId, TWeakInterfacePtr<IPraxisMachine> Receiver);
+	
+	/** Try to assign a work order to a registered machine; it joins the idle set if there is none */
 	void TryAssignToMachine(FName MachineId);
 	
-	/** Try to assign all pending work orders to available machines */
+	/** Hand the orders a machine's plan has not dispatched back to the pending queue, at their original arrivals */
+	void ReturnPlannedWorkOrders(FName MachineId, const FPraxisPlannedQueue& Queue, TArray<TPair<int64, FPraxisDispatchQueue::FKey>>& OutKeys, TArray<uint64>& OutArrivals);
+	
+	/** Same for the orders assigned to a machine but not started: unlinked and returned at their arrivals */
+	void ReturnAssignedWorkOrders(FName MachineId, TArray<TPair<int64, FPraxisDispatchQueue::FKey>>& OutKeys, TArray<uint64>& OutArrivals);
+	
+	/** Next order the plan holds for a machine, or the next by dispatch rule; false if there is none */
+	bool TakePlannedWorkOrder(FName MachineId, int64& OutWorkOrderID);
+	bool TakePendingWorkOrder(int64& OutWorkOrderID);
+	
+	/** Match pending work orders to idle machines until either runs out */
 	void TryAssignPendingWorkOrders();
 	
+	/** Set up an order's state for queuing; returns its state */
+	FPraxisOrderState& ResetOrderState(const FPraxisWorkOrder& WorkOrder);
+	
+	/** Order state by id, through the slot index */
+	FPraxisOrderState* FindOrder(int64 WorkOrderID);
+	const FPraxisOrderState* FindOrder(int64 WorkOrderID) const;
+	
+	/** Append an order to a registered machine's queue, or take it off whichever queue holds it; O(1) */
+	void LinkToMachine(int32 Slot, FName MachineId);
+	void UnlinkFromMachine(int32 Slot);
+	
 	/** Notify a machine of work order assignment */
 	void NotifyMachineOfAssignment(FName MachineId, const FPraxisWorkOrder& WorkOrder);
 
+	// ═══════════════════════════════════════════════════════════════════════════
+	// Dispatch Keys
+	// ═══════════════════════════════════════════════════════════════════════════
+	
+	/** Estimated processing time of a work order, from its SKU's routing */
+	double EstimateProcessSeconds(const FPraxisWorkOrder& WorkOrder) const;
+	
+	/** Dispatch key of a pending order under the current rule at a time */
+	FPraxisDispatchQueue::FKey ComputeDispatchKey(const FPraxisOrderState& State, int64 AtUnixSeconds) const;
+	
+	/** Queue an order for dispatch, or take it out of the queue or plan; keeps the totals in step */
+	void EnqueuePending(int64 WorkOrderID, const FPraxisOrderState& State);
+	void DequeuePending(int64 WorkOrderID, FPraxisOrderState& State);
+	
+	/** Recompute every pending key at the current time, against the current mean processing time */
+	void RekeyPending();
+	
+	/** Critical ratio and ATC depend on the clock: re-key once it has moved since the keys were taken */
+	bool IsDispatchRuleTimeDependent() const;
+
 	// ═══════════════════════════════════════════════════════════════════════════
 	// Data Storage
 	// ═══════════════════════════════════════════════════════════════════════════
 	
-	/** Per-machine queues of work order IDs */
-	TMap<FName, TArray<int64>> MachineQueues;
+	/** Per-machine queues, linked through the order slots */
+	TMap<FName, FPraxisMachineQueue> MachineQueues;
+	
+	/** Global work order state table; slots are stable while an order exists */
+	TSparseArray<FPraxisOrderState> Orders;
+	
+	/** Work order id to its slot in Orders */
+	TMap<int64, int32> OrderSlots;
+	
+	/** Unassigned work orders, in dispatch order */
+	FPraxisDispatchQueue PendingQueue;
+	
+	EPraxisDispatchRule DispatchRule = EPraxisDispatchRule::FIFO;
+	double ATCLookahead = 2.0;
+	
+	/** Sim time the pending keys were taken at (time-dependent rules) */
+	int64 PendingKeyedAt = 0;
+	
+	/** Sum of pending processing time estimates; ATC scales slack by their mean */
+	double PendingProcessSeconds = 0.0;
+	
+	/** Mean the pending ATC keys were taken with, fixed from one re-key to the next */
+	double PendingMeanProcess = 1.0;
+	
+	/** The pending set changed other than by a pop since the mean was taken; ATC re-keys before the next pop */
+	bool bPendingMeanStale = false;
+	
+	/** Operation times by SKU, from registered routings */
+	TMap<FName, FPraxisOperationCodes> RoutingOperations;
+	
+	/** Work centers and calendars, by machine */
+	TMap<FName, FPraxisMachineSetup> MachineSetups;
+	
+	/** Gantt plan from the last BuildPlan */
+	TArray<FPraxisPlannedOperation> Plan;
 	
-	/** Global work order state table */
-	TMap<int64, FPraxisOrderState> Orders;
+	/** Planned orders still to dispatch, by machine */
+	TMap<FName, FPraxisPlannedQueue> PlannedQueues;
+	int32 PlannedPendingCount = 0;
 	
-	/** Unassigned work orders (FIFO queue) */
-	TArray<int64> UnassignedWorkOrders;
+	/** Registered machines and where to dispatch their work (unset for polling machines) */
+	TMap<FName, TWeakInterfacePtr<IPraxisMachine>> RegisteredMachines;
 	
-	/** Registered machines */
-	TSet<FName> RegisteredMachines;
+	/** Registered machines waiting for work: found the queue empty and not assigned since */
+	TSet<FName> IdleMachines;
 	
 	/** Operator state */
 	TMap<FName, FPraxisOperatorState> Operators;
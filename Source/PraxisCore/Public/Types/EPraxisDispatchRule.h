@@ -0,0 +1,13 @@
+#pragma once
+
+/** Sequencing rule the schedule service dispatches pending work orders by */
+UENUM(BlueprintType)
+enum class EPraxisDispatchRule : uint8
+{
+	FIFO            UMETA(DisplayName="First In, First Out"),
+	EDD             UMETA(DisplayName="Earliest Due Date"),
+	SPT             UMETA(DisplayName="Shortest Processing Time"),
+	CriticalRatio   UMETA(DisplayName="Critical Ratio"),
+	ATC             UMETA(DisplayName="Apparent Tardiness Cost"),
+	PriorityThenEDD UMETA(DisplayName="Priority, then Earliest Due Date")
+};
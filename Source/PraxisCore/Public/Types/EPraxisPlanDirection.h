@@ -0,0 +1,9 @@
+#pragma once
+
+/** How the finite-capacity planner loads machines */
+UENUM(BlueprintType)
+enum class EPraxisPlanDirection : uint8
+{
+	Forward  UMETA(DisplayName="Forward (as soon as possible)"),
+	Backward UMETA(DisplayName="Backward (as late as the due date allows)")
+};
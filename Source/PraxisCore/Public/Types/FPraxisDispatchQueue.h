@@ -0,0 +1,87 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * FPraxisDispatchQueue
+ *
+ * Indexed binary min-heap of pending work order ids. Each order carries a
+ * two-part key computed by the owner from its dispatch rule; ties fall back to
+ * arrival order, so an all-zero key dispatches FIFO.
+ *
+ * - Push, Pop and Remove are O(log n); a slot map tracks each order's heap index
+ * - Append takes a whole batch and heapifies once
+ * - Rekey recomputes every key and re-heapifies in O(n), for rule changes and
+ *   time-dependent rules
+ * - Pushing an order that is already queued re-keys it as a new arrival
+ * - An order taken out can be re-queued at the arrival it had (GetArrival, Pop), so
+ *   it keeps its place among equal keys
+ */
+class PRAXISCORE_API FPraxisDispatchQueue
+{
+public:
+	/** Lower dispatches first: Primary, then Secondary, then arrival */
+	struct FKey
+	{
+		double Primary = 0.0;
+		double Secondary = 0.0;
+	};
+
+	void Push(int64 WorkOrderId, const FKey& Key);
+
+	/** Push a batch in arrival order; heapifies once, O(n + batch) */
+	void Append(TConstArrayView<TPair<int64, FKey>> Entries);
+
+	/** Re-queue a batch at arrivals GetArrival gave them earlier (one per entry); heapifies once */
+	void Append(TConstArrayView<TPair<int64, FKey>> Entries, TConstArrayView<uint64> Arrivals);
+
+	/** Take the order that dispatches first. Returns false when empty. */
+	bool Pop(int64& OutWorkOrderId);
+
+	/** Pop, also giving the order's arrival so it can be re-queued in its place later */
+	bool Pop(int64& OutWorkOrderId, uint64& OutArrival);
+
+	/** Change a queued order's key, keeping its arrival. Returns false if it is not queued. */
+	bool Update(int64 WorkOrderId, const FKey& Key);
+
+	/** Drop a queued order. Returns false if it is not queued. */
+	bool Remove(int64 WorkOrderId);
+
+	bool Contains(int64 WorkOrderId) const { return Slots.Contains(WorkOrderId); }
+
+	/** Arrival sequence of a queued order; earlier arrivals dispatch first among equal keys */
+	uint64 GetArrival(int64 WorkOrderId) const { return Heap[Slots.FindChecked(WorkOrderId)].Arrival; }
+	int32 Num() const { return Heap.Num(); }
+
+	/** Recompute every key and restore heap order */
+	void Rekey(TFunctionRef<FKey(int64 WorkOrderId)> KeyOf);
+
+	void Reset();
+
+private:
+	struct FNode
+	{
+		int64 WorkOrderId = 0;
+		FKey Key;
+		uint64 Arrival = 0;
+	};
+
+	static bool Before(const FNode& A, const FNode& B);
+
+	/** Add a node at the end of the heap, replacing any queued entry; heap order is left to the caller */
+	void AddNode(int64 WorkOrderId, const FKey& Key, uint64 Arrival);
+
+	void Heapify();
+
+	void SiftUp(int32 Index);
+	void SiftDown(int32 Index);
+
+	/** Write a node to a heap index and record its slot */
+	void Place(int32 Index, const FNode& Node);
+
+	TArray<FNode> Heap;
+	TMap<int64, int32> Slots;
+	uint64 NextArrival = 0;
+};
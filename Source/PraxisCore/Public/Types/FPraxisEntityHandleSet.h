@@ -0,0 +1,114 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+
+/**
+ * FPraxisEntityHandleSet
+ *
+ * Sparse set of Mass entity handles: a dense, contiguous array for iteration
+ * plus a sparse slot table indexed by FMassEntityHandle::Index.
+ *
+ * - Add / Remove / Contains are O(1) (Remove swaps the last handle into the hole)
+ * - Iteration walks the dense array; order is NOT insertion order
+ * - Handles are matched on Index and SerialNumber, so a stale handle whose
+ *   index has been recycled by Mass is never reported as present
+ */
+class FPraxisEntityHandleSet
+{
+public:
+	/** Add a handle. Returns false if it was already present or unset. */
+	bool Add(FMassEntityHandle Entity)
+	{
+		if (!Entity.IsSet() || Contains(Entity))
+		{
+			return false;
+		}
+
+		if (!Sparse.IsValidIndex(Entity.Index))
+		{
+			const int32 OldNum = Sparse.Num();
+			Sparse.SetNumUninitialized(Entity.Index + 1, EAllowShrinking::No);
+			for (int32 i = OldNum; i < Sparse.Num(); ++i)
+			{
+				Sparse[i] = INDEX_NONE;
+			}
+		}
+
+		Sparse[Entity.Index] = Dense.Add(Entity);
+		return true;
+	}
+
+	/** Remove a handle. Returns false if it was not present. */
+	bool Remove(FMassEntityHandle Entity)
+	{
+		const int32 Slot = FindSlot(Entity);
+		if (Slot == INDEX_NONE)
+		{
+			return false;
+		}
+
+		const int32 LastSlot = Dense.Num() - 1;
+		if (Slot != LastSlot)
+		{
+			const FMassEntityHandle Moved = Dense[LastSlot];
+			Dense[Slot] = Moved;
+			Sparse[Moved.Index] = Slot;
+		}
+
+		Dense.Pop(EAllowShrinking::No);
+		Sparse[Entity.Index] = INDEX_NONE;
+		return true;
+	}
+
+	bool Contains(FMassEntityHandle Entity) const { return FindSlot(Entity) != INDEX_NONE; }
+
+	int32 Num() const { return Dense.Num(); }
+
+	/** Drop all handles (keeps allocations unless bShrink) */
+	void Empty(bool bShrink = true)
+	{
+		if (bShrink)
+		{
+			Dense.Empty();
+			Sparse.Empty();
+		}
+		else
+		{
+			Dense.Reset();
+			for (int32& Slot : Sparse)
+			{
+				Slot = INDEX_NONE;
+			}
+		}
+	}
+
+	const FMassEntityHandle& operator[](int32 Slot) const { return Dense[Slot]; }
+
+	/** Contiguous view of all handles */
+	TConstArrayView<FMassEntityHandle> GetHandles() const { return Dense; }
+
+	// Range-for support (read-only; mutate through Add/Remove)
+	TArray<FMassEntityHandle>::RangedForConstIteratorType begin() const { return Dense.begin(); }
+	TArray<FMassEntityHandle>::RangedForConstIteratorType end() const { return Dense.end(); }
+
+private:
+	int32 FindSlot(FMassEntityHandle Entity) const
+	{
+		if (!Sparse.IsValidIndex(Entity.Index))
+		{
+			return INDEX_NONE;
+		}
+
+		const int32 Slot = Sparse[Entity.Index];
+		return (Slot != INDEX_NONE && Dense[Slot] == Entity) ? Slot : INDEX_NONE;
+	}
+
+	/** Tracked handles, packed */
+	TArray<FMassEntityHandle> Dense;
+
+	/** Entity.Index → slot in Dense (INDEX_NONE if absent) */
+	TArray<int32> Sparse;
+};
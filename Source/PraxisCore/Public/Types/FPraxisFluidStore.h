@@ -0,0 +1,124 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Types/EPraxisUnitOfMeasure.h"
+
+/**
+ * FPraxisFluidStore
+ *
+ * Continuous (rate-based) material held in tanks, silos and coils. Each
+ * container holds one SKU as a double-precision level in the SKU's unit of
+ * measure (kg, L, m) instead of as discrete batches.
+ *
+ * - Flows are named, signed rates (units/second; + fills, - draws) held per container
+ * - Rates are piecewise constant per sim tick, so Advance updates a level
+ *   analytically (Level += NetRate * Seconds) with no per-unit bookkeeping
+ * - Only containers with a non-zero net rate are visited: O(active containers)
+ * - A container that runs empty (or full) part-way through a step is clamped
+ *   and the flows pushing it past the limit are stopped; the time into the
+ *   step at which it hit the limit is reported
+ *
+ * Container ids are dense indexes, stable for the lifetime of the store.
+ */
+class PRAXISCORE_API FPraxisFluidStore
+{
+public:
+	struct FFlow
+	{
+		FName FlowId;             // Usually the machine driving the flow
+		int64 WorkOrderId = 0;
+		double Rate = 0.0;        // Units/second; + fills, - draws
+	};
+
+	struct FContainer
+	{
+		FName ContainerId;
+		FName LocationId;
+		FName SKU;
+		EPraxisUnitOfMeasure UnitOfMeasure = EPraxisUnitOfMeasure::Liter;
+		uint8 MaterialState = 0;
+		double Capacity = 0.0;
+		double Level = 0.0;       // As of the last Advance/Move
+		double NetRate = 0.0;     // Sum of flow rates
+		TArray<FFlow, TInlineAllocator<4>> Flows;
+
+		/** Level after Seconds at the current rates, clamped to [0, Capacity] */
+		double ProjectLevel(double Seconds) const
+		{
+			return FMath::Clamp(Level + NetRate * Seconds, 0.0, Capacity);
+		}
+
+		/** Seconds until the container runs empty or full at the current rates (infinite if it never does) */
+		double GetTimeToLimit() const;
+	};
+
+	/** Level change of one container during Advance */
+	struct FLevelChange
+	{
+		int32 Container = INDEX_NONE;
+		double Delta = 0.0;
+	};
+
+	/** Container that ran empty or full during Advance */
+	struct FLimitEvent
+	{
+		int32 Container = INDEX_NONE;
+		bool bFull = false;
+		double TimeIntoStep = 0.0;   // Seconds into the step the limit was reached
+	};
+
+	/** Add a container. Returns its id, or INDEX_NONE if the container id is taken. */
+	int32 AddContainer(FName ContainerId, FName LocationId, FName SKU, EPraxisUnitOfMeasure UnitOfMeasure, uint8 MaterialState, double Capacity, double InitialLevel);
+
+	/** Id of a container, or INDEX_NONE */
+	int32 Find(FName ContainerId) const
+	{
+		const int32* Id = ContainerLookup.Find(ContainerId);
+		return Id ? *Id : INDEX_NONE;
+	}
+
+	bool IsValidId(int32 Id) const { return Containers.IsValidIndex(Id); }
+	const FContainer& Get(int32 Id) const { return Containers[Id]; }
+
+	/** Set a flow's rate on a container (0 removes the flow) */
+	void SetFlow(int32 Id, FName FlowId, int64 WorkOrderId, double Rate);
+
+	/** Current rate of a flow, 0 if it isn't set (or was stopped at a limit) */
+	double GetFlowRate(int32 Id, FName FlowId) const;
+
+	/** Remove a flow from every container it is set on; O(containers). Returns the containers touched. */
+	int32 ClearFlows(FName FlowId);
+
+	/** Add (+) or draw (-) an amount at once. Clamped to what fits/is there; returns the amount moved. */
+	double Move(int32 Id, double Amount);
+
+	/** Advance every flowing container by Seconds */
+	void Advance(double Seconds, TArray<FLevelChange>& OutChanges, TArray<FLimitEvent>& OutLimits);
+
+	/** Containers holding a SKU / at a location */
+	TConstArrayView<int32> GetContainersForSKU(FName SKU) const;
+	TConstArrayView<int32> GetContainersAtLocation(FName LocationId) const;
+
+	bool HasSKU(FName SKU) const { return ContainersBySKU.Contains(SKU); }
+	int32 Num() const { return Containers.Num(); }
+
+	/** Containers with a non-zero net rate */
+	int32 NumActive() const { return ActiveContainers.Num(); }
+
+	void Reset();
+
+private:
+	/** Recompute a container's net rate and keep the active list in step */
+	void RefreshNetRate(int32 Id);
+
+	TArray<FContainer> Containers;
+	TMap<FName, int32> ContainerLookup;
+	TMap<FName, TArray<int32>> ContainersBySKU;
+	TMap<FName, TArray<int32>> ContainersByLocation;
+
+	/** Containers with a non-zero net rate (swap-remove), and each container's slot in it */
+	TArray<int32> ActiveContainers;
+	TArray<int32> ActiveSlots;
+};
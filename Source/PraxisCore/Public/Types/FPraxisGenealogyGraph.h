@@ -0,0 +1,199 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * FPraxisGenealogyGraph
+ *
+ * Batch genealogy DAG. Outlives the material entities it describes, so trace
+ * queries keep working after batches are consumed, converted or shipped.
+ *
+ * - Batches get dense 32-bit ids in creation order; FGuids live in a side table
+ * - Parent edges are stored CSR-style: a batch's parents are known when it is
+ *   created, so they append contiguously in id order
+ * - Child edges are the transpose: a CSR base plus per-parent lists of the edges
+ *   added since, folded into the base once they outgrow a fraction of it, so
+ *   adding a batch is amortized O(parents)
+ * - Merge edges record batches absorbed into an existing one after it was created
+ *   (lot compaction); they sit in per-batch lists beside the CSR and traces follow
+ *   them like any other edge. A split merged back into its lot closes a cycle, so
+ *   traces visit each batch once
+ * - Compact drops batches older than a horizon that the owner no longer needs and
+ *   renumbers the rest; creation order survives renumbering
+ * - Per-batch attributes are kept structure-of-arrays
+ */
+class PRAXISCORE_API FPraxisGenealogyGraph
+{
+public:
+	static constexpr uint32 InvalidId = MAX_uint32;
+
+	/** No expiry date */
+	static constexpr double NeverExpires = TNumericLimits<double>::Max();
+
+	/** Register a batch and its parents (parents must already exist). Returns its id. */
+	uint32 AddBatch(const FGuid& Guid, FName SKU, uint8 MaterialState, double CreationTime, TConstArrayView<uint32> Parents, double ExpiryTime = NeverExpires);
+
+	/** Id for a batch guid, or InvalidId */
+	uint32 FindBatch(const FGuid& Guid) const
+	{
+		const uint32* Id = IdByGuid.Find(Guid);
+		return Id ? *Id : InvalidId;
+	}
+
+	bool IsValidId(uint32 Id) const { return Id < static_cast<uint32>(Guids.Num()); }
+
+	// Attributes
+	const FGuid& GetGuid(uint32 Id) const { return Guids[Id]; }
+	FName GetSKU(uint32 Id) const { return SKUs[Id]; }
+	uint8 GetMaterialState(uint32 Id) const { return MaterialStates[Id]; }
+	double GetCreationTime(uint32 Id) const { return CreationTimes[Id]; }
+	double GetExpiryTime(uint32 Id) const { return ExpiryTimes[Id]; }
+	uint32 GetCreationOrder(uint32 Id) const { return CreationOrders[Id]; }
+	FName GetSourceMachine(uint32 Id) const { return SourceMachines[Id]; }
+	int64 GetSourceWorkOrder(uint32 Id) const { return SourceWorkOrders[Id]; }
+	bool HasPassedQuality(uint32 Id) const { return (Flags[Id] & FlagFailedQuality) == 0; }
+	bool IsShipped(uint32 Id) const { return (Flags[Id] & FlagShipped) != 0; }
+
+	/** Record the SKU a batch became (WIP converted in place keeps its batch) */
+	void SetSKU(uint32 Id, FName SKU) { SKUs[Id] = SKU; }
+
+	/** Record which machine/work order produced a batch */
+	void SetSource(uint32 Id, FName MachineId, int64 WorkOrderId);
+
+	/** Record a state change of the batch (e.g. WIP → FG/Scrap in place) */
+	void SetMaterialState(uint32 Id, uint8 MaterialState, bool bPassedQuality);
+
+	/** Record a batch's new expiry (a merged lot expires with its earliest unit) */
+	void SetExpiryTime(uint32 Id, double ExpiryTime) { ExpiryTimes[Id] = ExpiryTime; }
+
+	/** Record batches merged into an existing batch; each becomes an extra parent of it. O(parents). */
+	void AddMergedParents(uint32 Id, TConstArrayView<uint32> Parents);
+
+	/** Record that (some of) the batch left the plant */
+	void MarkShipped(uint32 Id) { Flags[Id] |= FlagShipped; }
+
+	/** Parents a batch was created from */
+	TConstArrayView<uint32> GetParents(uint32 Id) const
+	{
+		return TConstArrayView<uint32>(ParentEdges.GetData() + ParentOffsets[Id], ParentOffsets[Id + 1] - ParentOffsets[Id]);
+	}
+
+	/** Call Visitor(uint32 Parent) for each direct parent of a batch, merged ones last */
+	template<typename VisitorFunc>
+	void ForEachParent(uint32 Id, VisitorFunc&& Visitor) const
+	{
+		for (const uint32 Parent : GetParents(Id))
+		{
+			Visitor(Parent);
+		}
+		for (int32 Link = MergeLinkHeadsByChild[Id]; Link != INDEX_NONE; Link = MergeLinks[Link].NextOfChild)
+		{
+			Visitor(MergeLinks[Link].Parent);
+		}
+	}
+
+	/** Call Visitor(uint32 Child) for each direct child of a batch, oldest first, then the batches it merged into */
+	template<typename VisitorFunc>
+	void ForEachChild(uint32 Id, VisitorFunc&& Visitor) const
+	{
+		if (Id < static_cast<uint32>(ChildIndexedNum))
+		{
+			for (int32 Edge = ChildOffsets[Id]; Edge < ChildOffsets[Id + 1]; ++Edge)
+			{
+				Visitor(ChildEdges[Edge]);
+			}
+		}
+		for (int32 Link = ChildLinkHeads[Id]; Link != INDEX_NONE; Link = ChildLinks[Link].Next)
+		{
+			Visitor(ChildLinks[Link].Child);
+		}
+		for (int32 Link = MergeLinkHeadsByParent[Id]; Link != INDEX_NONE; Link = MergeLinks[Link].NextOfParent)
+		{
+			Visitor(MergeLinks[Link].Child);
+		}
+	}
+
+	/** All ancestors of a batch, nearest first (breadth-first) */
+	void TraceBackward(uint32 Id, TArray<uint32>& OutAncestors) const;
+
+	/** All descendants of a batch, nearest first (breadth-first) */
+	void TraceForward(uint32 Id, TArray<uint32>& OutDescendants) const;
+
+	int32 Num() const { return Guids.Num(); }
+	int32 NumEdges() const { return ParentEdges.Num() + MergeLinks.Num(); }
+
+	/**
+	 * Drop batches created before Horizon, with their edges, except those IsRetained(Id)
+	 * keeps and all of their ancestors. Traces stop at the dropped batches. Survivors are renumbered densely in creation
+	 * order, so ids held across the call are invalid; look batches up by guid again.
+	 * @return number of batches dropped
+	 */
+	int32 Compact(double Horizon, TFunctionRef<bool(uint32 Id)> IsRetained);
+
+	void Reset();
+
+private:
+	enum : uint8
+	{
+		FlagFailedQuality = 1 << 0,
+		FlagShipped       = 1 << 1,
+	};
+
+	/** Fold the per-parent child lists into a fresh child CSR; O(V+E) */
+	void RebuildChildIndex();
+
+	/** Breadth-first walk; ForEachNeighbour(Node, Visit) calls Visit for each neighbour */
+	template<typename NeighbourFunc>
+	void Trace(uint32 Id, TArray<uint32>& OutVisited, NeighbourFunc&& ForEachNeighbour) const;
+
+	// Attributes (indexed by batch id)
+	TArray<FGuid> Guids;
+	TArray<FName> SKUs;
+	TArray<uint8> MaterialStates;
+	TArray<double> CreationTimes;
+	TArray<double> ExpiryTimes;
+	TArray<uint32> CreationOrders;
+	TArray<FName> SourceMachines;
+	TArray<int64> SourceWorkOrders;
+	TArray<uint8> Flags;
+
+	// Parent CSR: parents of Id are ParentEdges[ParentOffsets[Id] .. ParentOffsets[Id + 1])
+	TArray<int32> ParentOffsets = { 0 };
+	TArray<uint32> ParentEdges;
+
+	// Child CSR (transpose of the parent CSR) over the edges of the first ChildIndexedNum batches
+	TArray<int32> ChildOffsets = { 0 };
+	TArray<uint32> ChildEdges;
+	int32 ChildIndexedNum = 0;
+
+	// Child edges added since: per-parent lists in insertion (so id) order
+	struct FChildLink
+	{
+		uint32 Child = 0;
+		int32 Next = INDEX_NONE;
+	};
+	TArray<FChildLink> ChildLinks;
+	TArray<int32> ChildLinkHeads;
+	TArray<int32> ChildLinkTails;
+
+	// Merge edges, in no id order: each link is on its parent's and its child's list
+	struct FMergeLink
+	{
+		uint32 Parent = 0;
+		uint32 Child = 0;
+		int32 NextOfParent = INDEX_NONE;
+		int32 NextOfChild = INDEX_NONE;
+	};
+	TArray<FMergeLink> MergeLinks;
+	TArray<int32> MergeLinkHeadsByParent;
+	TArray<int32> MergeLinkHeadsByChild;
+
+	/** Prepend a merge edge to both of its lists */
+	void LinkMerge(uint32 Parent, uint32 Child);
+
+	uint32 NextCreationOrder = 0;
+
+	TMap<FGuid, uint32> IdByGuid;
+};
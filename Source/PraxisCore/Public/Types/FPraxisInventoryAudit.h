@@ -0,0 +1,109 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "Types/FPraxisMaterialIndex.h"
+
+/**
+ * Consistency rules checked by the incremental inventory auditor
+ */
+enum class EPraxisAuditCheck : uint8
+{
+	StaleEntity,              // Tracked entity no longer exists
+	EntityNotIndexed,         // Entity holds stock but is missing from the material index
+	EntityKeyMismatch,        // Fragments and index disagree on SKU/location/state/reservation
+	EntityQuantityMismatch,   // Fragments and index disagree on quantity
+	EntityVolumeMismatch,     // Fragments and index disagree on volume
+	LotIndexMismatch,         // Pickable batch missing from the lot index, or the reverse
+	OverClaimed,              // Reservation ledger claims more than the batch holds
+	SKUQuantityMismatch,      // Aggregate cache total vs. recounted stock
+	SKUReservedMismatch,      // Aggregate cache reserved vs. reserved stock + ledger claims
+	SKUVolumeMismatch,        // Aggregate cache volume vs. recounted stock
+	SKULocationMismatch,      // Aggregate cache per-location quantity vs. recounted stock
+	LocationVolumeMismatch,   // Location capacity volume vs. volume of stock there
+	LocationItemsMismatch     // Location capacity item count vs. batches there
+};
+
+PRAXISCORE_API const TCHAR* LexToString(EPraxisAuditCheck Check);
+
+/** One entity as seen by its fragments and by the service's caches */
+struct FPraxisAuditEntityRecord
+{
+	FMassEntityHandle Entity;
+
+	// Fragments
+	bool bExists = false;
+	FPraxisMaterialStockKey FragmentKey;
+	int32 FragmentQuantity = 0;
+	float FragmentVolume = 0.0f;
+
+	// Material index / reservation ledger
+	bool bIndexed = false;
+	bool bInLotIndex = false;
+	FPraxisMaterialStockKey IndexKey;
+	int32 IndexQuantity = 0;
+	float IndexVolume = 0.0f;
+	int32 ClaimedQuantity = 0;
+};
+
+/** Cached aggregate of one SKU */
+struct FPraxisAuditSKURecord
+{
+	FName SKU;
+	int32 TotalQuantity = 0;
+	int32 ReservedQuantity = 0;
+	double TotalVolume = 0.0;
+	TArray<TPair<FName, int32>> QuantityByLocation;
+};
+
+/** Cached capacity usage of one location (sub-locations included) */
+struct FPraxisAuditLocationRecord
+{
+	FName LocationId;
+	double CurrentVolume = 0.0;
+	int32 CurrentItems = 0;
+};
+
+/** A failed check */
+struct FPraxisAuditFinding
+{
+	EPraxisAuditCheck Check = EPraxisAuditCheck::StaleEntity;
+	FMassEntityHandle Entity;   // Unset for aggregate checks
+	FName SKU;
+	FName LocationId;
+	double Expected = 0.0;      // Cached value
+	double Actual = 0.0;        // Value recomputed from the source data
+};
+
+/**
+ * FPraxisAuditSlice
+ *
+ * Everything one audit pass needs, copied on the game thread so the checks can
+ * run on a worker while the simulation keeps mutating the live data.
+ *
+ * - Entity records: a bounded slice of entities, fragments vs. index entry
+ * - Aggregates (once per round): aggregate cache and location capacities vs.
+ *   per-key totals recounted from the entity fragments (one chunk pass on the
+ *   game thread) plus reservation ledger claims
+ */
+struct PRAXISCORE_API FPraxisAuditSlice
+{
+	int32 TickCount = 0;
+
+	TArray<FPraxisAuditEntityRecord> Entities;
+
+	bool bAuditAggregates = false;
+	TArray<TPair<FPraxisMaterialStockKey, FPraxisMaterialIndex::FStockTotals>> StockTotals;
+	TArray<TPair<FPraxisMaterialStockKey, int32>> ClaimedTotals;
+	TArray<FPraxisAuditSKURecord> SKUs;
+	TArray<FPraxisAuditLocationRecord> Locations;
+
+	/** Run every check; findings are appended in slice order */
+	void Run(TArray<FPraxisAuditFinding>& OutFindings) const;
+
+private:
+	void AuditEntity(const FPraxisAuditEntityRecord& Record, TArray<FPraxisAuditFinding>& OutFindings) const;
+	void AuditAggregates(TArray<FPraxisAuditFinding>& OutFindings) const;
+};
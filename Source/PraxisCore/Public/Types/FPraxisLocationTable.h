@@ -0,0 +1,98 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Dense integer handle for an inventory location. Valid handles index
+ * directly into per-location arrays owned by the inventory service.
+ */
+struct FPraxisLocationHandle
+{
+	int32 Index = INDEX_NONE;
+
+	FPraxisLocationHandle() = default;
+	explicit FPraxisLocationHandle(int32 InIndex) : Index(InIndex) {}
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	bool operator==(const FPraxisLocationHandle& Other) const { return Index == Other.Index; }
+	bool operator!=(const FPraxisLocationHandle& Other) const { return Index != Other.Index; }
+
+	friend uint32 GetTypeHash(const FPraxisLocationHandle& Handle) { return ::GetTypeHash(Handle.Index); }
+};
+
+/**
+ * Per-machine locations, created once when the machine registers.
+ * Names are kept alongside the handles for the FName-facing API and fragments.
+ */
+struct FPraxisMachineLocations
+{
+	FPraxisLocationHandle WIP;
+	FPraxisLocationHandle Output;
+	FPraxisLocationHandle Scrap;
+
+	FName WIPName;      // "<MachineId>.WIP"
+	FName OutputName;   // "<MachineId>.Output"
+	FName ScrapName;    // "<MachineId>.Scrap"
+};
+
+/**
+ * Node in a location's sub-location capacity tree (Location → Zone → Rack → Bin).
+ * Sub-location ids are '/'-separated paths ("ZoneA/Rack03/Bin12"); each prefix is a node.
+ */
+struct FPraxisSubLocationNode
+{
+	FPraxisLocationHandle Location;   // Root location the path belongs to
+	int32 Parent = INDEX_NONE;        // Parent node, INDEX_NONE if it rolls up into the location itself
+	uint8 Depth = 1;                  // 1 = Zone, 2 = Rack, 3 = Bin
+	FName DisplayName;                // "<LocationId>/<SubLocationId>", for notifications
+};
+
+/**
+ * FPraxisLocationTable
+ *
+ * Interns location FNames into dense handles (0..Num-1). Handles are never
+ * reused, so they stay valid for the lifetime of the table.
+ */
+class FPraxisLocationTable
+{
+public:
+	/** Handle for a location, creating it if needed */
+	FPraxisLocationHandle FindOrAdd(FName LocationId)
+	{
+		if (const int32* Existing = HandleByName.Find(LocationId))
+		{
+			return FPraxisLocationHandle(*Existing);
+		}
+
+		const int32 Index = Names.Add(LocationId);
+		HandleByName.Add(LocationId, Index);
+		return FPraxisLocationHandle(Index);
+	}
+
+	/** Handle for a location (invalid if never registered) */
+	FPraxisLocationHandle Find(FName LocationId) const
+	{
+		const int32* Existing = HandleByName.Find(LocationId);
+		return Existing ? FPraxisLocationHandle(*Existing) : FPraxisLocationHandle();
+	}
+
+	FName GetName(FPraxisLocationHandle Handle) const
+	{
+		return Names.IsValidIndex(Handle.Index) ? Names[Handle.Index] : NAME_None;
+	}
+
+	int32 Num() const { return Names.Num(); }
+
+	void Reset()
+	{
+		Names.Reset();
+		HandleByName.Reset();
+	}
+
+private:
+	TArray<FName> Names;
+	TMap<FName, int32> HandleByName;
+};
@@ -0,0 +1,202 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+
+/**
+ * Stock lookup key: batches of one SKU at one location, in one material state,
+ * split by whether they are reserved.
+ */
+struct PRAXISCORE_API FPraxisMaterialStockKey
+{
+	FName SKU;
+	FName LocationId;
+	uint8 MaterialState = 0;   // EMaterialState as uint8 (0=RM, 1=WIP, 2=FG, 3=Scrap, 4=InTransit)
+	bool bReserved = false;
+
+	FPraxisMaterialStockKey() = default;
+	FPraxisMaterialStockKey(FName InSKU, FName InLocationId, uint8 InMaterialState, bool bInReserved)
+		: SKU(InSKU)
+		, LocationId(InLocationId)
+		, MaterialState(InMaterialState)
+		, bReserved(bInReserved)
+	{
+	}
+
+	bool operator==(const FPraxisMaterialStockKey& Other) const
+	{
+		return SKU == Other.SKU
+			&& LocationId == Other.LocationId
+			&& MaterialState == Other.MaterialState
+			&& bReserved == Other.bReserved;
+	}
+
+	friend uint32 GetTypeHash(const FPraxisMaterialStockKey& Key)
+	{
+		const uint32 Hash = HashCombineFast(GetTypeHash(Key.SKU), GetTypeHash(Key.LocationId));
+		return HashCombineFast(Hash, (static_cast<uint32>(Key.MaterialState) << 1) | (Key.bReserved ? 1u : 0u));
+	}
+};
+
+/**
+ * Reservation lookup key: everything claimed by one work order on one machine.
+ */
+struct PRAXISCORE_API FPraxisMaterialReservationKey
+{
+	int64 WorkOrderId = 0;
+	FName MachineId;
+
+	FPraxisMaterialReservationKey() = default;
+	FPraxisMaterialReservationKey(int64 InWorkOrderId, FName InMachineId)
+		: WorkOrderId(InWorkOrderId)
+		, MachineId(InMachineId)
+	{
+	}
+
+	bool operator==(const FPraxisMaterialReservationKey& Other) const
+	{
+		return WorkOrderId == Other.WorkOrderId && MachineId == Other.MachineId;
+	}
+
+	friend uint32 GetTypeHash(const FPraxisMaterialReservationKey& Key)
+	{
+		return HashCombineFast(GetTypeHash(Key.WorkOrderId), GetTypeHash(Key.MachineId));
+	}
+};
+
+/**
+ * Pick order of a lot within its (SKU, location) bucket; lower picks first.
+ * The service fills it according to the SKU's picking policy (FIFO/LIFO/FEFO).
+ */
+struct PRAXISCORE_API FPraxisLotSortKey
+{
+	double Order = 0.0;     // Creation time, negated creation time or expiry time
+	uint32 TieBreak = 0;    // Stable per-batch value (genealogy id) so equal times pick deterministically
+
+	bool operator<(const FPraxisLotSortKey& Other) const
+	{
+		return Order != Other.Order ? Order < Other.Order : TieBreak < Other.TieBreak;
+	}
+};
+
+/**
+ * FPraxisMaterialIndex
+ *
+ * Secondary indexes over material entities so the inventory service can find
+ * candidate batches without walking every tracked entity.
+ *
+ * - Stock index:       (SKU, LocationId, MaterialState, bReserved) → entities
+ * - Reservation index: (WorkOrderId, MachineId) → reserved entities
+ * - Lot index:         (SKU, LocationId) → unreserved, non-empty entities in a
+ *                      binary heap by FPraxisLotSortKey (O(log n) insert/remove,
+ *                      in-order visits in O(k log k) for the first k lots)
+ *
+ * Each entity remembers the keys and bucket slots it was filed under, so
+ * re-keying and removal are O(1) (swap-remove inside the bucket).
+ * Bucket order is therefore not insertion order.
+ *
+ * Entries also record the quantity/volume (and sub-location) the entity was
+ * last counted with, which is what the service subtracts when it applies
+ * aggregate and location capacity deltas.
+ */
+class PRAXISCORE_API FPraxisMaterialIndex
+{
+public:
+	/** Keys, bucket positions and counted amounts an entity is currently filed under */
+	struct FEntry
+	{
+		FPraxisMaterialStockKey StockKey;
+		FPraxisMaterialReservationKey ReservationKey;
+		FPraxisLotSortKey LotKey;
+		int32 StockSlot = INDEX_NONE;
+		int32 ReservationSlot = INDEX_NONE;   // INDEX_NONE when not reserved
+		int32 LotSlot = INDEX_NONE;           // Heap position; INDEX_NONE when not pickable
+		int32 Quantity = 0;
+		float Volume = 0.0f;
+		FName SubLocationId;                  // Where the volume is booked below LocationId (capacity)
+
+		bool IsReserved() const { return ReservationSlot != INDEX_NONE; }
+	};
+
+	/** Running totals of the entries filed under one stock key */
+	struct FStockTotals
+	{
+		int32 Entities = 0;
+		int32 Quantity = 0;
+		double Volume = 0.0;
+	};
+
+	/**
+	 * Add or re-key an entity.
+	 * @param ReservationKey Pass nullptr when the entity is not reserved
+	 * @param Quantity Units the entity holds
+	 * @param Volume Total volume the entity occupies
+	 * @param LotKey Pick order among unreserved lots of the same SKU and location
+	 * @param SubLocationId Bin/rack the entity sits in (recorded only; not a key)
+	 */
+	void Update(
+		FMassEntityHandle Entity,
+		const FPraxisMaterialStockKey& StockKey,
+		const FPraxisMaterialReservationKey* ReservationKey,
+		int32 Quantity,
+		float Volume,
+		const FPraxisLotSortKey& LotKey = FPraxisLotSortKey(),
+		FName SubLocationId = NAME_None);
+
+	/** Remove an entity from all indexes. Returns false if it was not indexed. */
+	bool Remove(FMassEntityHandle Entity);
+
+	/** Entities filed under a stock key (empty view if none) */
+	TConstArrayView<FMassEntityHandle> FindStock(const FPraxisMaterialStockKey& Key) const;
+
+	/** Entities reserved for a work order/machine pair (empty view if none) */
+	TConstArrayView<FMassEntityHandle> FindReserved(const FPraxisMaterialReservationKey& Key) const;
+
+	/** Next lot to pick for a SKU at a location (unset if none); O(1) */
+	FMassEntityHandle PeekLot(FName SKU, FName LocationId) const;
+	
+	/**
+	 * Visit unreserved lots of a SKU at a location in pick order.
+	 * Return false from the visitor to stop. Do not modify the index while visiting.
+	 */
+	void VisitLots(FName SKU, FName LocationId, TFunctionRef<bool(FMassEntityHandle, const FEntry&)> Visitor) const;
+
+	/** Keys an entity is currently filed under */
+	const FEntry* FindEntry(FMassEntityHandle Entity) const { return Entries.Find(Entity); }
+
+	/** Per-stock-key totals, kept alongside the buckets (for consistency audits) */
+	const TMap<FPraxisMaterialStockKey, FStockTotals>& GetStockTotals() const { return StockTotals; }
+
+	/** Number of indexed entities */
+	int32 Num() const { return Entries.Num(); }
+
+	/** Drop everything */
+	void Reset();
+
+private:
+	template<typename KeyType>
+	static int32 AddToBucket(TMap<KeyType, TArray<FMassEntityHandle>>& Buckets, const KeyType& Key, FMassEntityHandle Entity);
+
+	/** Swap-remove from a bucket; returns the entity moved into Slot (unset if none) */
+	template<typename KeyType>
+	static FMassEntityHandle RemoveFromBucket(TMap<KeyType, TArray<FMassEntityHandle>>& Buckets, const KeyType& Key, int32 Slot);
+
+	using FLotBucketKey = TPair<FName, FName>;   // (SKU, LocationId)
+
+	void AddStockTotals(const FPraxisMaterialStockKey& Key, int32 EntityDelta, int32 QuantityDelta, double VolumeDelta);
+
+	bool LotLess(FMassEntityHandle A, FMassEntityHandle B) const;
+	void AddLot(FMassEntityHandle Entity, FEntry& Entry);
+	void RemoveLot(FEntry& Entry);
+	void SiftLotUp(TArray<FMassEntityHandle>& Heap, int32 Slot);
+	void SiftLotDown(TArray<FMassEntityHandle>& Heap, int32 Slot);
+	void PlaceLot(TArray<FMassEntityHandle>& Heap, int32 Slot, FMassEntityHandle Entity);
+
+	TMap<FPraxisMaterialStockKey, TArray<FMassEntityHandle>> StockBuckets;
+	TMap<FPraxisMaterialStockKey, FStockTotals> StockTotals;
+	TMap<FLotBucketKey, TArray<FMassEntityHandle>> LotHeaps;
+	TMap<FPraxisMaterialReservationKey, TArray<FMassEntityHandle>> ReservationBuckets;
+	TMap<FMassEntityHandle, FEntry> Entries;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FPraxisPlannedOperation.generated.h"
+
+/** One bar of the schedule service's Gantt plan: a work order's operation on a machine */
+USTRUCT(BlueprintType)
+struct PRAXISCORE_API FPraxisPlannedOperation
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(BlueprintReadOnly)
+	int64 WorkOrderID = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	FName MachineId = "None";
+
+	/** Work center from the SKU's routing */
+	UPROPERTY(BlueprintReadOnly)
+	FName WorkCenter = "None";
+
+	UPROPERTY(BlueprintReadOnly)
+	FDateTime PlannedStart;
+
+	UPROPERTY(BlueprintReadOnly)
+	FDateTime PlannedFinish;
+
+	/** Planned to finish after the work order's due date */
+	UPROPERTY(BlueprintReadOnly)
+	bool bLate = false;
+};
@@ -0,0 +1,126 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Types/FPraxisLocationTable.h"
+
+/**
+ * A putaway bin: a location or sub-location node with a volume limit and no
+ * child nodes. Lives in the putaway index of its dedicated SKU (None = shared).
+ */
+struct FPraxisPutawayBin
+{
+	FPraxisLocationHandle Location;
+	int32 SubLocationNode = INDEX_NONE;   // INDEX_NONE when the location itself is the bin
+	FName SKU;
+	int32 Slot = INDEX_NONE;              // Slot in the SKU's FPraxisPutawayIndex
+};
+
+/**
+ * FPraxisPutawayIndex
+ *
+ * Free-volume index over storage bins for putaway decisions. Bins are added
+ * once and get a dense slot; their free volume is updated as stock moves.
+ *
+ * - First-fit: max segment tree over slots in registration order, O(log n)
+ * - Best-fit:  bins bucketed by free volume on a log scale (each bucket spans a
+ *              RelativeResolution fraction of its volume) with a Fenwick tree over
+ *              bucket occupancy. The bucket the volume falls in is scanned exactly,
+ *              then the next occupied bucket is found in O(log buckets); a few
+ *              thousand buckets cover cm³ to millions of m³
+ * - Closest:   max segment tree over slots in Z-order (Morton) of position;
+ *              the nearest fitting bins on either side of the query point are
+ *              compared by real distance, O(log n). Approximate: Z-order
+ *              neighbours are usually, not always, the spatially closest
+ */
+class PRAXISCORE_API FPraxisPutawayIndex
+{
+public:
+	/** Smallest free volume told apart by best-fit (m³); less is bucketed with it */
+	static constexpr float MinBucketVolume = 1.0e-6f;
+
+	explicit FPraxisPutawayIndex(float InRelativeResolution = 0.01f)
+		: BucketsPerDoubling(FMath::CeilToFloat(1.0f / FMath::Log2(1.0f + FMath::Max(InRelativeResolution, KINDA_SMALL_NUMBER))))
+	{
+	}
+
+	/** Add a bin (not eligible until UpdateBin gives it free volume). Returns its slot. */
+	int32 AddBin(int32 BinId, const FVector& Position);
+
+	/** Set a bin's free volume (0 = full / not accepting) */
+	void UpdateBin(int32 Slot, float FreeVolume);
+
+	/** Take a bin out of consideration permanently (e.g. it now has child bins) */
+	void RetireBin(int32 Slot);
+
+	int32 GetBinId(int32 Slot) const { return Slots[Slot].BinId; }
+	float GetFreeVolume(int32 Slot) const { return Slots[Slot].FreeVolume; }
+	bool IsRetired(int32 Slot) const { return Slots[Slot].bRetired; }
+
+	/** Slot of the first registered bin that fits, or INDEX_NONE */
+	int32 FindFirstFit(float Volume) const;
+
+	/** Slot of the fitting bin with the least free volume (to the relative resolution), or INDEX_NONE */
+	int32 FindBestFit(float Volume) const;
+
+	/** Slot of a fitting bin near a position, or INDEX_NONE */
+	int32 FindClosest(float Volume, const FVector& From) const;
+
+	int32 Num() const { return Slots.Num(); }
+
+	void Reset();
+
+private:
+	struct FSlot
+	{
+		int32 BinId = INDEX_NONE;
+		float FreeVolume = 0.0f;
+		FVector Position = FVector::ZeroVector;
+		int32 Bucket = INDEX_NONE;      // Best-fit bucket, INDEX_NONE when not eligible
+		int32 BucketPosition = INDEX_NONE;
+		bool bRetired = false;
+	};
+
+	/** Value stored in the segment trees for a slot (-1 when not eligible) */
+	float GetTreeValue(const FSlot& Slot) const { return Slot.Bucket != INDEX_NONE ? Slot.FreeVolume : -1.0f; }
+
+	// Segment tree helpers (implicit binary tree, leaves at [Leaves, 2 * Leaves))
+	static void SetLeaf(TArray<float>& Tree, int32 Leaves, int32 Index, float Value);
+	static int32 FindFirstAtOrAfter(const TArray<float>& Tree, int32 Node, int32 Lo, int32 Hi, int32 From, float Volume);
+	static int32 FindLastBefore(const TArray<float>& Tree, int32 Node, int32 Lo, int32 Hi, int32 Before, float Volume);
+
+	void GrowOrderTree();
+	void RebuildSpatialIndex() const;
+	uint64 GetMortonCode(const FVector& Position) const;
+
+	// Best-fit buckets
+	int32 GetBucket(float FreeVolume) const;
+	void EnsureBucket(int32 Bucket);
+	void AddToBucket(int32 SlotIndex, int32 Bucket);
+	void RemoveFromBucket(int32 SlotIndex);
+	void FenwickAdd(int32 Bucket, int32 Delta);
+	int32 FenwickPrefix(int32 Count) const;
+	int32 FenwickFindByOrder(int32 Order) const;
+
+	TArray<FSlot> Slots;
+	float BucketsPerDoubling;
+
+	// First-fit tree (registration order)
+	TArray<float> OrderTree;
+	int32 OrderLeaves = 0;
+
+	// Closest tree (Morton order); rebuilt lazily when bins were added
+	mutable TArray<float> SpatialTree;
+	mutable int32 SpatialLeaves = 0;
+	mutable TArray<int32> SpatialSlots;   // rank → slot
+	mutable TArray<int32> SpatialRanks;   // slot → rank
+	mutable TArray<uint64> SpatialCodes;  // rank → Morton code (sorted)
+	mutable FBox SpatialBounds = FBox(ForceInit);
+	mutable bool bSpatialDirty = false;
+
+	// Best-fit buckets by floor(log2(FreeVolume / MinBucketVolume) * BucketsPerDoubling)
+	TArray<TArray<int32>> Buckets;
+	TArray<int32> BucketFenwick;
+	int32 EligibleCount = 0;
+};
@@ -0,0 +1,94 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "Types/FPraxisMaterialIndex.h"
+
+/**
+ * FPraxisReservationLedger
+ *
+ * Quantity-level reservations. A claim reserves some units of one batch for a
+ * work order/machine without touching the batch itself; the batch is only
+ * split when claimed units physically move (consumed onto the machine).
+ *
+ * - Claims live in a dense array with a free list; ids are stable until released
+ * - Running totals per batch, per (owner, SKU), per (work order, SKU) and per
+ *   stock key, so every available-to-promise question is a single map lookup
+ * - Claims keep the stock key of the batch when claimed. Only unclaimed units
+ *   of a batch may move location or state, so the key stays accurate
+ */
+class PRAXISCORE_API FPraxisReservationLedger
+{
+public:
+	struct FClaim
+	{
+		FMassEntityHandle Batch;
+		FPraxisMaterialStockKey StockKey;      // Batch's SKU/location/state (bReserved = false)
+		FPraxisMaterialReservationKey Owner;   // Work order + machine
+		int32 Quantity = 0;                    // 0 = free slot
+		double ClaimTime = 0.0;
+	};
+
+	/** Claim units of a batch for an owner (merges with the owner's existing claim on it). Returns the claim id. */
+	int32 AddClaim(FMassEntityHandle Batch, const FPraxisMaterialStockKey& StockKey, const FPraxisMaterialReservationKey& Owner, int32 Quantity, double ClaimTime);
+
+	/** Take units off a claim (consumed or released); the claim is removed at zero. Returns units taken. */
+	int32 ReduceClaim(int32 ClaimId, int32 Quantity);
+
+	/** Remove all of an owner's claims; removed claims are appended to OutReleased */
+	void ReleaseOwner(const FPraxisMaterialReservationKey& Owner, TArray<FClaim>& OutReleased);
+
+	/** Remove all claims on a batch (e.g. the batch was destroyed) */
+	void ReleaseBatch(FMassEntityHandle Batch, TArray<FClaim>& OutReleased);
+
+	/** Re-point every claim on a batch at another batch with the same stock key (batches merged) */
+	void MoveClaims(FMassEntityHandle FromBatch, FMassEntityHandle ToBatch);
+
+	/** Oldest live claim of an owner on a SKU, or INDEX_NONE (scans the owner's claims) */
+	int32 FindClaim(const FPraxisMaterialReservationKey& Owner, FName SKU) const;
+
+	const FClaim& GetClaim(int32 ClaimId) const { return Claims[ClaimId]; }
+
+	// Totals, O(1)
+	int32 GetClaimedFromBatch(FMassEntityHandle Batch) const { return BatchTotals.FindRef(Batch); }
+	int32 GetClaimed(const FPraxisMaterialReservationKey& Owner, FName SKU) const { return OwnerTotals.FindRef(FOwnerSKUKey(Owner, SKU)); }
+	int32 GetClaimedForWorkOrder(int64 WorkOrderId, FName SKU) const { return WorkOrderTotals.FindRef(FWorkOrderSKUKey(WorkOrderId, SKU)); }
+	int32 GetClaimedStock(const FPraxisMaterialStockKey& StockKey) const { return StockTotals.FindRef(StockKey); }
+
+	/** Claimed units per stock key (for aggregate rebuilds) */
+	const TMap<FPraxisMaterialStockKey, int32>& GetStockTotals() const { return StockTotals; }
+
+	/** Number of live claims */
+	int32 Num() const { return Claims.Num() - FreeClaims.Num(); }
+
+	void Reset();
+
+private:
+	using FOwnerSKUKey = TPair<FPraxisMaterialReservationKey, FName>;
+	using FWorkOrderSKUKey = TPair<int64, FName>;
+	using FClaimList = TArray<int32, TInlineAllocator<2>>;
+
+	/** Add a signed amount to every total a claim contributes to */
+	void ApplyTotals(const FClaim& Claim, int32 Delta);
+
+	/** Drop a claim from the lists and free its slot */
+	void RemoveClaim(int32 ClaimId);
+
+	template<typename KeyType>
+	static void AddTotal(TMap<KeyType, int32>& Totals, const KeyType& Key, int32 Delta);
+
+	TArray<FClaim> Claims;
+	TArray<int32> FreeClaims;
+
+	// Live claim ids, oldest first
+	TMap<FMassEntityHandle, FClaimList> ClaimsByBatch;
+	TMap<FPraxisMaterialReservationKey, FClaimList> ClaimsByOwner;
+
+	// Running totals (entries removed at zero)
+	TMap<FMassEntityHandle, int32> BatchTotals;
+	TMap<FOwnerSKUKey, int32> OwnerTotals;
+	TMap<FWorkOrderSKUKey, int32> WorkOrderTotals;
+	TMap<FPraxisMaterialStockKey, int32> StockTotals;
+};
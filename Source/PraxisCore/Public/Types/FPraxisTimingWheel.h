@@ -0,0 +1,75 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * FPraxisTimingWheel
+ *
+ * Hierarchical timing wheel over integer sim ticks. Timers are scheduled
+ * for a deadline tick and reported once Advance reaches it.
+ *
+ * - NumLevels wheels of SlotsPerLevel slots; level L slots span SlotsPerLevel^L ticks
+ * - Timers sit in intrusive doubly linked slot lists, so Schedule and Cancel are O(1)
+ * - When a lower wheel wraps, the next slot of the wheel above is cascaded down;
+ *   each timer cascades at most NumLevels - 1 times
+ * - Advance costs O(ticks advanced + timers expired + timers cascaded)
+ * - Deadlines past the top wheel's horizon park in its last slot and are
+ *   re-placed each time they cascade
+ *
+ * Timer ids are recycled once a timer expires or is cancelled.
+ */
+class PRAXISCORE_API FPraxisTimingWheel
+{
+public:
+	static constexpr int32 SlotBits = 6;
+	static constexpr int32 SlotsPerLevel = 1 << SlotBits;
+	static constexpr int32 NumLevels = 4;   // Horizon: 64^4 ≈ 16.7M ticks
+
+	FPraxisTimingWheel();
+
+	/** Schedule a timer; deadlines at or before the current tick fire on the next Advance. Returns its id. */
+	int32 Schedule(int64 DeadlineTick);
+
+	/** Cancel a pending timer. Returns false if it is not pending. */
+	bool Cancel(int32 TimerId);
+
+	bool IsPending(int32 TimerId) const { return Timers.IsValidIndex(TimerId) && Timers[TimerId].Slot != INDEX_NONE; }
+	int64 GetDeadline(int32 TimerId) const { return Timers[TimerId].Deadline; }
+
+	/** Advance to a tick; ids of timers that expired are appended to OutExpired (in deadline order) */
+	void Advance(int64 ToTick, TArray<int32>& OutExpired);
+
+	int64 GetCurrentTick() const { return CurrentTick; }
+
+	/** Pending timers */
+	int32 Num() const { return PendingCount; }
+
+	/** Drop all timers and restart at a tick */
+	void Reset(int64 StartTick = 0);
+
+private:
+	struct FTimer
+	{
+		int64 Deadline = 0;
+		int32 Slot = INDEX_NONE;   // Flat slot (Level * SlotsPerLevel + Index); INDEX_NONE when free
+		int32 Prev = INDEX_NONE;
+		int32 Next = INDEX_NONE;
+	};
+
+	/** Put a timer in the slot its deadline falls in, relative to the current tick */
+	void Place(int32 TimerId);
+
+	void Link(int32 TimerId, int32 Slot);
+	void Unlink(int32 TimerId);
+
+	/** Detach a slot's list and return its head */
+	int32 TakeSlot(int32 Slot);
+
+	TArray<FTimer> Timers;
+	TArray<int32> FreeTimers;
+	TArray<int32> SlotHeads;   // NumLevels * SlotsPerLevel list heads
+	int64 CurrentTick = 0;
+	int32 PendingCount = 0;
+};
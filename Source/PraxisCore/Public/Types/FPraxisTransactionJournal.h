@@ -0,0 +1,106 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Inventory transaction kinds recorded in the journal
+ */
+enum class EPraxisInventoryTransactionType : uint8
+{
+	Purchase,
+	Reservation,
+	Consumption,
+	Production,
+	Scrap,
+	BOMConsumption,
+	BOMProduction,
+	Shipment,
+	Transfer,
+	Release,
+	Adjustment
+};
+
+/** Display name used for FInventoryTransaction::TransactionType */
+PRAXISCORE_API const TCHAR* LexToString(EPraxisInventoryTransactionType Type);
+
+/**
+ * Compact journal record. Trivially copyable; nothing is formatted at log time.
+ *
+ * The meaning of the reference fields depends on Type:
+ * - Reservation/Consumption/Production/Scrap/Release: WorkOrderId + RefName (machine)
+ * - BOMConsumption/BOMProduction:                     WorkOrderId + RefName (BOM) + RefCount (inputs)
+ * - Shipment:                                          RefCount (batches)
+ * - Transfer:                                          RefName (source location)
+ * - Adjustment (lot compaction):                      RefCount (batches merged into the lot)
+ * - Adjustment (fluid fill/draw):                     RefName (container) + FluidDelta (exact amount);
+ *                                                      QuantityDelta is it rounded to whole units
+ */
+struct PRAXISCORE_API FPraxisTransactionRecord
+{
+	FName SKU;
+	FName LocationId;
+	FName SubLocationId;
+	FName RefName;
+	FGuid BatchId;
+	int64 TimestampTicks = 0;   // FDateTime ticks (UTC)
+	int64 WorkOrderId = 0;
+	double FluidDelta = 0.0;
+	int32 QuantityDelta = 0;
+	int32 RefCount = 0;
+	EPraxisInventoryTransactionType Type = EPraxisInventoryTransactionType::Adjustment;
+
+	FPraxisTransactionRecord() = default;
+	FPraxisTransactionRecord(EPraxisInventoryTransactionType InType, FName InSKU, int32 InQuantityDelta, FName InLocationId)
+		: SKU(InSKU)
+		, LocationId(InLocationId)
+		, TimestampTicks(FDateTime::UtcNow().GetTicks())
+		, QuantityDelta(InQuantityDelta)
+		, Type(InType)
+	{
+	}
+
+	/** Human-readable reference ("WO:12 Machine:CNC_01", "BOM:X WO:12 Inputs:3", ...) */
+	FString FormatReference() const;
+};
+
+/**
+ * FPraxisTransactionJournal
+ *
+ * Fixed-capacity ring buffer of transaction records. Appending is O(1); once
+ * full, the oldest record is overwritten. Logical index 0 is the oldest record.
+ */
+class PRAXISCORE_API FPraxisTransactionJournal
+{
+public:
+	explicit FPraxisTransactionJournal(int32 InCapacity = 10000) { SetCapacity(InCapacity); }
+
+	/** Resize the buffer, keeping the newest records that still fit */
+	void SetCapacity(int32 NewCapacity);
+
+	int32 GetCapacity() const { return Records.Num(); }
+
+	void Append(const FPraxisTransactionRecord& Record);
+
+	/** Number of records currently held */
+	int32 Num() const { return Count; }
+
+	/** Total records ever appended (including overwritten ones) */
+	int64 GetTotalAppended() const { return TotalAppended; }
+
+	/** Record by logical index (0 = oldest held) */
+	const FPraxisTransactionRecord& operator[](int32 Index) const
+	{
+		check(Index >= 0 && Index < Count);
+		return Records[(Head + Index) % Records.Num()];
+	}
+
+	void Reset();
+
+private:
+	TArray<FPraxisTransactionRecord> Records;
+	int32 Head = 0;    // Slot of the oldest record
+	int32 Count = 0;
+	int64 TotalAppended = 0;
+};
@@ -0,0 +1,55 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectMacros.h"
+#include "EPraxisShift.h"
+
+/**
+ * FPraxisWorkCalendar
+ *
+ * A machine's working time as a daily pattern of shifts, over unix seconds (UTC).
+ * Day runs 06:00-14:00, Afternoon 14:00-22:00 and Night 22:00-06:00; no shifts
+ * means working around the clock.
+ *
+ * - Shift windows are merged, so adjacent shifts form one window
+ * - Advance and Retreat skip whole days in one step, then walk at most a day's
+ *   windows, so their cost does not grow with the duration
+ */
+class PRAXISCORE_API FPraxisWorkCalendar
+{
+public:
+	static constexpr double SecondsPerDay = 86400.0;
+
+	/** Around the clock */
+	FPraxisWorkCalendar() = default;
+
+	explicit FPraxisWorkCalendar(TConstArrayView<EPraxisShift> Shifts);
+
+	bool IsAlwaysOpen() const { return Windows.Num() == 0; }
+
+	/** Earliest working instant at or after T */
+	double NextOpen(double T) const;
+
+	/** Latest instant at or before T that working time runs up to */
+	double PrevOpen(double T) const;
+
+	/** When WorkSeconds of working time started at Start finish */
+	double Advance(double Start, double WorkSeconds) const;
+
+	/** When WorkSeconds of working time must start to finish by Finish */
+	double Retreat(double Finish, double WorkSeconds) const;
+
+private:
+	/** Working window within a day, in seconds since midnight */
+	struct FWindow
+	{
+		double Begin = 0.0;
+		double End = 0.0;
+	};
+
+	/** Sorted and disjoint; empty when always open */
+	TArray<FWindow> Windows;
+	double OpenSecondsPerDay = SecondsPerDay;
+};
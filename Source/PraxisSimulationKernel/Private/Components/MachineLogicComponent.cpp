@@ -7,6 +7,7 @@
 #include "PraxisRandomService.h"
 #include "PraxisMetricsSubsystem.h"
 #include "PraxisScheduleService.h"
+#include "PraxisInventoryService.h"
 #include "StateTree.h"
 #include "Components/StateTreeComponent.h"
 #include "Engine/World.h"
@@ -145,16 +146,10 @@ void UMachineLogicComponent::BeginPlay()
 	Orchestrator->OnSimTick.AddDynamic(this, &UMachineLogicComponent::HandleSimTick);
 	Orchestrator->OnEndSession.AddDynamic(this, &UMachineLogicComponent::HandleEndSession);
 	
-	// Register with schedule service
-	if (UGameInstance* GI = GetWorld()->GetGameInstance())
+	// Pre-create this machine's WIP/Output/Scrap inventory locations
+	if (UPraxisInventoryService* Inventory = GetWorld()->GetSubsystem<UPraxisInventoryService>())
 	{
-		if (UPraxisScheduleService* ScheduleService = GI->GetSubsystem<UPraxisScheduleService>())
-		{
-			ScheduleService->RegisterMachine(MachineId);
-			UE_LOG(LogPraxisSim, Log, 
-				TEXT("[%s] Registered with schedule service"), 
-				*MachineId.ToString());
-		}
+		Inventory->RegisterMachineLocations(MachineId);
 	}
 
 	// Initialize machine context
@@ -188,6 +183,19 @@ void UMachineLogicComponent::BeginPlay()
 			TEXT("[%s] MachineLogicComponent initialized WITHOUT StateTree component"), 
 			*MachineId.ToString());
 	}
+	
+	// Register with schedule service last: it may hand over a work order at once, which
+	// must land on an initialized context and a running StateTree
+	if (UGameInstance* GI = GetWorld()->GetGameInstance())
+	{
+		if (UPraxisScheduleService* ScheduleService = GI->GetSubsystem<UPraxisScheduleService>())
+		{
+			ScheduleService->RegisterMachine(MachineId, *this);
+			UE_LOG(LogPraxisSim, Log, 
+				TEXT("[%s] Registered with schedule service"), 
+				*MachineId.ToString());
+		}
+	}
 }
 
 void UMachineLogicComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
@@ -204,6 +212,15 @@ void UMachineLogicComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 		Orchestrator->OnSimTick.RemoveDynamic(this, &UMachineLogicComponent::HandleSimTick);
 		Orchestrator->OnEndSession.RemoveDynamic(this, &UMachineLogicComponent::HandleEndSession);
 	}
+	
+	// Stop receiving work orders
+	if (UGameInstance* GI = GetWorld() ? GetWorld()->GetGameInstance() : nullptr)
+	{
+		if (UPraxisScheduleService* ScheduleService = GI->GetSubsystem<UPraxisScheduleService>())
+		{
+			ScheduleService->UnregisterMachine(MachineId);
+		}
+	}
 
 	Super::EndPlay(EndPlayReason);
 }
@@ -65,6 +65,44 @@ EStateTreeRunStatus FSTTask_Production::EnterState(
 	// Reset time in state
 	MachineCtx.TimeInState = 0.0f;
 	
+	// Inputs come from the BOM for the work order's SKU; its quantities are per OutputQuantity batch
+	InstanceData.InputsPerUnit.Reset();
+	if (InstanceData.Inventory)
+	{
+		if (const FBOMEntry* BOM = InstanceData.Inventory->FindBOMForOutput(FName(*MachineCtx.CurrentSKU)))
+		{
+			const double BatchSize = FMath::Max(1, BOM->OutputQuantity);
+			for (const TPair<FName, int32>& Requirement : BOM->InputRequirements)
+			{
+				if (Requirement.Value > 0)
+				{
+					InstanceData.InputsPerUnit.Emplace(Requirement.Key, Requirement.Value / BatchSize);
+				}
+			}
+		}
+		else
+		{
+			UE_LOG(LogPraxisSim, Warning, TEXT("[%s] No BOM produces %s - no material will be consumed"),
+				*MachineCtx.MachineId.ToString(), *MachineCtx.CurrentSKU);
+		}
+	}
+	
+	// Part-used units carry over a re-entry (jam, changeover) but not to the next work order
+	if (InstanceData.InputCarryWorkOrderId != MachineCtx.CurrentWorkOrderId || InstanceData.InputCarry.Num() != InstanceData.InputsPerUnit.Num())
+	{
+		InstanceData.InputCarry.Init(0.0, InstanceData.InputsPerUnit.Num());
+		InstanceData.InputCarryWorkOrderId = MachineCtx.CurrentWorkOrderId;
+	}
+	
+	// Continuous mode re-picks its containers for each work order
+	InstanceData.FluidOutputContainer = NAME_None;
+	InstanceData.FluidInputContainer = NAME_None;
+	InstanceData.FluidInputPerUnit = 0.0;
+	InstanceData.FluidFlowId = NAME_None;
+	InstanceData.FluidGoodAccumulator = 0.0;
+	InstanceData.FluidScrapAccumulator = 0.0;
+	InstanceData.bFluidOutputMissingReported = false;
+	
 	// Report state change to metrics
 	if (InstanceData.Metrics && !InstanceData.PreviousState.IsEmpty())
 	{
@@ -117,116 +155,165 @@ EStateTreeRunStatus FSTTask_Production::Tick(
 	// Update time in state
 	MachineCtx.TimeInState += DeltaTime;
 	
+	// Fluid output: flows instead of units
+	const bool bContinuous = InstanceData.Inventory && InstanceData.Inventory->IsFluidSKU(FName(*MachineCtx.CurrentSKU));
+	if (bContinuous)
+	{
+		TickContinuous(Context, InstanceData, MachineCtx);
+	}
+	
 	// Accumulate production progress
 	// Progress = ProductionRate (units/sec) × DeltaTime (sec)
-	MachineCtx.ProductionAccumulator += MachineCtx.ProductionRate * DeltaTime;
-	
-	// Process completed units
-	while (MachineCtx.ProductionAccumulator >= 1.0f)
+	int32 UnitsReady = 0;
+	if (!bContinuous)
 	{
-		MachineCtx.ProductionAccumulator -= 1.0f;
+		MachineCtx.ProductionAccumulator += MachineCtx.ProductionRate * DeltaTime;
 		
-		// Get MachineId for reporting (resolve once per unit)
-		FName ReportMachineId = MachineCtx.MachineId;
-		if (ReportMachineId == NAME_None)
+		// Process completed units
+		while (MachineCtx.ProductionAccumulator >= 1.0f)
 		{
-			if (AActor* Owner = Cast<AActor>(Context.GetOwner()))
-			{
-				if (UMachineLogicComponent* LogicComp = Owner->FindComponentByClass<UMachineLogicComponent>())
-				{
-					ReportMachineId = LogicComp->MachineId;
-				}
-			}
+			MachineCtx.ProductionAccumulator -= 1.0f;
+			UnitsReady++;
 		}
+	}
+	
+	if (UnitsReady > 0)
+	{
+		// Get MachineId for reporting (resolve once per tick)
+		const FName ReportMachineId = ResolveMachineId(Context, MachineCtx);
 		
-		// Consume raw material from reservation (creates WIP)
+		const FName OutputSKU = FName(*MachineCtx.CurrentSKU);
+		
+		// Units without reserved material for every input are skipped for this cycle
+		int32 UnitsToProduce = UnitsReady;
 		if (InstanceData.Inventory)
 		{
-			// For now, assume input SKU is "Steel_Bar" - TODO: Get from BOM
-			FName InputSKU = TEXT("Steel_Bar");
+			for (int32 Index = 0; Index < InstanceData.InputsPerUnit.Num(); ++Index)
+			{
+				// What is reserved plus what is left of units already drawn
+				const TPair<FName, double>& Input = InstanceData.InputsPerUnit[Index];
+				const int32 Available = InstanceData.Inventory->GetReservedQuantity(
+					ReportMachineId, MachineCtx.CurrentWorkOrderId, Input.Key);
+				const double Covered = (FMath::Max(0, Available) + InstanceData.InputCarry[Index]) / Input.Value;
+				UnitsToProduce = FMath::Min(UnitsToProduce, FMath::FloorToInt(Covered + InputTolerance));
+			}
 			
-			if (!InstanceData.Inventory->ConsumeReservedMaterial(
-				ReportMachineId,
-				MachineCtx.CurrentWorkOrderId,
-				InputSKU))
+			if (UnitsToProduce < UnitsReady)
 			{
-				// No material available - skip this production cycle
 				UE_LOG(LogPraxisSim, Warning, 
-					TEXT("[%s] No reserved material available for production"),
-					*ReportMachineId.ToString());
-				continue;
+					TEXT("[%s] No reserved material available for %d of %d units"),
+					*ReportMachineId.ToString(), UnitsReady - UnitsToProduce, UnitsReady);
+			}
+		}
+		
+		// Decide quality per unit, then commit the whole tick's output at once
+		int32 GoodUnits = 0;
+		int32 ScrapUnits = 0;
+		for (int32 Unit = 0; Unit < UnitsToProduce; ++Unit)
+		{
+			if (ShouldScrapUnit(InstanceData, MachineCtx))
+			{
+				MachineCtx.ScrapCounter++;
+				ScrapUnits++;
+			}
+			else
+			{
+				MachineCtx.OutputCounter++;
+				GoodUnits++;
 			}
 		}
 		
-		// Determine if this unit is scrap
-		if (ShouldScrapUnit(InstanceData, MachineCtx))
+		if (InstanceData.Inventory && UnitsToProduce > 0)
 		{
-			MachineCtx.ScrapCounter++;
+			TArray<FPraxisInventoryOp> Ops;
 			
-			// Convert WIP to scrap in inventory
-			if (InstanceData.Inventory)
+			// Discrete stock is drawn in whole units, only as the output's share of the BOM
+			// outgrows what is left of units drawn before. Good units draw first, then scrap;
+			// each output uses up (and descends from) the WIP drawn for it.
+			TArray<double> Carry = InstanceData.InputCarry;
+			TMap<FName, int32> GoodInputs;
+			TMap<FName, int32> ScrapInputs;
+			for (int32 Index = 0; Index < InstanceData.InputsPerUnit.Num(); ++Index)
 			{
-				FName ScrapLocation = FName(*FString::Printf(TEXT("%s.Scrap"), *ReportMachineId.ToString()));
-				InstanceData.Inventory->ProduceScrap(
-					ReportMachineId,
-					MachineCtx.CurrentWorkOrderId,
-					FName(*MachineCtx.CurrentSKU),
-					ScrapLocation
-				);
+				const TPair<FName, double>& Input = InstanceData.InputsPerUnit[Index];
+				const int32 GoodDraw = DrawWholeUnits(Input.Value * GoodUnits, Carry[Index]);
+				const int32 ScrapDraw = DrawWholeUnits(Input.Value * ScrapUnits, Carry[Index]);
+				if (GoodDraw + ScrapDraw > 0)
+				{
+					Ops.Add(FPraxisInventoryOp::MakeConsume(ReportMachineId, MachineCtx.CurrentWorkOrderId, Input.Key, GoodDraw + ScrapDraw));
+				}
+				if (GoodDraw > 0)
+				{
+					GoodInputs.Add(Input.Key, GoodDraw);
+				}
+				if (ScrapDraw > 0)
+				{
+					ScrapInputs.Add(Input.Key, ScrapDraw);
+				}
 			}
 			
-			// Report scrap to metrics
-			if (InstanceData.Metrics)
+			// Output/scrap locations are pre-built when the machine registers
+			const FPraxisMachineLocations& MachineLocations = InstanceData.Inventory->GetMachineLocations(ReportMachineId);
+			if (GoodUnits > 0)
 			{
-				InstanceData.Metrics->RecordScrap(
-					ReportMachineId,
-					1,
-					MachineCtx.CurrentSKU,
-					FDateTime::UtcNow()
-				);
+				Ops.Add(FPraxisInventoryOp::MakeProduceFromInputs(ReportMachineId, MachineCtx.CurrentWorkOrderId, OutputSKU, GoodUnits, MachineLocations.OutputName, GoodInputs));
+			}
+			if (ScrapUnits > 0)
+			{
+				Ops.Add(FPraxisInventoryOp::MakeProduceFromInputs(ReportMachineId, MachineCtx.CurrentWorkOrderId, OutputSKU, ScrapUnits, MachineLocations.ScrapName, ScrapInputs, true));
 			}
 			
-			UE_LOG(LogPraxisSim, Verbose, 
-				TEXT("[%s] Produced SCRAP unit (%d/%d good, %d scrap)"), 
-				*ReportMachineId.ToString(),
-				MachineCtx.OutputCounter,
-				MachineCtx.TargetQuantity,
-				MachineCtx.ScrapCounter);
+			// The batch is all-or-nothing: if it was rejected, none of this tick's units exist
+			// and nothing was drawn
+			int32 AppliedCount = 0;
+			if (InstanceData.Inventory->ApplyInventoryBatch(Ops, AppliedCount))
+			{
+				InstanceData.InputCarry = MoveTemp(Carry);
+			}
+			else
+			{
+				UE_LOG(LogPraxisSim, Warning, 
+					TEXT("[%s] Inventory rejected this tick's output (%d good, %d scrap); not counted"),
+					*ReportMachineId.ToString(), GoodUnits, ScrapUnits);
+				MachineCtx.OutputCounter -= GoodUnits;
+				MachineCtx.ScrapCounter -= ScrapUnits;
+				GoodUnits = 0;
+				ScrapUnits = 0;
+			}
 		}
-		else
+		
+		// Report to metrics
+		if (InstanceData.Metrics)
 		{
-			MachineCtx.OutputCounter++;
-			
-			// Convert WIP to finished good in inventory
-			if (InstanceData.Inventory)
+			if (ScrapUnits > 0)
 			{
-				FName OutputLocation = FName(*FString::Printf(TEXT("%s.Output"), *ReportMachineId.ToString()));
-				InstanceData.Inventory->ProduceFinishedGood(
+				InstanceData.Metrics->RecordScrap(
 					ReportMachineId,
-					MachineCtx.CurrentWorkOrderId,
-					FName(*MachineCtx.CurrentSKU),
-					OutputLocation
+					ScrapUnits,
+					MachineCtx.CurrentSKU,
+					FDateTime::UtcNow()
 				);
 			}
 			
-			// Report good production to metrics
-			if (InstanceData.Metrics)
+			if (GoodUnits > 0)
 			{
 				InstanceData.Metrics->RecordGoodProduction(
 					ReportMachineId,
-					1,
+					GoodUnits,
 					MachineCtx.CurrentSKU,
 					FDateTime::UtcNow()
 				);
 			}
-			
-			UE_LOG(LogPraxisSim, Verbose, 
-				TEXT("[%s] Produced GOOD unit (%d/%d good, %d scrap)"), 
-				*ReportMachineId.ToString(),
-				MachineCtx.OutputCounter,
-				MachineCtx.TargetQuantity,
-				MachineCtx.ScrapCounter);
 		}
+		
+		UE_LOG(LogPraxisSim, Verbose, 
+			TEXT("[%s] Produced %d GOOD, %d SCRAP this tick (%d/%d good, %d scrap)"), 
+			*ReportMachineId.ToString(),
+			GoodUnits,
+			ScrapUnits,
+			MachineCtx.OutputCounter,
+			MachineCtx.TargetQuantity,
+			MachineCtx.ScrapCounter);
 	}
 	
 	// Check if work order is complete
@@ -275,6 +362,13 @@ void FSTTask_Production::ExitState(
 	// Get context
 	const FPraxisMachineContext& MachineCtx = InstanceData.MachineContext->GetContext();
 	
+	// Done, blocked or interrupted (jam, changeover): the machine stops filling/drawing
+	if (InstanceData.Inventory && !InstanceData.FluidFlowId.IsNone())
+	{
+		InstanceData.Inventory->StopFluidFlows(InstanceData.FluidFlowId);
+		InstanceData.FluidFlowId = NAME_None;
+	}
+	
 	UE_LOG(LogPraxisSim, Verbose, 
 		TEXT("[%s] Exiting Production state - Final: %d good, %d scrap"), 
 		*MachineCtx.MachineId.ToString(),
@@ -282,6 +376,139 @@ void FSTTask_Production::ExitState(
 		MachineCtx.ScrapCounter);
 }
 
+void FSTTask_Production::TickContinuous(
+	FStateTreeExecutionContext& Context,
+	FInstanceDataType& InstanceData,
+	FPraxisMachineContext& MachineCtx) const
+{
+	UPraxisInventoryService* Inventory = InstanceData.Inventory;
+	const FPraxisFluidStore& FluidStore = Inventory->GetFluidStore();
+	const FName OutputSKU = FName(*MachineCtx.CurrentSKU);
+	
+	// Output to the tank at the machine's output buffer if there is one, else the emptiest;
+	// draw from the BOM's first fluid input (discrete inputs aren't drawn in this mode)
+	if (InstanceData.FluidFlowId.IsNone())
+	{
+		InstanceData.FluidFlowId = ResolveMachineId(Context, MachineCtx);
+		const FPraxisMachineLocations& MachineLocations = Inventory->GetMachineLocations(InstanceData.FluidFlowId);
+		InstanceData.FluidOutputContainer = Inventory->FindFluidContainer(OutputSKU, MachineLocations.OutputName, true);
+		for (const TPair<FName, double>& Input : InstanceData.InputsPerUnit)
+		{
+			if (Inventory->IsFluidSKU(Input.Key))
+			{
+				InstanceData.FluidInputContainer = Inventory->FindFluidContainer(Input.Key, MachineLocations.WIPName, false);
+				InstanceData.FluidInputPerUnit = Input.Value;
+				break;
+			}
+		}
+	}
+	
+	const int32 Output = FluidStore.Find(InstanceData.FluidOutputContainer);
+	const int32 Input = FluidStore.Find(InstanceData.FluidInputContainer);
+	if (Output == INDEX_NONE)
+	{
+		// Nowhere to put the output: the machine makes nothing until a container is registered
+		if (!InstanceData.bFluidOutputMissingReported)
+		{
+			UE_LOG(LogPraxisSim, Warning, 
+				TEXT("[%s] No fluid container for %s at %s - production is stalled"),
+				*InstanceData.FluidFlowId.ToString(), *MachineCtx.CurrentSKU,
+				*Inventory->GetMachineLocations(InstanceData.FluidFlowId).OutputName.ToString());
+			InstanceData.bFluidOutputMissingReported = true;
+		}
+		
+		// Look again next tick
+		InstanceData.FluidFlowId = NAME_None;
+		return;
+	}
+	
+	// Plan over the tick the inventory advances the flows by, so counters and levels share
+	// one clock. Other flows on the same containers are assumed to hold for the tick.
+	const double TickSeconds = Inventory->GetSimTickSeconds();
+	const double Yield = 1.0 - MachineCtx.ScrapRate;
+	double Gross = MachineCtx.ProductionRate * TickSeconds;
+	
+	// Blocked: no more than the output container has room for
+	const FPraxisFluidStore::FContainer& OutputTank = FluidStore.Get(Output);
+	if (Yield > 0.0)
+	{
+		const double OtherRate = OutputTank.NetRate - FluidStore.GetFlowRate(Output, InstanceData.FluidFlowId);
+		const double Room = OutputTank.Capacity - (OutputTank.Level + OtherRate * TickSeconds);
+		Gross = FMath::Min(Gross, FMath::Max(0.0, Room) / Yield);
+	}
+	
+	// Starved: no more than the input container holds
+	if (Input != INDEX_NONE && InstanceData.FluidInputPerUnit > 0.0)
+	{
+		const FPraxisFluidStore::FContainer& InputTank = FluidStore.Get(Input);
+		const double OtherRate = InputTank.NetRate - FluidStore.GetFlowRate(Input, InstanceData.FluidFlowId);
+		const double Stock = InputTank.Level + OtherRate * TickSeconds;
+		Gross = FMath::Min(Gross, FMath::Max(0.0, Stock) / InstanceData.FluidInputPerUnit);
+	}
+	Gross = FMath::Max(0.0, Gross);
+	
+	// Average rates that move exactly the planned amounts by tick end, so the output can't
+	// outrun the draw when one container would hit its limit part-way through
+	const double Rate = TickSeconds > 0.0 ? Gross / TickSeconds : 0.0;
+	Inventory->SetFluidFlow(InstanceData.FluidOutputContainer, InstanceData.FluidFlowId, MachineCtx.CurrentWorkOrderId, Rate * Yield);
+	if (Input != INDEX_NONE)
+	{
+		Inventory->SetFluidFlow(InstanceData.FluidInputContainer, InstanceData.FluidFlowId, MachineCtx.CurrentWorkOrderId, -Rate * InstanceData.FluidInputPerUnit);
+	}
+	
+	if (Gross <= 0.0)
+	{
+		return;
+	}
+	
+	// Scrap is yield loss: it never reaches the tank
+	InstanceData.FluidGoodAccumulator += Gross * Yield;
+	InstanceData.FluidScrapAccumulator += Gross * MachineCtx.ScrapRate;
+	
+	const int32 GoodUnits = FMath::FloorToInt(InstanceData.FluidGoodAccumulator);
+	const int32 ScrapUnits = FMath::FloorToInt(InstanceData.FluidScrapAccumulator);
+	InstanceData.FluidGoodAccumulator -= GoodUnits;
+	InstanceData.FluidScrapAccumulator -= ScrapUnits;
+	MachineCtx.OutputCounter += GoodUnits;
+	MachineCtx.ScrapCounter += ScrapUnits;
+	
+	if (InstanceData.Metrics)
+	{
+		if (ScrapUnits > 0)
+		{
+			InstanceData.Metrics->RecordScrap(InstanceData.FluidFlowId, ScrapUnits, MachineCtx.CurrentSKU, FDateTime::UtcNow());
+		}
+		if (GoodUnits > 0)
+		{
+			InstanceData.Metrics->RecordGoodProduction(InstanceData.FluidFlowId, GoodUnits, MachineCtx.CurrentSKU, FDateTime::UtcNow());
+		}
+	}
+}
+
+int32 FSTTask_Production::DrawWholeUnits(double Needed, double& Carry)
+{
+	const int32 Drawn = FMath::Max(0, FMath::CeilToInt(Needed - Carry - InputTolerance));
+	Carry = FMath::Max(0.0, Carry + Drawn - Needed);
+	return Drawn;
+}
+
+FName FSTTask_Production::ResolveMachineId(FStateTreeExecutionContext& Context, const FPraxisMachineContext& MachineCtx)
+{
+	if (MachineCtx.MachineId != NAME_None)
+	{
+		return MachineCtx.MachineId;
+	}
+	
+	if (AActor* Owner = Cast<AActor>(Context.GetOwner()))
+	{
+		if (UMachineLogicComponent* LogicComp = Owner->FindComponentByClass<UMachineLogicComponent>())
+		{
+			return LogicComp->MachineId;
+		}
+	}
+	return NAME_None;
+}
+
 bool FSTTask_Production::ShouldScrapUnit(
 	const FInstanceDataType& InstanceData, 
 	const FPraxisMachineContext& MachineCtx) const
@@ -4,6 +4,7 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "StateTreeReference.h"
+#include "PraxisMachineInterface.h"
 #include "MachineLogicComponent.generated.h"
 
 // Forward declarations
@@ -22,7 +23,7 @@ class UMachineContextComponent;
  * Ticks the StateTree in response to simulation ticks from Orchestrator.
  */
 UCLASS(Blueprintable, BlueprintType, ClassGroup=(Praxis), meta=(BlueprintSpawnableComponent))
-class PRAXISSIMULATIONKERNEL_API UMachineLogicComponent : public UActorComponent
+class PRAXISSIMULATIONKERNEL_API UMachineLogicComponent : public UActorComponent, public IPraxisMachine
 {
 	GENERATED_BODY()
 
@@ -33,9 +34,9 @@ public:
 	// Public API
 	// ═══════════════════════════════════════════════════════════════════════════
 	
-	/** Assign a work order to this machine */
+	/** Assign a work order to this machine (the schedule service calls this directly once registered) */
 	UFUNCTION(BlueprintCallable, Category = "Machine")
-	void AssignWorkOrder(int64 WorkOrderId, const FString& SKU, int32 Quantity);
+	virtual void AssignWorkOrder(int64 WorkOrderId, const FString& SKU, int32 Quantity) override;
 	
 	/** Get current machine state for debugging/monitoring */
 	UFUNCTION(BlueprintCallable, Category = "Machine")
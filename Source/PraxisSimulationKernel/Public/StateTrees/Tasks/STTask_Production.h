@@ -38,6 +38,33 @@ struct FSTTask_ProductionInstanceData
 	
 	/** Track previous state for reporting */
 	FString PreviousState;
+	
+	/** Input SKUs and amounts used per output unit, from the BOM for the work order's SKU (resolved on entry) */
+	TArray<TPair<FName, double>> InputsPerUnit;
+	
+	/** Per input (same order): part of a unit already drawn that later output can still use.
+	 *  Stock is drawn in whole units only once output needs more than this. Kept for the work order. */
+	TArray<double> InputCarry;
+	
+	/** Work order the carry belongs to */
+	int64 InputCarryWorkOrderId = 0;
+	
+	/** Continuous mode: containers the machine's flows are set on (resolved on the first tick) */
+	FName FluidOutputContainer;
+	FName FluidInputContainer;
+	
+	/** Continuous mode: fluid input drawn per unit of output */
+	double FluidInputPerUnit = 0.0;
+	
+	/** Continuous mode: flow id the flows were set under (the machine id) */
+	FName FluidFlowId;
+	
+	/** Continuous mode: output not yet counted as whole units */
+	double FluidGoodAccumulator = 0.0;
+	double FluidScrapAccumulator = 0.0;
+	
+	/** Continuous mode: the missing output container was reported for this work order */
+	bool bFluidOutputMissingReported = false;
 };
 
 /**
@@ -48,6 +75,18 @@ struct FSTTask_ProductionInstanceData
  * - When accumulator >= 1.0, outputs a unit (good or scrap based on ScrapRate)
  * - Returns Succeeded when work order complete (OutputCounter >= TargetQuantity)
  * - Returns Running while still producing
+ *
+ * - Inputs come from the BOM producing the work order's SKU; units are limited by
+ *   the material reserved for the work order. Each output unit uses its share of the
+ *   BOM, drawn in whole units as the share adds up (1 bar for 10 parts is drawn once),
+ *   and the output batch records every input batch it used as a parent
+ *
+ * Fluid output SKUs (see UPraxisInventoryService::RegisterFluidContainer) run in
+ * continuous mode instead: each tick the machine plans what it can make over the
+ * inventory's tick length (limited by the output container's room and, when the
+ * input is fluid too, by the input container's stock) and sets flows that move
+ * exactly that by tick end. Output therefore never outruns the draw; scrap is
+ * yield loss and counters track whole units of what the flows move.
  */
 USTRUCT(BlueprintType, meta = (Category = "Praxis", DisplayName = "Production"))
 struct PRAXISSIMULATIONKERNEL_API FSTTask_Production : public FStateTreeTaskBase
@@ -69,6 +108,19 @@ struct PRAXISSIMULATIONKERNEL_API FSTTask_Production : public FStateTreeTaskBase
 	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
 
 protected:
+	/** Continuous mode: set the machine's flows for this tick and count progress */
+	void TickContinuous(FStateTreeExecutionContext& Context, FInstanceDataType& InstanceData, FPraxisMachineContext& MachineCtx) const;
+	
+	/** Whole units to draw for Needed units' worth of an input, using Carry (what is left of
+	 *  units drawn before) first; Carry keeps the unused part of what is drawn */
+	static int32 DrawWholeUnits(double Needed, double& Carry);
+	
+	/** Slack for per-unit shares that don't sum exactly in floating point (10 × 0.1) */
+	static constexpr double InputTolerance = 1.0e-6;
+	
+	/** Machine id from the context, falling back to the owner's logic component */
+	static FName ResolveMachineId(FStateTreeExecutionContext& Context, const FPraxisMachineContext& MachineCtx);
+	
 	/** Check if a produced unit should be scrapped based on scrap rate */
 	bool ShouldScrapUnit(const FInstanceDataType& InstanceData, const FPraxisMachineContext& MachineCtx) const;
 };
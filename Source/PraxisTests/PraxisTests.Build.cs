@@ -17,7 +17,8 @@ public class PraxisTests : ModuleRules
             new string[]
             {
                 "CoreUObject",
-                "Engine"
+                "Engine",
+                "PraxisCore"
             }
         );
     }
@@ -0,0 +1,263 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "Types/FPraxisDispatchQueue.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace PraxisDispatchQueueTests
+{
+	using FKey = FPraxisDispatchQueue::FKey;
+
+	FKey MakeKey(double Primary, double Secondary = 0.0)
+	{
+		FKey Key;
+		Key.Primary = Primary;
+		Key.Secondary = Secondary;
+		return Key;
+	}
+
+	/** Reference model: every queued order with its key and arrival, kept in a plain map */
+	struct FModel
+	{
+		struct FEntry
+		{
+			FKey Key;
+			uint64 Arrival = 0;
+		};
+
+		TMap<int64, FEntry> Entries;
+		uint64 NextArrival = 0;
+
+		void Push(int64 Id, const FKey& Key) { Entries.Add(Id, { Key, NextArrival++ }); }
+
+		/** Order the queue must pop next, or INDEX_NONE when empty */
+		int64 Min() const
+		{
+			int64 Best = INDEX_NONE;
+			const FEntry* BestEntry = nullptr;
+			for (const TPair<int64, FEntry>& KVP : Entries)
+			{
+				const FEntry& E = KVP.Value;
+				if (!BestEntry
+					|| E.Key.Primary < BestEntry->Key.Primary
+					|| (E.Key.Primary == BestEntry->Key.Primary && (E.Key.Secondary < BestEntry->Key.Secondary
+						|| (E.Key.Secondary == BestEntry->Key.Secondary && E.Arrival < BestEntry->Arrival))))
+				{
+					Best = KVP.Key;
+					BestEntry = &E;
+				}
+			}
+			return Best;
+		}
+	};
+
+	TArray<int64> PopAll(FPraxisDispatchQueue& Queue)
+	{
+		TArray<int64> Out;
+		int64 Id = 0;
+		while (Queue.Pop(Id))
+		{
+			Out.Add(Id);
+		}
+		return Out;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPraxisDispatchQueueTieBreakTest, "Praxis.Core.DispatchQueue.TieBreak",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPraxisDispatchQueueTieBreakTest::RunTest(const FString& Parameters)
+{
+	using namespace PraxisDispatchQueueTests;
+
+	// Equal keys dispatch in arrival order
+	{
+		FPraxisDispatchQueue Queue;
+		Queue.Push(3, FKey());
+		Queue.Push(1, FKey());
+		Queue.Push(2, FKey());
+		TestEqual(TEXT("Equal keys pop FIFO"), PopAll(Queue), TArray<int64>({ 3, 1, 2 }));
+	}
+
+	// Secondary breaks a Primary tie before arrival does
+	{
+		FPraxisDispatchQueue Queue;
+		Queue.Push(1, MakeKey(1.0, 5.0));
+		Queue.Push(2, MakeKey(1.0, 2.0));
+		Queue.Push(3, MakeKey(0.0, 9.0));
+		TestEqual(TEXT("Primary, then Secondary"), PopAll(Queue), TArray<int64>({ 3, 2, 1 }));
+	}
+
+	// Update keeps the arrival; a second Push is a new arrival
+	{
+		FPraxisDispatchQueue Queue;
+		Queue.Push(1, FKey());
+		Queue.Push(2, FKey());
+		Queue.Push(3, FKey());
+		TestTrue(TEXT("Update finds a queued order"), Queue.Update(1, FKey()));
+		TestFalse(TEXT("Update ignores an unknown order"), Queue.Update(9, FKey()));
+		TestEqual(TEXT("Updated order keeps its place"), PopAll(Queue), TArray<int64>({ 1, 2, 3 }));
+
+		Queue.Push(1, FKey());
+		Queue.Push(2, FKey());
+		Queue.Push(1, FKey());
+		TestEqual(TEXT("Re-pushed order goes to the back"), Queue.Num(), 2);
+		TestEqual(TEXT("Re-pushed order pops last"), PopAll(Queue), TArray<int64>({ 2, 1 }));
+	}
+
+	// Append continues the arrival sequence in batch order and replaces queued entries
+	{
+		FPraxisDispatchQueue Queue;
+		Queue.Push(4, FKey());
+		Queue.Push(5, FKey());
+		TArray<TPair<int64, FKey>> Batch;
+		Batch.Emplace(6, FKey());
+		Batch.Emplace(4, FKey());
+		Batch.Emplace(7, FKey());
+		Queue.Append(Batch);
+		TestEqual(TEXT("Append keeps one entry per order"), Queue.Num(), 4);
+		TestEqual(TEXT("Append arrivals follow the queue's"), PopAll(Queue), TArray<int64>({ 5, 6, 4, 7 }));
+	}
+
+	// An order taken out and re-queued at its old arrival keeps its place
+	{
+		FPraxisDispatchQueue Queue;
+		Queue.Push(1, FKey());
+		Queue.Push(2, FKey());
+		Queue.Push(3, FKey());
+		const uint64 Arrival = Queue.GetArrival(1);
+		Queue.Remove(1);
+		Queue.Push(4, FKey());
+		TArray<TPair<int64, FKey>> Batch;
+		Batch.Emplace(1, FKey());
+		Queue.Append(Batch, { Arrival });
+		TestEqual(TEXT("Re-queued at its arrival"), PopAll(Queue), TArray<int64>({ 1, 2, 3, 4 }));
+	}
+
+	// Rekey reorders by the new keys, arrival still breaking ties
+	{
+		FPraxisDispatchQueue Queue;
+		for (int64 Id = 1; Id <= 4; ++Id)
+		{
+			Queue.Push(Id, MakeKey(static_cast<double>(Id)));
+		}
+		Queue.Rekey([](int64 Id) { return MakeKey(Id % 2 == 0 ? 0.0 : 1.0); });
+		TestEqual(TEXT("Rekeyed order"), PopAll(Queue), TArray<int64>({ 2, 4, 1, 3 }));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPraxisDispatchQueueHeapTest, "Praxis.Core.DispatchQueue.Heap",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPraxisDispatchQueueHeapTest::RunTest(const FString& Parameters)
+{
+	using namespace PraxisDispatchQueueTests;
+
+	// Random operations against the reference model; keys from a small range so ties are common.
+	// Every pop must match the model's minimum, which only holds if each operation left a valid heap.
+	FRandomStream Random(0x5eed);
+	FPraxisDispatchQueue Queue;
+	FModel Model;
+	constexpr int64 IdRange = 64;
+
+	auto RandomKey = [&Random]()
+	{
+		return MakeKey(Random.RandRange(0, 3), Random.RandRange(0, 2));
+	};
+
+	for (int32 Step = 0; Step < 5000; ++Step)
+	{
+		const int64 Id = Random.RandRange(0, IdRange - 1);
+		const int32 Op = Random.RandRange(0, 5);
+		switch (Op)
+		{
+		case 0:
+		case 1:
+		{
+			const FKey Key = RandomKey();
+			Queue.Push(Id, Key);
+			Model.Push(Id, Key);
+			break;
+		}
+		case 2:
+		{
+			const FKey Key = RandomKey();
+			const bool bQueued = Model.Entries.Contains(Id);
+			if (bQueued)
+			{
+				Model.Entries[Id].Key = Key;
+			}
+			if (Queue.Update(Id, Key) != bQueued)
+			{
+				AddError(FString::Printf(TEXT("Step %d: Update(%lld) disagreed with the model"), Step, Id));
+				return false;
+			}
+			break;
+		}
+		case 3:
+		{
+			if (Queue.Remove(Id) != (Model.Entries.Remove(Id) > 0))
+			{
+				AddError(FString::Printf(TEXT("Step %d: Remove(%lld) disagreed with the model"), Step, Id));
+				return false;
+			}
+			break;
+		}
+		case 4:
+		{
+			TArray<TPair<int64, FKey>> Batch;
+			const int32 Count = Random.RandRange(0, 8);
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				const int64 BatchId = Random.RandRange(0, IdRange - 1);
+				const FKey Key = RandomKey();
+				Batch.Emplace(BatchId, Key);
+				Model.Push(BatchId, Key);
+			}
+			Queue.Append(Batch);
+			break;
+		}
+		case 5:
+		{
+			const int64 Expected = Model.Min();
+			int64 Popped = INDEX_NONE;
+			const bool bPopped = Queue.Pop(Popped);
+			if (bPopped != (Expected != INDEX_NONE) || (bPopped && Popped != Expected))
+			{
+				AddError(FString::Printf(TEXT("Step %d: popped %lld, expected %lld"), Step, bPopped ? Popped : INDEX_NONE, Expected));
+				return false;
+			}
+			Model.Entries.Remove(Expected);
+			break;
+		}
+		}
+
+		if (Queue.Num() != Model.Entries.Num() || Queue.Contains(Id) != Model.Entries.Contains(Id))
+		{
+			AddError(FString::Printf(TEXT("Step %d: queue holds %d orders, model %d"), Step, Queue.Num(), Model.Entries.Num()));
+			return false;
+		}
+	}
+
+	// Drain what is left in full order
+	while (Model.Entries.Num() > 0)
+	{
+		const int64 Expected = Model.Min();
+		int64 Popped = INDEX_NONE;
+		if (!Queue.Pop(Popped) || Popped != Expected)
+		{
+			AddError(FString::Printf(TEXT("Drain: popped %lld, expected %lld"), Popped, Expected));
+			return false;
+		}
+		Model.Entries.Remove(Expected);
+	}
+	TestEqual(TEXT("Queue drained"), Queue.Num(), 0);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,78 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Misc/AutomationTest.h"
+#include "Types/FPraxisGenealogyGraph.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPraxisGenealogyGraphTest, "Praxis.Core.Inventory.GenealogyGraph",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPraxisGenealogyGraphTest::RunTest(const FString& Parameters)
+{
+	auto Children = [](const FPraxisGenealogyGraph& Graph, uint32 Id)
+	{
+		TArray<uint32> Out;
+		Graph.ForEachChild(Id, [&Out](uint32 Child) { Out.Add(Child); });
+		return Out;
+	};
+	auto Parents = [](const FPraxisGenealogyGraph& Graph, uint32 Id)
+	{
+		TArray<uint32> Out;
+		Graph.ForEachParent(Id, [&Out](uint32 Parent) { Out.Add(Parent); });
+		return Out;
+	};
+
+	// Two raw batches into a WIP batch, one also into a second WIP batch, then a finished good
+	// and a split of the first WIP batch. Lot G stands alone.
+	const FGuid GuidA = FGuid::NewGuid(), GuidB = FGuid::NewGuid(), GuidC = FGuid::NewGuid();
+	const FGuid GuidD = FGuid::NewGuid(), GuidE = FGuid::NewGuid(), GuidF = FGuid::NewGuid(), GuidG = FGuid::NewGuid();
+
+	FPraxisGenealogyGraph Graph;
+	const uint32 A = Graph.AddBatch(GuidA, TEXT("RM-1"), 0, 0.0, {});
+	const uint32 B = Graph.AddBatch(GuidB, TEXT("RM-2"), 0, 0.0, {});
+	const uint32 G = Graph.AddBatch(GuidG, TEXT("RM-3"), 0, 0.5, {});
+	const uint32 C = Graph.AddBatch(GuidC, TEXT("WIP-1"), 1, 1.0, { A, B });
+	const uint32 D = Graph.AddBatch(GuidD, TEXT("WIP-2"), 1, 2.0, { A });
+	const uint32 F = Graph.AddBatch(GuidF, TEXT("WIP-1"), 1, 3.0, { C });
+	const uint32 E = Graph.AddBatch(GuidE, TEXT("FG-1"), 2, 10.0, { C });
+
+	TestEqual(TEXT("Children oldest first"), Children(Graph, A), TArray<uint32>({ C, D }));
+	TestEqual(TEXT("Children of WIP"), Children(Graph, C), TArray<uint32>({ F, E }));
+	TestEqual(TEXT("Edges before merging"), Graph.NumEdges(), 5);
+
+	// D merges into C's lot, and the split F merges back into it, closing a cycle
+	Graph.AddMergedParents(C, { D, F });
+	TestEqual(TEXT("Merged batches become parents"), Parents(Graph, C).Num(), 4);
+	TestTrue(TEXT("Merge edge seen from the merged batch"), Children(Graph, D).Contains(C));
+	TestEqual(TEXT("Edges after merging"), Graph.NumEdges(), 7);
+
+	TArray<uint32> Trace;
+	Graph.TraceForward(C, Trace);
+	TestEqual(TEXT("Forward trace visits each batch once around the cycle"), Trace.Num(), 2);
+	Graph.TraceBackward(E, Trace);
+	TestEqual(TEXT("Backward trace follows merge edges"), Trace.Num(), 5);
+	TestTrue(TEXT("Backward trace reaches the merged batch's parent"), Trace.Contains(A));
+
+	// Keep F: its parent C, C's parents (D only through the merge edge) and A stay. G goes.
+	const int32 Dropped = Graph.Compact(5.0, [F](uint32 Id) { return Id == F; });
+	TestEqual(TEXT("Compact drops the unretained old batch"), Dropped, 1);
+	TestEqual(TEXT("Batches left"), Graph.Num(), 6);
+	TestEqual(TEXT("Dropped batch is gone"), Graph.FindBatch(GuidG), FPraxisGenealogyGraph::InvalidId);
+	TestEqual(TEXT("Edges survive compaction"), Graph.NumEdges(), 7);
+
+	const uint32 NewA = Graph.FindBatch(GuidA);
+	const uint32 NewC = Graph.FindBatch(GuidC);
+	const uint32 NewD = Graph.FindBatch(GuidD);
+	const uint32 NewE = Graph.FindBatch(GuidE);
+	TestTrue(TEXT("Batch kept through a merge edge"), Graph.IsValidId(NewD));
+	TestEqual(TEXT("Children renumbered"), Children(Graph, NewA), TArray<uint32>({ NewC, NewD }));
+	TestTrue(TEXT("Merge edge renumbered"), Children(Graph, NewD).Contains(NewC));
+	TestTrue(TEXT("Creation order survives"), Graph.GetCreationOrder(NewA) < Graph.GetCreationOrder(NewE));
+	Graph.TraceBackward(NewE, Trace);
+	TestEqual(TEXT("Backward trace after compaction"), Trace.Num(), 5);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
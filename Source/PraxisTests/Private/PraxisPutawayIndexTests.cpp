@@ -0,0 +1,47 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Misc/AutomationTest.h"
+#include "Types/FPraxisPutawayIndex.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPraxisPutawayIndexTest, "Praxis.Core.Inventory.PutawayIndex",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPraxisPutawayIndexTest::RunTest(const FString& Parameters)
+{
+	FPraxisPutawayIndex Index;
+	const int32 Near = Index.AddBin(10, FVector(0.0, 0.0, 0.0));
+	const int32 Small = Index.AddBin(11, FVector(100.0, 0.0, 0.0));
+	const int32 Far = Index.AddBin(12, FVector(5000.0, 0.0, 0.0));
+	TestEqual(TEXT("Bin id by slot"), Index.GetBinId(Far), 12);
+	TestEqual(TEXT("New bins are not eligible"), Index.FindFirstFit(0.5f), INDEX_NONE);
+
+	Index.UpdateBin(Near, 5.0f);
+	Index.UpdateBin(Small, 2.0f);
+	Index.UpdateBin(Far, 10.0f);
+
+	TestEqual(TEXT("First fit: first registered bin that fits"), Index.FindFirstFit(1.0f), Near);
+	TestEqual(TEXT("First fit skips bins too small"), Index.FindFirstFit(6.0f), Far);
+	TestEqual(TEXT("First fit: nothing fits"), Index.FindFirstFit(20.0f), INDEX_NONE);
+
+	TestEqual(TEXT("Best fit: tightest bin"), Index.FindBestFit(1.5f), Small);
+	TestEqual(TEXT("Best fit: tightest bin that fits"), Index.FindBestFit(3.0f), Near);
+	TestEqual(TEXT("Best fit: nothing fits"), Index.FindBestFit(20.0f), INDEX_NONE);
+
+	TestEqual(TEXT("Closest: nearest bin that fits"), Index.FindClosest(1.0f, FVector(4900.0, 0.0, 0.0)), Far);
+	TestEqual(TEXT("Closest skips bins too small"), Index.FindClosest(3.0f, FVector(100.0, 0.0, 0.0)), Near);
+
+	// Filling a bin and retiring another take them out of every query
+	Index.UpdateBin(Far, 0.0f);
+	Index.RetireBin(Near);
+	TestTrue(TEXT("Retired bin"), Index.IsRetired(Near));
+	TestEqual(TEXT("First fit after fill and retire"), Index.FindFirstFit(1.0f), Small);
+	TestEqual(TEXT("Best fit after fill and retire"), Index.FindBestFit(1.0f), Small);
+	TestEqual(TEXT("Closest after fill and retire"), Index.FindClosest(1.0f, FVector(5000.0, 0.0, 0.0)), Small);
+	TestEqual(TEXT("Nothing left for a large volume"), Index.FindBestFit(3.0f), INDEX_NONE);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,64 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Misc/AutomationTest.h"
+#include "Types/FPraxisReservationLedger.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPraxisReservationLedgerTest, "Praxis.Core.Inventory.ReservationLedger",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPraxisReservationLedgerTest::RunTest(const FString& Parameters)
+{
+	const FName SKU = TEXT("RM-1");
+	const FMassEntityHandle Batch1(1, 1);
+	const FMassEntityHandle Batch2(2, 1);
+	const FMassEntityHandle Batch3(3, 1);
+	const FPraxisMaterialStockKey Stock(SKU, TEXT("Bin-A"), 0, false);
+	const FPraxisMaterialStockKey OtherStock(SKU, TEXT("Bin-B"), 0, false);
+	const FPraxisMaterialReservationKey Owner1(100, TEXT("M1"));
+	const FPraxisMaterialReservationKey Owner2(200, TEXT("M2"));
+
+	FPraxisReservationLedger Ledger;
+	const int32 Claim1 = Ledger.AddClaim(Batch1, Stock, Owner1, 5, 0.0);
+	TestEqual(TEXT("Second claim on a batch by the same owner tops it up"), Ledger.AddClaim(Batch1, Stock, Owner1, 3, 1.0), Claim1);
+	Ledger.AddClaim(Batch2, OtherStock, Owner1, 4, 2.0);
+	const int32 Claim3 = Ledger.AddClaim(Batch1, Stock, Owner2, 2, 3.0);
+
+	TestEqual(TEXT("Live claims"), Ledger.Num(), 3);
+	TestEqual(TEXT("Claimed from batch"), Ledger.GetClaimedFromBatch(Batch1), 10);
+	TestEqual(TEXT("Claimed by owner"), Ledger.GetClaimed(Owner1, SKU), 12);
+	TestEqual(TEXT("Claimed for work order"), Ledger.GetClaimedForWorkOrder(100, SKU), 12);
+	TestEqual(TEXT("Claimed stock"), Ledger.GetClaimedStock(Stock), 10);
+	TestEqual(TEXT("Oldest claim of an owner"), Ledger.FindClaim(Owner1, SKU), Claim1);
+
+	// Reducing past the claim takes what is there and removes it
+	TestEqual(TEXT("Reduce takes at most the claim"), Ledger.ReduceClaim(Claim1, 20), 8);
+	TestEqual(TEXT("Claim removed at zero"), Ledger.Num(), 2);
+	TestEqual(TEXT("Batch total after reduce"), Ledger.GetClaimedFromBatch(Batch1), 2);
+	TestEqual(TEXT("Stock total after reduce"), Ledger.GetClaimedStock(Stock), 2);
+	TestEqual(TEXT("Reduce on a freed claim takes nothing"), Ledger.ReduceClaim(Claim1, 1), 0);
+
+	// Moving claims onto a batch the owner already claims merges them
+	Ledger.AddClaim(Batch3, Stock, Owner2, 1, 4.0);
+	Ledger.MoveClaims(Batch3, Batch1);
+	TestEqual(TEXT("Moved batch has no claims"), Ledger.GetClaimedFromBatch(Batch3), 0);
+	TestEqual(TEXT("Target batch has the moved units"), Ledger.GetClaimedFromBatch(Batch1), 3);
+	TestEqual(TEXT("Moved claim merged with the owner's"), Ledger.GetClaim(Claim3).Quantity, 3);
+	TestEqual(TEXT("Live claims after move"), Ledger.Num(), 2);
+
+	TArray<FPraxisReservationLedger::FClaim> Released;
+	Ledger.ReleaseOwner(Owner1, Released);
+	TestEqual(TEXT("Owner release returns its claims"), Released.Num(), 1);
+	TestEqual(TEXT("Owner has nothing claimed"), Ledger.GetClaimed(Owner1, SKU), 0);
+
+	Released.Reset();
+	Ledger.ReleaseBatch(Batch1, Released);
+	TestEqual(TEXT("Batch release returns its claims"), Released.Num(), 1);
+	TestEqual(TEXT("Ledger empty"), Ledger.Num(), 0);
+	TestEqual(TEXT("Totals removed at zero"), Ledger.GetStockTotals().Num(), 0);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,226 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Misc/AutomationTest.h"
+#include "PraxisScheduleTestUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPraxisSchedulePlannerTest, "Praxis.Core.Schedule.Planner",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPraxisSchedulePlannerTest::RunTest(const FString& Parameters)
+{
+	using namespace PraxisScheduleTests;
+
+	const FName DayMachine = TEXT("M1");
+	const FName AnyTimeMachine = TEXT("M2");
+	const TArray<EPraxisShift> DayShift = { EPraxisShift::Day };
+	const FPraxisWorkCalendar DayCalendar(DayShift);
+	const FPraxisWorkCalendar AroundTheClock;
+
+	for (const EPraxisPlanDirection Direction : { EPraxisPlanDirection::Forward, EPraxisPlanDirection::Backward })
+	{
+		const bool bForward = Direction == EPraxisPlanDirection::Forward;
+		const TCHAR* DirectionName = bForward ? TEXT("Forward") : TEXT("Backward");
+
+		UPraxisScheduleService* Schedule = NewScheduleService();
+		const int64 Now = Schedule->NowUnixSeconds();
+
+		// Hours of work, due well after they could all be done
+		TArray<FPraxisWorkOrder> WorkOrders;
+		for (int64 Id = 1; Id <= 8; ++Id)
+		{
+			WorkOrders.Add(MakeOrder(Id, static_cast<int32>(Id % 3 + 1) * 3600, Now + 30 * 86400 + Id * 3600));
+		}
+		Schedule->LoadSchedule(WorkOrders);
+
+		// Each machine takes one order when it registers; the rest are planned
+		Schedule->SetMachineShifts(DayMachine, DayShift);
+		Schedule->RegisterMachine(DayMachine);
+		Schedule->RegisterMachine(AnyTimeMachine);
+		TMap<FName, int32> Assigned;
+		for (const FName MachineId : { DayMachine, AnyTimeMachine })
+		{
+			FPraxisWorkOrder WO;
+			TestTrue(*FString::Printf(TEXT("%s: %s took an order"), DirectionName, *MachineId.ToString()), Schedule->GetNextForMachine(MachineId, WO));
+			Assigned.Add(MachineId, WO.Quantity);
+		}
+		const int32 Pending = Schedule->GetPendingWorkOrderCount();
+		TestEqual(*FString::Printf(TEXT("%s: orders left to plan"), DirectionName), Pending, WorkOrders.Num() - 2);
+		TestEqual(*FString::Printf(TEXT("%s: operations planned"), DirectionName), Schedule->BuildPlan(Direction), Pending);
+		TestEqual(*FString::Printf(TEXT("%s: planned orders still count as pending"), DirectionName), Schedule->GetPendingWorkOrderCount(), Pending);
+
+		int32 Planned = 0;
+		for (const FName MachineId : { DayMachine, AnyTimeMachine })
+		{
+			const FPraxisWorkCalendar& Calendar = MachineId == DayMachine ? DayCalendar : AroundTheClock;
+			TArray<FPraxisPlannedOperation> Plan;
+			Schedule->GetPlanForMachine(MachineId, Plan);
+			Planned += Plan.Num();
+
+			// Operations follow one another in working time, after the order the machine already has
+			double FreeFrom = Calendar.Advance(static_cast<double>(Now), Assigned[MachineId]);
+			for (const FPraxisPlannedOperation& Op : Plan)
+			{
+				const FString What = FString::Printf(TEXT("%s: order %lld on %s"), DirectionName, Op.WorkOrderID, *MachineId.ToString());
+				const double Start = Op.PlannedStart.ToUnixTimestampDecimal();
+				const double Finish = Op.PlannedFinish.ToUnixTimestampDecimal();
+				const FPraxisWorkOrder* Order = WorkOrders.FindByPredicate([&Op](const FPraxisWorkOrder& W) { return W.WorkOrderID == Op.WorkOrderID; });
+
+				TestTrue(*(What + TEXT(" does not overlap the previous operation")), Start >= FreeFrom - 1.0e-3);
+				TestEqual(*(What + TEXT(" starts in working time")), Calendar.NextOpen(Start), Start, 1.0e-3);
+				TestEqual(*(What + TEXT(" runs for its processing time")), Finish, Calendar.Advance(Start, Order->Quantity), 1.0e-3);
+				TestFalse(*(What + TEXT(" is on time")), Op.bLate);
+				FreeFrom = Finish;
+			}
+
+			// Dispatching against the plan follows it machine by machine
+			TArray<int64> Dispatched;
+			FPraxisWorkOrder WO;
+			while (Schedule->GetNextForMachine(MachineId, WO))
+			{
+				Schedule->CompleteWorkOrder(WO.WorkOrderID);
+				if (Schedule->GetNextForMachine(MachineId, WO))
+				{
+					Dispatched.Add(WO.WorkOrderID);
+				}
+			}
+			TArray<int64> Expected;
+			for (const FPraxisPlannedOperation& Op : Plan)
+			{
+				Expected.Add(Op.WorkOrderID);
+			}
+			TestEqual(*FString::Printf(TEXT("%s: %s dispatches in plan order"), DirectionName, *MachineId.ToString()), Dispatched, Expected);
+		}
+		TestEqual(*FString::Printf(TEXT("%s: every pending order is on one machine's plan"), DirectionName), Planned, Pending);
+		TestEqual(*FString::Printf(TEXT("%s: plan fully dispatched"), DirectionName), Schedule->GetPendingWorkOrderCount(), 0);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPraxisSchedulePlanReturnTest, "Praxis.Core.Schedule.PlanReturn",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPraxisSchedulePlanReturnTest::RunTest(const FString& Parameters)
+{
+	using namespace PraxisScheduleTests;
+
+	auto LoadBusyMachines = [](UPraxisScheduleService* Schedule)
+	{
+		// M1 and M2 each take an order on registering, leaving 3..8 pending in FIFO order
+		const int64 Now = Schedule->NowUnixSeconds();
+		TArray<FPraxisWorkOrder> WorkOrders;
+		for (int64 Id = 1; Id <= 8; ++Id)
+		{
+			WorkOrders.Add(MakeOrder(Id, 60, Now + 86400));
+		}
+		Schedule->LoadSchedule(WorkOrders);
+		Schedule->RegisterMachine(TEXT("M1"));
+		Schedule->RegisterMachine(TEXT("M2"));
+	};
+
+	// A machine that was only set up, never registered, gets no plan
+	{
+		UPraxisScheduleService* Schedule = NewScheduleService();
+		LoadBusyMachines(Schedule);
+		Schedule->SetMachineShifts(TEXT("M3"), { EPraxisShift::Day });
+		Schedule->BuildPlan(EPraxisPlanDirection::Forward);
+
+		TArray<FPraxisPlannedOperation> Plan;
+		Schedule->GetPlanForMachine(TEXT("M3"), Plan);
+		TestEqual(TEXT("Unregistered machine has no plan"), Plan.Num(), 0);
+	}
+
+	// Clearing the plan puts its orders back where they were in arrival order
+	{
+		UPraxisScheduleService* Schedule = NewScheduleService();
+		LoadBusyMachines(Schedule);
+		Schedule->BuildPlan(EPraxisPlanDirection::Forward);
+		Schedule->ClearPlan();
+		TestEqual(TEXT("Cleared orders are pending"), Schedule->GetPendingWorkOrderCount(), 6);
+
+		// M2 hands order 2 back at its arrival; M1 finishes order 1 and runs the rest
+		Schedule->UnregisterMachine(TEXT("M2"));
+		TestEqual(TEXT("Assigned order returned"), Schedule->GetPendingWorkOrderCount(), 7);
+		Schedule->CompleteWorkOrder(1);
+		TestEqual(TEXT("Returned orders dispatch FIFO"), DispatchAll(Schedule, TEXT("M1")), TArray<int64>({ 2, 3, 4, 5, 6, 7, 8 }));
+	}
+
+	// Unregistering a machine returns its assigned and planned orders for the others to take
+	{
+		UPraxisScheduleService* Schedule = NewScheduleService();
+		LoadBusyMachines(Schedule);
+		Schedule->BuildPlan(EPraxisPlanDirection::Forward);
+
+		TArray<FPraxisPlannedOperation> Plan;
+		Schedule->GetPlanForMachine(TEXT("M2"), Plan);
+		TestTrue(TEXT("M2 has planned work"), Plan.Num() > 0);
+
+		Schedule->UnregisterMachine(TEXT("M2"));
+		Schedule->GetPlanForMachine(TEXT("M2"), Plan);
+		TestEqual(TEXT("Unregistered machine's plan dropped"), Plan.Num(), 0);
+		TestEqual(TEXT("Nothing lost"), Schedule->GetPendingWorkOrderCount(), 7);
+
+		Schedule->CompleteWorkOrder(1);
+		TArray<int64> Dispatched;
+		FPraxisWorkOrder WO;
+		while (Schedule->GetNextForMachine(TEXT("M1"), WO))
+		{
+			Dispatched.Add(WO.WorkOrderID);
+			Schedule->CompleteWorkOrder(WO.WorkOrderID);
+		}
+		Dispatched.Sort();
+		TestEqual(TEXT("Remaining machine runs every order"), Dispatched, TArray<int64>({ 2, 3, 4, 5, 6, 7, 8 }));
+		TestEqual(TEXT("Nothing pending"), Schedule->GetPendingWorkOrderCount(), 0);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPraxisSchedulePlannerScaleTest, "Praxis.Core.Schedule.PlannerScale",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPraxisSchedulePlannerScaleTest::RunTest(const FString& Parameters)
+{
+	using namespace PraxisScheduleTests;
+
+	constexpr int32 OrderCount = 10000;
+	constexpr int32 MachineCount = 200;
+
+	UPraxisScheduleService* Schedule = NewScheduleService();
+	const int64 Now = Schedule->NowUnixSeconds();
+
+	// Mixed lengths and due dates; every other machine works the day shift only
+	TArray<FPraxisWorkOrder> WorkOrders;
+	WorkOrders.Reserve(OrderCount);
+	for (int64 Id = 1; Id <= OrderCount; ++Id)
+	{
+		WorkOrders.Add(MakeOrder(Id, static_cast<int32>(Id % 7 + 1) * 600, Now + (Id % 97) * 3600));
+	}
+	Schedule->LoadSchedule(WorkOrders);
+	for (int32 Index = 0; Index < MachineCount; ++Index)
+	{
+		const FName MachineId(*FString::Printf(TEXT("M%03d"), Index));
+		if (Index % 2 == 0)
+		{
+			Schedule->SetMachineShifts(MachineId, { EPraxisShift::Day });
+		}
+		Schedule->RegisterMachine(MachineId);
+	}
+
+	for (const EPraxisPlanDirection Direction : { EPraxisPlanDirection::Forward, EPraxisPlanDirection::Backward })
+	{
+		const TCHAR* DirectionName = Direction == EPraxisPlanDirection::Forward ? TEXT("Forward") : TEXT("Backward");
+		const double StartSeconds = FPlatformTime::Seconds();
+		const int32 Planned = Schedule->BuildPlan(Direction);
+		const double ElapsedSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		TestEqual(*FString::Printf(TEXT("%s: every pending order planned"), DirectionName), Planned, OrderCount - MachineCount);
+		TestTrue(*FString::Printf(TEXT("%s: planned in %.3fs, well under a second"), DirectionName, ElapsedSeconds), ElapsedSeconds < 0.5);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,103 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Misc/AutomationTest.h"
+#include "PraxisScheduleTestUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace PraxisScheduleServiceTests
+{
+	using namespace PraxisScheduleTests;
+
+	/** Known answer for one rule: load the orders with no machine, then dispatch them all */
+	TArray<int64> DispatchWithRule(EPraxisDispatchRule Rule, TFunctionRef<TArray<FPraxisWorkOrder>(int64 Now)> MakeOrders)
+	{
+		UPraxisScheduleService* Schedule = NewScheduleService();
+		Schedule->SetDispatchRule(Rule);
+		Schedule->LoadSchedule(MakeOrders(Schedule->NowUnixSeconds()));
+		return DispatchAll(Schedule, TEXT("M1"));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPraxisScheduleDispatchRulesTest, "Praxis.Core.Schedule.DispatchRules",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPraxisScheduleDispatchRulesTest::RunTest(const FString& Parameters)
+{
+	using namespace PraxisScheduleServiceTests;
+	using EPriority = EPraxisWorkOrderPriority;
+
+	// Same due date and quantity throughout: arrival order
+	TestEqual(TEXT("FIFO"), DispatchWithRule(EPraxisDispatchRule::FIFO, [](int64 Now)
+	{
+		return TArray<FPraxisWorkOrder>({ MakeOrder(3, 10, Now), MakeOrder(1, 10, Now), MakeOrder(2, 10, Now) });
+	}), TArray<int64>({ 3, 1, 2 }));
+
+	TestEqual(TEXT("EDD"), DispatchWithRule(EPraxisDispatchRule::EDD, [](int64 Now)
+	{
+		return TArray<FPraxisWorkOrder>({ MakeOrder(1, 5, Now + 300), MakeOrder(2, 50, Now + 100), MakeOrder(3, 1, Now + 200) });
+	}), TArray<int64>({ 2, 3, 1 }));
+
+	TestEqual(TEXT("SPT"), DispatchWithRule(EPraxisDispatchRule::SPT, [](int64 Now)
+	{
+		return TArray<FPraxisWorkOrder>({ MakeOrder(1, 30, Now + 100), MakeOrder(2, 10, Now + 300), MakeOrder(3, 20, Now + 200) });
+	}), TArray<int64>({ 2, 3, 1 }));
+
+	// Time left over work left: 10, 30 and 2; EDD or SPT would order these differently
+	TestEqual(TEXT("CriticalRatio"), DispatchWithRule(EPraxisDispatchRule::CriticalRatio, [](int64 Now)
+	{
+		return TArray<FPraxisWorkOrder>({ MakeOrder(1, 100, Now + 1000), MakeOrder(2, 10, Now + 300), MakeOrder(3, 50000, Now + 100000) });
+	}), TArray<int64>({ 3, 1, 2 }));
+
+	// No slack: weight over processing time, 0.2, 0.4 and 0.25. A far due date discounts order 4 to nothing.
+	TestEqual(TEXT("ATC"), DispatchWithRule(EPraxisDispatchRule::ATC, [](int64 Now)
+	{
+		return TArray<FPraxisWorkOrder>({
+			MakeOrder(1, 10, Now, EPriority::Low),
+			MakeOrder(2, 10, Now, EPriority::High),
+			MakeOrder(3, 4, Now, EPriority::None),
+			MakeOrder(4, 10, Now + 1000000, EPriority::None) });
+	}), TArray<int64>({ 2, 3, 1, 4 }));
+
+	// Slack counts for less as the mean pending time grows: alone, orders 1 and 2 (mean 15s) favour
+	// 2's lack of slack; a long order 3 lifts the mean to 143s and 1's shorter time wins. Every key
+	// uses the same mean however the orders came in.
+	TestEqual(TEXT("ATC: short mean"), DispatchWithRule(EPraxisDispatchRule::ATC, [](int64 Now)
+	{
+		return TArray<FPraxisWorkOrder>({ MakeOrder(1, 10, Now + 110), MakeOrder(2, 20, Now + 20) });
+	}), TArray<int64>({ 2, 1 }));
+	TestEqual(TEXT("ATC: long mean"), DispatchWithRule(EPraxisDispatchRule::ATC, [](int64 Now)
+	{
+		return TArray<FPraxisWorkOrder>({ MakeOrder(1, 10, Now + 110), MakeOrder(2, 20, Now + 20), MakeOrder(3, 400, Now + 1000000) });
+	}), TArray<int64>({ 1, 2, 3 }));
+	{
+		UPraxisScheduleService* Schedule = NewScheduleService();
+		Schedule->SetDispatchRule(EPraxisDispatchRule::ATC);
+		const int64 Now = Schedule->NowUnixSeconds();
+		Schedule->LoadSchedule({ MakeOrder(1, 10, Now + 110), MakeOrder(2, 20, Now + 20) });
+		Schedule->AddWorkOrder(MakeOrder(3, 400, Now + 1000000));
+		TestEqual(TEXT("ATC: added order re-keys the rest"), DispatchAll(Schedule, TEXT("M1")), TArray<int64>({ 1, 2, 3 }));
+	}
+
+	TestEqual(TEXT("PriorityThenEDD"), DispatchWithRule(EPraxisDispatchRule::PriorityThenEDD, [](int64 Now)
+	{
+		return TArray<FPraxisWorkOrder>({
+			MakeOrder(1, 10, Now + 100, EPriority::High),
+			MakeOrder(2, 10, Now + 10, EPriority::Low),
+			MakeOrder(3, 10, Now + 50, EPriority::High) });
+	}), TArray<int64>({ 3, 1, 2 }));
+
+	// Changing a priority re-keys the order in place
+	{
+		UPraxisScheduleService* Schedule = NewScheduleService();
+		Schedule->SetDispatchRule(EPraxisDispatchRule::PriorityThenEDD);
+		const int64 Now = Schedule->NowUnixSeconds();
+		Schedule->LoadSchedule({ MakeOrder(1, 10, Now), MakeOrder(2, 10, Now) });
+		Schedule->SetWorkOrderPriority(2, EPriority::Expedited);
+		TestEqual(TEXT("Priority change re-keys"), DispatchAll(Schedule, TEXT("M1")), TArray<int64>({ 2, 1 }));
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
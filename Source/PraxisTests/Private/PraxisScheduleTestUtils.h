@@ -0,0 +1,46 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/GameInstance.h"
+#include "UObject/Package.h"
+#include "PraxisScheduleService.h"
+
+/** Helpers shared by the schedule service tests */
+namespace PraxisScheduleTests
+{
+	/** A schedule service outside any subsystem collection; it keys on wall-clock time with no orchestrator */
+	inline UPraxisScheduleService* NewScheduleService()
+	{
+		UGameInstance* GameInstance = NewObject<UGameInstance>(GetTransientPackage());
+		return NewObject<UPraxisScheduleService>(GameInstance);
+	}
+
+	/** Untimed SKU, so an order's processing time is its quantity in seconds */
+	inline FPraxisWorkOrder MakeOrder(int64 Id, int32 Quantity, int64 DueUnixSeconds, EPraxisWorkOrderPriority Priority = EPraxisWorkOrderPriority::None)
+	{
+		FPraxisWorkOrder WO;
+		WO.WorkOrderID = Id;
+		WO.SKU = TEXT("TEST-SKU");
+		WO.Quantity = Quantity;
+		WO.DueDate = FDateTime::FromUnixTimestamp(DueUnixSeconds);
+		WO.Priority = Priority;
+		return WO;
+	}
+
+	/** Register a polling machine and run every pending order through it; returns the dispatch order */
+	inline TArray<int64> DispatchAll(UPraxisScheduleService* Schedule, FName MachineId)
+	{
+		TArray<int64> Dispatched;
+		Schedule->RegisterMachine(MachineId);
+
+		FPraxisWorkOrder WO;
+		while (Schedule->GetNextForMachine(MachineId, WO))
+		{
+			Dispatched.Add(WO.WorkOrderID);
+			Schedule->CompleteWorkOrder(WO.WorkOrderID);
+		}
+		return Dispatched;
+	}
+}
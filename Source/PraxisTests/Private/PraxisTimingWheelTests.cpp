@@ -0,0 +1,62 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Misc/AutomationTest.h"
+#include "Types/FPraxisTimingWheel.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPraxisTimingWheelTest, "Praxis.Core.Inventory.TimingWheel",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPraxisTimingWheelTest::RunTest(const FString& Parameters)
+{
+	FPraxisTimingWheel Wheel;
+	Wheel.Reset(10);
+
+	// Deadlines on every level, including ones that cascade down more than once, plus one already due
+	const TArray<int64> Deadlines = { 5, 11, 12, 12, 70, 74, 4106, 4200, 262154, 300000 };
+	TMap<int32, int64> DeadlineById;
+	for (const int64 Deadline : Deadlines)
+	{
+		DeadlineById.Add(Wheel.Schedule(Deadline), Deadline);
+	}
+	TestEqual(TEXT("Pending after scheduling"), Wheel.Num(), Deadlines.Num());
+
+	const int32 Cancelled = Wheel.Schedule(4150);
+	TestTrue(TEXT("Cancel a pending timer"), Wheel.Cancel(Cancelled));
+	TestFalse(TEXT("Cancel it twice"), Wheel.Cancel(Cancelled));
+	TestFalse(TEXT("Cancelled timer is not pending"), Wheel.IsPending(Cancelled));
+
+	// Step a tick at a time through the lower levels: each timer fires on its own tick
+	TArray<int32> Expired;
+	while (Wheel.GetCurrentTick() < 5000)
+	{
+		const int64 Tick = Wheel.GetCurrentTick() + 1;
+		Expired.Reset();
+		Wheel.Advance(Tick, Expired);
+		for (const int32 TimerId : Expired)
+		{
+			const int64 Deadline = DeadlineById.FindAndRemoveChecked(TimerId);
+			if (Deadline != Tick && !(Deadline < 10 && Tick == 11))
+			{
+				AddError(FString::Printf(TEXT("Timer due at %lld fired at %lld"), Deadline, Tick));
+			}
+		}
+	}
+	TestEqual(TEXT("Timers left past tick 5000"), DeadlineById.Num(), 2);
+
+	// One long jump fires the rest in deadline order
+	Expired.Reset();
+	Wheel.Advance(400000, Expired);
+	TestEqual(TEXT("Far timers fired"), Expired.Num(), 2);
+	if (Expired.Num() == 2)
+	{
+		TestEqual(TEXT("Far timers in deadline order"), DeadlineById.FindRef(Expired[0]), int64(262154));
+		TestEqual(TEXT("Far timers in deadline order"), DeadlineById.FindRef(Expired[1]), int64(300000));
+	}
+	TestEqual(TEXT("Nothing pending"), Wheel.Num(), 0);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,62 @@
+// Copyright 2025 Celsian Pty Ltd
+
+#include "Misc/AutomationTest.h"
+#include "Types/FPraxisWorkCalendar.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPraxisWorkCalendarTest, "Praxis.Core.WorkCalendar",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPraxisWorkCalendarTest::RunTest(const FString& Parameters)
+{
+	constexpr double Hour = 3600.0;
+	constexpr double Day = FPraxisWorkCalendar::SecondsPerDay;
+	const double Midnight = 20000.0 * Day;
+
+	TestTrue(TEXT("No shifts: around the clock"), FPraxisWorkCalendar().IsAlwaysOpen());
+	TestTrue(TEXT("All three shifts: around the clock"),
+		FPraxisWorkCalendar({ EPraxisShift::Day, EPraxisShift::Afternoon, EPraxisShift::Night }).IsAlwaysOpen());
+
+	// Day shift, 06:00-14:00
+	{
+		const FPraxisWorkCalendar Calendar({ EPraxisShift::Day });
+		TestFalse(TEXT("Day: has closed hours"), Calendar.IsAlwaysOpen());
+		TestEqual(TEXT("Day: NextOpen before the shift"), Calendar.NextOpen(Midnight + 2 * Hour), Midnight + 6 * Hour);
+		TestEqual(TEXT("Day: NextOpen inside the shift"), Calendar.NextOpen(Midnight + 9 * Hour), Midnight + 9 * Hour);
+		TestEqual(TEXT("Day: NextOpen after the shift"), Calendar.NextOpen(Midnight + 15 * Hour), Midnight + Day + 6 * Hour);
+		TestEqual(TEXT("Day: PrevOpen after the shift"), Calendar.PrevOpen(Midnight + 20 * Hour), Midnight + 14 * Hour);
+		TestEqual(TEXT("Day: PrevOpen before the shift"), Calendar.PrevOpen(Midnight + Day + 3 * Hour), Midnight + 14 * Hour);
+
+		// A full shift ends the same day, not at the next one's start
+		TestEqual(TEXT("Day: Advance a full shift"), Calendar.Advance(Midnight + 6 * Hour, 8 * Hour), Midnight + 14 * Hour);
+		TestEqual(TEXT("Day: Advance into the next day"), Calendar.Advance(Midnight + 6 * Hour, 10 * Hour), Midnight + Day + 8 * Hour);
+		TestEqual(TEXT("Day: Advance from closed time"), Calendar.Advance(Midnight + 20 * Hour, 1 * Hour), Midnight + Day + 7 * Hour);
+		TestEqual(TEXT("Day: Advance many days"), Calendar.Advance(Midnight + 10 * Hour, 41 * Hour), Midnight + 5 * Day + 11 * Hour);
+
+		TestEqual(TEXT("Day: Retreat a full shift"), Calendar.Retreat(Midnight + 14 * Hour, 8 * Hour), Midnight + 6 * Hour);
+		TestEqual(TEXT("Day: Retreat into the previous day"), Calendar.Retreat(Midnight + Day + 8 * Hour, 10 * Hour), Midnight + 6 * Hour);
+		TestEqual(TEXT("Day: Retreat from closed time"), Calendar.Retreat(Midnight + Day + 3 * Hour, 1 * Hour), Midnight + 13 * Hour);
+		TestEqual(TEXT("Day: Retreat many days"), Calendar.Retreat(Midnight + 5 * Day + 11 * Hour, 41 * Hour), Midnight + 10 * Hour);
+	}
+
+	// Night shift crosses midnight
+	{
+		const FPraxisWorkCalendar Calendar({ EPraxisShift::Night });
+		TestEqual(TEXT("Night: NextOpen in the day"), Calendar.NextOpen(Midnight + 12 * Hour), Midnight + 22 * Hour);
+		TestEqual(TEXT("Night: Advance across midnight"), Calendar.Advance(Midnight + 22 * Hour, 4 * Hour), Midnight + Day + 2 * Hour);
+		TestEqual(TEXT("Night: Retreat across midnight"), Calendar.Retreat(Midnight + Day + 2 * Hour, 4 * Hour), Midnight + 22 * Hour);
+		TestEqual(TEXT("Night: PrevOpen at midnight"), Calendar.PrevOpen(Midnight + Day), Midnight + Day);
+	}
+
+	// Adjacent shifts merge into one window, 06:00-22:00
+	{
+		const FPraxisWorkCalendar Calendar({ EPraxisShift::Afternoon, EPraxisShift::Day });
+		TestEqual(TEXT("Day+Afternoon: Advance through the change of shift"), Calendar.Advance(Midnight + 12 * Hour, 8 * Hour), Midnight + 20 * Hour);
+		TestEqual(TEXT("Day+Afternoon: Advance overnight"), Calendar.Advance(Midnight + 20 * Hour, 4 * Hour), Midnight + Day + 8 * Hour);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS